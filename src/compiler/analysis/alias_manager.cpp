@@ -76,6 +76,8 @@ bool AliasManager::parseOptimizations(const std::string &optimizations,
       Option::LocalCopyProp = val;
     } else if (opt == "string") {
       Option::StringLoopOpts = val;
+    } else if (opt == "refcount") {
+      Option::RefCountOpts = val;
     } else if (opt == "inline") {
       Option::AutoInline = val;
     } else if (val && (opt == "all" || opt == "none")) {
@@ -1331,6 +1333,15 @@ int AliasManager::optimize(AnalysisResultPtr ar, MethodStatementPtr m) {
     if (!m_changes && Option::StringLoopOpts && !m_wildRefs) {
       stringOptsRecur(m->getStmts());
     }
+
+    if (!m_changes && Option::RefCountOpts && !m_wildRefs &&
+        !m_variables->getAttribute(VariableTable::ContainsDynamicVariable) &&
+        !m_variables->getAttribute(VariableTable::ContainsExtract) &&
+        !m_variables->getAttribute(VariableTable::ContainsCompact) &&
+        !m_variables->getAttribute(VariableTable::ContainsGetDefinedVars)) {
+      collectLastUsesRecur(m->getStmts());
+      refCountOptsRecur(m->getStmts(), false);
+    }
   }
 
   return m_changes ? 1 : 0;
@@ -1553,3 +1564,106 @@ void AliasManager::stringOptsRecur(StatementPtr s) {
     popStringScope(s);
   }
 }
+
+///////////////////////////////////////////////////////////////////////////////
+// reference count elimination
+
+/*
+  Turn "$b = $a;" into a hand-over of $a's value when $a is never read
+  again, saving the incRef of the copy and the decRef when $a dies.
+
+  Without gotos, anything executed after a statement that is not inside a
+  loop comes textually after it, so "never read again" reduces to "this is
+  the last occurrence of $a in the function".
+*/
+void AliasManager::collectLastUsesRecur(ConstructPtr cs) {
+  if (!cs) return;
+
+  if (StatementPtr s = dpc(Statement, cs)) {
+    switch (s->getKindOf()) {
+    case Statement::KindOfFunctionStatement:
+    case Statement::KindOfMethodStatement:
+    case Statement::KindOfClassStatement:
+    case Statement::KindOfInterfaceStatement:
+      return;
+    default:
+      break;
+    }
+  }
+
+  for (int i = 0, n = cs->getKidCount(); i < n; i++) {
+    collectLastUsesRecur(cs->getNthKid(i));
+  }
+
+  if (SimpleVariablePtr sv = dpc(SimpleVariable, cs)) {
+    m_lastUses[sv->getName()] = sv;
+  }
+}
+
+bool AliasManager::isMovable(const std::string &name) {
+  AliasInfo &ai = m_aliasInfo[name];
+  if (ai.getIsRefTo() || ai.getIsGlobal() || ai.getIsParam() ||
+      ai.getRefLevels() ||
+      m_variables->isStatic(name) || m_variables->isGlobal(name)) {
+    return false;
+  }
+  TypePtr type = m_variables->getFinalType(name);
+  return type && (type->is(Type::KindOfVariant) ||
+                  type->is(Type::KindOfString) ||
+                  type->is(Type::KindOfArray));
+}
+
+void AliasManager::refCountOptsRecur(StatementPtr s, bool inLoop) {
+  if (!s) return;
+
+  switch (s->getKindOf()) {
+  case Statement::KindOfFunctionStatement:
+  case Statement::KindOfMethodStatement:
+  case Statement::KindOfClassStatement:
+  case Statement::KindOfInterfaceStatement:
+    return;
+
+  case Statement::KindOfForStatement:
+  case Statement::KindOfWhileStatement:
+  case Statement::KindOfDoStatement:
+  case Statement::KindOfForEachStatement:
+    inLoop = true;
+    break;
+
+  case Statement::KindOfExpStatement:
+    if (!inLoop) {
+      AssignmentExpressionPtr ae =
+        dpc(AssignmentExpression, spc(ExpStatement, s)->getExpression());
+      if (!ae || ae->isMoveValue()) return;
+      SimpleVariablePtr var = dpc(SimpleVariable, ae->getVariable());
+      SimpleVariablePtr val = dpc(SimpleVariable, ae->getValue());
+      if (!var || !val ||
+          (val->getContext() & Expression::RefValue) ||
+          var->isThis() || val->isThis() ||
+          var->isSuperGlobal() || val->isSuperGlobal()) {
+        return;
+      }
+      const std::string &to = var->getName();
+      const std::string &from = val->getName();
+      if (to == from || !isMovable(to) || !isMovable(from) ||
+          m_lastUses[from] != val ||
+          !Type::SameType(m_variables->getFinalType(to),
+                          m_variables->getFinalType(from))) {
+        return;
+      }
+      ae->setMoveValue();
+      // one incRef for the copy, one decRef when $from goes away
+      m_arp->addRefCountOpsEliminated(2);
+    }
+    return;
+
+  default:
+    break;
+  }
+
+  for (int i = 0, n = s->getKidCount(); i < n; i++) {
+    if (StatementPtr skid = dpc(Statement, s->getNthKid(i))) {
+      refCountOptsRecur(skid, inLoop);
+    }
+  }
+}
@@ -145,6 +145,10 @@ class AliasManager {
   void stringOptsRecur(StatementPtr s);
   void stringOptsRecur(ExpressionPtr s, bool ok);
 
+  void collectLastUsesRecur(ConstructPtr cs);
+  bool isMovable(const std::string &name);
+  void refCountOptsRecur(StatementPtr s, bool inLoop);
+
   BucketMap             m_bucketMap;
   CondStack             m_stack;
 
@@ -159,6 +163,7 @@ class AliasManager {
   VariableTablePtr      m_variables;
 
   LoopInfoVec           m_loopInfo;
+  StringToExpressionPtrMap m_lastUses;
 
   std::string           m_returnVar;
   int                   m_nrvoFix;
@@ -28,6 +28,7 @@
 #include <util/util.h>
 #include <util/hash.h>
 #include <compiler/option.h>
+#include <compiler/util/output_file.h>
 #include <compiler/analysis/function_scope.h>
 #include <compiler/builtin_symbols.h>
 #include <compiler/analysis/constant_table.h>
@@ -52,6 +53,7 @@ AnalysisResult::AnalysisResult()
     m_package(NULL), m_parseOnDemand(false), m_phase(AnalyzeInclude),
     m_newlyInferred(0), m_dynamicClass(false), m_dynamicFunction(false),
     m_classForcedVariants(false), m_optCounter(0),
+    m_refCountOpsEliminated(0),
     m_scalarArraysCounter(0), m_paramRTTICounter(0),
     m_insideScalarArray(false), m_inExpression(false),
     m_wrappedExpression(false),
@@ -938,7 +940,7 @@ bool AnalysisResult::outputAllPHP(CodeGenerator::Output output) {
     for (StringToFileScopePtrMap::const_iterator iter = m_files.begin();
          iter != m_files.end(); ++iter) {
       string fullPath = prepareFile(m_outputPath.c_str(), iter->first, false);
-      ofstream f(fullPath.c_str());
+      OutputFile f(fullPath.c_str());
       if (f) {
         CodeGenerator cg(&f, output);
         cg_printf("<?php\n");
@@ -1022,6 +1024,15 @@ void AnalysisResult::clusterByFileSizes(StringToFileScopePtrVecMap &clusters,
   }
 }
 
+// parts a bigger version of a file was cut into last time
+static void remove_parts(const string &base, int from) {
+  char name[PATH_MAX];
+  for (int seq = from; ; seq++) {
+    snprintf(name, sizeof(name), "%s-%d.cpp", base.c_str(), seq);
+    if (remove(name)) break;
+  }
+}
+
 void AnalysisResult::repartitionCPP(const string &filename, int64 targetSize,
                                     bool insideHPHP) {
   struct stat results;
@@ -1032,6 +1043,7 @@ void AnalysisResult::repartitionCPP(const string &filename, int64 targetSize,
   int64 size = (int64)results.st_size;
   if (size <= targetSize * 2) {
     // tolerable size
+    remove_parts(filename.substr(0, filename.length() - 4), 0);
     return;
   }
 
@@ -1058,7 +1070,7 @@ void AnalysisResult::repartitionCPP(const string &filename, int64 targetSize,
   string base = filename.substr(0, filename.length() - 4);
   char foutName[PATH_MAX];
   snprintf(foutName, sizeof(foutName), "%s-%d.cpp", base.c_str(), seq);
-  ofstream fout(foutName);
+  OutputFile fout(foutName);
   while (getline(fin, line)) {
     fout << line << endl;
 
@@ -1111,6 +1123,8 @@ void AnalysisResult::repartitionCPP(const string &filename, int64 targetSize,
   }
   fout.close();
 
+  remove_parts(base, seq + 1);
+
   fin.close();
   remove(filename.c_str());
 }
@@ -1126,12 +1140,17 @@ void AnalysisResult::repartitionLargeCPP(const vector<string> &filenames,
       count++;
     }
   }
+  // Cut points move whenever the target does, which rewrites every part
+  // after them. So the average is rounded down to a power of two, and a
+  // change to one PHP file almost never moves the cut points of others.
   int64 averageSize = totalSize / count;
+  int64 targetSize = 1;
+  while (targetSize * 2 <= averageSize) targetSize *= 2;
   for (unsigned int i = 0; i < filenames.size(); i++) {
-    repartitionCPP(filenames[i], averageSize, true);
+    repartitionCPP(filenames[i], targetSize, true);
   }
   for (unsigned int i = 0; i < additionals.size(); i++) {
-    repartitionCPP(additionals[i], averageSize, false);
+    repartitionCPP(additionals[i], targetSize, false);
   }
 }
 
@@ -1167,7 +1186,7 @@ void AnalysisResult::outputAllCPP(CodeGenerator::Output output,
     Util::mkdir(root + iter->first);
     string filename = root + iter->first + ".cpp";
     filenames.push_back(filename);
-    ofstream f(filename.c_str());
+    OutputFile f(filename.c_str());
     if (compileDir) {
       // this is the file that will be compiled, so we need to use this
       // for source info:
@@ -1186,13 +1205,13 @@ void AnalysisResult::outputAllCPP(CodeGenerator::Output output,
       string fileHeader = root + header;
       string fwFileHeader = root + fwheader;
       {
-        ofstream f(fwFileHeader.c_str());
+        OutputFile f(fwFileHeader.c_str());
         CodeGenerator cg(&f, output);
         fs->outputCPPForwardDeclHeader(cg, ar);
         f.close();
       }
       {
-        ofstream f(fileHeader.c_str());
+        OutputFile f(fileHeader.c_str());
         CodeGenerator cg(&f, output);
         fs->outputCPPDeclHeader(cg, ar);
         f.close();
@@ -1255,6 +1274,9 @@ void AnalysisResult::outputAllCPP(CodeGenerator::Output output,
   if (Option::GenRTTIProfileData) {
     outputRTTIMetaData(Option::RTTIOutputFile.c_str());
   }
+
+  Logger::Info("%d of %d generated files changed",
+               OutputFile::GetWrittenCount(), OutputFile::GetClosedCount());
 }
 
 void AnalysisResult::outputAllCPP(CodeGenerator &cg) {
@@ -1359,7 +1381,7 @@ void AnalysisResult::outputCPPClassMapFile() {
   string filename = m_outputPath + "/" + Option::SystemFilePrefix +
     "class_map.cpp";
   Util::mkdir(filename);
-  ofstream f(filename.c_str());
+  OutputFile f(filename.c_str());
   CodeGenerator cg(&f, CodeGenerator::ClusterCPP);
   cg_printf("\n");
   cg_printInclude("<runtime/base/hphp.h>");
@@ -1398,7 +1420,7 @@ void AnalysisResult::outputCPPSourceInfos() {
   string filename = m_outputPath + "/" + Option::SystemFilePrefix +
     "source_info.cpp";
   Util::mkdir(filename);
-  ofstream f(filename.c_str());
+  OutputFile f(filename.c_str());
   CodeGenerator cg(&f, CodeGenerator::ClusterCPP);
   cg_printf("\n");
   cg_printInclude("<runtime/base/hphp.h>");
@@ -1429,7 +1451,7 @@ void AnalysisResult::outputCPPNameMaps() {
   string filename = m_outputPath + "/" + Option::SystemFilePrefix +
     "name_maps.cpp";
   Util::mkdir(filename);
-  ofstream f(filename.c_str());
+  OutputFile f(filename.c_str());
   CodeGenerator cg(&f, CodeGenerator::ClusterCPP);
   cg_printf("\n");
   cg_printInclude("<runtime/base/hphp.h>");
@@ -1574,7 +1596,7 @@ void AnalysisResult::outputCPPDynamicTables(CodeGenerator::Output output) {
     string tablePath = m_outputPath + "/" + Option::SystemFilePrefix +
       "dynamic_table_func.no.cpp";
     Util::mkdir(tablePath);
-    ofstream fTable(tablePath.c_str());
+    OutputFile fTable(tablePath.c_str());
     CodeGenerator cg(&fTable, output);
 
     outputCPPDynamicTablesHeader(cg, true, false);
@@ -1712,7 +1734,7 @@ void AnalysisResult::outputCPPDynamicTables(CodeGenerator::Output output) {
     string tablePath = m_outputPath + "/" + Option::SystemFilePrefix +
       "dynamic_table_class.no.cpp";
     Util::mkdir(tablePath);
-    ofstream fTable(tablePath.c_str());
+    OutputFile fTable(tablePath.c_str());
     CodeGenerator cg(&fTable, output);
 
     outputCPPDynamicTablesHeader(cg, true, false);
@@ -1767,7 +1789,7 @@ void AnalysisResult::outputCPPDynamicTables(CodeGenerator::Output output) {
     string tablePath = m_outputPath + "/" + Option::SystemFilePrefix +
       "dynamic_table_constant.no.cpp";
     Util::mkdir(tablePath);
-    ofstream fTable(tablePath.c_str());
+    OutputFile fTable(tablePath.c_str());
     CodeGenerator cg(&fTable, output);
 
     outputCPPDynamicTablesHeader(cg, true, false);
@@ -1842,7 +1864,7 @@ void AnalysisResult::outputCPPDynamicTables(CodeGenerator::Output output) {
     string tablePath = m_outputPath + "/" + Option::SystemFilePrefix +
       "dynamic_table_file.no.cpp";
     Util::mkdir(tablePath);
-    ofstream fTable(tablePath.c_str());
+    OutputFile fTable(tablePath.c_str());
     CodeGenerator cg(&fTable, output);
 
     outputCPPDynamicTablesHeader(cg, false, false);
@@ -1937,12 +1959,12 @@ void AnalysisResult::outputCPPSystem() {
 
   string headerPath = m_outputPath + "/" + filename;
   Util::mkdir(headerPath);
-  ofstream fSystem(headerPath.c_str());
+  OutputFile fSystem(headerPath.c_str());
   CodeGenerator cg(&fSystem, CodeGenerator::SystemCPP);
 
   string implPath = m_outputPath + "/" + Option::SystemFilePrefix +
     "system_globals.cpp";
-  ofstream fSystemImpl(implPath.c_str());
+  OutputFile fSystemImpl(implPath.c_str());
   cg.setStream(CodeGenerator::ImplFile, &fSystemImpl);
 
   cg.headerBegin(filename.c_str());
@@ -2262,7 +2284,7 @@ void AnalysisResult::outputCPPGlobalDeclarations() {
 
   string headerPath = m_outputPath + "/" + filename;
   Util::mkdir(headerPath);
-  ofstream f(headerPath.c_str());
+  OutputFile f(headerPath.c_str());
   CodeGenerator cg(&f, CodeGenerator::ClusterCPP);
 
   cg.headerBegin(filename.c_str());
@@ -2403,7 +2425,7 @@ void AnalysisResult::outputCPPScalarArrays(bool system) {
     string filename = m_outputPath + "/" + Option::SystemFilePrefix +
       "scalar_arrays_" + lexical_cast<string>(i) + ".no.cpp";
     Util::mkdir(filename);
-    ofstream f(filename.c_str());
+    OutputFile f(filename.c_str());
     CodeGenerator cg(&f, system ? CodeGenerator::SystemCPP :
                      CodeGenerator::ClusterCPP);
 
@@ -2482,7 +2504,7 @@ void AnalysisResult::outputCPPGlobalVariablesMethods(int part) {
   string filename = m_outputPath + "/" + Option::SystemFilePrefix +
     "global_variables_" + lexical_cast<string>(part) + ".no.cpp";
   Util::mkdir(filename);
-  ofstream f(filename.c_str());
+  OutputFile f(filename.c_str());
   CodeGenerator cg(&f, CodeGenerator::ClusterCPP);
   AnalysisResultPtr ar = shared_from_this();
 
@@ -2554,7 +2576,7 @@ void AnalysisResult::outputCPPGlobalState() {
   string filename = m_outputPath + "/" + Option::SystemFilePrefix +
     "global_state.no.cpp";
   Util::mkdir(filename);
-  ofstream f(filename.c_str());
+  OutputFile f(filename.c_str());
   CodeGenerator cg(&f, CodeGenerator::ClusterCPP);
   AnalysisResultPtr ar = shared_from_this();
 
@@ -2706,7 +2728,7 @@ void AnalysisResult::outputCPPFiberGlobalState() {
   string filename = m_outputPath + "/" + Option::SystemFilePrefix +
     "global_state_fiber.no.cpp";
   Util::mkdir(filename);
-  ofstream f(filename.c_str());
+  OutputFile f(filename.c_str());
   CodeGenerator cg(&f, CodeGenerator::ClusterCPP);
   AnalysisResultPtr ar = shared_from_this();
 
@@ -2840,7 +2862,7 @@ void AnalysisResult::outputCPPMain() {
   string mainPath = m_outputPath + "/" + Option::SystemFilePrefix +
     "main.no.cpp";
   Util::mkdir(mainPath);
-  ofstream fMain(mainPath.c_str());
+  OutputFile fMain(mainPath.c_str());
   CodeGenerator cg(&fMain, CodeGenerator::ClusterCPP);
 
   cg_printf("\n");
@@ -2988,8 +3010,8 @@ void AnalysisResult::outputCPPFFIStubs() {
   string hPath = m_outputPath + "/" + Option::FFIFilePrefix +
     "stubs.h";
   Util::mkdir(iPath);
-  ofstream fi(iPath.c_str());
-  ofstream fh(hPath.c_str());
+  OutputFile fi(iPath.c_str());
+  OutputFile fh(hPath.c_str());
   CodeGenerator cg(&fh, CodeGenerator::ClusterCPP);
   cg_printInclude("<runtime/base/hphp_ffi.h>");
   cg_printf("using namespace HPHP;\n");
@@ -3018,7 +3040,7 @@ void AnalysisResult::outputHSFFIStubs() {
   string path = m_outputPath + "/" + Option::FFIFilePrefix +
     "HphpStubs.hs";
   Util::mkdir(path);
-  ofstream f(path.c_str());
+  OutputFile f(path.c_str());
   CodeGenerator cg(&f, CodeGenerator::ClusterCPP);
   cg_printf("{-# INCLUDE \"stubs.h\" #-}\n");
   cg_printf("{-# LANGUAGE ForeignFunctionInterface #-}\n");
@@ -3065,7 +3087,7 @@ void AnalysisResult::outputJavaFFIStubs() {
   Util::mkdir(outputDir);
 
   string mainFile = outputDir + "HphpMain.java";
-  ofstream fmain(mainFile.c_str());
+  OutputFile fmain(mainFile.c_str());
   CodeGenerator cg(&fmain, CodeGenerator::FileCPP);
   cg.setContext(CodeGenerator::JavaFFI);
 
@@ -3100,7 +3122,7 @@ void AnalysisResult::outputJavaFFICppDecl() {
   string path = m_outputPath + "/" + Option::FFIFilePrefix +
     "java_stubs.h";
   Util::mkdir(path);
-  ofstream f(path.c_str());
+  OutputFile f(path.c_str());
   CodeGenerator cg(&f, CodeGenerator::ClusterCPP);
   cg.setContext(CodeGenerator::JavaFFICppDecl);
 
@@ -3130,7 +3152,7 @@ void AnalysisResult::outputJavaFFICppImpl() {
   string path = m_outputPath + "/" + Option::FFIFilePrefix +
     "java_stubs.cpp";
   Util::mkdir(path);
-  ofstream f(path.c_str());
+  OutputFile f(path.c_str());
   CodeGenerator cg(&f, CodeGenerator::ClusterCPP);
   cg.setContext(CodeGenerator::JavaFFICppImpl);
 
@@ -3181,7 +3203,7 @@ void AnalysisResult::outputSwigFFIStubs() {
   string path = m_outputPath + "/" + Option::FFIFilePrefix +
     Option::ProgramName + ".i";
   Util::mkdir(path);
-  ofstream f(path.c_str());
+  OutputFile f(path.c_str());
   CodeGenerator cg(&f, CodeGenerator::ClusterCPP);
 
   cg_printf("%%module %s\n%%{\n", Option::ProgramName.c_str());
@@ -3326,7 +3348,7 @@ void AnalysisResult::outputCPPLiteralStringPrecomputation() {
     string filename = m_outputPath + "/" + Option::SystemFilePrefix +
       "literal_strings.h";
     Util::mkdir(filename);
-    ofstream f(filename.c_str());
+    OutputFile f(filename.c_str());
     CodeGenerator cg(&f, CodeGenerator::ClusterCPP);
 
     cg_printf("\n");
@@ -3366,7 +3388,7 @@ void AnalysisResult::outputCPPLiteralStringPrecomputation() {
       "literal_strings_" << i << ".cpp";
     string filename = filenames.str();
     Util::mkdir(filename);
-    ofstream f(filename.c_str());
+    OutputFile f(filename.c_str());
     CodeGenerator cg(&f, CodeGenerator::ClusterCPP);
     cg_printf("\n");
     cg_printInclude("\"literal_strings.h\"");
@@ -3411,7 +3433,7 @@ void AnalysisResult::outputCPPLiteralStringPrecomputation() {
 void AnalysisResult::outputCPPSepExtensionMake() {
   string filename = m_outputPath + "/sep_extensions.mk";
   Util::mkdir(filename);
-  ofstream f(filename.c_str());
+  OutputFile f(filename.c_str());
 
   f << "\nSEP_EXTENSION_INCLUDE_PATHS = \\\n";
   for (unsigned int i = 0; i < Option::SepExtensions.size(); i++) {
@@ -3466,7 +3488,7 @@ void AnalysisResult::outputCPPSepExtensionIncludes(CodeGenerator &cg) {
 void AnalysisResult::outputCPPSepExtensionImpl(const std::string &filename) {
   AnalysisResultPtr ar = shared_from_this();
 
-  ofstream fTable(filename.c_str());
+  OutputFile fTable(filename.c_str());
   CodeGenerator cg(&fTable, CodeGenerator::SystemCPP);
 
   outputCPPDynamicTablesHeader(cg, true, false, true);
@@ -173,6 +173,24 @@ public:
     m_newlyInferred++;
   }
 
+  /**
+   * Number of incRef/decRef operations optimizations removed from the
+   * generated code, for stats reporting.
+   */
+  void addRefCountOpsEliminated(int count) {
+    m_refCountOpsEliminated += count;
+  }
+  int getRefCountOpsEliminated() const { return m_refCountOpsEliminated;}
+
+  /**
+   * Builtin calls evaluated at compile time, keyed by function name, for
+   * stats reporting.
+   */
+  void addFoldedCall(const std::string &name) { m_foldedCalls[name]++;}
+  const std::map<std::string, int> &getFoldedCalls() const {
+    return m_foldedCalls;
+  }
+
   void containsDynamicFunctionCall() { m_dynamicFunction = true;}
   void containsDynamicClass() { m_dynamicClass = true;}
 
@@ -402,6 +420,8 @@ private:
   StatementPtrSet m_calleesAdded;
   std::string m_outputPath;
   int m_optCounter;
+  int m_refCountOpsEliminated;
+  std::map<std::string, int> m_foldedCalls;
 
   std::map<std::string, int> m_scalarArrays;
   int m_scalarArraysCounter;
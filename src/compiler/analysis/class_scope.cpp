@@ -24,6 +24,7 @@
 #include <compiler/analysis/variable_table.h>
 #include <compiler/statement/statement_list.h>
 #include <compiler/option.h>
+#include <compiler/util/output_file.h>
 #include <compiler/statement/interface_statement.h>
 #include <util/util.h>
 #include <compiler/analysis/constant_table.h>
@@ -918,7 +919,7 @@ void ClassScope::outputCPPHeader(CodeGenerator &old_cg, AnalysisResultPtr ar,
   string filename = getHeaderFilename(old_cg);
   string root = ar->getOutputPath() + "/";
   Util::mkdir(root + filename);
-  ofstream f((root + filename).c_str());
+  OutputFile f((root + filename).c_str());
   CodeGenerator cg(&f, output);
 
   cg.headerBegin(filename);
@@ -45,7 +45,7 @@ AssignmentExpression::AssignmentExpression
 (EXPRESSION_CONSTRUCTOR_PARAMETERS,
  ExpressionPtr variable, ExpressionPtr value, bool ref)
   : Expression(EXPRESSION_CONSTRUCTOR_PARAMETER_VALUES),
-    m_variable(variable), m_value(value), m_ref(ref) {
+    m_variable(variable), m_value(value), m_ref(ref), m_move(false) {
   m_variable->setContext(Expression::DeepAssignmentLHS);
   m_variable->setContext(Expression::AssignmentLHS);
   m_variable->setContext(Expression::LValue);
@@ -224,6 +224,16 @@ void AssignmentExpression::outputCPPImpl(CodeGenerator &cg,
   BlockScopePtr scope = ar->getScope();
   bool ref = (m_ref && !m_value->is(Expression::KindOfNewObjectExpression));
 
+  if (m_move && !m_variable->hasCPPTemp() && !m_value->hasCPPTemp()) {
+    // both sides are plain locals of the same type, see AliasManager
+    cg_printf("moveVal(");
+    m_variable->outputCPPImpl(cg, ar);
+    cg_printf(", ");
+    m_value->outputCPPImpl(cg, ar);
+    cg_printf(")");
+    return;
+  }
+
   bool setElement = false; // turning $a['elem'] = $b into $a.set('elem', $b);
   bool type_cast = false;
   bool setNull = false;
@@ -45,12 +45,20 @@ public:
   ExpressionPtr getValue() { return m_value;}
   int getLocalEffects() const;
 
+  /**
+   * The value is a local that is never read again, so it can be handed over
+   * to the variable instead of being copied.
+   */
+  void setMoveValue() { m_move = true;}
+  bool isMoveValue() const { return m_move;}
+
 private:
   ExpressionPtr makeIdCall(AnalysisResultPtr ar);
 
   ExpressionPtr m_variable;
   ExpressionPtr m_value;
   bool m_ref;
+  bool m_move;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -449,6 +449,94 @@ static int cloneStmtsForInline(ExpressionListPtr elist, StatementPtr s,
   return 1;
 }
 
+// folded strings longer than this are left as calls
+static const int MaxFoldedStringSize = 4096;
+// and arrays bigger than this are not even built
+static const int MaxFoldedArraySize = 65536;
+
+static int64 format_size_bound(CStrRef format) {
+  int64 total = format.size();
+  const char *p = format.data();
+  const char *end = p + format.size();
+  while (p < end) {
+    if (!isdigit(*p)) {
+      p++;
+      continue;
+    }
+    // any number may be a width or precision
+    int64 n = 0;
+    for (; p < end && isdigit(*p); p++) {
+      if (n <= MaxFoldedStringSize) n = n * 10 + (*p - '0');
+    }
+    total += n;
+  }
+  return total;
+}
+
+/**
+ * Whether folding a builtin with these arguments could produce something too
+ * big to be worth it, for the ones whose result can be far bigger than their
+ * arguments, so they are not run at compile time just to find out.
+ */
+static bool fold_too_big(const string &name, CArrRef args) {
+  int n = args.size();
+  if (name == "str_repeat" && n >= 2) {
+    return (int64)args[0].toString().size() * args[1].toInt32() >
+      MaxFoldedStringSize;
+  }
+  if (name == "str_pad" && n >= 2) {
+    return args[1].toInt32() > MaxFoldedStringSize;
+  }
+  if (name == "sprintf" && n >= 1) {
+    int64 size = format_size_bound(args[0].toString());
+    for (int i = 1; i < n; i++) size += args[i].toString().size();
+    return size > MaxFoldedStringSize;
+  }
+  if (name == "vsprintf" && n >= 2) {
+    int64 size = format_size_bound(args[0].toString());
+    if (args[1].isArray()) {
+      for (ArrayIter iter(args[1]); iter; ++iter) {
+        size += iter.second().toString().size();
+      }
+    }
+    return size > MaxFoldedStringSize;
+  }
+  if ((name == "str_replace" || name == "str_ireplace") && n >= 3) {
+    // every byte of the subject replaced by the longest replacement
+    int64 longest = 0;
+    if (args[1].isArray()) {
+      for (ArrayIter iter(args[1]); iter; ++iter) {
+        longest = max(longest, (int64)iter.second().toString().size());
+      }
+    } else {
+      longest = args[1].toString().size();
+    }
+    int64 subject = 0;
+    if (args[2].isArray()) {
+      for (ArrayIter iter(args[2]); iter; ++iter) {
+        subject += iter.second().toString().size();
+      }
+    } else {
+      subject = args[2].toString().size();
+    }
+    return subject * (longest + 1) > MaxFoldedStringSize;
+  }
+  if (name == "array_fill" && n >= 2) {
+    return args[1].toInt32() > MaxFoldedArraySize;
+  }
+  if (name == "array_pad" && n >= 2) {
+    return abs(args[1].toInt32()) > MaxFoldedArraySize;
+  }
+  if (name == "range" && n >= 2) {
+    if (args[0].isString() && args[1].isString()) return false; // letters
+    double step = n >= 3 ? fabs(args[2].toDouble()) : 1.0;
+    if (step == 0) step = 1.0;
+    return fabs(args[1].toDouble() - args[0].toDouble()) / step >
+      MaxFoldedArraySize;
+  }
+  return false;
+}
+
 ExpressionPtr SimpleFunctionCall::optimize(AnalysisResultPtr ar) {
   if (m_class || !m_className.empty() || !m_funcScope) return ExpressionPtr();
 
@@ -463,11 +551,19 @@ ExpressionPtr SimpleFunctionCall::optimize(AnalysisResultPtr ar) {
           arr.set(i, v);
         }
       }
+      if (fold_too_big(m_funcScope->getName(), arr)) {
+        return ExpressionPtr();
+      }
       try {
         g_context->setThrowAllErrors(true);
         Variant v = invoke_builtin(m_funcScope->getName().c_str(),
                                    arr, -1, true);
         g_context->setThrowAllErrors(false);
+        // keep calls like str_repeat() that would bloat the binary at runtime
+        if (v.isString() && v.toString().size() > MaxFoldedStringSize) {
+          return ExpressionPtr();
+        }
+        ar->addFoldedCall(m_funcScope->getName());
         return MakeScalarExpression(ar, getLocation(), v);
       } catch (...) {
         g_context->setThrowAllErrors(false);
@@ -1248,6 +1344,20 @@ void SimpleFunctionCall::outputCPPImpl(CodeGenerator &cg,
   if (linemap) cg_printf(")");
 }
 
+bool SimpleFunctionCall::outputCPPEcho(CodeGenerator &cg,
+                                       AnalysisResultPtr ar) {
+  if (!m_valid || !m_builtinFunction || m_class || !m_className.empty() ||
+      m_name != "json_encode" || !m_params || m_params->getCount() == 0 ||
+      m_params->getCount() > 2) {
+    return false;
+  }
+  cg_printf("echo_json_encode(");
+  FunctionScope::outputCPPArguments(m_params, cg, ar, m_extraArg,
+                                    m_variableArgument, m_argArrayId);
+  cg_printf(");\n");
+  return true;
+}
+
 bool SimpleFunctionCall::canInvokeFewArgs() {
   // We can always change out minds about saying yes, but once we say
   // no, it sticks.
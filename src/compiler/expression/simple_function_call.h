@@ -56,6 +56,13 @@ public:
 
   void addDependencies(AnalysisResultPtr ar);
   const std::string &getName() const { return m_name;}
+
+  /**
+   * Outputs "echo json_encode(...)" as a call that streams the encoded value
+   * into the output without building a String first. Returns false without
+   * writing anything if this call can't be echoed that way.
+   */
+  bool outputCPPEcho(CodeGenerator &cg, AnalysisResultPtr ar);
 private:
   enum FunctionType {
     UnknownType,
@@ -170,6 +170,7 @@ int Option::InvokeFewArgsCount = 6;
 bool Option::PrecomputeLiteralStrings = true;
 bool Option::FlattenInvoke = true;
 int Option::InlineFunctionThreshold = -1;
+int Option::SwitchHashThreshold = 8;
 bool Option::ControlEvalOrder = true;
 
 bool Option::AllDynamic = true;
@@ -184,6 +185,7 @@ bool Option::UseVirtualDispatch = false;
 bool Option::EliminateDeadCode = true;
 bool Option::LocalCopyProp = true;
 bool Option::StringLoopOpts = true;
+bool Option::RefCountOpts = true;
 bool Option::AutoInline = false;
 
 bool Option::FlAnnotate = false;
@@ -338,10 +340,12 @@ void Option::Load(Hdf &config) {
 
   GenerateSourceInfo = config["GenerateSourceInfo"].getBool(false);
   UseVirtualDispatch = config["UseVirtualDispatch"].getBool(false);
+  SwitchHashThreshold = config["SwitchHashThreshold"].getInt32(8);
 
   EliminateDeadCode  = config["EliminateDeadCode"].getBool(true);
   LocalCopyProp      = config["LocalCopyProp"].getBool(true);
   StringLoopOpts     = config["StringLoopOpts"].getBool(true);
+  RefCountOpts       = config["RefCountOpts"].getBool(true);
   AutoInline         = config["AutoInline"].getBool(false);
 
   OnLoad();
@@ -297,6 +297,7 @@ public:
   static bool PrecomputeLiteralStrings;
   static bool FlattenInvoke;
   static int InlineFunctionThreshold;
+  static int SwitchHashThreshold; // min string cases for hashed dispatch
   static bool ControlEvalOrder;
   static bool GenerateSourceInfo;
   static bool UseVirtualDispatch;
@@ -304,6 +305,7 @@ public:
   static bool EliminateDeadCode;
   static bool LocalCopyProp;
   static bool StringLoopOpts;
+  static bool RefCountOpts;
   static bool AutoInline;
 
   static bool FlAnnotate; // annotate emitted code withe compiler file-line info
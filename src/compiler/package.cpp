@@ -402,7 +402,8 @@ void Package::saveStatsToFile(const char *filename, int totalSeconds) const {
       .add("CharCount", getCharCount())
       .add("FunctionCount", m_ar->getFunctionCount())
       .add("ClassCount", m_ar->getClassCount())
-      .add("TotalTime", totalSeconds);
+      .add("TotalTime", totalSeconds)
+      .add("RefCountOpsEliminated", m_ar->getRefCountOpsEliminated());
 
     if (getLineCount()) {
       ms.add("AvgCharPerLine", getCharCount() / getLineCount());
@@ -418,6 +419,9 @@ void Package::saveStatsToFile(const char *filename, int totalSeconds) const {
     ms.add("SymbolTypes");
     o << counts;
 
+    ms.add("FoldedCalls");
+    o << m_ar->getFoldedCalls();
+
     ms.add("VariableTableFunctions");
     JSON::ListStream ls(o);
     BOOST_FOREACH(const std::string &f, m_ar->m_variableTableFunctions) {
@@ -43,6 +43,7 @@ public:
   bool isLiteralInteger() const;
   bool isLiteralString() const;
   int64 getLiteralInteger() const;
+  std::string getLiteralString() const;
 
   /**
    * SwitchStatement needs to inspect this expression.
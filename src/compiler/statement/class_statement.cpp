@@ -30,6 +30,7 @@
 #include <util/util.h>
 #include <compiler/statement/interface_statement.h>
 #include <compiler/option.h>
+#include <compiler/util/output_file.h>
 #include <sstream>
 #include <algorithm>
 
@@ -735,7 +736,7 @@ void ClassStatement::outputCPPImpl(CodeGenerator &cg, AnalysisResultPtr ar) {
       // uses a different cg to generate a separate file for each PHP class
       // also, uses the original capitalized class name
       string clsFile = outputDir + getOriginalName() + ".java";
-      ofstream fcls(clsFile.c_str());
+      OutputFile fcls(clsFile.c_str());
       CodeGenerator cgCls(&fcls, CodeGenerator::FileCPP);
       cgCls.setContext(CodeGenerator::JavaFFI);
 
@@ -26,6 +26,7 @@
 #include <compiler/analysis/variable_table.h>
 #include <util/util.h>
 #include <compiler/option.h>
+#include <compiler/util/output_file.h>
 #include <compiler/parser/parser.h>
 
 using namespace HPHP;
@@ -353,7 +354,7 @@ void InterfaceStatement::outputCPPImpl(CodeGenerator &cg, AnalysisResultPtr ar)
 
       // uses a different cg to generate a separate file for each PHP class
       string clsFile = outputDir + getOriginalName() + ".java";
-      ofstream fcls(clsFile.c_str());
+      OutputFile fcls(clsFile.c_str());
       CodeGenerator cgCls(&fcls, CodeGenerator::FileCPP);
       cgCls.setContext(CodeGenerator::JavaFFIInterface);
 
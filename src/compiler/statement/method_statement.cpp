@@ -373,7 +373,8 @@ StatementPtr MethodStatement::postOptimize(AnalysisResultPtr ar) {
   FunctionScopePtr funcScope = m_funcScope.lock();
   ar->pushScope(funcScope);
   if (ar->getPhase() != AnalysisResult::AnalyzeInclude &&
-      (Option::LocalCopyProp || Option::StringLoopOpts)) {
+      (Option::LocalCopyProp || Option::StringLoopOpts ||
+       Option::RefCountOpts)) {
     int flag;
     do {
       AliasManager am;
@@ -20,6 +20,8 @@
 #include <compiler/statement/case_statement.h>
 #include <compiler/option.h>
 #include <compiler/analysis/code_error.h>
+#include <compiler/util/jump_table.h>
+#include <runtime/base/zend/zend_functions.h>
 
 using namespace HPHP;
 using namespace std;
@@ -253,13 +255,21 @@ void SwitchStatement::outputCPPImpl(CodeGenerator &cg, AnalysisResultPtr ar) {
       for (int i = 0; i < m_cases->getCount(); i++) {
         CaseStatementPtr stmt =
           dynamic_pointer_cast<CaseStatement>((*m_cases)[i]);
-        if (stmt->getCondition()) {
-          stmt->outputCPPAsIf(cg, ar, varId, i);
-        } else {
+        if (!stmt->getCondition()) {
           defaultCase = stmt;
           defaultCaseNum = i;
         }
       }
+      if (hasHashableCases()) {
+        outputCPPHashDispatch(cg, ar, varId, labelId, defaultCaseNum);
+      }
+      for (int i = 0; i < m_cases->getCount(); i++) {
+        CaseStatementPtr stmt =
+          dynamic_pointer_cast<CaseStatement>((*m_cases)[i]);
+        if (stmt->getCondition()) {
+          stmt->outputCPPAsIf(cg, ar, varId, i);
+        }
+      }
       if (defaultCaseNum != -1) {
         defaultCase->outputCPPAsIf(cg, ar, varId, defaultCaseNum);
       } else {
@@ -288,3 +298,78 @@ void SwitchStatement::outputCPPImpl(CodeGenerator &cg, AnalysisResultPtr ar) {
   cg_indentEnd("}\n");
   cg.popBreakScope();
 }
+
+bool SwitchStatement::hasHashableCases() const {
+  TypePtr type = m_exp->getType();
+  if (!type->is(Type::KindOfString) && !type->is(Type::KindOfVariant)) {
+    return false;
+  }
+  int count = 0;
+  for (int i = 0; i < m_cases->getCount(); i++) {
+    CaseStatementPtr stmt =
+      dynamic_pointer_cast<CaseStatement>((*m_cases)[i]);
+    if (!stmt->getCondition()) continue;
+    if (!stmt->isLiteralString()) return false;
+
+    // numeric strings compare numerically, and keys are NUL terminated
+    string s = stmt->getLiteralString();
+    if (s.find('\0') != string::npos ||
+        is_numeric_string(s.data(), s.size(), NULL, NULL, 0) != KindOfNull) {
+      return false;
+    }
+    count++;
+  }
+  return count >= Option::SwitchHashThreshold;
+}
+
+/**
+ * When the switch value turns out to be a string at runtime, none of the
+ * non-numeric literal cases can match it loosely unless they match it
+ * exactly, so we can jump straight to the right case by hash. Any other
+ * value falls through to the sequential equal() checks.
+ */
+void SwitchStatement::outputCPPHashDispatch(CodeGenerator &cg,
+                                            AnalysisResultPtr ar,
+                                            int varId, int labelId,
+                                            int defaultCaseNum) {
+  map<string, int> firstCases;
+  vector<string> strings;
+  for (int i = 0; i < m_cases->getCount(); i++) {
+    CaseStatementPtr stmt =
+      dynamic_pointer_cast<CaseStatement>((*m_cases)[i]);
+    if (!stmt->getCondition()) continue;
+    string s = stmt->getLiteralString();
+    if (firstCases.find(s) == firstCases.end()) {
+      firstCases[s] = i;
+      strings.push_back(s);
+    }
+  }
+  vector<const char *> keys;
+  for (unsigned int i = 0; i < strings.size(); i++) {
+    keys.push_back(strings[i].c_str());
+  }
+
+  if (m_exp->getType()->is(Type::KindOfString)) {
+    cg_indentBegin("if (!%s%d.isNull()) {\n", Option::TempPrefix, varId);
+    cg_printf("CStrRef s = %s%d;\n", Option::TempPrefix, varId);
+  } else {
+    cg_indentBegin("if (%s%d.isString()) {\n", Option::TempPrefix, varId);
+    cg_printf("String s = %s%d.toString();\n", Option::TempPrefix, varId);
+  }
+  for (JumpTable jt(cg, keys, false, false, true); jt.ready(); jt.next()) {
+    const char *key = jt.key();
+    int caseNum = firstCases[key];
+    CaseStatementPtr stmt =
+      dynamic_pointer_cast<CaseStatement>((*m_cases)[caseNum]);
+    cg_printf("if (hash == 0x%016llXLL && s.same(", hash_string(key));
+    stmt->getCondition()->outputCPP(cg, ar);
+    cg_printf(")) goto case_%d_%d;\n", varId, caseNum);
+  }
+  if (defaultCaseNum != -1) {
+    cg_printf("goto case_%d_%d;\n", varId, defaultCaseNum);
+  } else {
+    cg_printf("goto break%d;\n", labelId);
+    cg.addLabelId("break", labelId);
+  }
+  cg_indentEnd("}\n");
+}
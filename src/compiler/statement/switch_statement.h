@@ -37,6 +37,10 @@ public:
 private:
   ExpressionPtr m_exp;
   StatementListPtr m_cases;
+
+  bool hasHashableCases() const;
+  void outputCPPHashDispatch(CodeGenerator &cg, AnalysisResultPtr ar,
+                             int varId, int labelId, int defaultCaseNum);
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -36,13 +36,18 @@ JumpTable::JumpTable(CodeGenerator &cg,
   } else {
     m_cg_printf("int64 ");
   }
-  m_cg_printf("hash = hash_string%s(", caseInsensitive ? "_i" : "");
-  if (useString) {
-    m_cg_printf("s.data(), s.length()");
+  if (useString && !caseInsensitive) {
+    // String keeps its hash code once computed
+    m_cg_printf("hash = s.hash();\n");
   } else {
-    m_cg_printf("s");
+    m_cg_printf("hash = hash_string%s(", caseInsensitive ? "_i" : "");
+    if (useString) {
+      m_cg_printf("s.data(), s.length()");
+    } else {
+      m_cg_printf("s");
+    }
+    m_cg_printf(");\n");
   }
-  m_cg_printf(");\n");
   m_cg.printStartOfJumpTable(tableSize);
   m_iter = m_table.begin();
   if (ready()) {
@@ -0,0 +1,82 @@
+/*
+   +----------------------------------------------------------------------+
+   | HipHop for PHP                                                       |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2010 Facebook, Inc. (http://www.facebook.com)          |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 3.01 of the PHP license,      |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available through the world-wide-web at the following url:           |
+   | http://www.php.net/license/3_01.txt                                  |
+   | If you did not receive a copy of the PHP license and are unable to   |
+   | obtain it through the world-wide-web, please send a note to          |
+   | license@php.net so we can mail you a copy immediately.               |
+   +----------------------------------------------------------------------+
+*/
+
+
+#include <compiler/util/output_file.h>
+#include <util/logger.h>
+#include <fstream>
+#include <sys/stat.h>
+
+using namespace HPHP;
+using namespace std;
+
+///////////////////////////////////////////////////////////////////////////////
+
+int OutputFile::s_closed = 0;
+int OutputFile::s_written = 0;
+
+void OutputFile::open(const char *filename) {
+  close();
+  ASSERT(filename && *filename);
+  m_filename = filename;
+  str("");
+  clear();
+}
+
+bool OutputFile::unchanged(const string &content) {
+  struct stat sb;
+  if (stat(m_filename.c_str(), &sb) ||
+      (size_t)sb.st_size != content.size()) {
+    return false;
+  }
+
+  ifstream f(m_filename.c_str(), ios::in | ios::binary);
+  if (!f) return false;
+  char buf[8192];
+  size_t pos = 0;
+  while (pos < content.size()) {
+    f.read(buf, sizeof(buf));
+    size_t n = f.gcount();
+    if (n == 0 || content.compare(pos, n, buf, n) != 0) {
+      return false;
+    }
+    pos += n;
+  }
+  return true;
+}
+
+bool OutputFile::close() {
+  if (m_filename.empty()) return true;
+
+  bool ret = true;
+  string content = str();
+  s_closed++;
+  if (!unchanged(content)) {
+    s_written++;
+    ofstream f(m_filename.c_str(), ios::out | ios::binary | ios::trunc);
+    if (f) {
+      f.write(content.data(), content.size());
+    }
+    if (!f) {
+      Logger::Error("Unable to write %s", m_filename.c_str());
+      ret = false;
+    }
+  }
+
+  m_filename.clear();
+  str("");
+  return ret;
+}
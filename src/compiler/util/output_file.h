@@ -0,0 +1,65 @@
+/*
+   +----------------------------------------------------------------------+
+   | HipHop for PHP                                                       |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2010 Facebook, Inc. (http://www.facebook.com)          |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 3.01 of the PHP license,      |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available through the world-wide-web at the following url:           |
+   | http://www.php.net/license/3_01.txt                                  |
+   | If you did not receive a copy of the PHP license and are unable to   |
+   | obtain it through the world-wide-web, please send a note to          |
+   | license@php.net so we can mail you a copy immediately.               |
+   +----------------------------------------------------------------------+
+*/
+
+
+#ifndef __OUTPUT_FILE_H__
+#define __OUTPUT_FILE_H__
+
+#include <util/base.h>
+#include <sstream>
+
+namespace HPHP {
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Drop-in replacement of ofstream for generated files. Output is buffered
+ * and only written out on close() when it differs from what is already on
+ * disk, so unchanged files keep their timestamps and make does not rebuild
+ * them.
+ */
+class OutputFile : public std::ostringstream {
+public:
+  OutputFile() {}
+  explicit OutputFile(const char *filename) { open(filename);}
+  ~OutputFile() { close();}
+
+  void open(const char *filename);
+  bool is_open() const { return !m_filename.empty();}
+
+  /**
+   * Returns false if the file had to be written but could not be.
+   */
+  bool close();
+
+  /**
+   * How many files were closed and how many of them were rewritten.
+   */
+  static int GetClosedCount() { return s_closed;}
+  static int GetWrittenCount() { return s_written;}
+
+private:
+  std::string m_filename;
+
+  static int s_closed;
+  static int s_written;
+
+  bool unchanged(const std::string &content);
+};
+
+///////////////////////////////////////////////////////////////////////////////
+}
+
+#endif // __OUTPUT_FILE_H__
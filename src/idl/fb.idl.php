@@ -68,6 +68,10 @@ f('xhprof_disable', Variant);
 f('xhprof_sample_enable',  NULL);
 f('xhprof_sample_disable',  Variant);
 
+f('xhprof_heap_enable',  NULL,
+  array('sample_bytes' => array(Int64, '0')));
+f('xhprof_heap_disable',  Variant);
+
 ///////////////////////////////////////////////////////////////////////////////
 // php_query
 
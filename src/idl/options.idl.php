@@ -131,6 +131,14 @@ f('set_magic_quotes_runtime', Boolean,
 f('set_time_limit', NULL,
   array('seconds' => Int32));
 
+f('hphp_set_request_deadline', NULL,
+  array('milliseconds' => Int64));
+
+f('hphp_set_request_cpu_budget', NULL,
+  array('milliseconds' => Int64));
+
+f('hphp_get_request_cpu_time', Int64);
+
 f('sys_get_temp_dir', String);
 
 f('version_compare', Variant,
@@ -5,15 +5,17 @@ include_once 'base.php';
 ///////////////////////////////////////////////////////////////////////////////
 // transformations and manipulations
 
-f('addcslashes',   String, array('str' => String, 'charlist' => String));
-f('stripcslashes', String, array('str' => String));
-f('addslashes',    String, array('str' => String));
-f('stripslashes',  String, array('str' => String));
-f('bin2hex',       String, array('str' => String));
-f('nl2br',         String, array('str' => String));
-f('quotemeta',     String, array('str' => String));
+f('addcslashes',   String, array('str' => String, 'charlist' => String),
+  FunctionIsFoldable);
+f('stripcslashes', String, array('str' => String), FunctionIsFoldable);
+f('addslashes',    String, array('str' => String), FunctionIsFoldable);
+f('stripslashes',  String, array('str' => String), FunctionIsFoldable);
+f('bin2hex',       String, array('str' => String), FunctionIsFoldable);
+f('nl2br',         String, array('str' => String), FunctionIsFoldable);
+f('quotemeta',     String, array('str' => String), FunctionIsFoldable);
 f('str_shuffle',   String, array('str' => String));
-f('strrev',        String, array('str' => String));
+f('strrev',        String, array('str' => String), FunctionIsFoldable);
+// these follow setlocale() through tolower()/toupper(), so aren't folded
 f('strtolower',    String, array('str' => String));
 f('strtoupper',    String, array('str' => String));
 f('ucfirst',       String, array('str' => String));
@@ -25,36 +27,40 @@ f('strip_tags', String,
 
 f('trim', String,
   array('str' => String,
-        'charlist' => array(String, 'k_HPHP_TRIM_CHARLIST')));
+        'charlist' => array(String, 'k_HPHP_TRIM_CHARLIST')),
+  FunctionIsFoldable);
 
 f('ltrim', String,
   array('str' => String,
-        'charlist' => array(String, 'k_HPHP_TRIM_CHARLIST')));
+        'charlist' => array(String, 'k_HPHP_TRIM_CHARLIST')),
+  FunctionIsFoldable);
 
 f('rtrim', String,
   array('str' => String,
-        'charlist' => array(String, 'k_HPHP_TRIM_CHARLIST')));
+        'charlist' => array(String, 'k_HPHP_TRIM_CHARLIST')),
+  FunctionIsFoldable);
 
 f('chop', String,
   array('str' => String,
-        'charlist' => array(String, 'k_HPHP_TRIM_CHARLIST')));
+        'charlist' => array(String, 'k_HPHP_TRIM_CHARLIST')),
+  FunctionIsFoldable);
 
 f('explode', Variant,
   array('delimiter' => String,
         'str' => String,
-        'limit' => array(Int32, '0x7FFFFFFF')));
+        'limit' => array(Int32, '0x7FFFFFFF')), FunctionIsFoldable);
 
 f('implode', String,
   array('arg1' => Variant,
-        'arg2' => array(Variant, 'null_variant')));
+        'arg2' => array(Variant, 'null_variant')), FunctionIsFoldable);
 
 f('join', String,
   array('glue' => Variant,
-        'pieces' => array(Variant, 'null_variant')));
+        'pieces' => array(Variant, 'null_variant')), FunctionIsFoldable);
 
 f('str_split', Variant,
   array('str' => String,
-        'split_length' => array(Int32, '1')));
+        'split_length' => array(Int32, '1')), FunctionIsFoldable);
 
 f('chunk_split', Variant,
   array('body' => String,
@@ -86,17 +92,17 @@ f('substr_replace', Variant,
 f('substr', Variant,
   array('str' => String,
         'start' => Int32,
-        'length' => array(Int32, '0x7FFFFFFF')));
+        'length' => array(Int32, '0x7FFFFFFF')), FunctionIsFoldable);
 
 f('str_pad', String,
   array('input' => String,
         'pad_length' => Int32,
         'pad_string' => array(String, '" "'),
-        'pad_type' => array(Int32, 'k_STR_PAD_RIGHT')));
+        'pad_type' => array(Int32, 'k_STR_PAD_RIGHT')), FunctionIsFoldable);
 
 f('str_repeat', String,
   array('input' => String,
-        'multiplier' => Int32));
+        'multiplier' => Int32), FunctionIsFoldable);
 
 f('wordwrap', Variant,
   array('str' => String,
@@ -156,7 +162,7 @@ f('md5', String,
 
 f('sha1', String,
   array('str' => String,
-        'raw_output' => array(Boolean, 'false')));
+        'raw_output' => array(Boolean, 'false')), FunctionIsFoldable);
 
 f('strtr', Variant,
   array('str' => String,
@@ -0,0 +1,92 @@
+<?php
+
+include_once 'base.php';
+
+pre("#include <libxml/xmlreader.h>");
+pre("#include <runtime/base/file/file.h>");
+
+///////////////////////////////////////////////////////////////////////////////
+// class style
+
+c('XMLReader', null, array(),
+  array(
+    m(PublicMethod, "__construct"),
+
+    m(PublicMethod, 'open', Boolean,
+      array('uri' => String,
+            'encoding' => array(String, 'null_string'),
+            'options' => array(Int64, '0'))),
+    m(PublicMethod, 'XML', Boolean,
+      array('source' => String,
+            'encoding' => array(String, 'null_string'),
+            'options' => array(Int64, '0'))),
+    m(PublicMethod, 'close', Boolean),
+    m(PublicMethod, 'read', Boolean),
+    m(PublicMethod, 'next', Boolean,
+      array('localname' => array(String, 'null_string'))),
+    m(PublicMethod, 'readString', String),
+    m(PublicMethod, 'readInnerXML', String),
+    m(PublicMethod, 'readOuterXML', String),
+    m(PublicMethod, 'getAttribute', Variant,
+      array('name' => String)),
+    m(PublicMethod, 'getAttributeNo', Variant,
+      array('index' => Int64)),
+    m(PublicMethod, 'getAttributeNs', Variant,
+      array('localName' => String,
+            'namespaceURI' => String)),
+    m(PublicMethod, 'moveToAttribute', Boolean,
+      array('name' => String)),
+    m(PublicMethod, 'moveToAttributeNo', Boolean,
+      array('index' => Int64)),
+    m(PublicMethod, 'moveToAttributeNs', Boolean,
+      array('localName' => String,
+            'namespaceURI' => String)),
+    m(PublicMethod, 'moveToElement', Boolean),
+    m(PublicMethod, 'moveToFirstAttribute', Boolean),
+    m(PublicMethod, 'moveToNextAttribute', Boolean),
+    m(PublicMethod, 'isValid', Boolean),
+    m(PublicMethod, 'lookupNamespace', Variant,
+      array('prefix' => String)),
+    m(PublicMethod, 'getParserProperty', Boolean,
+      array('property' => Int64)),
+    m(PublicMethod, 'setParserProperty', Boolean,
+      array('property' => Int64,
+            'value' => Boolean)),
+    m(PublicMethod, 'expand', Variant),
+    m(PublicMethod, "__get", Variant,
+      array('name' => Variant)),
+    m(PublicMethod, "__set", Variant,
+      array('name' => Variant,
+            'value' => Variant)),
+    ),
+
+  array(
+    ck("NONE",                   Int64),
+    ck("ELEMENT",                Int64),
+    ck("ATTRIBUTE",              Int64),
+    ck("TEXT",                   Int64),
+    ck("CDATA",                  Int64),
+    ck("ENTITY_REF",             Int64),
+    ck("ENTITY",                 Int64),
+    ck("PI",                     Int64),
+    ck("COMMENT",                Int64),
+    ck("DOC",                    Int64),
+    ck("DOC_TYPE",               Int64),
+    ck("DOC_FRAGMENT",           Int64),
+    ck("NOTATION",               Int64),
+    ck("WHITESPACE",             Int64),
+    ck("SIGNIFICANT_WHITESPACE", Int64),
+    ck("END_ELEMENT",            Int64),
+    ck("END_ENTITY",             Int64),
+    ck("XML_DECLARATION",        Int64),
+    ck("LOADDTD",                Int64),
+    ck("DEFAULTATTRS",           Int64),
+    ck("VALIDATE",               Int64),
+    ck("SUBST_ENTITIES",         Int64),
+  ),
+  "\n public:".
+  "\n  SmartObject<File> m_uri;".
+  "\n private:".
+  "\n  xmlTextReaderPtr  m_ptr;".
+  "\n  String            m_source;"
+  );
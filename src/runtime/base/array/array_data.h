@@ -229,6 +229,18 @@ class ArrayData : public Countable {
    */
   virtual void renumber() {}
 
+  /**
+   * Relink elements into the order given by their iterator positions, which
+   * must be a permutation of all of them, without copying any. With
+   * "renumber", numeric keys are re-indexed from 0, and so are string keys
+   * unless "keepStringKeys". Returns false if this class can't do it, and
+   * callers have to build a new array instead.
+   */
+  virtual bool reorder(const std::vector<ssize_t> &order, bool renumber,
+                       bool keepStringKeys) {
+    return false;
+  }
+
   /**
    * When an array data is set static, some calculated data members need to
    * be initialized, for example, Map::getKeyVector(). More importantly, all
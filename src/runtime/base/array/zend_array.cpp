@@ -19,6 +19,8 @@
 #include <runtime/base/array/array_init.h>
 #include <runtime/base/complex_types.h>
 #include <runtime/base/runtime_error.h>
+#include <runtime/base/runtime_option.h>
+#include <runtime/base/util/request_local.h>
 #include <util/hash.h>
 #include <util/lock.h>
 
@@ -305,12 +307,14 @@ bool ZendArray::exists(litstr k, int64 prehash /* = -1 */) const {
 }
 
 bool ZendArray::exists(CStrRef k, int64 prehash /* = -1 */) const {
+  if (prehash < 0) prehash = k.hash();
   return find(k.data(), k.size(), prehash);
 }
 
 bool ZendArray::exists(CVarRef k, int64 prehash /* = -1 */) const {
   if (k.isNumeric()) return find(k.toInt64());
   String key = k.toString();
+  if (prehash < 0) prehash = key.hash();
   return find(key.data(), key.size(), prehash);
 }
 
@@ -345,7 +349,7 @@ Variant ZendArray::get(litstr k, int64 prehash /* = -1 */,
 Variant ZendArray::get(CStrRef k, int64 prehash /* = -1 */,
                        bool error /* = false */) const {
   StringData *key = k.get();
-  if (key->isStatic()) prehash = key->getStaticHash();
+  if (prehash < 0) prehash = key->hash();
   Bucket *p = find(key->data(), key->size(), prehash);
   if (p) {
     return p->data;
@@ -364,7 +368,7 @@ Variant ZendArray::get(CVarRef k, int64 prehash /* = -1 */,
   } else {
     String key = k.toString();
     StringData *strkey = key.get();
-    if (strkey->isStatic()) prehash = key->getStaticHash();
+    if (prehash < 0) prehash = strkey->hash();
     p = find(strkey->data(), strkey->size(), prehash);
   }
   if (p) {
@@ -393,6 +397,7 @@ ssize_t ZendArray::getIndex(litstr k, int64 prehash /* = -1 */) const {
 }
 
 ssize_t ZendArray::getIndex(CStrRef k, int64 prehash /* = -1 */) const {
+  if (prehash < 0) prehash = k.hash();
   Bucket *p = find(k.data(), k.size(), prehash);
   if (p) {
     return (ssize_t)p;
@@ -406,6 +411,7 @@ ssize_t ZendArray::getIndex(CVarRef k, int64 prehash /* = -1 */) const {
     p = find(k.toInt64());
   } else {
     String key = k.toString();
+    if (prehash < 0) prehash = key.hash();
     p = find(key.data(), key.size(), prehash);
   }
   if (p) {
@@ -414,6 +420,55 @@ ssize_t ZendArray::getIndex(CVarRef k, int64 prehash /* = -1 */) const {
   return ArrayData::invalid_index;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// key interning
+
+/**
+ * String keys arrays were given in this request, so that a key built again
+ * and again, like "user_" . $id, is kept in one StringData with one cached
+ * hash code, and later lookups hit on pointer equality. Keys that don't own
+ * their buffer are kept as copies.
+ */
+class ArrayKeyTable : public RequestEventHandler {
+public:
+  virtual void requestInit() {}
+  virtual void requestShutdown() {
+    for (StringDataSet::iterator iter = m_keys.begin(); iter != m_keys.end();
+         ++iter) {
+      if ((*iter)->decRefCount() == 0) {
+        DELETE(StringData)(*iter);
+      }
+    }
+    m_keys.clear();
+  }
+
+  StringData *intern(StringData *key) {
+    StringDataSet::const_iterator iter = m_keys.find(key);
+    if (iter != m_keys.end()) return *iter;
+    if ((int)m_keys.size() < RuntimeOption::InternArrayKeys) {
+      if (!key->isMalloced()) {
+        // a literal's bytes belong to someone else and may not outlive it
+        key = NEW(StringData)(key->data(), key->size(), CopyString);
+      }
+      key->incRefCount();
+      m_keys.insert(key);
+    }
+    return key;
+  }
+
+private:
+  StringDataSet m_keys;
+};
+IMPLEMENT_STATIC_REQUEST_LOCAL(ArrayKeyTable, s_array_keys);
+
+static inline StringData *bucket_key(StringData *key) {
+  if (key->isShared()) return key->copy(false);
+  if (RuntimeOption::InternArrayKeys && !key->isStatic()) {
+    return s_array_keys->intern(key);
+  }
+  return key;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // append/insert/update
 
@@ -544,6 +599,7 @@ bool ZendArray::addLval(litstr key, int len, int64 h, Variant **pDest,
 bool ZendArray::addLval(StringData *key, int64 h, Variant **pDest,
                         bool doFind /* = true */) {
   ASSERT(key != NULL && pDest != NULL);
+  if (h < 0) h = key->hash();
   Bucket *p;
   if (doFind) {
     p = find(key->data(), key->size(), h, &h);
@@ -553,11 +609,7 @@ bool ZendArray::addLval(StringData *key, int64 h, Variant **pDest,
     }
   }
   p = NEW(Bucket)();
-  if (key->isShared()) {
-    p->key = key->copy(false);
-  } else {
-    p->key = key;
-  }
+  p->key = bucket_key(key);
   p->key->incRefCount();
   p->h = h;
   *pDest = &p->data;
@@ -612,16 +664,13 @@ bool ZendArray::add(litstr key, int64 h, CVarRef data) {
 }
 
 bool ZendArray::add(StringData *key, int64 h, CVarRef data) {
+  if (h < 0) h = key->hash();
   Bucket *p = find(key->data(), key->size(), h, &h);
   if (p) {
     return false;
   }
   p = NEW(Bucket)(data);
-  if (key->isShared()) {
-    p->key = key->copy(false);
-  } else {
-    p->key = key;
-  }
+  p->key = bucket_key(key);
   p->key->incRefCount();
   p->h = h;
   uint nIndex = (h & m_nTableMask);
@@ -683,7 +732,7 @@ bool ZendArray::update(litstr key, int64 h, CVarRef data) {
 }
 
 bool ZendArray::update(StringData *key, int64 h, CVarRef data) {
-  if (key->isStatic()) h = key->getStaticHash();
+  if (h < 0) h = key->hash();
   Bucket *p = find(key->data(), key->size(), h, &h);
   if (p) {
     p->data = data;
@@ -691,11 +740,7 @@ bool ZendArray::update(StringData *key, int64 h, CVarRef data) {
   }
 
   p = NEW(Bucket)(data);
-  if (key->isShared()) {
-    p->key = key->copy(false);
-  } else {
-    p->key = key;
-  }
+  p->key = bucket_key(key);
   p->key->incRefCount();
   p->h = h;
 
@@ -748,7 +793,7 @@ ArrayData *ZendArray::lval(CStrRef k, Variant *&ret, bool copy,
                            int64 prehash /* = -1 */,
                            bool checkExist /* = false */) {
   StringData *key = k.get();
-  if (key->isStatic()) prehash = key->getStaticHash();
+  if (prehash < 0) prehash = key->hash();
   if (!copy) {
     addLval(key, prehash, &ret);
     return NULL;
@@ -921,6 +966,7 @@ ArrayData *ZendArray::remove(int64 k, bool copy, int64 prehash /* = -1 */) {
 }
 
 ArrayData *ZendArray::remove(CStrRef k, bool copy, int64 prehash /* = -1 */) {
+  if (prehash < 0) prehash = k.hash();
   if (copy) {
     ZendArray *a = copyImpl();
     a->prepareBucketHeadsForWrite();
@@ -957,6 +1003,7 @@ ArrayData *ZendArray::remove(CVarRef k, bool copy, int64 prehash /* = -1 */) {
     return NULL;
   } else {
     String key = k.toString();
+    if (prehash < 0) prehash = key.hash();
     if (copy) {
       ZendArray *a = copyImpl();
       a->prepareBucketHeadsForWrite();
@@ -1180,6 +1227,45 @@ void ZendArray::renumber() {
   rehash();
 }
 
+bool ZendArray::reorder(const std::vector<ssize_t> &order, bool renumber,
+                        bool keepStringKeys) {
+  ASSERT(order.size() == m_nNumOfElements);
+  Bucket *last = NULL;
+  for (unsigned int i = 0; i < order.size(); i++) {
+    Bucket *p = reinterpret_cast<Bucket *>(order[i]);
+    p->pListLast = last;
+    if (last) {
+      last->pListNext = p;
+    } else {
+      m_pListHead = p;
+    }
+    last = p;
+  }
+  if (last) last->pListNext = NULL;
+  m_pListTail = last;
+  m_pos = (ssize_t)m_pListHead;
+
+  if (renumber) {
+    if (!keepStringKeys) {
+      for (Bucket *p = m_pListHead; p; p = p->pListNext) {
+        if (p->key) {
+          if (p->key->decRefCount() == 0) {
+            DELETE(StringData)(p->key);
+          }
+          p->key = NULL;
+        }
+      }
+    }
+    if (m_linear) {
+      // rehash() is about to rewrite the bucket heads
+      m_arBuckets = (Bucket **)malloc(m_nTableSize * sizeof(Bucket *));
+      m_linear = false;
+    }
+    this->renumber();
+  }
+  return true;
+}
+
 void ZendArray::onSetStatic() {
   for (Bucket *p = m_pListHead; p; p = p->pListNext) {
     if (p->key) {
@@ -102,6 +102,8 @@ public:
   virtual ArrayData *dequeue(Variant &value);
   virtual ArrayData *prepend(CVarRef v, bool copy);
   virtual void renumber();
+  virtual bool reorder(const std::vector<ssize_t> &order, bool renumber,
+                       bool keepStringKeys);
   virtual void onSetStatic();
 
   virtual void getFullPos(FullPos &pos);
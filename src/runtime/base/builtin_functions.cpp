@@ -25,6 +25,9 @@
 #include <util/process.h>
 #include <runtime/base/execution_context.h>
 #include <runtime/base/util/request_local.h>
+#include <runtime/base/memory/heap_profiler.h>
+#include <runtime/base/timeout_thread.h>
+#include <runtime/base/server/server_stats.h>
 
 #include <limits>
 
@@ -295,17 +298,27 @@ void throw_infinite_recursion_exception() {
 void throw_request_timeout_exception() {
   ThreadInfo *info = ThreadInfo::s_threadInfo.get();
   RequestInjectionData &data = info->m_reqInjectionData;
-  if (data.timeoutSeconds > 0) {
-    ASSERT(data.timedout);
-    data.timedout = false; // avoid going through here twice in a row
-
-    // This extra checking is needed, because there may be a race condition
-    // a TimeoutThread sets flag "true" right after an old request finishes and
-    // right before a new requets resets "started". In this case, we flag
-    // "timedout" back to "false".
-    if (time(0) - data.started >= data.timeoutSeconds) {
-      throw FatalErrorException("request has timed-out");
-    }
+  ASSERT(data.timedout);
+  data.timedout = false; // avoid going through here twice in a row
+
+  // This extra checking is needed, because there may be a race condition
+  // a TimeoutThread sets flag "true" right after an old request finishes and
+  // right before a new requets resets "started". In this case, we flag
+  // "timedout" back to "false".
+  if (data.deadline > 0 && TimeoutThread::Now() >= data.deadline) {
+    data.deadline = 0; // counted here, not again when the request ends
+    ServerStats::Log("request.deadline.missed", 1);
+    throw FatalErrorException("request has missed its deadline");
+  }
+  if (data.cpuBudget > 0 && TimeoutThread::GetCpuTime() >= data.cpuBudget) {
+    data.cpuBudget = 0;
+    ServerStats::Log("request.cpu_budget.exceeded", 1);
+    throw FatalErrorException("request has used up its CPU time budget");
+  }
+  if (data.timeoutSeconds > 0 && data.started > 0 &&
+      time(0) - data.started >= data.timeoutSeconds) {
+    ServerStats::Log("request.timedout", 1);
+    throw FatalErrorException("request has timed-out");
   }
 }
 
@@ -315,6 +328,14 @@ void throw_memory_exceeded_exception() {
   ThreadInfo *info = ThreadInfo::s_threadInfo.get();
   RequestInjectionData &data = info->m_reqInjectionData;
   data.memExceeded = false;
+
+  HeapProfiler *profiler = HeapProfiler::TheHeapProfiler().get();
+  if (profiler->active()) {
+    HeapProfiler::SiteVec sites;
+    HeapProfiler::Sort(profiler->getSites(), sites, 10);
+    Logger::Warning("request has exceeded memory limit, top allocation "
+                    "sites:\n%s", HeapProfiler::Format(sites).c_str());
+  }
   throw UncatchableException("request has exceeded memory limit");
 }
 
@@ -582,6 +603,14 @@ bool isset(CVarRef v, CStrRef offset, int64 prehash /* = -1 */,
   return isset(v.rvalAt(offset, prehash, false, isString));
 }
 
+void echo_json_encode(CVarRef v, bool loose /* = false */) {
+  VariableSerializer vs(VariableSerializer::JSON, loose ? 1 : 0);
+  vs.serialize(v, false);
+  if (v.isContagious()) {
+    v.clearContagious();
+  }
+}
+
 String get_source_filename(litstr path) {
   if (path[0] == '/') return path;
   if (RuntimeOption::SourceRoot.empty()) {
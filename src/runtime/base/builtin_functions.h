@@ -477,6 +477,12 @@ inline void echo(CStrRef s) {
   g_context->write(s);
 }
 
+/**
+ * Same as echo(f_json_encode(v, loose)), but the encoded value is written out
+ * as it is produced, instead of first being built up as one String.
+ */
+void echo_json_encode(CVarRef v, bool loose = false);
+
 String get_source_filename(litstr path);
 
 inline void throw_exception(CObjRef v) { throw v;}
@@ -510,6 +516,21 @@ inline Variant unset(CVarRef v)                {              return null;}
 inline Variant setNull(Variant &v)             { v.setNull(); return null;}
 inline Variant unset(Object &v)                { v.reset();   return null;}
 
+/**
+ * $to = $from, where the compiler has proven $from is never read again:
+ * hand over the value instead of copying it, saving the incRef of the copy
+ * and the decRef when $from goes out of scope.
+ */
+inline Variant moveVal(Variant &to, Variant &from) {
+  to.swap(from); from.setNull(); return null;
+}
+inline Variant moveVal(String &to, String &from) {
+  to.swap(from); from.reset(); return null;
+}
+inline Variant moveVal(Array &to, Array &from) {
+  to.swap(from); from.reset(); return null;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // special variable contexts
 
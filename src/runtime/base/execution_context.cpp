@@ -211,7 +211,7 @@ void ExecutionContext::obStart(CVarRef handler /* = null */) {
 
 String ExecutionContext::obCopyContents() {
   if (!m_buffers.empty()) {
-    StringBuffer &oss = m_buffers.back()->oss;
+    ChunkedBuffer &oss = m_buffers.back()->oss;
     if (!oss.empty()) {
       return oss.copy();
     }
@@ -221,7 +221,7 @@ String ExecutionContext::obCopyContents() {
 
 String ExecutionContext::obDetachContents() {
   if (!m_buffers.empty()) {
-    StringBuffer &oss = m_buffers.back()->oss;
+    ChunkedBuffer &oss = m_buffers.back()->oss;
     if (!oss.empty()) {
       return oss.detach();
     }
@@ -229,6 +229,16 @@ String ExecutionContext::obDetachContents() {
   return "";
 }
 
+void ExecutionContext::obSendContents(Transport *transport) {
+  ASSERT(transport);
+  vector<iovec> chunks;
+  if (!m_buffers.empty()) {
+    m_buffers.back()->oss.getChunks(chunks);
+  }
+  transport->sendRaw(chunks);
+  obClean();
+}
+
 int ExecutionContext::obGetContentLength() {
   if (m_buffers.empty()) {
     return 0;
@@ -264,7 +274,11 @@ bool ExecutionContext::obFlush() {
       }
       return true;
     }
-    fwrite(last->oss.data(), last->oss.size(), 1, stdout);
+    vector<iovec> chunks;
+    last->oss.getChunks(chunks);
+    for (unsigned int i = 0; i < chunks.size(); i++) {
+      fwrite(chunks[i].iov_base, chunks[i].iov_len, 1, stdout);
+    }
     last->oss.reset();
     return true;
   }
@@ -317,15 +331,16 @@ void ExecutionContext::flush() {
              (m_transport == NULL ||
               (m_transport->getHTTPVersion() == "1.1" &&
                m_transport->getMethod() != Transport::HEAD))) {
-    StringBuffer &oss = m_buffers.front()->oss;
+    ChunkedBuffer &oss = m_buffers.front()->oss;
     if (!oss.empty()) {
+      String content = oss.detach();
       if (m_transport) {
-        m_transport->sendRaw((void*)oss.data(), oss.size(), 200, false, true);
+        m_transport->sendRaw((void*)content.data(), content.size(), 200,
+                             false, true);
       } else {
-        fwrite(oss.data(), oss.size(), 1, stdout);
+        fwrite(content.data(), content.size(), 1, stdout);
         fflush(stdout);
       }
-      oss.reset();
     }
   }
 }
@@ -22,6 +22,7 @@
 #include <runtime/base/resource_data.h>
 #include <runtime/base/fiber_safe.h>
 #include <runtime/base/util/string_buffer.h>
+#include <runtime/base/util/chunked_buffer.h>
 #include <util/thread_local.h>
 
 namespace HPHP {
@@ -118,6 +119,7 @@ public:
   void obStart(CVarRef handler = null);
   String obCopyContents();
   String obDetachContents();
+  void obSendContents(Transport *transport); // without joining chunks
   int obGetContentLength();
   void obClean();
   bool obFlush();
@@ -195,8 +197,7 @@ public:
 private:
   class OutputBuffer {
   public:
-    OutputBuffer() : oss(8096) {}
-    StringBuffer oss;
+    ChunkedBuffer oss;
     Variant handler;
   };
 
@@ -207,7 +208,7 @@ private:
   String m_cwd;
 
   // output buffering
-  StringBuffer *m_out;                // current output buffer
+  ChunkedBuffer *m_out;               // current output buffer
   std::list<OutputBuffer*> m_buffers; // a stack of output buffers
   bool m_implicitFlush;
   int m_protectedLevel;
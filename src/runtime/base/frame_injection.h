@@ -68,6 +68,9 @@ public:
   // object context" fatal.
   Object &getThisForArrow();
 
+  FrameInjection *getPrev() const { return m_prev; }
+  const char *getFunction() const { return m_name; }
+
 public:
   // what does "static::" resolve to?
   static String GetStaticClassName(ThreadInfo *info);
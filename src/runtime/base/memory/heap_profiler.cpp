@@ -0,0 +1,260 @@
+/*
+   +----------------------------------------------------------------------+
+   | HipHop for PHP                                                       |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2010 Facebook, Inc. (http://www.facebook.com)          |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 3.01 of the PHP license,      |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available through the world-wide-web at the following url:           |
+   | http://www.php.net/license/3_01.txt                                  |
+   | If you did not receive a copy of the PHP license and are unable to   |
+   | obtain it through the world-wide-web, please send a note to          |
+   | license@php.net so we can mail you a copy immediately.               |
+   +----------------------------------------------------------------------+
+*/
+
+#include <runtime/base/memory/heap_profiler.h>
+#include <runtime/base/memory/memory_manager.h>
+#include <runtime/base/frame_injection.h>
+#include <runtime/base/runtime_option.h>
+#include <math.h>
+
+using namespace std;
+
+namespace HPHP {
+
+IMPLEMENT_THREAD_LOCAL(HeapProfiler, HeapProfiler::s_singleton);
+
+Mutex HeapProfiler::s_mutex;
+volatile int64 HeapProfiler::s_serverSampleBytes = 0;
+HeapProfiler::SiteMap HeapProfiler::s_serverSites;
+int64 HeapProfiler::s_serverRequests = 0;
+
+///////////////////////////////////////////////////////////////////////////////
+// reports
+
+static bool by_total(const pair<string, HeapProfiler::Site> &s1,
+                     const pair<string, HeapProfiler::Site> &s2) {
+  return s1.second.total > s2.second.total;
+}
+
+void HeapProfiler::Sort(const SiteMap &sites, SiteVec &sorted,
+                        int top /* = 0 */) {
+  sorted.assign(sites.begin(), sites.end());
+  std::sort(sorted.begin(), sorted.end(), by_total);
+  if (top > 0 && (int)sorted.size() > top) {
+    sorted.resize(top);
+  }
+}
+
+string HeapProfiler::Format(const SiteVec &sites) {
+  string out = "       total         peak     live  samples  site\n";
+  for (unsigned int i = 0; i < sites.size(); i++) {
+    const Site &site = sites[i].second;
+    char line[64];
+    snprintf(line, sizeof(line), "%12lld %12lld %8lld %8lld  ",
+             site.total, site.peak, site.live, site.samples);
+    out += line;
+    out += sites[i].first;
+    out += "\n";
+  }
+  return out;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// server-wide profile
+
+void HeapProfiler::ServerEnable(int64 sampleBytes) {
+  Lock lock(s_mutex);
+  s_serverSites.clear();
+  s_serverRequests = 0;
+  s_serverSampleBytes =
+    sampleBytes > 0 ? sampleBytes : RuntimeOption::HeapSampleBytes;
+}
+
+void HeapProfiler::ServerDisable() {
+  Lock lock(s_mutex);
+  s_serverSampleBytes = 0;
+}
+
+string HeapProfiler::ServerReport(int top) {
+  SiteVec sorted;
+  int64 requests;
+  int64 sampleBytes;
+  {
+    Lock lock(s_mutex);
+    Sort(s_serverSites, sorted, top);
+    requests = s_serverRequests;
+    sampleBytes = s_serverSampleBytes;
+  }
+
+  char header[128];
+  snprintf(header, sizeof(header),
+           "%s, %lld requests, peak is the largest in one request\n",
+           sampleBytes ? "on" : "off", requests);
+  return header + Format(sorted);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// per-request profile
+
+ThreadLocal<HeapProfiler> &HeapProfiler::TheHeapProfiler() {
+  return s_singleton;
+}
+
+HeapProfiler::HeapProfiler()
+  : m_requestSampleBytes(0), m_serverSampleBytes(0), m_sampleBytes(0) {
+  // different threads should not pick the same sample points
+  m_random = ((uint64)(long)this << 16) ^ (uint64)time(NULL) ^ 1;
+  memset(m_filter, 0, sizeof(m_filter));
+}
+
+void HeapProfiler::beginRequest() {
+  m_requestSampleBytes = 0;
+  m_serverSampleBytes = s_serverSampleBytes;
+  if (m_serverSampleBytes) {
+    m_sampleBytes = m_serverSampleBytes;
+    start();
+  }
+}
+
+void HeapProfiler::endRequest() {
+  if (m_serverSampleBytes) {
+    Lock lock(s_mutex);
+    if (s_serverSampleBytes) {
+      for (SiteMap::const_iterator iter = m_sites.begin();
+           iter != m_sites.end(); ++iter) {
+        const Site &site = iter->second;
+        Site &sum = s_serverSites[iter->first];
+        sum.total += site.total;
+        sum.samples += site.samples;
+        if (site.peak > sum.peak) sum.peak = site.peak;
+      }
+      s_serverRequests++;
+    }
+  }
+  m_requestSampleBytes = 0;
+  m_serverSampleBytes = 0;
+  stop();
+}
+
+void HeapProfiler::enable(int64 sampleBytes) {
+  if (sampleBytes <= 0) sampleBytes = RuntimeOption::HeapSampleBytes;
+  if (sampleBytes <= 0) sampleBytes = 1;
+  m_requestSampleBytes = sampleBytes;
+  m_sampleBytes = sampleBytes;
+  start();
+}
+
+bool HeapProfiler::disable(SiteMap &sites) {
+  if (!m_requestSampleBytes) return false;
+  m_requestSampleBytes = 0;
+  sites = m_sites;
+  if (m_serverSampleBytes) {
+    m_sampleBytes = m_serverSampleBytes;
+    start();
+  } else {
+    stop();
+  }
+  return true;
+}
+
+void HeapProfiler::start() {
+  MemoryManager::TheMemoryManager()->getStats().sampleDue = nextSample();
+}
+
+void HeapProfiler::stop() {
+  MemoryUsageStats &stats = MemoryManager::TheMemoryManager()->getStats();
+  stats.sampleDue = LLONG_MAX;
+  stats.sampleFilter = NULL;
+  m_sampleBytes = 0;
+  m_live.clear();
+  m_sites.clear();
+  memset(m_filter, 0, sizeof(m_filter));
+}
+
+int64 HeapProfiler::nextSample() {
+  // xorshift64*, then an exponential gap, so sample points form a Poisson
+  // process over allocated bytes and no allocation pattern can dodge them
+  m_random ^= m_random >> 12;
+  m_random ^= m_random << 25;
+  m_random ^= m_random >> 27;
+  uint64 r = m_random * 2685821657736338717ULL;
+  double u = ((r >> 11) + 1) * (1.0 / 9007199254740992.0); // (0, 1]
+  double gap = -log(u) * m_sampleBytes;
+  return gap < (double)(1LL << 62) ? (int64)gap : (1LL << 62);
+}
+
+string HeapProfiler::getSiteName(const char *type) {
+  const char *frames[MaxDepth];
+  int depth = 0;
+  FrameInjection *t = ThreadInfo::s_threadInfo->m_top;
+  for (; t && depth < MaxDepth; t = t->getPrev()) {
+    frames[depth++] = t->getFunction();
+  }
+
+  string name = t ? "...==>" : "main()==>";
+  for (int i = depth - 1; i >= 0; i--) {
+    name += frames[i];
+    name += "==>";
+  }
+  name.resize(name.size() - 3);
+  name += " (";
+  name += type;
+  name += ")";
+  return name;
+}
+
+void HeapProfiler::sample(void *p, const char *type, int size) {
+  MemoryUsageStats &stats = MemoryManager::TheMemoryManager()->getStats();
+  if (!m_sampleBytes) {
+    stats.sampleDue = LLONG_MAX;
+    return;
+  }
+  stats.sampleDue = nextSample();
+
+  // An object of "size" bytes covers a sample point with probability
+  // 1 - exp(-size / SampleBytes); dividing by that keeps sums unbiased.
+  double ratio = (double)size / m_sampleBytes;
+  int64 weight =
+    ratio > 1e-9 ? (int64)(size / -expm1(-ratio)) : m_sampleBytes;
+
+  Site &site = m_sites[getSiteName(type)];
+  site.samples++;
+  site.total += weight;
+  site.live += weight;
+  if (site.live > site.peak) {
+    site.peak = site.live;
+  }
+
+  Sample &s = m_live[p];
+  if (s.site) {
+    // reused without going through free(), e.g. after a rollback
+    s.site->live -= s.weight;
+  } else {
+    unsigned char &count = m_filter[FilterIndex(p)];
+    if (count < 255) count++;
+  }
+  s.site = &site;
+  s.weight = weight;
+  stats.sampleFilter = m_filter;
+}
+
+void HeapProfiler::free(void *p) {
+  SampleMap::iterator iter = m_live.find(p);
+  if (iter == m_live.end()) return;
+
+  iter->second.site->live -= iter->second.weight;
+  m_live.erase(iter);
+  unsigned char &count = m_filter[FilterIndex(p)];
+  if (count < 255) count--;
+
+  if (m_live.empty()) {
+    memset(m_filter, 0, sizeof(m_filter));
+    MemoryManager::TheMemoryManager()->getStats().sampleFilter = NULL;
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+}
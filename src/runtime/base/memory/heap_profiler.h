@@ -0,0 +1,156 @@
+/*
+   +----------------------------------------------------------------------+
+   | HipHop for PHP                                                       |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2010 Facebook, Inc. (http://www.facebook.com)          |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 3.01 of the PHP license,      |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available through the world-wide-web at the following url:           |
+   | http://www.php.net/license/3_01.txt                                  |
+   | If you did not receive a copy of the PHP license and are unable to   |
+   | obtain it through the world-wide-web, please send a note to          |
+   | license@php.net so we can mail you a copy immediately.               |
+   +----------------------------------------------------------------------+
+*/
+
+#ifndef __HPHP_HEAP_PROFILER_H__
+#define __HPHP_HEAP_PROFILER_H__
+
+#include <util/base.h>
+#include <util/thread_local.h>
+#include <util/lock.h>
+
+namespace HPHP {
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Sampling profiler of request memory dispensed by SmartAllocators.
+ *
+ * Sample points are laid out at random on the stream of allocated bytes,
+ * SampleBytes apart on average, and the allocation that covers one is
+ * charged to its site: the innermost PHP frames on FrameInjection's stack
+ * and the type of object allocated. A sample stands for the bytes expected
+ * between two points, so site totals are unbiased estimates that get better
+ * with more samples. Between samples SmartAllocatorImpl only counts bytes
+ * down, and a freed pointer is only looked up when it passes a filter that
+ * sampled objects are counted in.
+ *
+ * One request is profiled by xhprof_heap_enable() and _disable(); the admin
+ * server's /prof-mem-on profiles every request and sums their sites up.
+ */
+class HeapProfiler {
+public:
+  /**
+   * How many frames name a site, innermost ones kept.
+   */
+  static const int MaxDepth = 8;
+
+  /**
+   * Estimates of one site, all in bytes except for samples.
+   */
+  struct Site {
+    Site() : live(0), peak(0), total(0), samples(0) {}
+    int64 live;    // allocated and not freed yet
+    int64 peak;    // most live bytes at any time, or in any one request
+    int64 total;   // allocated, whether freed or not
+    int64 samples;
+  };
+  typedef hphp_string_map<Site> SiteMap;
+  typedef std::vector<std::pair<std::string, Site> > SiteVec;
+
+  /**
+   * Slot of a pointer in the filter. A slot counts up to 255 sampled
+   * objects and then stays set.
+   */
+  static const int FilterSize = 4096;
+  static int FilterIndex(void *p) {
+    return ((uint64)(long)p >> 4) * 0x9E3779B97F4A7C15ULL >> 52;
+  }
+
+  /**
+   * Sites from the biggest total down, at most "top" of them if positive.
+   */
+  static void Sort(const SiteMap &sites, SiteVec &sorted, int top = 0);
+  static std::string Format(const SiteVec &sites);
+
+  /**
+   * Server-wide profile across all requests that start while it's enabled.
+   * Enabling starts over from an empty profile; ServerReport() still works
+   * after disabling.
+   */
+  static void ServerEnable(int64 sampleBytes);
+  static void ServerDisable();
+  static bool ServerEnabled() { return s_serverSampleBytes > 0;}
+  static std::string ServerReport(int top);
+
+  static ThreadLocal<HeapProfiler> &TheHeapProfiler();
+
+  HeapProfiler();
+
+  /**
+   * Called by hphp_session_init() and hphp_session_exit(). Objects still
+   * live at the end of a request are left for MemoryManager to sweep, so
+   * they are forgotten instead of freed.
+   */
+  void beginRequest();
+  void endRequest();
+
+  /**
+   * Profile the rest of this request, sampling every sampleBytes bytes, or
+   * Stats.HeapProfile.SampleBytes if 0. A request that is already sampled
+   * for the server-wide profile reports from its start.
+   */
+  void enable(int64 sampleBytes);
+
+  /**
+   * Stop profiling this request and hand its sites out. Returns false if
+   * enable() wasn't called.
+   */
+  bool disable(SiteMap &sites);
+
+  /**
+   * Whether this request is sampled, for either kind of profile.
+   */
+  bool active() const { return m_sampleBytes > 0;}
+  const SiteMap &getSites() const { return m_sites;}
+
+  /**
+   * SmartAllocatorImpl's hooks: an allocation that covered a sample point,
+   * and a free while sampled objects are live.
+   */
+  void sample(void *p, const char *type, int size);
+  void free(void *p);
+
+private:
+  static DECLARE_THREAD_LOCAL(HeapProfiler, s_singleton);
+
+  static Mutex s_mutex;
+  static volatile int64 s_serverSampleBytes;
+  static SiteMap s_serverSites;
+  static int64 s_serverRequests;
+
+  struct Sample {
+    Site *site;
+    int64 weight;
+  };
+  typedef hphp_hash_map<void*, Sample, pointer_hash<void> > SampleMap;
+
+  int64 m_requestSampleBytes; // set by enable()
+  int64 m_serverSampleBytes;  // set if part of the server-wide profile
+  int64 m_sampleBytes;        // what this request is sampled at, 0 if not
+  uint64 m_random;
+  SiteMap m_sites;
+  SampleMap m_live;
+  unsigned char m_filter[FilterSize];
+
+  void start();
+  void stop();
+  int64 nextSample();
+  std::string getSiteName(const char *type);
+};
+
+///////////////////////////////////////////////////////////////////////////////
+}
+
+#endif // __HPHP_HEAP_PROFILER_H__
@@ -41,6 +41,8 @@ void MemoryManager::resetStats() {
   m_stats.alloc = 0;
   m_stats.peakUsage = 0;
   m_stats.peakAlloc = 0;
+  m_stats.sampleDue = LLONG_MAX;
+  m_stats.sampleFilter = NULL;
 }
 
 void MemoryManager::add(SmartAllocatorImpl *allocator) {
@@ -16,6 +16,7 @@
 
 #include <runtime/base/memory/smart_allocator.h>
 #include <runtime/base/memory/memory_manager.h>
+#include <runtime/base/memory/heap_profiler.h>
 #include <runtime/base/resource_data.h>
 #include <runtime/base/server/server_stats.h>
 #include <runtime/base/runtime_option.h>
@@ -125,17 +126,22 @@ void *SmartAllocatorImpl::alloc() {
   if (m_stats->usage > m_stats->peakUsage) {
     checkMemUsage();
   }
+  void *ret;
   if (m_stats->usage <= m_stats->peakUsage && m_freelist.size() > 0) {
     // Fast path
 #ifdef SMART_ALLOCATOR_STACKTRACE
     m_st_allocs.operator[](m_freelist.back());
 #endif
-    void *ret = m_freelist.back();
+    ret = m_freelist.back();
     m_freelist.pop_back();
-    return ret;
+  } else {
+    // Slow path
+    ret = allocHelper();
+  }
+  if ((m_stats->sampleDue -= m_itemSize) < 0) {
+    sampleAlloc(ret);
   }
-  // Slow path
-  return allocHelper();
+  return ret;
 }
 
 void *SmartAllocatorImpl::allocHelper() {
@@ -178,6 +184,10 @@ void SmartAllocatorImpl::checkMemUsage() {
   }
 }
 
+void SmartAllocatorImpl::sampleAlloc(void *obj) {
+  HeapProfiler::TheHeapProfiler()->sample(obj, m_name, m_itemSize);
+}
+
 void SmartAllocatorImpl::dealloc(void *obj) {
   if (obj) {
     ASSERT(isValid(obj));
@@ -188,6 +198,10 @@ void SmartAllocatorImpl::dealloc(void *obj) {
 
     ASSERT(m_stats);
     m_stats->usage -= m_itemSize;
+    if (m_stats->sampleFilter &&
+        m_stats->sampleFilter[HeapProfiler::FilterIndex(obj)]) {
+      HeapProfiler::TheHeapProfiler()->free(obj);
+    }
   }
 }
 
@@ -587,15 +601,75 @@ void ObjectAllocatorBase::dump(void *p) {
   printf("%p", p);
 }
 
+#define SIZE_CLASS_ALIGN 16
+#define SIZE_CLASS_SMALL 1024
+#define ALIGN_SIZE_CLASS(n)                                             \
+  (((n) + SIZE_CLASS_ALIGN - 1) & ~(SIZE_CLASS_ALIGN - 1))
+
 int ObjectAllocatorWrapper::getAllocatorSeqno(int size) {
-  int r = 0;
+  return size <= 0 ? 0 : ALIGN_WORD(size) / WORD_SIZE - 1;
+}
+
+int ObjectAllocatorWrapper::getSeqnoSize(int seqno) {
+  return (seqno + 1) * WORD_SIZE;
+}
+
+int ObjectAllocatorWrapper::getSizeClass(int size) {
+  if (size <= SIZE_CLASS_SMALL) {
+    return size <= SIZE_CLASS_ALIGN ? SIZE_CLASS_ALIGN : ALIGN_SIZE_CLASS(size);
+  }
+  int s = SIZE_CLASS_SMALL + ALIGN_SIZE_CLASS(SIZE_CLASS_SMALL >> 2);
+  while (s < size) {
+    s = ALIGN_SIZE_CLASS(s + (s >> 2));
+  }
+  return s;
+}
+
+int ObjectAllocatorWrapper::getItemSize(int seqno) {
+  int size = getSeqnoSize(seqno);
+  if (RuntimeOption::ObjectSizeClasses) {
+    return getSizeClass(size);
+  }
   int s = sizeof(ObjectData);
   while (s < size) {
-    r++;
     s += (s >> 1);
     s = ALIGN_WORD(s);
   }
-  return r;
+  return s;
+}
+
+ObjectAllocatorBase *ObjectAllocatorWrapper::get() const {
+  return ThreadInfo::s_threadInfo->m_allocators[m_seqno];
+}
+
+void ObjectAllocatorCollector::CreateAllocators
+(std::vector<ObjectAllocatorBase *> &allocators) {
+  map<int, ObjectAllocatorWrapper *> &wrappers = getWrappers();
+  allocators.clear();
+  if (wrappers.empty()) return;
+  allocators.resize(wrappers.rbegin()->first + 1);
+
+  map<int, ObjectAllocatorBase *> bySize;
+  for (map<int, ObjectAllocatorWrapper *>::const_iterator it =
+         wrappers.begin(); it != wrappers.end(); ++it) {
+    int itemSize = ObjectAllocatorWrapper::getItemSize(it->first);
+    ObjectAllocatorBase *&allocator = bySize[itemSize];
+    if (allocator == NULL) {
+      allocator = new ObjectAllocatorBase(itemSize);
+    }
+    allocators[it->first] = allocator;
+  }
+}
+
+void ObjectAllocatorCollector::DeleteAllocators
+(std::vector<ObjectAllocatorBase *> &allocators) {
+  std::set<ObjectAllocatorBase *> unique(allocators.begin(),
+                                         allocators.end());
+  for (std::set<ObjectAllocatorBase *>::const_iterator it = unique.begin();
+       it != unique.end(); ++it) {
+    delete *it;
+  }
+  allocators.clear();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -119,6 +119,10 @@ struct MemoryUsageStats {
   int64 alloc;     // how many bytes are currently malloc-ed
   int64 peakUsage; // how many bytes have been dispensed at maximum
   int64 peakAlloc; // how many bytes malloc-ed at maximum
+  int64 sampleDue; // how many bytes to dispense before the next heap sample
+
+  // HeapProfiler's filter of sampled objects, NULL when none is live
+  const unsigned char *sampleFilter;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -170,6 +174,7 @@ public:
   void *alloc();
   void *allocHelper() __attribute__((noinline));
   void checkMemUsage() __attribute__((noinline));
+  void sampleAlloc(void *obj) __attribute__((noinline));
   void dealloc(void *obj);
   bool isValid(void *obj) const;
 
@@ -321,8 +326,8 @@ class SmartAllocator : public SmartAllocatorImpl {
 
 ///////////////////////////////////////////////////////////////////////////////
 // This allocator is for unknown but fixed sized classes, like ObjectData.
-// NS::T::s_T_initializer allows private inner classes to be initialized,
-// this is completely hidden by using a nested private llocatorInitializer
+// AllocatorSeqno names a word-aligned object size, and every class whose
+// item size comes out the same shares one allocator per thread.
 
 #define DECLARE_OBJECT_ALLOCATION(T)                                    \
   public:                                                               \
@@ -332,15 +337,9 @@ class SmartAllocator : public SmartAllocatorImpl {
   virtual void sweep();
 
 #define IMPLEMENT_OBJECT_ALLOCATION_NO_DEFAULT_SWEEP_CLS(NS,T)              \
-  static ThreadLocalSingleton<ObjectAllocator<ItemSize<sizeof(T)>::value> > \
-    g_ ## T ## _allocator;                                                  \
-  static ObjectAllocatorBase *get_ ## T ## _allocator() {                   \
-    return g_ ## T ## _allocator.get();                                     \
-  }                                                                         \
   int NS::T::AllocatorSeqno =                                               \
     ObjectAllocatorWrapper::getAllocatorSeqno(sizeof(T));                   \
-  ObjectAllocatorWrapper NS::T::Allocator(NS::T::AllocatorSeqno,            \
-                                          get_ ## T ## _allocator);         \
+  ObjectAllocatorWrapper NS::T::Allocator(NS::T::AllocatorSeqno);           \
   void NS::T::release() {                                                   \
     destruct();                                                             \
     DELETE_EX_CLS(NS, T);                                                   \
@@ -374,22 +373,6 @@ public:
   virtual void dump(void *p);
 };
 
-template<int S>
-class ObjectAllocator : public ObjectAllocatorBase {
-public:
-  static ObjectAllocator<S> *Create() {
-    return new ObjectAllocator<S>();
-  }
-  static void Delete(ObjectAllocator *p) {
-    delete p;
-  }
-  static void OnThreadExit(ObjectAllocator *p) {
-    delete p;
-  }
-
-  ObjectAllocator() : ObjectAllocatorBase(S) { }
-};
-
 class ObjectAllocatorWrapper;
 class ObjectAllocatorCollector {
 public:
@@ -397,27 +380,42 @@ public:
     static std::map<int, ObjectAllocatorWrapper *> wrappers;
     return wrappers;
   }
+
+  /**
+   * Creates this thread's allocators, indexed by size class. Size classes
+   * with the same item size share one allocator.
+   */
+  static void CreateAllocators(std::vector<ObjectAllocatorBase *> &allocators);
+  static void DeleteAllocators(std::vector<ObjectAllocatorBase *> &allocators);
 };
 
 class ObjectAllocatorWrapper {
 public:
-  ObjectAllocatorWrapper(int seqno, ObjectAllocatorBase *(*get)(void))
-  : m_get(get) {
+  ObjectAllocatorWrapper(int seqno) : m_seqno(seqno) {
     ObjectAllocatorCollector::getWrappers()[seqno] = this;
   }
 
   ObjectAllocatorBase *operator->() const {
-    return m_get();
+    return get();
   }
 
-  ObjectAllocatorBase *get() const {
-    return m_get();
-  }
+  ObjectAllocatorBase *get() const;
 
+  /**
+   * A seqno stands for sizeof(T) rounded up to a word, as it is set before
+   * runtime options are loaded. How many bytes its allocator really hands
+   * out depends on RuntimeOption::ObjectSizeClasses: with it, the size class,
+   * which are 16 bytes apart up to 1KB and 25% apart above that; without it,
+   * the older 50% steps starting from sizeof(ObjectData), which means fewer
+   * allocators per thread but more padding per object.
+   */
   static int getAllocatorSeqno(int size);
+  static int getSeqnoSize(int seqno);
+  static int getSizeClass(int size);
+  static int getItemSize(int seqno);
 
 private:
-  ObjectAllocatorBase *(*m_get)(void);
+  int m_seqno;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -277,27 +277,6 @@ struct ObjectStaticCallbacks {
 
 #define WORD_SIZE sizeof(void *)
 #define ALIGN_WORD(n) ((n) + (WORD_SIZE - (n) % WORD_SIZE) % WORD_SIZE)
-#define UNIT_SIZE sizeof(ObjectData)
-
-template<int M>
-class ItemSize {
- public:
-  enum {
-    prev = (M + M + 3) / 3 >= UNIT_SIZE ? (M + M + 3) / 3 : UNIT_SIZE,
-    value = (ItemSize<prev>::value < M ?
-             ALIGN_WORD(ItemSize<prev>::value + (ItemSize<prev>::value >> 1)) :
-             ItemSize<prev>::value)
-  };
-};
-
-template<>
-class ItemSize<UNIT_SIZE> {
- public:
-  enum {
-    prev = 0,
-    value = UNIT_SIZE
-  };
-};
 
 ///////////////////////////////////////////////////////////////////////////////
 // Attribute helper
@@ -23,12 +23,17 @@
 #include <runtime/base/server/pagelet_server.h>
 #include <runtime/base/server/xbox_server.h>
 #include <runtime/base/server/http_server.h>
+#include <runtime/base/server/warm_snapshot.h>
 #include <runtime/base/server/replay_transport.h>
+#include <runtime/base/server/replay_benchmark.h>
+#include <runtime/base/server/server_stats_shm.h>
 #include <runtime/base/server/http_request_handler.h>
 #include <runtime/base/server/admin_request_handler.h>
 #include <runtime/base/server/server_stats.h>
 #include <runtime/base/server/server_note.h>
 #include <runtime/base/memory/memory_manager.h>
+#include <runtime/base/memory/heap_profiler.h>
+#include <runtime/base/timeout_thread.h>
 #include <util/process.h>
 #include <util/capability.h>
 #include <util/timer.h>
@@ -71,6 +76,9 @@ struct ProgramOptions {
   string user;
   string file;
   int    count;
+  int    threads;
+  int    rate;
+  string benchOutput;
   bool   noSafeAccessCheck;
   vector<string> args;
   string buildId;
@@ -461,6 +469,13 @@ static int start_server(const std::string &username) {
     LightProcess::ChangeUser(username);
   }
 
+  if (RuntimeOption::EnableWarmSnapshot) {
+    int exitCode;
+    if (!WarmSnapshot::Run(exitCode)) {
+      return exitCode;
+    }
+  }
+
   HttpServer::Server = HttpServerPtr(new HttpServer());
   HttpServer::Server->run();
   return 0;
@@ -523,7 +538,8 @@ static int execute_program_impl(int argc, char **argv) {
     ("compiler-id", "display the git hash for the compiler id")
 #endif
     ("mode,m", value<string>(&po.mode)->default_value("run"),
-     "run | server | daemon | replay | translate")
+     "run | server | daemon | replay | bench | bench-compare | stats | "
+     "translate")
     ("config,c", value<string>(&po.config),
      "load specified config file")
     ("config-value,v", value<vector<string> >(&po.confStrings)->composing(),
@@ -539,6 +555,12 @@ static int execute_program_impl(int argc, char **argv) {
      "executing specified file")
     ("count", value<int>(&po.count)->default_value(1),
      "how many times to repeat execution")
+    ("threads", value<int>(&po.threads)->default_value(1),
+     "how many requests to replay at once in bench mode")
+    ("rate", value<int>(&po.rate)->default_value(0),
+     "requests per second to replay in bench mode, 0 for as fast as possible")
+    ("bench-output", value<string>(&po.benchOutput),
+     "save bench mode results to this file for bench-compare")
     ("no-safe-access-check",
       value<bool>(&po.noSafeAccessCheck)->default_value(false),
      "whether to ignore safe file access check")
@@ -588,8 +610,13 @@ static int execute_program_impl(int argc, char **argv) {
   }
   RuntimeOption::Load(config);
 
-  LightProcess::Initialize(RuntimeOption::LightProcessFilePrefix,
-                           RuntimeOption::LightProcessCount);
+  // with a warm snapshot, the servers it forks start their own
+  if (!RuntimeOption::EnableWarmSnapshot ||
+      (po.mode != "server" && po.mode != "daemon")) {
+    LightProcess::Initialize(RuntimeOption::LightProcessFilePrefix,
+                             RuntimeOption::LightProcessCount,
+                             RuntimeOption::LightProcessMaxCount);
+  }
 
   RuntimeOption::BuildId = po.buildId;
   if (po.port != -1) {
@@ -653,6 +680,58 @@ static int execute_program_impl(int argc, char **argv) {
     return 0;
   }
 
+  if (po.mode == "bench" && !po.args.empty()) {
+    RuntimeOption::RecordInput = false;
+    RuntimeOption::ExecutionMode = "srv";
+    HttpServer server; // so we initialize runtime properly
+    ReplayBenchmark bench;
+    if (bench.load(po.args[0]) == 0) {
+      cerr << "No recorded requests found in " << po.args[0] << "\n";
+      return -1;
+    }
+    bench.run(po.threads, po.count, po.rate);
+    bench.report(cout);
+    if (!po.benchOutput.empty()) {
+      bench.save(po.benchOutput);
+    }
+    return 0;
+  }
+
+  if (po.mode == "bench-compare" && po.args.size() == 2) {
+    ReplayBenchmark::Compare(cout, po.args[0], po.args[1]);
+    return 0;
+  }
+
+  if (po.mode == "stats") {
+    string file = po.args.empty() ?
+      RuntimeOption::StatsSharedMemoryFile : po.args[0];
+    ServerStatsShm shm;
+    if (file.empty() || !shm.attach(file)) {
+      cerr << "Unable to open stats file " << file << "\n";
+      return -1;
+    }
+    string snapshot;
+    int retries = 0;
+    timeval start, end;
+    gettimeofday(&start, 0);
+    for (int i = 0; i < po.count; i++) {
+      int ret = shm.snapshot(snapshot);
+      if (ret < 0) {
+        cerr << "Stats file " << file << " is not being updated cleanly\n";
+        return -1;
+      }
+      retries += ret;
+    }
+    gettimeofday(&end, 0);
+    ServerStatsShm::Report(cout, snapshot);
+    int64 usec = (end.tv_sec - start.tv_sec) * 1000000LL +
+      (end.tv_usec - start.tv_usec);
+    cout << "scrape.bytes: " << snapshot.size() << "\n";
+    cout << "scrape.usec: " << (double)usec / po.count << "\n";
+    cout << "scrape.retries: " << retries << "\n";
+    return 0;
+  }
+
   if (po.mode == "translate" && !po.args.empty()) {
     if (!access(po.args[0].c_str(), F_OK)) {
       translate_rtti(po.args[0].c_str());
@@ -703,15 +782,20 @@ void hphp_process_init() {
   Extension::InitModules();
   apc_load(RuntimeOption::ApcLoadThread);
   StaticString::FinishInit();
+  if (RuntimeOption::EnableHeapProfile) {
+    HeapProfiler::ServerEnable(RuntimeOption::HeapSampleBytes);
+  }
 }
 
 void hphp_session_init() {
   ThreadInfo *info = ThreadInfo::s_threadInfo.get();
   info->m_reqInjectionData.started = time(0);
   info->m_reqInjectionData.timedout = false;
+  TimeoutThread::OnRequestStart();
   info->reset();
 
   MemoryManager::TheMemoryManager()->resetStats();
+  HeapProfiler::TheHeapProfiler()->beginRequest();
 
   if (!s_warmup_state->done) {
     free_global_variables(); // just to be safe
@@ -830,6 +914,7 @@ void hphp_context_exit(ExecutionContext *context, bool psp,
 }
 
 void hphp_session_exit() {
+  TimeoutThread::OnRequestEnd();
   FiberAsyncFunc::OnRequestExit();
   Eval::RequestEvalState::Reset();
   // Server note has to live long enough for the access log to fire.
@@ -844,6 +929,7 @@ void hphp_session_exit() {
   if (RuntimeOption::EnableStats && RuntimeOption::EnableMemoryStats) {
     mm->logStats();
   }
+  HeapProfiler::TheHeapProfiler()->endRequest();
   mm->resetStats();
 
   if (mm->afterCheckpoint()) {
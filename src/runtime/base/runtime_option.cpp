@@ -78,6 +78,7 @@ int RuntimeOption::ServerThreadCount = 50;
 int RuntimeOption::PageletServerThreadCount = 0;
 int RuntimeOption::FiberCount = 0;
 int RuntimeOption::RequestTimeoutSeconds = 0;
+int RuntimeOption::RequestCpuBudgetMilliSeconds = 0;
 int RuntimeOption::RequestMemoryMaxBytes = -1;
 int RuntimeOption::ImageMemoryMaxBytes = 0;
 int RuntimeOption::ResponseQueueCount;
@@ -144,6 +145,9 @@ std::string RuntimeOption::FatalErrorMessage;
 std::string RuntimeOption::FontPath;
 bool RuntimeOption::EnableStaticContentCache = true;
 bool RuntimeOption::EnableStaticContentFromDisk = true;
+bool RuntimeOption::EnableFileContentCache = false;
+int RuntimeOption::FileContentCacheSize = 64; // MB
+int RuntimeOption::FileContentCacheMaxFileSize = 1 << 20;
 
 std::string RuntimeOption::RTTIDirectory;
 bool RuntimeOption::EnableCliRTTI = false;
@@ -152,6 +156,9 @@ std::string RuntimeOption::StartupDocument;
 std::string RuntimeOption::WarmupDocument;
 std::string RuntimeOption::RequestInitFunction;
 std::vector<std::string> RuntimeOption::ThreadDocuments;
+bool RuntimeOption::EnableWarmSnapshot = false;
+std::vector<std::string> RuntimeOption::WarmSnapshotDocuments;
+int RuntimeOption::WarmSnapshotRequests = 1;
 
 bool RuntimeOption::SafeFileAccess = false;
 std::vector<std::string> RuntimeOption::AllowedDirectories;
@@ -185,6 +192,8 @@ bool RuntimeOption::MySQLKillOnTimeout = false;
 
 int RuntimeOption::HttpDefaultTimeout = 30;
 int RuntimeOption::HttpSlowQueryThreshold = 5000; // ms
+int RuntimeOption::HttpConnectionPoolMaxIdlePerHost = 4;
+int RuntimeOption::HttpConnectionPoolIdleTimeout = 30; // seconds
 
 bool RuntimeOption::TranslateLeakStackTrace = false;
 bool RuntimeOption::NativeStackTrace = false;
@@ -206,6 +215,7 @@ bool RuntimeOption::EnableMemoryStats = false;
 bool RuntimeOption::EnableMallocStats = false;
 bool RuntimeOption::EnableAPCStats = false;
 bool RuntimeOption::EnableAPCKeyStats = false;
+bool RuntimeOption::EnableEvalStats = false;
 bool RuntimeOption::EnableMemcacheStats = false;
 bool RuntimeOption::EnableMemcacheKeyStats = false;
 bool RuntimeOption::EnableSQLStats = false;
@@ -214,6 +224,13 @@ std::string RuntimeOption::StatsXSL;
 std::string RuntimeOption::StatsXSLProxy;
 int RuntimeOption::StatsSlotDuration = 10 * 60; // 10 minutes
 int RuntimeOption::StatsMaxSlot = 12 * 6; // 12 hours
+std::string RuntimeOption::StatsSharedMemoryFile;
+int RuntimeOption::StatsSharedMemoryInterval = 1;
+int RuntimeOption::StatsSharedMemoryMaxKeys = 1024;
+int RuntimeOption::StatsSharedMemoryMaxSlot = 6;
+int RuntimeOption::StatsSharedMemoryMaxThreads = 256;
+bool RuntimeOption::EnableHeapProfile = false;
+int64 RuntimeOption::HeapSampleBytes = 512 * 1024;
 
 int64 RuntimeOption::MaxRSS = 0;
 int64 RuntimeOption::MaxRSSPollingCycle = 0;
@@ -222,14 +239,19 @@ int64 RuntimeOption::MaxSQLRowCount = 10000;
 int64 RuntimeOption::MaxMemcacheKeyCount = 0;
 int RuntimeOption::SocketDefaultTimeout = 5;
 bool RuntimeOption::EnableMemoryManager = true;
+bool RuntimeOption::ObjectSizeClasses = false;
 bool RuntimeOption::CheckMemory = false;
 bool RuntimeOption::UseZendArray = true;
 bool RuntimeOption::UseSmallArray = true;
+int RuntimeOption::InternArrayKeys = 0;
 bool RuntimeOption::EnableApc = true;
 bool RuntimeOption::ApcUseSharedMemory = false;
-int RuntimeOption::ApcSharedMemorySize = 1024; // 1GB
+int RuntimeOption::ApcSharedMemorySize = 1024; // 1GB per store
+std::string RuntimeOption::ApcSharedMemoryFile = "/dev/shm/hphp.apc";
 std::string RuntimeOption::ApcPrimeLibrary;
 int RuntimeOption::ApcLoadThread = 1;
+std::string RuntimeOption::ApcSnapshotFile;
+bool RuntimeOption::ApcSnapshotOnShutdown = false;
 std::set<std::string> RuntimeOption::ApcCompletionKeys;
 RuntimeOption::ApcTableTypes RuntimeOption::ApcTableType = ApcHashTable;
 RuntimeOption::ApcTableLockTypes RuntimeOption::ApcTableLockType =
@@ -252,6 +274,7 @@ std::map<std::string, std::string> RuntimeOption::EnvVariables;
 
 std::string RuntimeOption::LightProcessFilePrefix;
 int RuntimeOption::LightProcessCount;
+int RuntimeOption::LightProcessMaxCount;
 
 bool RuntimeOption::EnableXHP = true;
 bool RuntimeOption::EnableStrict = false;
@@ -448,6 +471,8 @@ void RuntimeOption::Load(Hdf &config) {
     ServerPort = server["Port"].getInt16(80);
     ServerThreadCount = server["ThreadCount"].getInt32(50);
     RequestTimeoutSeconds = server["RequestTimeoutSeconds"].getInt32(0);
+    RequestCpuBudgetMilliSeconds =
+      server["RequestCpuBudgetMilliSeconds"].getInt32(0);
     RequestMemoryMaxBytes = server["RequestMemoryMaxBytes"].getInt32(-1);
     ResponseQueueCount = server["ResponseQueueCount"].getInt32(0);
     if (ResponseQueueCount <= 0) {
@@ -524,6 +549,10 @@ void RuntimeOption::Load(Hdf &config) {
       server["EnableStaticContentCache"].getBool(true);
     EnableStaticContentFromDisk =
       server["EnableStaticContentFromDisk"].getBool(true);
+    EnableFileContentCache = server["EnableFileContentCache"].getBool();
+    FileContentCacheSize = server["FileContentCacheSize"].getInt32(64);
+    FileContentCacheMaxFileSize =
+      server["FileContentCacheMaxFileSize"].getInt32(1 << 20);
 
     RTTIDirectory = server["RTTIDirectory"].getString("/tmp/");
     if (!RTTIDirectory.empty() &&
@@ -540,6 +569,15 @@ void RuntimeOption::Load(Hdf &config) {
     for (unsigned int i = 0; i < ThreadDocuments.size(); i++) {
       normalizePath(ThreadDocuments[i]);
     }
+    {
+      Hdf warm = server["WarmSnapshot"];
+      EnableWarmSnapshot = warm["Enabled"].getBool();
+      warm["Documents"].get(WarmSnapshotDocuments);
+      for (unsigned int i = 0; i < WarmSnapshotDocuments.size(); i++) {
+        normalizePath(WarmSnapshotDocuments[i]);
+      }
+      WarmSnapshotRequests = warm["Requests"].getInt32(1);
+    }
 
     SafeFileAccess = server["SafeFileAccess"].getBool();
     server["AllowedDirectories"].get(AllowedDirectories);
@@ -556,17 +594,23 @@ void RuntimeOption::Load(Hdf &config) {
     server["ForbiddenFileExtensions"].get(ForbiddenFileExtensions);
 
     EnableMemoryManager = server["EnableMemoryManager"].getBool(true);
+    ObjectSizeClasses = server["ObjectSizeClasses"].getBool();
     CheckMemory = server["CheckMemory"].getBool();
     UseZendArray = server["UseZendArray"].getBool(true);
     UseSmallArray = server["UseSmallArray"].getBool(true);
+    InternArrayKeys = server["InternArrayKeys"].getInt32(0);
 
     Hdf apc = server["APC"];
     EnableApc = apc["EnableApc"].getBool(true);
     ApcUseSharedMemory = apc["UseSharedMemory"].getBool();
     ApcSharedMemorySize = apc["SharedMemorySize"].getInt32(1024 /* 1GB */);
+    ApcSharedMemoryFile =
+      apc["SharedMemoryFile"].getString("/dev/shm/hphp.apc");
     ApcPrimeLibrary = apc["PrimeLibrary"].getString();
     ApcLoadThread = apc["LoadThread"].getInt16(2);
     apc["CompletionKeys"].get(ApcCompletionKeys);
+    ApcSnapshotFile = apc["SnapshotFile"].getString();
+    ApcSnapshotOnShutdown = apc["SnapshotOnShutdown"].getBool();
 
     string apcTableType = apc["TableType"].getString("hash");
     if (strcasecmp(apcTableType.c_str(), "hash") == 0) {
@@ -626,6 +670,8 @@ void RuntimeOption::Load(Hdf &config) {
     LightProcessFilePrefix =
       server["LightProcessFilePrefix"].getString("./lightprocess");
     LightProcessCount = server["LightProcessCount"].getInt32(0);
+    LightProcessMaxCount =
+      server["LightProcessMaxCount"].getInt32(LightProcessCount * 4);
 
     InjectedStackTrace = server["InjectedStackTrace"].getBool(true);
 
@@ -731,6 +777,10 @@ void RuntimeOption::Load(Hdf &config) {
     Hdf http = config["Http"];
     HttpDefaultTimeout = http["DefaultTimeout"].getInt32(30);
     HttpSlowQueryThreshold = http["SlowQueryThreshold"].getInt32(5000);
+
+    Hdf pool = http["ConnectionPool"];
+    HttpConnectionPoolMaxIdlePerHost = pool["MaxIdlePerHost"].getInt32(4);
+    HttpConnectionPoolIdleTimeout = pool["IdleTimeout"].getInt32(30);
   }
   {
     Hdf debug = config["Debug"];
@@ -764,6 +814,7 @@ void RuntimeOption::Load(Hdf &config) {
     EnableMallocStats = stats["Malloc"].getBool();
     EnableAPCStats = stats["APC"].getBool();
     EnableAPCKeyStats = stats["APCKey"].getBool();
+    EnableEvalStats = stats["Eval"].getBool();
     EnableMemcacheStats = stats["Memcache"].getBool();
     EnableMemcacheKeyStats = stats["MemcacheKey"].getBool();
     EnableSQLStats = stats["SQL"].getBool();
@@ -778,6 +829,17 @@ void RuntimeOption::Load(Hdf &config) {
 
     StatsSlotDuration = stats["SlotDuration"].getInt32(10 * 60); // 10 minutes
     StatsMaxSlot = stats["MaxSlot"].getInt32(12 * 6); // 12 hours
+
+    Hdf shm = stats["SharedMemory"];
+    StatsSharedMemoryFile = shm["File"].getString();
+    StatsSharedMemoryInterval = shm["Interval"].getInt32(1);
+    StatsSharedMemoryMaxKeys = shm["MaxKeys"].getInt32(1024);
+    StatsSharedMemoryMaxSlot = shm["MaxSlot"].getInt32(6);
+    StatsSharedMemoryMaxThreads = shm["MaxThreads"].getInt32(256);
+
+    Hdf heap = stats["HeapProfile"];
+    EnableHeapProfile = heap.getBool();
+    HeapSampleBytes = heap["SampleBytes"].getInt64(512 * 1024);
   }
   {
     config["ServerVariables"].get(ServerVariables);
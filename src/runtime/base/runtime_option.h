@@ -76,6 +76,7 @@ public:
   static int PageletServerThreadCount;
   static int FiberCount;
   static int RequestTimeoutSeconds;
+  static int RequestCpuBudgetMilliSeconds;
   static int RequestMemoryMaxBytes;
   static int ImageMemoryMaxBytes;
   static int ResponseQueueCount;
@@ -143,6 +144,9 @@ public:
   static std::string FontPath;
   static bool EnableStaticContentCache;
   static bool EnableStaticContentFromDisk;
+  static bool EnableFileContentCache;
+  static int FileContentCacheSize;
+  static int FileContentCacheMaxFileSize;
 
   static std::string RTTIDirectory;
   static bool EnableCliRTTI;
@@ -151,6 +155,9 @@ public:
   static std::string WarmupDocument;
   static std::string RequestInitFunction;
   static std::vector<std::string> ThreadDocuments;
+  static bool EnableWarmSnapshot;
+  static std::vector<std::string> WarmSnapshotDocuments;
+  static int WarmSnapshotRequests;
 
   static bool SafeFileAccess;
   static std::vector<std::string> AllowedDirectories;
@@ -184,6 +191,8 @@ public:
 
   static int  HttpDefaultTimeout;
   static int  HttpSlowQueryThreshold;
+  static int  HttpConnectionPoolMaxIdlePerHost;
+  static int  HttpConnectionPoolIdleTimeout;
 
   static bool TranslateLeakStackTrace;
   static bool NativeStackTrace;
@@ -205,6 +214,7 @@ public:
   static bool EnableMallocStats;
   static bool EnableAPCStats;
   static bool EnableAPCKeyStats;
+  static bool EnableEvalStats;
   static bool EnableMemcacheStats;
   static bool EnableMemcacheKeyStats;
   static bool EnableSQLStats;
@@ -213,6 +223,13 @@ public:
   static std::string StatsXSLProxy;
   static int StatsSlotDuration;
   static int StatsMaxSlot;
+  static std::string StatsSharedMemoryFile;
+  static int StatsSharedMemoryInterval;
+  static int StatsSharedMemoryMaxKeys;
+  static int StatsSharedMemoryMaxSlot;
+  static int StatsSharedMemoryMaxThreads;
+  static bool EnableHeapProfile;
+  static int64 HeapSampleBytes;
 
   static int64 MaxRSS;
   static int64 MaxRSSPollingCycle;
@@ -221,14 +238,19 @@ public:
   static int64 MaxMemcacheKeyCount;
   static int  SocketDefaultTimeout;
   static bool EnableMemoryManager;
+  static bool ObjectSizeClasses;
   static bool CheckMemory;
   static bool UseZendArray; // ignored: ZendArray is always enabled
   static bool UseSmallArray;
+  static int InternArrayKeys;
   static bool EnableApc;
   static bool ApcUseSharedMemory;
   static int ApcSharedMemorySize;
+  static std::string ApcSharedMemoryFile;
   static std::string ApcPrimeLibrary;
   static int ApcLoadThread;
+  static std::string ApcSnapshotFile;
+  static bool ApcSnapshotOnShutdown;
   static std::set<std::string> ApcCompletionKeys;
   enum ApcTableTypes {
     ApcHashTable,
@@ -262,6 +284,7 @@ public:
   // is the following prefix followed by the pid of the hphp process.
   static std::string LightProcessFilePrefix;
   static int LightProcessCount;
+  static int LightProcessMaxCount;
 
   // Eval options
   static bool EnableXHP;
@@ -16,6 +16,7 @@
 
 #include <runtime/base/server/admin_request_handler.h>
 #include <runtime/base/server/http_server.h>
+#include <runtime/base/server/warm_snapshot.h>
 #include <runtime/base/util/http_client.h>
 #include <runtime/base/server/server_stats.h>
 #include <runtime/base/runtime_option.h>
@@ -28,7 +29,9 @@
 #include <runtime/base/program_functions.h>
 #include <runtime/base/shared/shared_store.h>
 #include <runtime/base/memory/leak_detectable.h>
+#include <runtime/base/memory/heap_profiler.h>
 #include <runtime/ext/mysql_stats.h>
+#include <runtime/ext/ext_apc.h>
 
 #ifdef GOOGLE_CPU_PROFILER
 #include <google/profiler.h>
@@ -75,6 +78,7 @@ void AdminRequestHandler::handleRequest(Transport *transport) {
     if (cmd == "" || cmd == "help") {
       string usage =
         "/stop:            stop the web server\n"
+        "/warm-restart:    fork a new web server off the warm snapshot\n"
         "/translate:       translate hex encoded stacktrace in 'stack' param\n"
         "    stack         required, stack trace to translate\n"
         "    build-id      optional, if specified, build ID has to match\n"
@@ -88,6 +92,7 @@ void AdminRequestHandler::handleRequest(Transport *transport) {
         "/check-load:      how many threads are actively handling requests\n"
         "/check-mem:       report memory quick statistics in log file\n"
         "/check-apc:       report APC quick statistics\n"
+        "/dump-apc:        save APC contents to the configured SnapshotFile\n"
         "/check-sql:       report SQL table statistics\n"
 
         "/status.xml:      show server status in XML\n"
@@ -102,6 +107,7 @@ void AdminRequestHandler::handleRequest(Transport *transport) {
         "/stats-mem:       turn on/off memory statistics\n"
         "/stats-apc:       turn on/off APC statistics\n"
         "/stats-apc-key:   turn on/off APC key statistics\n"
+        "/stats-eval:      turn on/off eval inline cache statistics\n"
         "/stats-mcc:       turn on/off memcache statistics\n"
         "/stats-sql:       turn on/off SQL statistics\n"
         "/stats-mutex:     turn on/off mutex statistics\n"
@@ -124,6 +130,12 @@ void AdminRequestHandler::handleRequest(Transport *transport) {
         "/stats.html:      show server stats in HTML\n"
         "    (same as /stats.xml)\n"
 
+        "/prof-mem-on:     sample request memory by allocation site\n"
+        "    bytes         optional, average bytes between samples\n"
+        "/prof-mem-off:    stop sampling request memory\n"
+        "/prof-mem-dump:   show allocation sites sampled so far\n"
+        "    top           optional, default 50\n"
+
 #ifdef GOOGLE_CPU_PROFILER
         "/prof-cpu-on:     turn on CPU profiler\n"
         "/prof-cpu-off:    turn off CPU profiler\n"
@@ -170,6 +182,14 @@ void AdminRequestHandler::handleRequest(Transport *transport) {
       HttpServer::Server->stop();
       break;
     }
+    if (cmd == "warm-restart") {
+      if (WarmSnapshot::RequestRestart()) {
+        transport->sendString("OK\n");
+      } else {
+        transport->sendString("Not forked off a warm snapshot\n", 500);
+      }
+      break;
+    }
     if (cmd == "build-id") {
       transport->sendString(RuntimeOption::BuildId, 200);
       break;
@@ -385,6 +405,16 @@ bool AdminRequestHandler::handleCheckRequest(const std::string &cmd,
     transport->sendString(stats);
     return true;
   }
+  if (cmd == "dump-apc") {
+    if (RuntimeOption::ApcSnapshotFile.empty()) {
+      transport->sendString("No SnapshotFile configured\n", 500);
+    } else if (apc_dump_snapshot(RuntimeOption::ApcSnapshotFile)) {
+      transport->sendString("OK\n");
+    } else {
+      transport->sendString("Unable to save APC snapshot\n", 500);
+    }
+    return true;
+  }
   if (cmd == "check-sql") {
     string stats = "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n";
     stats += "<SQL>\n";
@@ -446,6 +476,9 @@ bool AdminRequestHandler::handleStatsRequest(const std::string &cmd,
   if (cmd == "stats-apc-key") {
     return toggle_switch(transport, RuntimeOption::EnableAPCKeyStats);
   }
+  if (cmd == "stats-eval") {
+    return toggle_switch(transport, RuntimeOption::EnableEvalStats);
+  }
   if (cmd == "stats-mcc") {
     return toggle_switch(transport, RuntimeOption::EnableMemcacheStats);
   }
@@ -507,6 +540,9 @@ bool AdminRequestHandler::handleStatsRequest(const std::string &cmd,
 
 bool AdminRequestHandler::handleProfileRequest(const std::string &cmd,
                                                Transport *transport) {
+  if (handleMemoryProfilerRequest(cmd, transport)) {
+    return true;
+  }
 #ifdef GOOGLE_CPU_PROFILER
   if (handleCPUProfilerRequest(cmd, transport)) {
     return true;
@@ -520,6 +556,26 @@ bool AdminRequestHandler::handleProfileRequest(const std::string &cmd,
   return false;
 }
 
+bool AdminRequestHandler::handleMemoryProfilerRequest(const std::string &cmd,
+                                                      Transport *transport) {
+  if (cmd == "prof-mem-on") {
+    HeapProfiler::ServerEnable(transport->getInt64Param("bytes"));
+    transport->sendString("OK\n");
+    return true;
+  }
+  if (cmd == "prof-mem-off") {
+    HeapProfiler::ServerDisable();
+    transport->sendString("OK\n");
+    return true;
+  }
+  if (cmd == "prof-mem-dump") {
+    int top = transport->getIntParam("top");
+    transport->sendString(HeapProfiler::ServerReport(top ? top : 50));
+    return true;
+  }
+  return false;
+}
+
 #if (defined(GOOGLE_CPU_PROFILER) || defined(GOOGLE_HEAP_PROFILER))
 
 // call pprof to generate outputs
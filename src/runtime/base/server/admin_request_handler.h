@@ -38,6 +38,8 @@ private:
   bool handleStatsRequest  (const std::string &cmd, Transport *transport);
   bool handleProfileRequest(const std::string &cmd, Transport *transport);
   bool handleLeakRequest   (const std::string &cmd, Transport *transport);
+  bool handleMemoryProfilerRequest(const std::string &cmd,
+                                   Transport *transport);
 
 #ifdef GOOGLE_CPU_PROFILER
   bool handleCPUProfilerRequest (const std::string &cmd, Transport *transport);
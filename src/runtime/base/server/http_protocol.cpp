@@ -51,6 +51,13 @@ static bool read_all_post_data(Transport *transport,
   return false;
 }
 
+static void skip_all_post_data(Transport *transport) {
+  while (transport->hasMorePostData()) {
+    int delta = 0;
+    transport->getMorePostData(delta);
+  }
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 const VirtualHost *HttpProtocol::GetVirtualHost(Transport *transport) {
@@ -117,12 +124,22 @@ void HttpProtocol::PrepareSystemVariables(Transport *transport,
           Logger::Warning("POST Content-Length of %d bytes exceeds "
                           "the limit of %ld bytes",
                           content_length, RuntimeOption::MaxPostSize);
-          needDelete = read_all_post_data(transport, data, size);
+          if (RuntimeOption::AlwaysPopulateRawPostData) {
+            needDelete = read_all_post_data(transport, data, size);
+          } else {
+            skip_all_post_data(transport);
+            // the first chunk went with the rest
+            data = NULL;
+            size = 0;
+          }
         } else {
-          if (transport->hasMorePostData()) {
+          if (transport->hasMorePostData() &&
+              RuntimeOption::AlwaysPopulateRawPostData) {
             needDelete = true;
             data = Util::buffer_duplicate(data, size);
           }
+          // without a raw copy to keep, the rest of the body is parsed
+          // straight out of the transport and data comes back as NULL
           DecodeRfc1867(transport, g->gv__POST, g->gv__FILES,
                         content_length, data, size, boundary);
         }
@@ -137,7 +154,7 @@ void HttpProtocol::PrepareSystemVariables(Transport *transport,
         } else {
           free((void *)data);
         }
-      } else {
+      } else if (data) {
         // For literal we disregard RuntimeOption::AlwaysPopulateRawPostData
         g->gv_HTTP_RAW_POST_DATA = String((char*)data, size, AttachLiteral);
       }
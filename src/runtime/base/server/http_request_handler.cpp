@@ -22,6 +22,8 @@
 #include <runtime/base/server/static_content_cache.h>
 #include <runtime/base/server/dynamic_content_cache.h>
 #include <runtime/base/server/server_stats.h>
+#include <runtime/base/timeout_thread.h>
+#include <runtime/base/memory/memory_manager.h>
 #include <util/network.h>
 #include <runtime/base/preg.h>
 #include <runtime/ext/ext_function.h>
@@ -286,15 +288,19 @@ bool HttpRequestHandler::executePHPRequest(Transport *transport,
                       error, errorMsg);
 
     if (ret) {
-      String content = context->obDetachContents();
-      if (cachableDynamicContent && !content.empty()) {
-        ASSERT(transport->getUrl());
-        string key = file + transport->getUrl();
-        DynamicContentCache::TheCache.store(key, content.data(),
-                                            content.size());
-      }
       code = 200;
-      transport->sendRaw((void*)content.data(), content.size());
+      if (cachableDynamicContent) {
+        String content = context->obDetachContents();
+        if (!content.empty()) {
+          ASSERT(transport->getUrl());
+          string key = file + transport->getUrl();
+          DynamicContentCache::TheCache.store(key, content.data(),
+                                              content.size());
+        }
+        transport->sendRaw((void*)content.data(), content.size());
+      } else {
+        context->obSendContents(transport);
+      }
     } else if (error) {
       code = 500;
 
@@ -331,7 +337,10 @@ bool HttpRequestHandler::executePHPRequest(Transport *transport,
   }
 
   transport->onSendEnd();
+  TimeoutThread::OnRequestEnd();
   ServerStats::LogPage(file, code);
+  transport->setPeakMemory
+    (MemoryManager::TheMemoryManager()->getStats().peakUsage);
   hphp_context_exit(context, true);
   return ret;
 }
@@ -20,6 +20,7 @@
 #include <runtime/base/server/http_request_handler.h>
 #include <runtime/base/server/admin_request_handler.h>
 #include <runtime/base/server/server_stats.h>
+#include <runtime/base/server/server_stats_shm.h>
 #include <runtime/base/runtime_option.h>
 #include <runtime/base/server/static_content_cache.h>
 #include <runtime/base/class_info.h>
@@ -30,6 +31,7 @@
 #include <runtime/base/externals.h>
 #include <runtime/base/util/http_client.h>
 #include <runtime/base/server/replay_transport.h>
+#include <runtime/base/server/warm_snapshot.h>
 #include <runtime/base/program_functions.h>
 #include <util/db_conn.h>
 #include <util/log_aggregator.h>
@@ -49,10 +51,54 @@ time_t HttpServer::StartTime;
 
 ///////////////////////////////////////////////////////////////////////////////
 
+bool HttpServer::LoadProcess() {
+  static int loaded = -1;
+  if (loaded >= 0) {
+    return loaded;
+  }
+  loaded = false;
+
+  if (RuntimeOption::EnableStaticContentCache) {
+    StaticContentCache::TheCache.load();
+  }
+  ClassInfo::Load();
+  SourceInfo::TheSourceInfo.load();
+  RTTIInfo::TheRTTIInfo.init(true);
+
+  hphp_process_init();
+
+  if (!RuntimeOption::StartupDocument.empty()) {
+    Hdf hdf;
+    hdf["get"] = 1;
+    hdf["url"] = RuntimeOption::StartupDocument;
+    hdf["remote_host"] = RuntimeOption::ServerIP;
+
+    ReplayTransport rt;
+    rt.replayInput(hdf);
+    HttpRequestHandler handler;
+    handler.handleRequest(&rt);
+    int code = rt.getResponseCode();
+    if (code == 200) {
+      Logger::Info("StartupDocument %s returned 200 OK: %s",
+                   RuntimeOption::StartupDocument.c_str(),
+                   rt.getResponse().c_str());
+    } else {
+      Logger::Error("StartupDocument %s failed %d: %s",
+                    RuntimeOption::StartupDocument.c_str(),
+                    code, rt.getResponse().data());
+      return false;
+    }
+  }
+
+  loaded = true;
+  return true;
+}
+
 HttpServer::HttpServer()
   : m_stopped(false),
     m_loggerThread(this, &HttpServer::flushLog),
-    m_watchDog(this, &HttpServer::watchDog) {
+    m_watchDog(this, &HttpServer::watchDog),
+    m_statsPublisher(this, &HttpServer::publishStats) {
 
   // enabling mutex profiling, but it's not turned on
   LockProfiler::s_pfunc_profile = server_stats_log_mutex;
@@ -99,39 +145,13 @@ HttpServer::HttpServer()
     }
   }
 
-  if (RuntimeOption::EnableStaticContentCache) {
-    StaticContentCache::TheCache.load();
-  }
-  ClassInfo::Load();
-  SourceInfo::TheSourceInfo.load();
-  RTTIInfo::TheRTTIInfo.init(true);
-
-  hphp_process_init();
+  bool loaded = LoadProcess();
 
   Server::InstallStopSignalHandlers(m_pageServer);
   Server::InstallStopSignalHandlers(m_adminServer);
 
-  if (!RuntimeOption::StartupDocument.empty()) {
-    Hdf hdf;
-    hdf["get"] = 1;
-    hdf["url"] = RuntimeOption::StartupDocument;
-    hdf["remote_host"] = RuntimeOption::ServerIP;
-
-    ReplayTransport rt;
-    rt.replayInput(hdf);
-    HttpRequestHandler handler;
-    handler.handleRequest(&rt);
-    int code = rt.getResponseCode();
-    if (code == 200) {
-      Logger::Info("StartupDocument %s returned 200 OK: %s",
-                   RuntimeOption::StartupDocument.c_str(),
-                   rt.getResponse().c_str());
-    } else {
-      Logger::Error("StartupDocument %s failed %d: %s",
-                    RuntimeOption::StartupDocument.c_str(),
-                    code, rt.getResponse().data());
-      return;
-    }
+  if (!loaded) {
+    return;
   }
 
   for (unsigned int i = 0; i < RuntimeOption::ThreadDocuments.size(); i++) {
@@ -185,6 +205,9 @@ void HttpServer::run() {
 
   m_loggerThread.start();
   m_watchDog.start();
+  if (!RuntimeOption::StatsSharedMemoryFile.empty()) {
+    m_statsPublisher.start();
+  }
 
   for (unsigned int i = 0; i < m_serviceThreads.size(); i++) {
     m_serviceThreads[i]->start();
@@ -225,6 +248,7 @@ void HttpServer::run() {
 
   {
     Logger::Info("all servers started");
+    WarmSnapshot::ServerStarted();
     createPid();
     Lock lock(this);
     // continously running until /stop is received on admin server
@@ -254,6 +278,12 @@ void HttpServer::run() {
                  m_danglings[i]->getName().c_str());
   }
 
+  // no more requests to change APC after this point
+  if (RuntimeOption::ApcSnapshotOnShutdown) {
+    apc_dump_snapshot(RuntimeOption::ApcSnapshotFile);
+  }
+
+  m_statsPublisher.waitForEnd();
   m_watchDog.waitForEnd();
   m_loggerThread.waitForEnd();
   Logger::Info("all servers stopped");
@@ -398,6 +428,23 @@ void HttpServer::checkMemory() {
   }
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// stats publisher thread
+
+void HttpServer::publishStats() {
+  ServerStatsShm shm;
+  if (!shm.create(RuntimeOption::StatsSharedMemoryFile,
+                  RuntimeOption::StatsSharedMemoryMaxKeys,
+                  RuntimeOption::StatsSharedMemoryMaxSlot,
+                  RuntimeOption::StatsSharedMemoryMaxThreads)) {
+    return;
+  }
+  while (!m_stopped) {
+    ServerStats::Publish(shm);
+    sleep(RuntimeOption::StatsSharedMemoryInterval);
+  }
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // page server
 
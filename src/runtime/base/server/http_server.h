@@ -33,6 +33,13 @@ public:
   static HttpServerPtr Server;
   static time_t StartTime;
 
+  /**
+   * Loads and initializes everything the process serves with, and runs
+   * StartupDocument, once; the constructor calls it if no one did before.
+   * Returns false if StartupDocument failed.
+   */
+  static bool LoadProcess();
+
 public:
   HttpServer();
   ~HttpServer();
@@ -42,6 +49,7 @@ public:
 
   void flushLog();
   void watchDog();
+  void publishStats();
 
   void takeoverShutdown(LibEventServerWithTakeover* server);
 
@@ -56,6 +64,7 @@ private:
   SatelliteServerPtrVec m_danglings;
   AsyncFunc<HttpServer> m_loggerThread;
   AsyncFunc<HttpServer> m_watchDog;
+  AsyncFunc<HttpServer> m_statsPublisher;
   ServiceThreadPtrVec m_serviceThreads;
 
   bool startServer(bool pageServer);
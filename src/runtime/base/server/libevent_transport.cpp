@@ -249,6 +249,22 @@ void LibEventTransport::sendImpl(const void *data, int size, int code,
   m_sendStarted = true;
 }
 
+void LibEventTransport::sendvImpl(const std::vector<iovec> &chunks,
+                                  int code) {
+  ASSERT(!m_sendEnded);
+  ASSERT(!m_sendStarted);
+
+  if (m_method != HEAD) {
+    for (unsigned int i = 0; i < chunks.size(); i++) {
+      evbuffer_add(m_request->output_buffer, chunks[i].iov_base,
+                   chunks[i].iov_len);
+    }
+  }
+  m_server->onResponse(m_workerId, m_request, code);
+  m_sendEnded = true;
+  m_sendStarted = true;
+}
+
 void LibEventTransport::onSendEndImpl() {
   if (m_chunkedEncoding) {
     m_server->onChunkedResponseEnd(m_workerId, m_request);
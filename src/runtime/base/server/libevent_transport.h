@@ -48,6 +48,7 @@ public:
   virtual void addRequestHeaderImpl(const char *name, const char *value);
   virtual void removeRequestHeaderImpl(const char *name);
   virtual void sendImpl(const void *data, int size, int code, bool chunked);
+  virtual void sendvImpl(const std::vector<iovec> &chunks, int code);
   virtual void onSendEndImpl();
   virtual bool isServerStopping();
 
@@ -223,12 +223,16 @@ bool PageletServer::Enabled() {
   return RuntimeOption::PageletServerThreadCount > 0;
 }
 
-void PageletServer::Restart() {
+void PageletServer::Stop() {
   if (s_dispatcher) {
     s_dispatcher->stop();
     delete s_dispatcher;
     s_dispatcher = NULL;
   }
+}
+
+void PageletServer::Restart() {
+  Stop();
   if (RuntimeOption::PageletServerThreadCount > 0) {
     s_dispatcher = new JobQueueDispatcher<PageletTransport*, PageletWorker>
       (RuntimeOption::PageletServerThreadCount, NULL);
@@ -0,0 +1,264 @@
+/*
+   +----------------------------------------------------------------------+
+   | HipHop for PHP                                                       |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2010 Facebook, Inc. (http://www.facebook.com)          |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 3.01 of the PHP license,      |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available through the world-wide-web at the following url:           |
+   | http://www.php.net/license/3_01.txt                                  |
+   | If you did not receive a copy of the PHP license and are unable to   |
+   | obtain it through the world-wide-web, please send a note to          |
+   | license@php.net so we can mail you a copy immediately.               |
+   +----------------------------------------------------------------------+
+*/
+
+#include <runtime/base/server/replay_benchmark.h>
+#include <runtime/base/server/replay_transport.h>
+#include <runtime/base/server/http_request_handler.h>
+#include <runtime/base/memory/memory_manager.h>
+#include <util/async_func.h>
+#include <util/atomic.h>
+#include <util/logger.h>
+#include <dirent.h>
+
+#ifdef GOOGLE_TCMALLOC
+#include <google/malloc_extension.h>
+#endif
+#ifdef USE_JEMALLOC
+#include <jemalloc/jemalloc.h>
+#endif
+
+using namespace std;
+
+namespace HPHP {
+///////////////////////////////////////////////////////////////////////////////
+
+static int64 now_usec() {
+  struct timeval tv;
+  gettimeofday(&tv, 0);
+  return (int64)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+ReplayBenchmark::ReplayBenchmark()
+  : m_total(0), m_next(0), m_rate(0), m_start(0), m_elapsed(0),
+    m_threads(0) {
+}
+
+int ReplayBenchmark::load(const std::string &dir) {
+  DIR *dp = opendir(dir.c_str());
+  if (dp == NULL) {
+    Logger::Error("unable to open directory %s", dir.c_str());
+    return 0;
+  }
+  vector<string> files;
+  struct dirent *ep;
+  while ((ep = readdir(dp))) {
+    if (ep->d_name[0] == '.') continue;
+    files.push_back(dir + "/" + ep->d_name);
+  }
+  closedir(dp);
+  // same order every time, so that two runs replay the same sequence
+  sort(files.begin(), files.end());
+
+  for (unsigned int i = 0; i < files.size(); i++) {
+    try {
+      Hdf hdf(files[i]);
+      if (!hdf.exists("url")) continue;
+      m_requests.push_back(hdf.toString());
+    } catch (HdfException &e) {
+      Logger::Warning("skipping %s: %s", files[i].c_str(), e.what());
+    }
+  }
+  return m_requests.size();
+}
+
+void ReplayBenchmark::run(int threads, int count, int rate) {
+  if (threads < 1) threads = 1;
+  m_threads = threads;
+  m_total = m_requests.size() * count;
+  m_samples.clear();
+  m_samples.resize(m_total);
+  m_next = 0;
+  m_rate = rate;
+
+  GetAllocatorStats(m_allocBefore);
+  vector<AsyncFunc<ReplayBenchmark>*> funcs;
+  for (int i = 0; i < threads; i++) {
+    funcs.push_back(new AsyncFunc<ReplayBenchmark>
+                    (this, &ReplayBenchmark::worker));
+  }
+  m_start = now_usec();
+  for (int i = 0; i < threads; i++) {
+    funcs[i]->start();
+  }
+  for (int i = 0; i < threads; i++) {
+    funcs[i]->waitForEnd();
+    delete funcs[i];
+  }
+  m_elapsed = now_usec() - m_start;
+  GetAllocatorStats(m_allocAfter);
+}
+
+void ReplayBenchmark::worker() {
+  HttpRequestHandler handler;
+  while (true) {
+    int i = atomic_inc(m_next) - 1;
+    if (i >= m_total) break;
+
+    // parsing the recording is not part of what we measure
+    Hdf hdf;
+    hdf.fromString(m_requests[i % m_requests.size()].c_str());
+    ReplayTransport rt;
+    rt.replayInput(hdf);
+
+    int64 begin = now_usec();
+    if (m_rate > 0) {
+      int64 scheduled = m_start + (int64)i * 1000000 / m_rate;
+      if (scheduled > begin) {
+        usleep(scheduled - begin);
+      }
+      begin = scheduled;
+    }
+    handler.handleRequest(&rt);
+
+    Sample &sample = m_samples[i];
+    sample.latency = now_usec() - begin;
+    sample.memory = rt.getPeakMemory();
+    sample.code = rt.getResponseCode();
+  }
+  MemoryManager::TheMemoryManager()->cleanup();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// reporting
+
+static int64 percentile(const vector<int64> &sorted, int permille) {
+  if (sorted.empty()) return 0;
+  return sorted[(sorted.size() - 1) * permille / 1000];
+}
+
+void ReplayBenchmark::summarize(Hdf hdf) const {
+  vector<int64> latencies;
+  latencies.reserve(m_samples.size());
+  int64 latencyTotal = 0;
+  int64 memoryTotal = 0;
+  int64 memoryMax = 0;
+  int errors = 0;
+  for (unsigned int i = 0; i < m_samples.size(); i++) {
+    const Sample &sample = m_samples[i];
+    latencies.push_back(sample.latency);
+    latencyTotal += sample.latency;
+    memoryTotal += sample.memory;
+    if (sample.memory > memoryMax) memoryMax = sample.memory;
+    if (sample.code != 200) errors++;
+  }
+  sort(latencies.begin(), latencies.end());
+  int64 count = latencies.size() ? latencies.size() : 1;
+
+  hdf["requests"] = m_total;
+  hdf["threads"] = m_threads;
+  hdf["rate"] = m_rate;
+  hdf["errors"] = errors;
+  hdf["elapsed_us"] = m_elapsed;
+  hdf["throughput"] = m_elapsed ? m_total * 1000000.0 / m_elapsed : 0.0;
+
+  Hdf latency = hdf["latency_us"];
+  latency["avg"] = latencyTotal / count;
+  latency["p50"] = percentile(latencies, 500);
+  latency["p90"] = percentile(latencies, 900);
+  latency["p99"] = percentile(latencies, 990);
+  latency["p999"] = percentile(latencies, 999);
+  latency["max"] = latencies.empty() ? 0 : latencies.back();
+
+  Hdf memory = hdf["memory_bytes"];
+  memory["avg"] = memoryTotal / count;
+  memory["max"] = memoryMax;
+
+  // growth of the process heap over the whole run
+  for (map<string, int64>::const_iterator iter = m_allocAfter.begin();
+       iter != m_allocAfter.end(); ++iter) {
+    map<string, int64>::const_iterator before =
+      m_allocBefore.find(iter->first);
+    hdf["allocator"][iter->first] =
+      iter->second - (before == m_allocBefore.end() ? 0 : before->second);
+  }
+}
+
+void ReplayBenchmark::report(std::ostream &out) const {
+  Hdf hdf;
+  summarize(hdf);
+  out << hdf.toString();
+}
+
+void ReplayBenchmark::save(const std::string &filename) const {
+  Hdf hdf;
+  summarize(hdf);
+  hdf.write(filename);
+}
+
+static void compare_node(std::ostream &out, const string &path,
+                         Hdf before, Hdf after) {
+  for (Hdf hdf = before.firstChild(); hdf.exists(); hdf = hdf.next()) {
+    string name = hdf.getName();
+    string full = path.empty() ? name : path + "." + name;
+    if (hdf.firstChild().exists()) {
+      compare_node(out, full, hdf, after[name]);
+      continue;
+    }
+    double b = hdf.getDouble();
+    double a = after[name].getDouble();
+    char buf[256];
+    if (b != 0) {
+      snprintf(buf, sizeof(buf), "%-24s %14.2f %14.2f %+8.2f%%\n",
+               full.c_str(), b, a, (a - b) * 100 / b);
+    } else {
+      snprintf(buf, sizeof(buf), "%-24s %14.2f %14.2f\n",
+               full.c_str(), b, a);
+    }
+    out << buf;
+  }
+}
+
+void ReplayBenchmark::Compare(std::ostream &out, const std::string &before,
+                              const std::string &after) {
+  Hdf b(before);
+  Hdf a(after);
+  char buf[256];
+  snprintf(buf, sizeof(buf), "%-24s %14s %14s %9s\n",
+           "", "before", "after", "change");
+  out << buf;
+  compare_node(out, "", b, a);
+}
+
+void ReplayBenchmark::GetAllocatorStats(std::map<std::string, int64> &stats) {
+  stats.clear();
+#ifdef GOOGLE_TCMALLOC
+  size_t allocated = 0;
+  size_t heap_size = 0;
+  MallocExtension::instance()->
+    GetNumericProperty("generic.current_allocated_bytes", &allocated);
+  MallocExtension::instance()->
+    GetNumericProperty("generic.heap_size", &heap_size);
+  stats["allocated"] = allocated;
+  stats["heap_size"] = heap_size;
+#endif
+#ifdef USE_JEMALLOC
+  uint64_t epoch = 1;
+  mallctl("epoch", NULL, NULL, &epoch, sizeof(epoch));
+  size_t sz = sizeof(size_t);
+  size_t allocated = 0;
+  size_t active = 0;
+  size_t mapped = 0;
+  mallctl("stats.allocated", &allocated, &sz, NULL, 0);
+  mallctl("stats.active", &active, &sz, NULL, 0);
+  mallctl("stats.mapped", &mapped, &sz, NULL, 0);
+  stats["allocated"] = allocated;
+  stats["active"] = active;
+  stats["mapped"] = mapped;
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+}
@@ -0,0 +1,90 @@
+/*
+   +----------------------------------------------------------------------+
+   | HipHop for PHP                                                       |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2010 Facebook, Inc. (http://www.facebook.com)          |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 3.01 of the PHP license,      |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available through the world-wide-web at the following url:           |
+   | http://www.php.net/license/3_01.txt                                  |
+   | If you did not receive a copy of the PHP license and are unable to   |
+   | obtain it through the world-wide-web, please send a note to          |
+   | license@php.net so we can mail you a copy immediately.               |
+   +----------------------------------------------------------------------+
+*/
+
+#ifndef __HPHP_REPLAY_BENCHMARK_H__
+#define __HPHP_REPLAY_BENCHMARK_H__
+
+#include <util/base.h>
+#include <util/hdf.h>
+
+namespace HPHP {
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Turns requests recorded by RuntimeOption::RecordInput into a benchmark:
+ * they are replayed through HttpRequestHandler in this process, without any
+ * networking, and timed. Results can be saved as HDF, so two builds replaying
+ * the same traffic can be compared with Compare().
+ */
+class ReplayBenchmark {
+public:
+  ReplayBenchmark();
+
+  /**
+   * Loads every file in a directory that holds a recorded request. Returns
+   * how many were found.
+   */
+  int load(const std::string &dir);
+
+  /**
+   * Replays all loaded requests "count" times on "threads" threads. With a
+   * non-zero "rate", requests are started on a fixed schedule of that many
+   * per second and latency is measured from the scheduled time, so a slow
+   * server is charged for the queueing it causes. Otherwise every thread
+   * sends its next request as soon as the last one finishes.
+   */
+  void run(int threads, int count, int rate);
+
+  void report(std::ostream &out) const;
+  void save(const std::string &filename) const;
+
+  /**
+   * Prints every metric of two saved runs side by side.
+   */
+  static void Compare(std::ostream &out, const std::string &before,
+                      const std::string &after);
+
+  /**
+   * Thread body, public for AsyncFunc.
+   */
+  void worker();
+
+private:
+  struct Sample {
+    int64 latency; // in microseconds
+    int64 memory;  // peak bytes from the smart allocators
+    int code;
+  };
+
+  std::vector<std::string> m_requests;
+  std::vector<Sample> m_samples;
+  int m_total;
+  int m_next;
+  int m_rate;
+  int64 m_start;
+  int64 m_elapsed;
+  int m_threads;
+  std::map<std::string, int64> m_allocBefore;
+  std::map<std::string, int64> m_allocAfter;
+
+  void summarize(Hdf hdf) const;
+  static void GetAllocatorStats(std::map<std::string, int64> &stats);
+};
+
+///////////////////////////////////////////////////////////////////////////////
+}
+
+#endif // __HPHP_REPLAY_BENCHMARK_H__
@@ -16,6 +16,7 @@
 
 #include <runtime/base/server/server_stats.h>
 #include <runtime/base/server/http_server.h>
+#include <runtime/base/server/server_stats_shm.h>
 #include <runtime/base/runtime_option.h>
 #include <runtime/base/memory/memory_manager.h>
 #include <util/json.h>
@@ -773,6 +774,94 @@ void ServerStats::ReportStatus(std::string &output, Format format) {
   output = out.str();
 }
 
+static void safe_copy(char *dest, const char *src, int max) {
+  int len = strlen(src) + 1;
+  dest[--max] = '\0';
+  strncpy(dest, src, len > max ? max : len);
+}
+
+void ServerStats::Publish(ServerStatsShm &shm) {
+  ServerStatsShm::Header *h = shm.header();
+
+  // Gather everything first, so readers only ever wait for the copying.
+  list<TimeSlot*> slots;
+  CollectSlots(slots, -(int64)RuntimeOption::StatsSlotDuration * h->maxSlots,
+               0);
+  while ((int)slots.size() > h->maxSlots) {
+    delete slots.front(); // oldest
+    slots.pop_front();
+  }
+  vector<int64> hits;
+  vector<map<string, int64> > values;
+  for (list<TimeSlot*>::const_iterator iter = slots.begin();
+       iter != slots.end(); ++iter) {
+    TimeSlot *s = *iter;
+    hits.push_back(0);
+    values.resize(values.size() + 1);
+    map<string, int64> &sum = values.back();
+    for (PageStatsMap::const_iterator piter = s->m_pages.begin();
+         piter != s->m_pages.end(); ++piter) {
+      const PageStats &ps = piter->second;
+      hits.back() += ps.m_hit;
+      for (CounterMap::const_iterator viter =
+             ps.m_values.begin(); viter != ps.m_values.end(); ++viter) {
+        sum[viter->first->getString()] += viter->second;
+      }
+    }
+  }
+
+  vector<ThreadStatus> threads;
+  {
+    Lock lock(s_lock, false);
+    for (unsigned int i = 0; i < s_loggers.size() &&
+           (int)i < h->maxThreads; i++) {
+      threads.push_back(s_loggers[i]->m_threadStatus);
+    }
+  }
+
+  shm.beginUpdate();
+  h->start = HttpServer::StartTime;
+  h->slotDuration = RuntimeOption::StatsSlotDuration;
+
+  int index = 0;
+  for (list<TimeSlot*>::const_iterator iter = slots.begin();
+       iter != slots.end(); ++iter, ++index) {
+    ServerStatsShm::Slot *s = shm.slot(index);
+    s->time = (*iter)->m_time * RuntimeOption::StatsSlotDuration;
+    s->hits = hits[index];
+    memset(s->values, 0, sizeof(int64) * h->maxKeys);
+    const map<string, int64> &sum = values[index];
+    for (map<string, int64>::const_iterator viter = sum.begin();
+         viter != sum.end(); ++viter) {
+      int k = shm.findOrAddKey(viter->first);
+      if (k >= 0) {
+        s->values[k] = viter->second;
+      }
+    }
+  }
+  h->slotCount = index;
+
+  for (unsigned int i = 0; i < threads.size(); i++) {
+    const ThreadStatus &ts = threads[i];
+    ServerStatsShm::Thread *t = shm.thread(i);
+    t->threadId = (int64)ts.m_threadId;
+    t->requestCount = ts.m_requestCount;
+    t->writeBytes = ts.m_writeBytes;
+    t->start = ts.m_start;
+    t->done = ts.m_done;
+    t->mode = ts.m_mode;
+    t->iostart = ts.m_iostart;
+    safe_copy(t->iostatus, ts.m_iostatus, sizeof(t->iostatus));
+    safe_copy(t->url, ts.m_url, sizeof(t->url));
+    safe_copy(t->clientIP, ts.m_clientIP, sizeof(t->clientIP));
+    safe_copy(t->vhost, ts.m_vhost, sizeof(t->vhost));
+  }
+  h->threadCount = threads.size();
+  shm.endUpdate();
+
+  FreeSlots(slots);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 ServerStats::ThreadStatus::ThreadStatus()
@@ -881,12 +970,6 @@ void ServerStats::logBytes(int64 bytes) {
   m_threadStatus.m_writeBytes += bytes;
 }
 
-static void safe_copy(char *dest, const char *src, int max) {
-  int len = strlen(src) + 1;
-  dest[--max] = '\0';
-  strncpy(dest, src, len > max ? max : len);
-}
-
 void ServerStats::startRequest(const char *url, const char *clientIP,
                                const char *vhost) {
   ++m_threadStatus.m_requestCount;
@@ -24,6 +24,8 @@
 namespace HPHP {
 ///////////////////////////////////////////////////////////////////////////////
 
+class ServerStatsShm;
+
 class ServerStats {
 public:
   enum Format {
@@ -59,6 +61,12 @@ public:
   static void SetThreadIOStatus(const char *status);
   static void ReportStatus(std::string &out, Format format);
 
+  /**
+   * Copies recent time slots, summed over all pages, and every thread's
+   * status into a shared memory segment for out-of-process readers.
+   */
+  static void Publish(ServerStatsShm &shm);
+
 public:
   ServerStats();
   ~ServerStats();
@@ -0,0 +1,256 @@
+/*
+   +----------------------------------------------------------------------+
+   | HipHop for PHP                                                       |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2010 Facebook, Inc. (http://www.facebook.com)          |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 3.01 of the PHP license,      |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available through the world-wide-web at the following url:           |
+   | http://www.php.net/license/3_01.txt                                  |
+   | If you did not receive a copy of the PHP license and are unable to   |
+   | obtain it through the world-wide-web, please send a note to          |
+   | license@php.net so we can mail you a copy immediately.               |
+   +----------------------------------------------------------------------+
+*/
+
+#include <runtime/base/server/server_stats_shm.h>
+#include <util/logger.h>
+#include <util/util.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+namespace HPHP {
+///////////////////////////////////////////////////////////////////////////////
+// layout
+
+static size_t slot_size(const ServerStatsShm::Header &h) {
+  return sizeof(int64) * (2 + h.maxKeys);
+}
+
+size_t ServerStatsShm::KeyOffset(const Header &h, int index) {
+  return sizeof(Header) + sizeof(Key) * index;
+}
+
+size_t ServerStatsShm::SlotOffset(const Header &h, int index) {
+  return KeyOffset(h, h.maxKeys) + slot_size(h) * index;
+}
+
+size_t ServerStatsShm::ThreadOffset(const Header &h, int index) {
+  return SlotOffset(h, h.maxSlots) + sizeof(Thread) * index;
+}
+
+size_t ServerStatsShm::Size(const Header &h) {
+  return ThreadOffset(h, h.maxThreads);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+ServerStatsShm::ServerStatsShm() : m_base(NULL), m_size(0) {
+}
+
+ServerStatsShm::~ServerStatsShm() {
+  detach();
+}
+
+void ServerStatsShm::detach() {
+  if (m_base) {
+    munmap(m_base, m_size);
+    m_base = NULL;
+    m_size = 0;
+  }
+  m_keys.clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// writer
+
+bool ServerStatsShm::create(const string &path, int maxKeys, int maxSlots,
+                            int maxThreads) {
+  detach();
+
+  Header h;
+  memset(&h, 0, sizeof(h));
+  h.magic = Magic;
+  h.version = Version;
+  h.pid = getpid();
+  h.maxKeys = maxKeys;
+  h.maxSlots = maxSlots;
+  h.maxThreads = maxThreads;
+  size_t size = Size(h);
+
+  string tmp = path + ".tmp";
+  int fd = open(tmp.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    Logger::Error("Unable to create %s: %s", tmp.c_str(),
+                  Util::safe_strerror(errno).c_str());
+    return false;
+  }
+  if (ftruncate(fd, size) < 0) {
+    Logger::Error("Unable to resize %s: %s", tmp.c_str(),
+                  Util::safe_strerror(errno).c_str());
+    close(fd);
+    unlink(tmp.c_str());
+    return false;
+  }
+  void *base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED) {
+    Logger::Error("Unable to map %s: %s", tmp.c_str(),
+                  Util::safe_strerror(errno).c_str());
+    unlink(tmp.c_str());
+    return false;
+  }
+  m_base = (char*)base;
+  m_size = size;
+  memcpy(m_base, &h, sizeof(h));
+
+  if (rename(tmp.c_str(), path.c_str()) < 0) {
+    Logger::Error("Unable to rename %s to %s: %s", tmp.c_str(), path.c_str(),
+                  Util::safe_strerror(errno).c_str());
+    unlink(tmp.c_str());
+    detach();
+    return false;
+  }
+  return true;
+}
+
+void ServerStatsShm::beginUpdate() {
+  ASSERT((header()->seq & 1) == 0);
+  header()->seq++;
+  __sync_synchronize();
+}
+
+void ServerStatsShm::endUpdate() {
+  header()->updated = time(NULL);
+  __sync_synchronize();
+  header()->seq++;
+}
+
+int ServerStatsShm::findOrAddKey(const string &name) {
+  hphp_string_map<int>::const_iterator iter = m_keys.find(name);
+  if (iter != m_keys.end()) {
+    return iter->second;
+  }
+
+  Header *h = header();
+  if (h->keyCount >= h->maxKeys || name.size() >= KeyLength) {
+    // remembered, so a name is counted once and not on every publish
+    h->droppedKeys++;
+    m_keys[name] = -1;
+    return -1;
+  }
+  int index = h->keyCount++;
+  memcpy(key(index)->name, name.c_str(), name.size() + 1);
+  m_keys[name] = index;
+  return index;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// reader
+
+bool ServerStatsShm::attach(const string &path) {
+  detach();
+
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat sb;
+  if (fstat(fd, &sb) < 0 || (size_t)sb.st_size < sizeof(Header)) {
+    close(fd);
+    return false;
+  }
+  void *base = mmap(NULL, sb.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED) {
+    return false;
+  }
+  m_base = (char*)base;
+  m_size = sb.st_size;
+
+  const Header *h = (const Header*)m_base;
+  if (h->magic != Magic || h->version != Version || Size(*h) > m_size) {
+    detach();
+    return false;
+  }
+  return true;
+}
+
+int ServerStatsShm::snapshot(string &out, int maxRetries /* = 1000 */) const {
+  ASSERT(m_base);
+  const Header *h = (const Header*)m_base;
+  for (int i = 0; i < maxRetries; i++) {
+    int64 seq = h->seq;
+    if (seq & 1) {
+      sched_yield();
+      continue;
+    }
+    __sync_synchronize();
+    out.assign(m_base, m_size);
+    __sync_synchronize();
+    if (h->seq == seq) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+void ServerStatsShm::Report(ostream &out, const string &snapshot) {
+  const char *base = snapshot.data();
+  const Header *h = (const Header*)base;
+  if (snapshot.size() < sizeof(Header) || h->magic != Magic ||
+      h->version != Version || Size(*h) > snapshot.size()) {
+    out << "invalid stats segment\n";
+    return;
+  }
+
+  out << "pid: " << h->pid << "\n";
+  out << "start: " << h->start << "\n";
+  out << "updated: " << h->updated << "\n";
+  out << "slot.duration: " << h->slotDuration << "\n";
+  out << "keys.dropped: " << h->droppedKeys << "\n";
+
+  const Slot *latest = NULL;
+  for (int i = 0; i < h->slotCount; i++) {
+    const Slot *s = (const Slot*)(base + SlotOffset(*h, i));
+    if (latest == NULL || s->time > latest->time) {
+      latest = s;
+    }
+  }
+  if (latest) {
+    out << "slot.time: " << latest->time << "\n";
+    out << "hit: " << latest->hits << "\n";
+    for (int i = 0; i < h->keyCount; i++) {
+      const Key *k = (const Key*)(base + KeyOffset(*h, i));
+      out << k->name << ": " << latest->values[i] << "\n";
+    }
+  }
+
+  static const char *modes[] = { "idle", "process", "writing", "psp" };
+  for (int i = 0; i < h->threadCount; i++) {
+    const Thread *t = (const Thread*)(base + ThreadOffset(*h, i));
+    const char *mode = "(unknown)";
+    if (t->mode >= 0 && t->mode < (int64)(sizeof(modes) / sizeof(modes[0]))) {
+      mode = modes[t->mode];
+    }
+    out << "thread." << i << ": id=" << t->threadId
+        << " req=" << t->requestCount
+        << " bytes=" << t->writeBytes
+        << " start=" << t->start
+        << " mode=" << mode;
+    if (t->iostart) {
+      out << " iostatus=" << t->iostatus << " iostart=" << t->iostart;
+    }
+    out << " url=" << t->url
+        << " client=" << t->clientIP
+        << " vhost=" << t->vhost << "\n";
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+}
@@ -0,0 +1,167 @@
+/*
+   +----------------------------------------------------------------------+
+   | HipHop for PHP                                                       |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2010 Facebook, Inc. (http://www.facebook.com)          |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 3.01 of the PHP license,      |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available through the world-wide-web at the following url:           |
+   | http://www.php.net/license/3_01.txt                                  |
+   | If you did not receive a copy of the PHP license and are unable to   |
+   | obtain it through the world-wide-web, please send a note to          |
+   | license@php.net so we can mail you a copy immediately.               |
+   +----------------------------------------------------------------------+
+*/
+
+#ifndef __HPHP_SERVER_STATS_SHM_H__
+#define __HPHP_SERVER_STATS_SHM_H__
+
+#include <util/base.h>
+
+namespace HPHP {
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * A memory mapped file that ServerStats publishes itself into, so monitoring
+ * agents can read counters and thread status without going through the admin
+ * server. The layout only has fixed size fields:
+ *
+ *   Header
+ *   Key    [maxKeys]      counter names, in the order they were first seen
+ *   Slot   [maxSlots]     time, hits, then one int64 per key
+ *   Thread [maxThreads]   live status of each server thread
+ *
+ * Writes are guarded by a sequence lock: the writer makes Header::seq odd
+ * before an update and even again after it, and a reader copies the whole
+ * file and retries if seq was odd or changed during the copy. Readers never
+ * block the server and never write to the file, so it can be mapped
+ * read-only by any number of them.
+ */
+class ServerStatsShm {
+public:
+  enum {
+    Magic = 0x48505353, // "HPSS"
+    Version = 1,
+
+    KeyLength = 128,
+    UrlLength = 256,
+    IOStatusLength = 128,
+    ClientIPLength = 64,
+    VHostLength = 128,
+  };
+
+  struct Header {
+    int32 magic;
+    int32 version;
+    volatile int64 seq;
+    int64 pid;
+    int64 start;        // when server started
+    int64 updated;      // when this segment was last written
+    int64 slotDuration; // in seconds
+    int32 maxKeys;
+    int32 keyCount;
+    int32 maxSlots;
+    int32 slotCount;
+    int32 maxThreads;
+    int32 threadCount;
+    int32 droppedKeys;  // names not published because maxKeys was reached
+    int32 reserved;
+  };
+
+  struct Key {
+    char name[KeyLength];
+  };
+
+  struct Slot {
+    int64 time; // in seconds
+    int64 hits;
+    int64 values[1]; // actually maxKeys of them
+  };
+
+  struct Thread {
+    int64 threadId;
+    int64 requestCount;
+    int64 writeBytes;
+    int64 start;
+    int64 done;
+    int64 mode; // ServerStats::ThreadMode
+    int64 iostart;
+    char iostatus[IOStatusLength];
+    char url[UrlLength];
+    char clientIP[ClientIPLength];
+    char vhost[VHostLength];
+  };
+
+  /**
+   * Where each part starts, given the capacities in a header.
+   */
+  static size_t Size(const Header &h);
+  static size_t KeyOffset(const Header &h, int index);
+  static size_t SlotOffset(const Header &h, int index);
+  static size_t ThreadOffset(const Header &h, int index);
+
+public:
+  ServerStatsShm();
+  ~ServerStatsShm();
+
+  /**
+   * Writer side: creates a new file and maps it read-write. The file is
+   * written under a temporary name and renamed into place, so a reader that
+   * still has an old one mapped never sees it change size underneath.
+   */
+  bool create(const std::string &path, int maxKeys, int maxSlots,
+              int maxThreads);
+
+  /**
+   * Writer side: every change to the mapped data has to happen between
+   * these two calls.
+   */
+  void beginUpdate();
+  void endUpdate();
+
+  /**
+   * Writer side: returns the index of a counter name, adding it to the key
+   * table if it is new, or -1 if the table is full.
+   */
+  int findOrAddKey(const std::string &name);
+
+  Header *header() { return (Header*)m_base;}
+  Key *key(int index) { return (Key*)(m_base + KeyOffset(*header(), index));}
+  Slot *slot(int index) {
+    return (Slot*)(m_base + SlotOffset(*header(), index));
+  }
+  Thread *thread(int index) {
+    return (Thread*)(m_base + ThreadOffset(*header(), index));
+  }
+
+  /**
+   * Reader side: maps an existing file read-only.
+   */
+  bool attach(const std::string &path);
+
+  /**
+   * Reader side: copies a consistent image of the segment into "out".
+   * Returns how many times the copy had to be retried because the writer was
+   * updating it, or -1 if no consistent copy was made in maxRetries tries.
+   */
+  int snapshot(std::string &out, int maxRetries = 1000) const;
+
+  /**
+   * Prints a snapshot as "name: value" lines: the most recent slot's
+   * counters first, then one line per thread.
+   */
+  static void Report(std::ostream &out, const std::string &snapshot);
+
+private:
+  char *m_base;
+  size_t m_size;
+  hphp_string_map<int> m_keys; // -1 for a dropped name
+
+  void detach();
+};
+
+///////////////////////////////////////////////////////////////////////////////
+}
+
+#endif // __HPHP_SERVER_STATS_SHM_H__
@@ -35,8 +35,8 @@ namespace HPHP {
 Transport::Transport()
   : m_url(NULL), m_postData(NULL), m_postDataParsed(false),
     m_chunkedEncoding(false), m_headerSent(false),
-    m_responseCode(-1), m_responseSize(0), m_sendContentType(true),
-    m_compression(true), m_compressor(NULL),
+    m_responseCode(-1), m_responseSize(0), m_peakMemory(0),
+    m_sendContentType(true), m_compression(true), m_compressor(NULL),
     m_compressionDecision(NotDecidedYet), m_threadType(RequestThread) {
 }
 
@@ -650,6 +650,72 @@ void Transport::sendRaw(void *data, int size, int code /* = 200 */,
   }
 }
 
+void Transport::sendRaw(const std::vector<iovec> &chunks,
+                        int code /* = 200 */) {
+  if (chunks.size() <= 1) {
+    if (chunks.empty()) {
+      sendRaw((void*)"", 0, code);
+    } else {
+      sendRaw(chunks[0].iov_base, chunks[0].iov_len, code);
+    }
+    return;
+  }
+
+  int size = 0;
+  for (unsigned int i = 0; i < chunks.size(); i++) {
+    size += chunks[i].iov_len;
+  }
+
+  {
+    FiberWriteLock lock(this);
+    if (m_compressionDecision == NotDecidedYet) {
+      decideCompression();
+    }
+    bool compress = isCompressionEnabled() &&
+      m_compressionDecision != ShouldNotCompress &&
+      (size > 1000 || m_compressionDecision == HasToCompress);
+    if (!compress && !m_chunkedEncoding &&
+        !RuntimeOption::ForceChunkedEncoding) {
+      ServerStatsHelper ssh("send");
+      if (!m_headerSent) {
+        prepareHeaders(false);
+        m_headerSent = true;
+      }
+      m_responseSize += size;
+      if (m_responseCode < 0) {
+        m_responseCode = code;
+      }
+      ServerStats::SetThreadMode(ServerStats::Writing);
+      sendvImpl(chunks, m_responseCode);
+      ServerStats::SetThreadMode(ServerStats::Processing);
+
+      ServerStats::LogBytes(size);
+      if (RuntimeOption::EnableStats && RuntimeOption::EnableWebStats) {
+        ServerStats::Log("network.uncompressed", size);
+        ServerStats::Log("network.compressed", size);
+      }
+      return;
+    }
+  }
+
+  // Compressing makes a new copy anyway, and costs a lot more than joining
+  // the pieces first.
+  string joined;
+  joined.reserve(size);
+  for (unsigned int i = 0; i < chunks.size(); i++) {
+    joined.append((const char *)chunks[i].iov_base, chunks[i].iov_len);
+  }
+  sendRaw((void*)joined.data(), joined.size(), code);
+}
+
+void Transport::sendvImpl(const std::vector<iovec> &chunks, int code) {
+  string joined;
+  for (unsigned int i = 0; i < chunks.size(); i++) {
+    joined.append((const char *)chunks[i].iov_base, chunks[i].iov_len);
+  }
+  sendImpl(joined.data(), joined.size(), code, false);
+}
+
 void Transport::onSendEnd() {
   FiberWriteLock lock(this);
   if (m_compressor && m_chunkedEncoding) {
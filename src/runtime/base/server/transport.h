@@ -22,6 +22,7 @@
 #include <runtime/base/types.h>
 #include <runtime/base/complex_types.h>
 #include <runtime/base/fiber_safe.h>
+#include <sys/uio.h>
 
 namespace HPHP {
 ///////////////////////////////////////////////////////////////////////////////
@@ -175,6 +176,13 @@ public:
   virtual void sendImpl(const void *data, int size, int code,
                         bool chunked) = 0;
 
+  /**
+   * Send back a complete, non-chunked response made of several pieces. The
+   * default joins them and calls sendImpl(); override to hand the pieces to
+   * the network layer without joining them first.
+   */
+  virtual void sendvImpl(const std::vector<iovec> &chunks, int code);
+
   /**
    * Override to implement more send end logic.
    */
@@ -265,6 +273,7 @@ public:
   bool headersSent() { return m_headerSent;}
   virtual void sendRaw(void *data, int size, int code = 200,
                        bool compressed = false, bool chunked = false);
+  void sendRaw(const std::vector<iovec> &chunks, int code = 200);
   void sendString(const char *data, int code = 200, bool compressed = false,
                   bool chunked = false) {
     sendRaw((void*)data, strlen(data), code, compressed, chunked);
@@ -282,6 +291,13 @@ public:
   int getResponseSize() const { return m_responseSize; }
   int getResponseCode() const { return m_responseCode; }
 
+  /**
+   * Smart allocators' peak usage while handling the request, recorded before
+   * the request's memory stats are reset.
+   */
+  void setPeakMemory(int64 bytes) { m_peakMemory = bytes;}
+  int64 getPeakMemory() const { return m_peakMemory;}
+
   void setThreadType(ThreadType type) { m_threadType = type;}
   ThreadType getThreadType() const { return m_threadType;}
 
@@ -310,6 +326,7 @@ protected:
   HeaderMap m_responseHeaders;
   CookieMap m_responseCookies;
   int m_responseSize;
+  int64 m_peakMemory;
 
   std::string m_mimeType;
   bool m_sendContentType;
@@ -184,6 +184,12 @@ static void destroy_uploaded_files() {
 
 #define FILLUNIT (1024 * 5)
 
+/*
+ * File parts are parsed and written to disk in units of this size, so a large
+ * upload turns into few big write()s instead of many 5KB ones.
+ */
+#define FILE_WRITE_UNIT (1024 * 64)
+
 typedef struct {
   Transport *transport;
 
@@ -204,6 +210,7 @@ typedef struct {
   int throw_size;
   char *cursor;
   int read_post_bytes;
+  bool streamed; // post_data is pointing into transport's buffer
 } multipart_buffer;
 
 typedef std::list<std::pair<std::string, std::string> > header_list;
@@ -235,12 +242,12 @@ static int read_post(multipart_buffer *self, char *buf, int bytes_to_read) {
         self->post_data, self->post_size, extra, extra_byte_read);
       self->cursor = (char*)self->post_data + self->post_size;
     } else {
-      self->post_data =
-        (const char *)realloc((void *)self->post_data, extra_byte_read + 1);
-      memcpy((void *)self->post_data, extra, extra_byte_read);
-      ((char*)self->post_data)[extra_byte_read] = 0;
+      // read straight out of the transport's buffer, which stays valid
+      // until the next getMorePostData() call, by when it's all consumed
+      self->post_data = (const char *)extra;
       self->throw_size = self->post_size;
       self->cursor = (char*)self->post_data;
+      self->streamed = true;
     }
     self->post_size += extra_byte_read;
     if (bytes_to_read <= extra_byte_read) {
@@ -316,7 +323,7 @@ static multipart_buffer *multipart_buffer_new(Transport *transport,
 
   self->transport = transport;
   int minsize = boundary.length() + 6;
-  if (minsize < FILLUNIT) minsize = FILLUNIT;
+  if (minsize < FILE_WRITE_UNIT) minsize = FILE_WRITE_UNIT;
 
   self->buffer = (char *) calloc(1, minsize + 1);
   self->bufsize = minsize;
@@ -668,13 +675,22 @@ static int multipart_buffer_read(multipart_buffer *self, char *buf,
 */
 static char *multipart_buffer_read_body(multipart_buffer *self,
                                         unsigned int *len) {
-  char buf[FILLUNIT], *out=NULL;
-  int total_bytes=0, read_bytes=0;
+  char *out=NULL;
+  int total_bytes=0, read_bytes=0, capacity=0;
 
-  while((read_bytes = multipart_buffer_read(self, buf, sizeof(buf), NULL))) {
-    out = (char *)realloc(out, total_bytes + read_bytes + 1);
-    memcpy(out + total_bytes, buf, read_bytes);
+  do {
+    if (capacity - total_bytes < FILLUNIT) {
+      capacity = capacity ? capacity * 2 : FILLUNIT + 1;
+      out = (char *)realloc(out, capacity);
+    }
+    read_bytes = multipart_buffer_read(self, out + total_bytes,
+                                       capacity - total_bytes, NULL);
     total_bytes += read_bytes;
+  } while (read_bytes);
+
+  if (total_bytes == 0) {
+    free(out);
+    out = NULL;
   }
 
   if (out) out[total_bytes] = '\0';
@@ -701,6 +717,7 @@ void rfc1867PostHandler(Transport *transport,
   int fd=-1;
   void *event_extra_data = NULL;
   unsigned int llen = 0;
+  char *wbuff = NULL;
 
   /* Initialize the buffer */
   if (!(mbuff = multipart_buffer_new(transport,
@@ -729,8 +746,8 @@ void rfc1867PostHandler(Transport *transport,
     }
   }
 
+  wbuff = (char *)malloc(FILE_WRITE_UNIT);
   while (!multipart_buffer_eof(mbuff)) {
-    char buff[FILLUNIT];
     char *cd=NULL,*param=NULL,*filename=NULL, *tmp=NULL;
     size_t blen=0, wlen=0;
     off_t offset;
@@ -803,17 +820,19 @@ void rfc1867PostHandler(Transport *transport,
             continue;
           }
           new_val_len = newlength;
+          if (new_val_len > value_len) new_val_len = value_len;
+          value[new_val_len] = '\0';
         }
 
-        String val(value, new_val_len, CopyString);
-        safe_php_register_variable(param, val, post, 0);
-
         if (!strcasecmp(param, "MAX_FILE_SIZE")) {
           max_file_size = atol(value);
         }
 
+        // hand the malloc-ed buffer over instead of copying it
+        String val(value, new_val_len, AttachString);
+        safe_php_register_variable(param, val, post, 0);
+
         free(param);
-        free(value);
         continue;
       }
 
@@ -917,14 +936,15 @@ void rfc1867PostHandler(Transport *transport,
       offset = 0;
       end = 0;
       while (!cancel_upload &&
-             (blen = multipart_buffer_read(mbuff, buff, sizeof(buff), &end)))
+             (blen = multipart_buffer_read(mbuff, wbuff, FILE_WRITE_UNIT,
+                                           &end)))
       {
         if (php_rfc1867_callback != NULL) {
           multipart_event_file_data event_file_data;
 
           event_file_data.post_bytes_processed = mbuff->read_post_bytes;
           event_file_data.offset = offset;
-          event_file_data.data = buff;
+          event_file_data.data = wbuff;
           event_file_data.length = blen;
           event_file_data.newlength = &blen;
           if (php_rfc1867_callback(&s_rfc1867_data->rfc1867ApcData,
@@ -951,7 +971,7 @@ void rfc1867PostHandler(Transport *transport,
           cancel_upload = UPLOAD_ERROR_B;
         } else if (blen > 0) {
 
-          wlen = write(fd, buff, blen);
+          wlen = write(fd, wbuff, blen);
 
           if (wlen < blen) {
             Logger::Verbose("Only %d bytes were written, expected to "
@@ -1173,8 +1193,15 @@ void rfc1867PostHandler(Transport *transport,
     }
   }
 fileupload_done:
-  data = mbuff->post_data;
-  size = mbuff->post_size;
+  if (mbuff->streamed) {
+    // nothing left for the caller to hold on to or free
+    data = NULL;
+    size = 0;
+  } else {
+    data = mbuff->post_data;
+    size = mbuff->post_size;
+  }
+  if (wbuff) free(wbuff);
   if (php_rfc1867_callback != NULL) {
     multipart_event_end event_end;
 
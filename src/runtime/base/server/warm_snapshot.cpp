@@ -0,0 +1,279 @@
+/*
+   +----------------------------------------------------------------------+
+   | HipHop for PHP                                                       |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2010 Facebook, Inc. (http://www.facebook.com)          |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 3.01 of the PHP license,      |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available through the world-wide-web at the following url:           |
+   | http://www.php.net/license/3_01.txt                                  |
+   | If you did not receive a copy of the PHP license and are unable to   |
+   | obtain it through the world-wide-web, please send a note to          |
+   | license@php.net so we can mail you a copy immediately.               |
+   +----------------------------------------------------------------------+
+*/
+
+#include <runtime/base/server/warm_snapshot.h>
+#include <runtime/base/server/http_server.h>
+#include <runtime/base/server/http_request_handler.h>
+#include <runtime/base/server/replay_transport.h>
+#include <runtime/base/server/pagelet_server.h>
+#include <runtime/base/server/xbox_server.h>
+#include <runtime/base/util/curl_pool.h>
+#include <runtime/base/runtime_option.h>
+#include <util/light_process.h>
+#include <util/logger.h>
+#include <util/util.h>
+#include <dirent.h>
+#include <signal.h>
+#include <sys/prctl.h>
+#include <sys/wait.h>
+
+using namespace std;
+
+namespace HPHP {
+///////////////////////////////////////////////////////////////////////////////
+
+// in a child, inherited from the supervisor
+static pid_t s_supervisor = 0;
+static double s_forked = 0;
+static double s_restartRequested = 0;
+
+// in the supervisor
+static volatile sig_atomic_t s_restart = 0;
+static volatile sig_atomic_t s_stop = 0;
+static sigset_t s_mask;
+static set<pid_t> s_children;
+
+static double now() {
+  struct timeval tv;
+  gettimeofday(&tv, 0);
+  return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+static void on_restart(int sig) {
+  s_restart = 1;
+}
+
+static void on_stop(int sig) {
+  s_stop = sig;
+}
+
+static void on_child(int sig) {
+  // only here to wake sigsuspend() up
+}
+
+static void set_handler(int sig, void (*handler)(int)) {
+  struct sigaction sa;
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_handler = handler;
+  sigemptyset(&sa.sa_mask);
+  sigaction(sig, &sa, NULL);
+}
+
+static int count_threads() {
+  DIR *dir = opendir("/proc/self/task");
+  if (dir == NULL) return -1;
+  int count = 0;
+  struct dirent *ep;
+  while ((ep = readdir(dir))) {
+    if (ep->d_name[0] != '.') count++;
+  }
+  closedir(dir);
+  return count;
+}
+
+static void warm_up() {
+  for (int n = 0; n < RuntimeOption::WarmSnapshotRequests; n++) {
+    for (unsigned int i = 0;
+         i < RuntimeOption::WarmSnapshotDocuments.size(); i++) {
+      const string &url = RuntimeOption::WarmSnapshotDocuments[i];
+      Hdf hdf;
+      hdf["get"] = 1;
+      hdf["url"] = url;
+      hdf["remote_host"] = RuntimeOption::ServerIP;
+
+      ReplayTransport rt;
+      rt.replayInput(hdf);
+      HttpRequestHandler handler;
+      handler.handleRequest(&rt);
+      int code = rt.getResponseCode();
+      if (code != 200) {
+        Logger::Warning("warm snapshot: %s failed %d: %s", url.c_str(),
+                        code, rt.getResponse().data());
+      }
+    }
+  }
+}
+
+static pid_t fork_child() {
+  pid_t pid = fork();
+  if (pid == 0) {
+    set_handler(SIGHUP, SIG_DFL);
+    set_handler(SIGTERM, SIG_DFL);
+    set_handler(SIGINT, SIG_DFL);
+    set_handler(SIGCHLD, SIG_DFL);
+    sigprocmask(SIG_SETMASK, &s_mask, NULL);
+    // not to outlive the supervisor, even if it was SIGKILLed
+    prctl(PR_SET_PDEATHSIG, SIGTERM);
+    s_supervisor = getppid();
+    s_forked = now();
+    s_children.clear();
+  }
+  return pid;
+}
+
+static void stop_children(int sig) {
+  for (set<pid_t>::const_iterator iter = s_children.begin();
+       iter != s_children.end(); ++iter) {
+    kill(*iter, sig);
+  }
+  while (!s_children.empty()) {
+    int status;
+    pid_t pid = waitpid(-1, &status, 0);
+    if (pid > 0) {
+      s_children.erase(pid);
+    } else if (errno != EINTR) {
+      break;
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool WarmSnapshot::Run(int &exitCode) {
+  double start = now();
+  HttpServer::LoadProcess();
+  warm_up();
+
+  PageletServer::Stop();
+  XboxServer::Stop();
+  // or every child would write to the same pooled connections
+  CurlHandlePool::Reset();
+  int threads = count_threads();
+  if (threads > 1) {
+    Logger::Warning("warm snapshot: %d threads running, children will only "
+                    "have the one that forks them", threads);
+  }
+  Logger::Info("warm snapshot: warmed up in %.3fs", now() - start);
+
+  sigset_t mask;
+  sigemptyset(&mask);
+  sigaddset(&mask, SIGHUP);
+  sigaddset(&mask, SIGTERM);
+  sigaddset(&mask, SIGINT);
+  sigaddset(&mask, SIGCHLD);
+  sigprocmask(SIG_BLOCK, &mask, &s_mask);
+  set_handler(SIGHUP, on_restart);
+  set_handler(SIGTERM, on_stop);
+  set_handler(SIGINT, on_stop);
+  set_handler(SIGCHLD, on_child);
+
+  pid_t current = 0;     // the child that serves, or is about to
+  bool retiring = false; // current child was stopped to be replaced
+  double forked = 0;
+  while (true) {
+    if (s_stop) {
+      Logger::Info("warm snapshot: stopping %d children",
+                   (int)s_children.size());
+      stop_children(s_stop);
+      exitCode = 0;
+      return false;
+    }
+
+    if (s_restart) {
+      s_restart = 0;
+      s_restartRequested = now();
+      if (current && !retiring) {
+        if (RuntimeOption::TakeoverFilename.empty()) {
+          Logger::Info("warm snapshot: restarting, stopping child %d",
+                       (int)current);
+          kill(current, SIGTERM);
+          retiring = true;
+        } else {
+          Logger::Info("warm snapshot: restarting, child %d will be taken "
+                       "over", (int)current);
+          current = 0;
+        }
+      }
+    }
+
+    if (!current) {
+      pid_t pid = fork_child();
+      if (pid == 0) {
+        LightProcess::Initialize(RuntimeOption::LightProcessFilePrefix,
+                                 RuntimeOption::LightProcessCount,
+                                 RuntimeOption::LightProcessMaxCount);
+        PageletServer::Restart();
+        XboxServer::Restart();
+        return true;
+      }
+      if (pid < 0) {
+        Logger::Error("warm snapshot: unable to fork: %s",
+                      Util::safe_strerror(errno).c_str());
+        stop_children(SIGTERM);
+        exitCode = -1;
+        return false;
+      }
+      Logger::Info("warm snapshot: forked child %d", (int)pid);
+      s_children.insert(pid);
+      current = pid;
+      retiring = false;
+      forked = now();
+      s_restartRequested = 0;
+    }
+
+    int status;
+    pid_t pid;
+    while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+      s_children.erase(pid);
+      if (pid != current) {
+        Logger::Info("warm snapshot: replaced child %d exited", (int)pid);
+        continue;
+      }
+      current = 0;
+      if (retiring) {
+        continue;
+      }
+      if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+        Logger::Info("warm snapshot: child %d stopped", (int)pid);
+        stop_children(SIGTERM);
+        exitCode = 0;
+        return false;
+      }
+      Logger::Error("warm snapshot: child %d died with status %d, "
+                    "forking another one", (int)pid, status);
+      if (now() - forked < 1) {
+        sleep(1); // not to fork one crash after another
+      }
+    }
+
+    if (current && !s_stop && !s_restart) {
+      sigsuspend(&s_mask);
+    }
+  }
+}
+
+bool WarmSnapshot::IsChild() {
+  return s_supervisor != 0;
+}
+
+bool WarmSnapshot::RequestRestart() {
+  return s_supervisor && kill(s_supervisor, SIGHUP) == 0;
+}
+
+void WarmSnapshot::ServerStarted() {
+  if (!s_supervisor) return;
+  double t = now();
+  if (s_restartRequested) {
+    Logger::Info("warm snapshot: serving %.3fs after fork, %.3fs after "
+                 "restart was requested", t - s_forked,
+                 t - s_restartRequested);
+  } else {
+    Logger::Info("warm snapshot: serving %.3fs after fork", t - s_forked);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+}
@@ -0,0 +1,69 @@
+/*
+   +----------------------------------------------------------------------+
+   | HipHop for PHP                                                       |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2010 Facebook, Inc. (http://www.facebook.com)          |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 3.01 of the PHP license,      |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available through the world-wide-web at the following url:           |
+   | http://www.php.net/license/3_01.txt                                  |
+   | If you did not receive a copy of the PHP license and are unable to   |
+   | obtain it through the world-wide-web, please send a note to          |
+   | license@php.net so we can mail you a copy immediately.               |
+   +----------------------------------------------------------------------+
+*/
+
+#ifndef __HPHP_WARM_SNAPSHOT_H__
+#define __HPHP_WARM_SNAPSHOT_H__
+
+#include <util/base.h>
+
+namespace HPHP {
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Server.WarmSnapshot: the server process loads and warms up once, and then
+ * only supervises children it forks to serve. A child starts with the warm
+ * heap shared copy-on-write, APC, static content, class maps and static
+ * strings included, so it is serving in about the time it takes to start
+ * its threads and grab its ports.
+ *
+ * The supervisor stays single threaded for fork(): pagelet and xbox workers
+ * are stopped once warmup is done, and light processes are only started in
+ * children. Pooled curl connections are closed too, so children don't
+ * share their sockets. Whatever is per thread, like WarmupDocument and
+ * RequestInitFunction, still runs in every new worker thread.
+ *
+ * SIGHUP, or /warm-restart on a child's admin server, forks a replacement:
+ * with Server.TakeoverFilename set it takes the page server's socket over
+ * from the old child, otherwise the old child is stopped first. A child that
+ * crashes is replaced; one that exits cleanly, as after /stop, stops the
+ * supervisor too, and SIGTERM or SIGINT to the supervisor stops all of them.
+ */
+class WarmSnapshot {
+public:
+  /**
+   * Returns true in a child, which goes on to serve, and false with
+   * "exitCode" set when the supervisor is done.
+   */
+  static bool Run(int &exitCode);
+
+  /**
+   * Whether this process is a child, and if so, have the supervisor fork
+   * a replacement for it.
+   */
+  static bool IsChild();
+  static bool RequestRestart();
+
+  /**
+   * Called by a child's HttpServer once all servers started, to log how long
+   * that took after fork() and after the restart was requested.
+   */
+  static void ServerStarted();
+};
+
+///////////////////////////////////////////////////////////////////////////////
+}
+
+#endif // __HPHP_WARM_SNAPSHOT_H__
@@ -182,12 +182,16 @@ public:
 
 static JobQueueDispatcher<XboxTransport*, XboxWorker> *s_dispatcher;
 
-void XboxServer::Restart() {
+void XboxServer::Stop() {
   if (s_dispatcher) {
     s_dispatcher->stop();
     delete s_dispatcher;
     s_dispatcher = NULL;
   }
+}
+
+void XboxServer::Restart() {
+  Stop();
 
   s_xbox_server_info = XboxServerInfoPtr(new XboxServerInfo());
   s_xbox_server_info->reload();
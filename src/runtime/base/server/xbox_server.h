@@ -29,6 +29,11 @@ public:
    */
   static void Restart();
 
+  /**
+   * Stop its worker threads, if any are running.
+   */
+  static void Stop();
+
 public:
   /**
    * Send/PostMessage paradigm for local and remote RPC.
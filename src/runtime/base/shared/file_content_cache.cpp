@@ -0,0 +1,257 @@
+/*
+   +----------------------------------------------------------------------+
+   | HipHop for PHP                                                       |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2010 Facebook, Inc. (http://www.facebook.com)          |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 3.01 of the PHP license,      |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available through the world-wide-web at the following url:           |
+   | http://www.php.net/license/3_01.txt                                  |
+   | If you did not receive a copy of the PHP license and are unable to   |
+   | obtain it through the world-wide-web, please send a note to          |
+   | license@php.net so we can mail you a copy immediately.               |
+   +----------------------------------------------------------------------+
+*/
+
+#include <runtime/base/shared/file_content_cache.h>
+#include <runtime/base/shared/shared_variant.h>
+#include <runtime/base/complex_types.h>
+#include <runtime/base/file/file.h>
+#include <runtime/base/runtime_option.h>
+#include <runtime/base/server/server_stats.h>
+#include <runtime/base/server/static_content_cache.h>
+#include <runtime/base/util/alloc.h>
+#include <runtime/base/util/string_buffer.h>
+#include <util/atomic.h>
+#include <util/lock.h>
+#include <fcntl.h>
+#include <list>
+#include <sys/stat.h>
+
+using namespace std;
+
+namespace HPHP {
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * One file's contents, as a string SharedVariant so StringData can point
+ * into it and hold a reference. The contents are a copy on the heap, not a
+ * mapping of the file, so a file truncated or rewritten in place can neither
+ * crash a request nor change a String handed out earlier.
+ */
+class FileContent : public SharedVariant {
+public:
+  FileContent(char *data, size_t size) : m_data(data), m_size(size) {
+    m_type = KindOfString;
+  }
+
+  virtual ~FileContent() {
+    free(m_data);
+  }
+
+  static FileContent *Load(int fd, size_t size);
+
+  virtual void incRef() {
+    atomic_inc(m_ref);
+  }
+
+  virtual void decRef() {
+    ASSERT(m_ref);
+    if (atomic_dec(m_ref) == 0) {
+      delete this;
+    }
+  }
+
+  virtual Variant toLocal() { return NEW(StringData)(this);}
+  virtual int64 intData() const { ASSERT(false); return 0;}
+  virtual const char *stringData() const { return m_data;}
+  virtual size_t stringLength() const { return m_size;}
+  virtual bool serialize(StringBuffer &out) const {
+    out.append("s:");
+    out.append((int64)m_size);
+    out.append(":\"");
+    out.append(m_data, m_size);
+    out.append("\";");
+    return true;
+  }
+
+  virtual size_t arrSize() const { ASSERT(false); return 0;}
+  virtual int getIndex(CVarRef key) { ASSERT(false); return -1;}
+  virtual SharedVariant *get(CVarRef key) { ASSERT(false); return NULL;}
+  virtual bool exists(CVarRef key) { ASSERT(false); return false;}
+  virtual void loadElems(ArrayData *&elems, const SharedMap &sharedMap,
+                         bool keepRef = false) {
+    ASSERT(false);
+  }
+  virtual Variant getKey(ssize_t pos) const { ASSERT(false); return null;}
+  virtual SharedVariant *getValue(ssize_t pos) const {
+    ASSERT(false);
+    return NULL;
+  }
+
+protected:
+  virtual SharedVariant *getKeySV(ssize_t pos) const { return NULL;}
+
+private:
+  char *m_data;
+  size_t m_size;
+};
+
+FileContent *FileContent::Load(int fd, size_t size) {
+  char *data = (char*)Util::safe_malloc(size + 1);
+  size_t done = 0;
+  while (done < size) {
+    ssize_t n = pread(fd, data + done, size - done, done);
+    if (n <= 0) {
+      if (n < 0 && errno == EINTR) continue;
+      free(data); // shrunk while being read
+      return NULL;
+    }
+    done += n;
+  }
+  data[size] = '\0';
+  return new FileContent(data, size);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+struct FileContentEntry {
+  FileContent *content;
+  dev_t dev;
+  ino_t ino;
+  off_t size;
+  struct timespec mtime;
+  struct timespec ctime;
+  std::list<std::string>::iterator lru; // position in s_lru
+
+  bool matches(const struct stat &sb) const {
+    return dev == sb.st_dev && ino == sb.st_ino && size == sb.st_size &&
+      mtime.tv_sec == sb.st_mtim.tv_sec &&
+      mtime.tv_nsec == sb.st_mtim.tv_nsec &&
+      ctime.tv_sec == sb.st_ctim.tv_sec &&
+      ctime.tv_nsec == sb.st_ctim.tv_nsec;
+  }
+};
+typedef hphp_string_map<FileContentEntry> FileContentEntryMap;
+
+static Mutex s_mutex;
+static FileContentEntryMap s_entries;
+static std::list<std::string> s_lru; // most recently used first
+static int64 s_size;
+
+// has to be called with s_mutex held
+static void remove_entry(FileContentEntryMap::iterator iter) {
+  s_size -= iter->second.size;
+  s_lru.erase(iter->second.lru);
+  iter->second.content->decRef();
+  s_entries.erase(iter);
+}
+
+static bool lookup(const string &path, const struct stat &sb,
+                   String &content) {
+  Lock lock(s_mutex);
+  FileContentEntryMap::iterator iter = s_entries.find(path);
+  if (iter == s_entries.end()) {
+    return false;
+  }
+  FileContentEntry &entry = iter->second;
+  if (!entry.matches(sb)) {
+    remove_entry(iter);
+    return false;
+  }
+  s_lru.splice(s_lru.begin(), s_lru, entry.lru);
+  content = NEW(StringData)(entry.content);
+  return true;
+}
+
+bool FileContentCache::Read(CStrRef filename, String &content) {
+  if (!RuntimeOption::EnableFileContentCache || filename.empty() ||
+      filename.find("://") >= 0) {
+    return false; // php://, URLs and wrappers aren't local files
+  }
+  if (StaticContentCache::TheFileCache) {
+    return false; // File::Open() serves from the compiled file cache first
+  }
+  // the path File::Open() opens a plain file at
+  String path = File::TranslatePath(filename);
+  if (path.empty()) {
+    return false;
+  }
+  string spath(path.data(), path.size());
+
+  struct stat sb;
+  if (stat(spath.c_str(), &sb) < 0 || !S_ISREG(sb.st_mode) ||
+      sb.st_size == 0 ||
+      sb.st_size > RuntimeOption::FileContentCacheMaxFileSize) {
+    return false;
+  }
+
+  if (lookup(spath, sb, content)) {
+    ServerStats::Log("file_cache.hit", 1);
+    ServerStats::Log("file_cache.bytes", content.size());
+    return true;
+  }
+
+  int fd = open(spath.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  // what gets cached is what was opened, even if path changed since stat()
+  if (fstat(fd, &sb) < 0 || !S_ISREG(sb.st_mode) || sb.st_size == 0 ||
+      sb.st_size > RuntimeOption::FileContentCacheMaxFileSize) {
+    close(fd);
+    return false;
+  }
+  FileContent *fc = FileContent::Load(fd, sb.st_size);
+  close(fd);
+  if (fc == NULL) {
+    return false;
+  }
+  ServerStats::Log("file_cache.miss", 1);
+  ServerStats::Log("file_cache.bytes", sb.st_size);
+  content = NEW(StringData)(fc);
+
+  Lock lock(s_mutex);
+  FileContentEntryMap::iterator iter = s_entries.find(spath);
+  if (iter != s_entries.end()) {
+    remove_entry(iter); // another thread loaded it first
+  }
+  s_lru.push_front(spath);
+  FileContentEntry &entry = s_entries[spath];
+  entry.content = fc; // keeping the reference from new
+  entry.dev = sb.st_dev;
+  entry.ino = sb.st_ino;
+  entry.size = sb.st_size;
+  entry.mtime = sb.st_mtim;
+  entry.ctime = sb.st_ctim;
+  entry.lru = s_lru.begin();
+  s_size += sb.st_size;
+
+  int64 capacity = (int64)RuntimeOption::FileContentCacheSize << 20;
+  while (s_size > capacity && s_entries.size() > 1) {
+    ServerStats::Log("file_cache.evict", 1);
+    remove_entry(s_entries.find(s_lru.back()));
+  }
+  return true;
+}
+
+void FileContentCache::Clear() {
+  Lock lock(s_mutex);
+  while (!s_entries.empty()) {
+    remove_entry(s_entries.begin());
+  }
+}
+
+int FileContentCache::GetCount() {
+  Lock lock(s_mutex);
+  return s_entries.size();
+}
+
+int64 FileContentCache::GetSize() {
+  Lock lock(s_mutex);
+  return s_size;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+}
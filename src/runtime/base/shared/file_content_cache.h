@@ -0,0 +1,62 @@
+/*
+   +----------------------------------------------------------------------+
+   | HipHop for PHP                                                       |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2010 Facebook, Inc. (http://www.facebook.com)          |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 3.01 of the PHP license,      |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available through the world-wide-web at the following url:           |
+   | http://www.php.net/license/3_01.txt                                  |
+   | If you did not receive a copy of the PHP license and are unable to   |
+   | obtain it through the world-wide-web, please send a note to          |
+   | license@php.net so we can mail you a copy immediately.               |
+   +----------------------------------------------------------------------+
+*/
+
+#ifndef __HPHP_FILE_CONTENT_CACHE_H__
+#define __HPHP_FILE_CONTENT_CACHE_H__
+
+#include <runtime/base/types.h>
+
+namespace HPHP {
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Process-wide cache of local file contents for file_get_contents(), file()
+ * and readfile(), turned on by Server.EnableFileContentCache.
+ *
+ * A file is copied into memory the first time it is read. After that, every
+ * request gets a String that points into the same copy instead of its own.
+ * An entry is keyed by path and is only used while the file's device,
+ * inode, size, mtime and ctime still match a fresh stat(). So a file replaced
+ * by a rename, or rewritten in place, is picked up on its next read.
+ * Copies are reference counted, so Strings handed out earlier stay valid
+ * and unchanged after their entry is replaced or evicted.
+ */
+class FileContentCache {
+public:
+  /**
+   * Sets content to a local file's contents and returns true, or returns
+   * false if the cache is off or the file is not cacheable. The filename is
+   * translated the way File::Open() does it. The caller then falls back to
+   * reading the file normally.
+   */
+  static bool Read(CStrRef filename, String &content);
+
+  /**
+   * Drops all entries.
+   */
+  static void Clear();
+
+  /**
+   * Number of files and bytes cached.
+   */
+  static int GetCount();
+  static int64 GetSize();
+};
+
+///////////////////////////////////////////////////////////////////////////////
+}
+
+#endif // __HPHP_FILE_CONTENT_CACHE_H__
@@ -16,13 +16,14 @@
 
 #include <runtime/base/shared/shared_store.h>
 #include <runtime/base/complex_types.h>
-#include <runtime/base/shared/process_shared_variant.h>
 #include <runtime/base/shared/thread_shared_variant.h>
 #include <runtime/base/runtime_option.h>
 #include <runtime/base/builtin_functions.h>
 #include <runtime/base/memory/leak_detectable.h>
 #include <runtime/base/server/server_stats.h>
 #include <util/lfu_table.h>
+#include <util/shared_memory_table.h>
+#include <util/exception.h>
 #include <tbb/concurrent_hash_map.h>
 #include <queue>
 
@@ -34,6 +35,17 @@ namespace HPHP {
 
 size_t SharedStore::s_lockCount = 10000;
 
+static void add_snapshot_entry(std::vector<SharedStore::SnapshotEntry> &entries,
+                               const char *key, int len, SharedVariant *var,
+                               int64 expiry, int64 now) {
+  if (expiry && now >= expiry) return;
+  entries.resize(entries.size() + 1);
+  SharedStore::SnapshotEntry &entry = entries.back();
+  entry.key.assign(key, len);
+  entry.value = var;
+  entry.expiry = expiry;
+  var->incRef();
+}
 
 ///////////////////////////////////////////////////////////////////////////////
 // LockedSharedStore
@@ -61,154 +73,6 @@ protected:
 };
 
 
-///////////////////////////////////////////////////////////////////////////////
-// ProcessSharedStore
-
-class ProcessSharedStore : public LockedSharedStore {
-public:
-  ProcessSharedStore(int id) : LockedSharedStore(id) {
-    if (!s_initialized) {
-      Lock lock(s_mutex);
-      if (!s_initialized) {
-        SharedMemoryManager::Init(RuntimeOption::ApcSharedMemorySize *
-                                  1024 * 1024, true);
-        s_initialized = true;
-      }
-    }
-    std::string sid = boost::lexical_cast<std::string>(id);
-    std::string mapLockName = std::string("HPHP_MapLock") + sid;
-    std::string valLocksName = std::string("HPHP_VariantLocks") + sid;
-    std::string mapName = std::string("HPHP_APC") + sid;
-    m_mapLock = SharedMemoryManager::GetSegment()->
-      find_or_construct<boost::interprocess::interprocess_upgradable_mutex>
-      (mapLockName.c_str())();
-    m_locks = SharedMemoryManager::GetSegment()->
-      find_or_construct<ProcessSharedVariantLock>(valLocksName.c_str())
-      [s_lockCount]();
-    m_vars = SharedMemory<SharedMap>::OpenOrCreate(mapName.c_str());
-  }
-  virtual bool find(CStrRef key, StoreValue *&val, bool &expired) {
-    ASSERT(expired == false);
-    SharedMap::iterator iter =
-      m_vars->find(SharedMemoryString(key.data(), key.size()));
-    if (iter != m_vars->end()) {
-      val = &iter->second;
-      if (iter->second.expired()) {
-        expired = true;
-        return false;
-      }
-      return true;
-    } else {
-      return false;
-    }
-  }
-  virtual void set(CStrRef key, SharedVariant* v, int64 ttl) {
-    (*m_vars)[SharedMemoryString(key.data(), key.size())].set(putVar(v), ttl);
-  }
-  virtual SharedVariant* construct(CStrRef key, CVarRef v) {
-    ProcessSharedVariantLock* lock = getLock(key);
-    return SharedMemoryManager::GetSegment()->construct<ProcessSharedVariant>
-      (boost::interprocess::anonymous_instance)(v, lock);
-  }
-  virtual SharedVariant* construct(litstr str, int len, CStrRef v,
-                                   bool serialized) {
-    if (serialized) {
-      return construct(String(str, len, AttachLiteral), f_unserialize(v));
-    }
-    return construct(String(str, len, AttachLiteral), v);
-  }
-  virtual SharedVariant* construct(litstr str, int len, CVarRef v) {
-    return construct(String(str, len, AttachLiteral), v);
-  }
-  virtual void lockMap() {
-    m_mapLock->lock();
-  }
-  virtual void readLockMap() {
-    m_mapLock->lock_sharable();
-  }
-  virtual void unlockMap() {
-    m_mapLock->unlock();
-  }
-  virtual void readUnlockMap() {
-    m_mapLock->unlock_sharable();
-  }
-
-  virtual SharedVariant* putVar(SharedVariant* v) const {
-    return (SharedVariant*)((size_t)v - (size_t)this);
-  }
-
-  virtual SharedVariant* getVar(SharedVariant* v) const {
-    return (SharedVariant*)((size_t)v + (size_t)this);
-  }
-
-  virtual void clearImpl() {
-    for (SharedMap::const_iterator iter = m_vars->begin();
-         iter != m_vars->end(); ++iter) {
-      ASSERT(getVar(iter->second.var));
-      getVar(iter->second.var)->decRef();
-    }
-    m_vars->clear();
-  }
-
-  virtual bool eraseLockedImpl(CStrRef key, bool expired) {
-    SharedMap::const_iterator iter =
-      m_vars->find(SharedMemoryString(key.data(), key.size()));
-    if (iter != m_vars->end()) {
-      if (expired) {
-        if (!iter->second.expired()) {
-          return false;
-        }
-      }
-      getVar(iter->second.var)->decRef();
-      m_vars->erase(iter);
-      return true;
-    }
-    return false;
-  }
-
-  virtual int size() {
-    int ret = 0;
-    lockMap();
-    ret = m_vars->size();
-    unlockMap();
-    return ret;
-  }
-
-  virtual void count(int &reachable, int &expired, int &persistent) {
-    reachable = expired = persistent = 0;
-    int now = time(NULL);
-    lockMap();
-    for (SharedMap::const_iterator iter = m_vars->begin();
-         iter != m_vars->end(); ++iter) {
-      ASSERT(getVar(iter->second.var));
-      reachable += getVar(iter->second.var)->countReachable();
-
-      int64 expiration = iter->second.expiry;
-      if (expiration == 0) {
-        persistent++;
-      } else if (expiration <= now) {
-        expired++;
-      }
-    }
-    unlockMap();
-  }
-
-private:
-  typedef SharedMemoryMap<SharedMemoryString, StoreValue> SharedMap;
-  ProcessSharedVariantLock* getLock(CStrRef key) {
-    ssize_t hash = hash_string(key.data(), key.size());
-    return &m_locks[hash % s_lockCount];
-  }
-  SharedMap *m_vars;
-  boost::interprocess::interprocess_upgradable_mutex* m_mapLock;
-  ProcessSharedVariantLock *m_locks;
-  static Mutex s_mutex;
-  static bool s_initialized;
-};
-
-Mutex ProcessSharedStore::s_mutex;
-bool ProcessSharedStore::s_initialized = false;
-
 ///////////////////////////////////////////////////////////////////////////////
 // Constructor Parents
 
@@ -257,10 +121,185 @@ protected:
     return &m_locks[hash % SharedStore::s_lockCount];
   }
   Mutex* getLock(CStrRef key) {
-    return getLock(key.data(), key.size());
+    return &m_locks[key.hash() % SharedStore::s_lockCount];
   }
 };
 
+///////////////////////////////////////////////////////////////////////////////
+// ShmTableSharedStore
+
+/**
+ * Entries in a SharedMemoryTable that every process mapping the same file
+ * shares. Values are kept as bytes, so a get() copies one out and decodes it
+ * instead of sharing a SharedVariant.
+ */
+class ShmTableSharedStore : public SharedStore,
+                            private ThreadSharedVariantFactory {
+public:
+  ShmTableSharedStore(int id) : SharedStore(id) {
+    string path = RuntimeOption::ApcSharedMemoryFile + "." +
+      boost::lexical_cast<string>(id);
+    m_table = SharedMemoryTable::Open
+      (path, (int64)RuntimeOption::ApcSharedMemorySize * 1024 * 1024);
+    if (!m_table) {
+      throw Exception("Unable to open APC shared memory file %s",
+                      path.c_str());
+    }
+  }
+  ~ShmTableSharedStore() {
+    delete m_table;
+  }
+
+  virtual void clear() {
+    m_table->clear();
+  }
+  virtual int size() {
+    return m_table->getEntryCount();
+  }
+  virtual void count(int &reachable, int &expired, int &persistent) {
+    // no SharedVariant lives in the table, so none is reachable from it
+    reachable = expired = persistent = 0;
+    int64 now = time(NULL);
+    vector<SharedMemoryTable::Entry> entries;
+    m_table->dump(entries);
+    for (unsigned int i = 0; i < entries.size(); i++) {
+      int64 expiry = entries[i].expiry;
+      if (expiry == 0) {
+        persistent++;
+      } else if (expiry <= now) {
+        expired++;
+      }
+    }
+  }
+
+  virtual bool get(CStrRef key, Variant &value);
+  virtual bool store(CStrRef key, CVarRef val, int64 ttl,
+                     bool overwrite = true);
+  virtual int64 inc(CStrRef key, int64 step, bool &found);
+  virtual bool cas(CStrRef key, int64 old, int64 val);
+
+  virtual SharedVariant* construct(litstr str, int len, CStrRef v,
+                                   bool serialized) {
+    return create(str, len, v, serialized);
+  }
+  virtual SharedVariant* construct(litstr str, int len, CVarRef v) {
+    return create(str, len, v);
+  }
+  virtual void prime(const std::vector<KeyValuePair> &vars);
+  virtual void snapshot(std::vector<SnapshotEntry> &entries);
+
+protected:
+  virtual SharedVariant* construct(CStrRef key, CVarRef v) {
+    return create(key, v);
+  }
+  virtual bool eraseImpl(CStrRef key, bool expired) {
+    return m_table->erase(key.data(), key.size(), expired, time(NULL));
+  }
+
+private:
+  enum ValueType {
+    ValueNull,
+    ValueBoolean,
+    ValueInt64,
+    ValueDouble,
+    ValueString,
+    ValueSerialized
+  };
+  static int Encode(CVarRef v, string &bytes);
+  static Variant Decode(const string &bytes, int type);
+
+  SharedMemoryTable *m_table;
+};
+
+int ShmTableSharedStore::Encode(CVarRef v, string &bytes) {
+  switch (v.getType()) {
+  case KindOfNull:
+    bytes.clear();
+    return ValueNull;
+  case KindOfBoolean:
+    bytes.assign(1, v.toBoolean() ? 1 : 0);
+    return ValueBoolean;
+  case KindOfByte:
+  case KindOfInt16:
+  case KindOfInt32:
+  case KindOfInt64:
+    {
+      int64 n = v.toInt64();
+      bytes.assign((const char*)&n, sizeof(n));
+      return ValueInt64;
+    }
+  case KindOfDouble:
+    {
+      double d = v.toDouble();
+      bytes.assign((const char*)&d, sizeof(d));
+      return ValueDouble;
+    }
+  case LiteralString:
+  case KindOfStaticString:
+  case KindOfString:
+    {
+      String s = v.toString();
+      bytes.assign(s.data(), s.size());
+      return ValueString;
+    }
+  default:
+    {
+      String s = f_serialize(v);
+      bytes.assign(s.data(), s.size());
+      return ValueSerialized;
+    }
+  }
+}
+
+Variant ShmTableSharedStore::Decode(const string &bytes, int type) {
+  switch (type) {
+  case ValueBoolean:
+    return bytes.size() == 1 && bytes[0];
+  case ValueInt64:
+    {
+      int64 n = 0;
+      if (bytes.size() == sizeof(n)) memcpy(&n, bytes.data(), sizeof(n));
+      return n;
+    }
+  case ValueDouble:
+    {
+      double d = 0;
+      if (bytes.size() == sizeof(d)) memcpy(&d, bytes.data(), sizeof(d));
+      return d;
+    }
+  case ValueString:
+    return String(bytes.data(), bytes.size(), CopyString);
+  case ValueSerialized:
+    return f_unserialize(String(bytes.data(), bytes.size(), AttachLiteral));
+  default:
+    return null;
+  }
+}
+
+void ShmTableSharedStore::snapshot(std::vector<SnapshotEntry> &entries) {
+  int64 now = time(NULL);
+  vector<SharedMemoryTable::Entry> dumped;
+  m_table->dump(dumped);
+  entries.reserve(entries.size() + dumped.size());
+  for (unsigned int i = 0; i < dumped.size(); i++) {
+    const SharedMemoryTable::Entry &entry = dumped[i];
+    if (entry.expiry && now >= entry.expiry) continue;
+    entries.resize(entries.size() + 1);
+    SnapshotEntry &out = entries.back();
+    out.key = entry.key;
+    if (entry.type == ValueSerialized) {
+      // kept serialized, so nothing is unserialized outside a request
+      out.value = create(entry.key.data(), entry.key.size(),
+                         String(entry.value.data(), entry.value.size(),
+                                AttachLiteral), true);
+    } else {
+      out.value = create(entry.key.data(), entry.key.size(),
+                         Decode(entry.value, entry.type));
+    }
+    out.expiry = entry.expiry;
+  }
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // Maps
 
@@ -350,6 +389,17 @@ public:
     }
     unlockMap();
   }
+  virtual void snapshot(std::vector<SnapshotEntry> &entries) {
+    int64 now = time(NULL);
+    readLockMap();
+    entries.reserve(entries.size() + m_vars.size());
+    for (StringMap::const_iterator iter = m_vars.begin();
+         iter != m_vars.end(); ++iter) {
+      add_snapshot_entry(entries, iter->first->data(), iter->first->size(),
+                         iter->second.var, iter->second.expiry, now);
+    }
+    readUnlockMap();
+  }
   virtual void lockMap() {
     m_mlock.acquireWrite();
   }
@@ -377,7 +427,7 @@ protected:
   struct StringHash {
     size_t operator()(StringData *s) const {
       ASSERT(s);
-      return hash_string(s->data(), s->size());
+      return s->hash();
     }
   };
 
@@ -519,6 +569,22 @@ public:
     CountBody body(reachable, expired, persistent);
     m_vars.atomicForeach(body);
   }
+  virtual void snapshot(std::vector<SnapshotEntry> &entries) {
+    class SnapshotBody : public Map::AtomicReader {
+    public:
+      SnapshotBody(std::vector<SnapshotEntry> &e)
+        : now(time(NULL)), entries(e) {}
+      void read(StringData* const &k, const StoreValue &val) {
+        add_snapshot_entry(entries, k->data(), k->size(), val.var,
+                           val.expiry, now);
+      }
+    private:
+      int64 now;
+      std::vector<SnapshotEntry> &entries;
+    };
+    SnapshotBody body(entries);
+    m_vars.atomicForeach(body);
+  }
 
   virtual bool get(CStrRef key, Variant &value);
   virtual bool store(CStrRef key, CVarRef val, int64 ttl,
@@ -544,7 +610,7 @@ private:
   struct StringHash {
     size_t operator()(StringData *s) const {
       ASSERT(s);
-      return hash_string(s->data(), s->size());
+      return s->hash();
     }
   };
 
@@ -608,6 +674,16 @@ public:
       }
     }
   }
+  virtual void snapshot(std::vector<SnapshotEntry> &entries) {
+    int64 now = time(NULL);
+    WriteLock l(m_lock);
+    entries.reserve(entries.size() + m_vars.size());
+    for (Map::const_iterator iter = m_vars.begin();
+         iter != m_vars.end(); ++iter) {
+      add_snapshot_entry(entries, iter->first->data(), iter->first->size(),
+                         iter->second.var, iter->second.expiry, now);
+    }
+  }
   virtual bool get(CStrRef key, Variant &value);
   virtual bool store(CStrRef key, CVarRef val, int64 ttl,
                      bool overwrite = true);
@@ -859,6 +935,20 @@ bool LfuTableSharedStore::get(CStrRef key, Variant &value) {
   return true;
 }
 
+bool ShmTableSharedStore::get(CStrRef key, Variant &value) {
+  bool stats = RuntimeOption::EnableStats && RuntimeOption::EnableAPCStats;
+  string bytes;
+  int type;
+  if (!m_table->get(key.data(), key.size(), bytes, type, time(NULL))) {
+    value = false;
+    if (stats) ServerStats::Log("apc.miss", 1);
+    return false;
+  }
+  value = Decode(bytes, type);
+  if (stats) ServerStats::Log("apc.hit", 1);
+  return true;
+}
+
 bool LockedSharedStore::store(CStrRef key, CVarRef val, int64 ttl,
                               bool overwrite /* = true */) {
   bool stats = RuntimeOption::EnableStats && RuntimeOption::EnableAPCStats;
@@ -995,6 +1085,30 @@ bool LfuTableSharedStore::store(CStrRef key, CVarRef val, int64 ttl,
   return updater.added;
 }
 
+bool ShmTableSharedStore::store(CStrRef key, CVarRef val, int64 ttl,
+                                bool overwrite /* = true */) {
+  string bytes;
+  int type = Encode(val, bytes);
+  int64 expiry = ttl ? time(NULL) + ttl : 0;
+  bool replaced = false;
+  bool added = m_table->store(key.data(), key.size(), bytes.data(),
+                              bytes.size(), type, expiry, overwrite,
+                              time(NULL), &replaced);
+  if (added && RuntimeOption::EnableStats && RuntimeOption::EnableAPCStats) {
+    if (replaced) {
+      ServerStats::Log("apc.update", 1);
+    } else {
+      ServerStats::Log("apc.new", 1);
+      if (RuntimeOption::EnableAPCKeyStats) {
+        string prefix = "apc.new.";
+        prefix += GetSkeleton(key);
+        ServerStats::Log(prefix, 1);
+      }
+    }
+  }
+  return added;
+}
+
 void LockedSharedStore::prime(const std::vector<KeyValuePair> &vars) {
   lockMap();
   // we are priming, so we are not checking existence or expiration
@@ -1031,6 +1145,21 @@ void LfuTableSharedStore::prime
   }
 }
 
+void ShmTableSharedStore::prime
+(const std::vector<SharedStore::KeyValuePair> &vars) {
+  // a table that outlived the last process may hold newer values than the
+  // prime file, so only keys that aren't there are stored
+  int64 now = time(NULL);
+  string bytes;
+  for (unsigned int i = 0; i < vars.size(); i++) {
+    const SharedStore::KeyValuePair &item = vars[i];
+    int type = Encode(item.value->toLocal(), bytes);
+    m_table->store(item.key, item.len, bytes.data(), bytes.size(), type, 0,
+                   false, now);
+    item.value->decRef();
+  }
+}
+
 bool SharedStore::erase(CStrRef key, bool expired /* = false */) {
   bool success = eraseImpl(key, expired);
 
@@ -1141,6 +1270,32 @@ int64 LfuTableSharedStore::inc(CStrRef key, int64 step, bool &found) {
   return updater.ret;
 }
 
+int64 ShmTableSharedStore::inc(CStrRef key, int64 step, bool &found) {
+  class IncUpdater : public SharedMemoryTable::Updater {
+  public:
+    IncUpdater(int64 s) : ret(0), step(s) {}
+    bool update(string &bytes, int &type) {
+      // unserializing could run user code with the bucket owned, and an
+      // array or object is not a number to add to anyway, as in APC
+      if (type == ValueSerialized) return false;
+      ret = Decode(bytes, type).toInt64() + step;
+      type = Encode(ret, bytes);
+      return true;
+    }
+    int64 ret;
+  private:
+    int64 step;
+  };
+
+  IncUpdater updater(step);
+  found = m_table->update(key.data(), key.size(), updater, time(NULL));
+
+  if (RuntimeOption::EnableStats && RuntimeOption::EnableAPCStats) {
+    ServerStats::Log("apc.inc", 1);
+  }
+  return found ? updater.ret : 0;
+}
+
 bool LockedSharedStore::cas(CStrRef key, int64 old, int64 val) {
   bool success = false;
   lockMap();
@@ -1229,6 +1384,31 @@ bool LfuTableSharedStore::cas(CStrRef key, int64 old, int64 val) {
   return updater.success;
 }
 
+bool ShmTableSharedStore::cas(CStrRef key, int64 old, int64 val) {
+  class CasUpdater : public SharedMemoryTable::Updater {
+  public:
+    CasUpdater(int64 o, int64 v) : old(o), val(v) {}
+    bool update(string &bytes, int &type) {
+      // see inc()
+      if (type == ValueSerialized) return false;
+      if (Decode(bytes, type).toInt64() != old) return false;
+      type = Encode(val, bytes);
+      return true;
+    }
+  private:
+    int64 old;
+    int64 val;
+  };
+
+  CasUpdater updater(old, val);
+  bool success = m_table->update(key.data(), key.size(), updater, time(NULL));
+
+  if (RuntimeOption::EnableStats && RuntimeOption::EnableAPCStats) {
+    ServerStats::Log("apc.cas", 1);
+  }
+  return success;
+}
+
 static std::string appendElement(int indent, const char *name, int value) {
   string ret;
   for (int i = 0; i < indent; i++) {
@@ -1280,7 +1460,7 @@ SharedStores::SharedStores() {
 void SharedStores::create() {
   for (int i = 0; i < MAX_SHARED_STORE; i++) {
     if (RuntimeOption::ApcUseSharedMemory) {
-      m_stores[i] = new ProcessSharedStore(i);
+      m_stores[i] = new ShmTableSharedStore(i);
     } else {
       switch (RuntimeOption::ApcTableType) {
       case RuntimeOption::ApcHashTable:
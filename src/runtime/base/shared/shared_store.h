@@ -66,6 +66,15 @@ public:
   };
   virtual void prime(const std::vector<KeyValuePair> &vars) = 0;
 
+  // for snapshots: every unexpired entry, each value with a reference held
+  // that the caller has to release
+  struct SnapshotEntry {
+    std::string key;
+    SharedVariant *value;
+    int64 expiry;
+  };
+  virtual void snapshot(std::vector<SnapshotEntry> &entries) = 0;
+
   virtual std::string reportStats(int &reachable, int indent);
   virtual bool check() { return true; }
   static size_t s_lockCount;
@@ -27,6 +27,7 @@ namespace HPHP {
 ///////////////////////////////////////////////////////////////////////////////
 
 class SharedMap;
+class StringBuffer;
 
 class SharedVariant
 #ifdef DEBUG_APC_LEAK
@@ -69,6 +70,13 @@ public:
 
   int countReachable();
 
+  /**
+   * Appends the value in serialize() format from what is stored, without
+   * making a request-local copy of it, so no __sleep() or autoloading runs.
+   * Returns false if that can't be done exactly.
+   */
+  virtual bool serialize(StringBuffer &out) const = 0;
+
   // whether it is an object, or an array that recursively contains an object
   // or an array with circular reference
   bool shouldCache() { return m_shouldCache; }
@@ -18,6 +18,7 @@
 #include <runtime/ext/ext_variable.h>
 #include <runtime/base/shared/shared_map.h>
 #include <runtime/base/runtime_option.h>
+#include <runtime/base/util/string_buffer.h>
 
 using namespace std;
 
@@ -189,6 +190,85 @@ void ThreadSharedVariant::dump(std::string &out) {
   out += "\n";
 }
 
+static void serialize_string(StringBuffer &out, const StringData *s) {
+  out.append("s:");
+  out.append(s->size());
+  out.append(":\"");
+  out.append(s->data(), s->size());
+  out.append("\";");
+}
+
+// r:n; and R:n; count values from the start of the whole serialization, so
+// an object serialized on its own can't be embedded if it has them. This
+// errs on the side of finding one in a string property.
+static bool has_back_reference(const StringData *s) {
+  const char *p = s->data();
+  for (int i = 1; i + 1 < s->size(); i++) {
+    if ((p[i] == 'r' || p[i] == 'R') && p[i + 1] == ':' &&
+        (p[i - 1] == ';' || p[i - 1] == '{' || p[i - 1] == '}')) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool ThreadSharedVariant::serialize(StringBuffer &out) const {
+  return serialize(out, false);
+}
+
+bool ThreadSharedVariant::serialize(StringBuffer &out, bool inner) const {
+  switch (m_type) {
+  case KindOfBoolean:
+    out.append(m_data.num ? "b:1;" : "b:0;");
+    return true;
+  case KindOfInt64:
+    out.append("i:");
+    out.append(m_data.num);
+    out.append(';');
+    return true;
+  case KindOfDouble:
+    out.append(f_serialize(m_data.dbl));
+    return true;
+  case KindOfString:
+    serialize_string(out, m_data.str);
+    return true;
+  case KindOfArray:
+    {
+      if (m_serializedArray) {
+        out.append(m_data.str->data(), m_data.str->size());
+        return true;
+      }
+      size_t size = arrSize();
+      out.append("a:");
+      out.append((int64)size);
+      out.append(":{");
+      for (size_t i = 0; i < size; i++) {
+        if (m_isVector) {
+          out.append("i:");
+          out.append((int64)i);
+          out.append(';');
+        } else if (!m_data.map->getKeyIndex(i)->serialize(out, true)) {
+          return false;
+        }
+        ThreadSharedVariant *value = m_isVector ? m_data.vec->vals[i] :
+          m_data.map->getValIndex(i);
+        if (!value->serialize(out, true)) {
+          return false;
+        }
+      }
+      out.append('}');
+      return true;
+    }
+  default:
+    ASSERT(m_type == KindOfObject); // null too, as "N;"
+    if (inner && has_back_reference(m_data.str)) {
+      return false;
+    }
+    out.append(m_data.str->data(), m_data.str->size());
+    return true;
+  }
+}
+
 ThreadSharedVariant::~ThreadSharedVariant() {
   switch (m_type) {
   case KindOfString:
@@ -86,12 +86,16 @@ public:
   // implementing LeakDetectable
   virtual void dump(std::string &out);
 
+  virtual bool serialize(StringBuffer &out) const;
+
   StringData *getStringData() const {
     ASSERT(is(KindOfString));
     return m_data.str;
   }
 
 protected:
+  bool serialize(StringBuffer &out, bool inner) const;
+
   virtual ThreadSharedVariant *createAnother(CVarRef source, bool serialized,
                                              bool inner = false);
 
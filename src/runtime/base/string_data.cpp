@@ -179,6 +179,7 @@ void StringData::append(const char *s, int len) {
     memcpy((void*)(m_data + dataLen), s, len);
     ((char*)m_data)[m_len] = '\0';
   }
+  m_hash = 0;
 }
 
 StringData *StringData::copy(bool sharedMemory /* = false */) const {
@@ -210,6 +211,7 @@ void StringData::escalate() {
   buf[len] = '\0';
   m_len = len;
   m_data = buf;
+  m_hash = 0;
 }
 
 void StringData::dump() {
@@ -279,6 +281,7 @@ void StringData::setChar(int offset, char ch) {
     escalate();
   }
   ((char*)m_data)[offset] = ch;
+  m_hash = 0;
 }
 
 void StringData::removeChar(int offset) {
@@ -300,12 +303,14 @@ void StringData::removeChar(int offset) {
     m_len = ((m_len & IsMask) | (len - 1));
     memmove((void*)(m_data + offset), m_data + offset + 1, len - offset);
   }
+  m_hash = 0;
 }
 
 void StringData::inc() {
   if (empty()) {
     m_len = (IsLiteral | 1);
     m_data = "1";
+    m_hash = 0;
     return;
   }
   if (isImmutable()) {
@@ -315,6 +320,7 @@ void StringData::inc() {
   if (overflowed) {
     assign(overflowed, AttachString);
   }
+  m_hash = 0;
 }
 
 void StringData::negate() {
@@ -325,6 +331,7 @@ void StringData::negate() {
   for (int i = 0; i < len; i++) {
     buf[i] = ~(buf[i]);
   }
+  m_hash = 0;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
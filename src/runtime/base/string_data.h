@@ -80,6 +80,18 @@ class StringData {
     return m_hash & 0x7fffffffffffffffull;
   }
 
+  /**
+   * Same as hash_string(data(), size()). Static strings have it precomputed,
+   * other strings compute it on first use and keep it until they are
+   * mutated. Shared memory strings have no room to keep it.
+   */
+  int64 hash() const {
+    if (isStatic()) return getStaticHash();
+    if (isShared()) return hash_string(data(), size());
+    if (!m_hash) m_hash = hash_string(data(), size());
+    return m_hash;
+  }
+
   StringData() : m_data(NULL), _count(0), m_len(0), m_shared(NULL) {
     #ifdef TAINTED
     m_tainted = false;
@@ -189,7 +201,7 @@ class StringData {
   mutable unsigned int m_len;
   union {
     SharedVariant *m_shared;
-    mutable int64  m_hash;   // precompute hash codes for static strings
+    mutable int64  m_hash;   // cached hash code, 0 when not computed yet
   };
   #ifdef TAINTED
   bool m_tainted;
@@ -24,13 +24,7 @@ namespace HPHP {
 IMPLEMENT_THREAD_LOCAL(ThreadInfo, ThreadInfo::s_threadInfo);
 
 ThreadInfo::ThreadInfo() {
-  map<int, ObjectAllocatorWrapper *> &wrappers =
-    ObjectAllocatorCollector::getWrappers();
-  m_allocators.resize(wrappers.rbegin()->first + 1);
-  for (map<int, ObjectAllocatorWrapper *>::iterator it = wrappers.begin();
-       it != wrappers.end(); it++) {
-    m_allocators[it->first] = it->second->get();
-  }
+  ObjectAllocatorCollector::CreateAllocators(m_allocators);
 
   m_profiler = NULL;
 
@@ -43,6 +37,10 @@ ThreadInfo::ThreadInfo() {
   reset();
 }
 
+ThreadInfo::~ThreadInfo() {
+  ObjectAllocatorCollector::DeleteAllocators(m_allocators);
+}
+
 void ThreadInfo::reset() {
   char marker;
 
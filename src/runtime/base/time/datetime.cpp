@@ -19,6 +19,7 @@
 #include <runtime/base/util/string_buffer.h>
 #include <runtime/base/runtime_error.h>
 #include <runtime/base/builtin_functions.h>
+#include <util/thread_local.h>
 
 namespace HPHP {
 
@@ -216,6 +217,50 @@ Array DateTime::Parse(CStrRef ts, CStrRef format) {
 ///////////////////////////////////////////////////////////////////////////////
 // constructors
 
+/**
+ * The last timestamp each thread converted to local time. Pages call date()
+ * over and over with the current second, and copying the broken-down time
+ * is cheaper than another transition lookup and date calculation.
+ */
+class LocalTimeMemo {
+public:
+  LocalTimeMemo() : m_timestamp(0), m_valid(false) {}
+  ~LocalTimeMemo() { clear();}
+
+  bool get(int64 timestamp, const TimeZoneInfo &tzi, timelib_time *t) {
+    if (!m_valid || m_timestamp != timestamp || m_tzi != tzi) {
+      return false;
+    }
+    *t = m_time;
+    t->tz_abbr = m_time.tz_abbr ? strdup(m_time.tz_abbr) : NULL;
+    return true;
+  }
+
+  void set(int64 timestamp, const TimeZoneInfo &tzi, const timelib_time *t) {
+    clear();
+    m_time = *t;
+    m_time.tz_abbr = t->tz_abbr ? strdup(t->tz_abbr) : NULL;
+    m_timestamp = timestamp;
+    m_tzi = tzi; // keeps m_time.tz_info alive
+    m_valid = true;
+  }
+
+private:
+  timelib_time m_time;
+  int64 m_timestamp;
+  TimeZoneInfo m_tzi;
+  bool m_valid;
+
+  void clear() {
+    if (m_valid) {
+      free(m_time.tz_abbr);
+      m_tzi.reset();
+      m_valid = false;
+    }
+  }
+};
+static IMPLEMENT_THREAD_LOCAL(LocalTimeMemo, s_local_time_memo);
+
 DateTime::DateTime() : m_timestamp(-1), m_timestampSet(false) {
   m_time = TimePtr(timelib_time_ctor(), time_deleter());
   setTimezone(TimeZone::Current());
@@ -234,9 +279,13 @@ void DateTime::fromTimeStamp(int64 timestamp, bool utc /* = false */) {
     timelib_unixtime2gmt(t, (timelib_sll)m_timestamp);
   } else {
     m_tz = TimeZone::Current();
-    t->tz_info = m_tz->get();
-    t->zone_type = TIMELIB_ZONETYPE_ID;
-    timelib_unixtime2local(t, (timelib_sll)m_timestamp);
+    LocalTimeMemo &memo = *s_local_time_memo.get();
+    if (!memo.get(m_timestamp, m_tz->m_tzi, t)) {
+      t->tz_info = m_tz->get();
+      t->zone_type = TIMELIB_ZONETYPE_ID;
+      timelib_unixtime2local(t, (timelib_sll)m_timestamp);
+      memo.set(m_timestamp, m_tz->m_tzi, t);
+    }
   }
   m_time = TimePtr(t, time_deleter());
 }
@@ -489,13 +538,34 @@ String DateTime::toString(DateFormat format) const {
   return String();
 }
 
+// same as s.printf("%0*d", width, n), without going through vsnprintf for
+// every field of every date() call
+static void append_padded(StringBuffer &s, int64 n, int width) {
+  if (n < 0) {
+    s.printf("%0*lld", width, n);
+    return;
+  }
+  char buf[24];
+  char *end = buf + sizeof(buf);
+  char *p = end;
+  do {
+    *--p = '0' + n % 10;
+    n /= 10;
+    width--;
+  } while (n);
+  while (width-- > 0) {
+    *--p = '0';
+  }
+  s.append(p, end - p);
+}
+
 String DateTime::rfcFormat(CStrRef format) const {
   StringBuffer s;
   bool rfc_colon = false;
   bool error;
   for (int i = 0; i < format.size(); i++) {
     switch (format.charAt(i)) {
-    case 'd': s.printf("%02d", day()); break;
+    case 'd': append_padded(s, day(), 2); break;
     case 'D': s.append(shortWeekdayName()); break;
     case 'j': s.append(day()); break;
     case 'l': s.append(weekdayName()); break;
@@ -503,27 +573,30 @@ String DateTime::rfcFormat(CStrRef format) const {
     case 'w': s.append(dow()); break;
     case 'N': s.append(isoDow()); break;
     case 'z': s.append(doy()); break;
-    case 'W': s.printf("%02d", isoWeek()); break;
+    case 'W': append_padded(s, isoWeek(), 2); break;
     case 'o': s.append(isoYear()); break;
     case 'F': s.append(monthName()); break;
-    case 'm': s.printf("%02d", month()); break;
+    case 'm': append_padded(s, month(), 2); break;
     case 'M': s.append(shortMonthName()); break;
     case 'n': s.append(month()); break;
     case 't': s.append(DaysInMonth(year(), month())); break;
     case 'L': s.append(IsLeap(year())); break;
-    case 'y': s.printf("%02d", year() % 100); break;
-    case 'Y': s.printf("%s%04d", year() < 0 ? "-" : "", abs(year()));
+    case 'y': append_padded(s, year() % 100, 2); break;
+    case 'Y':
+      if (year() < 0) s.append('-');
+      append_padded(s, abs(year()), 4);
       break;
     case 'a': s.append(hour() >= 12 ? "pm" : "am"); break;
     case 'A': s.append(hour() >= 12 ? "PM" : "AM"); break;
-    case 'B': s.printf("%03d", beat()); break;
+    case 'B': append_padded(s, beat(), 3); break;
     case 'g': s.append((hour() % 12) ? (int)hour() % 12 : 12); break;
     case 'G': s.append(hour()); break;
-    case 'h': s.printf("%02d", (hour() % 12) ? (int)hour() % 12 : 12); break;
-    case 'H': s.printf("%02d", (int)hour()); break;
-    case 'i': s.printf("%02d", (int)minute()); break;
-    case 's': s.printf("%02d", (int)second()); break;
-    case 'u': s.printf("%06d", (int)floor(fraction() * 1000000)); break;
+    case 'h': append_padded(s, (hour() % 12) ? (int)hour() % 12 : 12, 2);
+      break;
+    case 'H': append_padded(s, hour(), 2); break;
+    case 'i': append_padded(s, minute(), 2); break;
+    case 's': append_padded(s, second(), 2); break;
+    case 'u': append_padded(s, (int)floor(fraction() * 1000000), 6); break;
     case 'I': s.append(!utc() && m_tz->dst(toTimeStamp(error)) ? 1 : 0);
       break;
     case 'P': rfc_colon = true; /* break intentionally missing */
@@ -21,6 +21,7 @@
 #include <runtime/base/builtin_functions.h>
 #include <runtime/base/runtime_error.h>
 #include <util/logger.h>
+#include <util/lock.h>
 
 namespace HPHP {
 
@@ -65,35 +66,42 @@ static GuessedTimeZone s_guessed_timezone;
 ///////////////////////////////////////////////////////////////////////////////
 // statics
 
+/**
+ * Parsed zones are never modified once loaded, so all threads share one copy
+ * of each: TimeZone objects only read them, and cloneTimeZone() makes its
+ * own copy before anything can change it.
+ */
 class TimeZoneData {
 public:
-  TimeZoneData() : Database(NULL) {}
+  TimeZoneData() : Database(timelib_builtin_db()) {}
 
   const timelib_tzdb *Database;
+  ReadWriteMutex CacheMutex;
   MapStringToTimeZoneInfo Cache;
 };
-static IMPLEMENT_THREAD_LOCAL(TimeZoneData, s_timezone_data);
+static TimeZoneData s_timezone_data;
 
 const timelib_tzdb *TimeZone::GetDatabase() {
-  const timelib_tzdb *&Database = s_timezone_data->Database;
-  if (Database == NULL) {
-    Database = timelib_builtin_db();
-  }
-  return Database;
+  return s_timezone_data.Database;
 }
 
 TimeZoneInfo TimeZone::GetTimeZoneInfo(CStrRef name) {
-  MapStringToTimeZoneInfo &Cache = s_timezone_data->Cache;
-
-  MapStringToTimeZoneInfo::const_iterator iter = Cache.find(name.data());
-  if (iter != Cache.end()) {
-    return iter->second;
+  MapStringToTimeZoneInfo &Cache = s_timezone_data.Cache;
+  {
+    ReadLock lock(s_timezone_data.CacheMutex);
+    MapStringToTimeZoneInfo::const_iterator iter = Cache.find(name.data());
+    if (iter != Cache.end()) {
+      return iter->second;
+    }
   }
 
   TimeZoneInfo tzi(timelib_parse_tzfile((char *)name.data(), GetDatabase()),
                    tzinfo_deleter());
   if (tzi) {
-    Cache[name.data()] = tzi;
+    WriteLock lock(s_timezone_data.CacheMutex);
+    // another thread may have loaded the same zone meanwhile
+    return Cache.insert(std::make_pair(std::string(name.data()), tzi))
+      .first->second;
   }
   return tzi;
 }
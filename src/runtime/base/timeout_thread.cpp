@@ -16,23 +16,15 @@
 
 #include <runtime/base/timeout_thread.h>
 #include <runtime/base/runtime_option.h>
+#include <runtime/base/server/server_stats.h>
 #include <util/lock.h>
 
+using namespace std;
+
 namespace HPHP {
 ///////////////////////////////////////////////////////////////////////////////
 // statics
 
-// class defined in runtime/base/types.h
-static void on_timer(int fd, short events, void *context) {
-  ((TimeoutThread*)context)->onTimer(fd);
-}
-
-static void on_thread_stop(int fd, short events, void *context) {
-  event_base_loopbreak((struct event_base *)context);
-}
-
-///////////////////////////////////////////////////////////////////////////////
-
 void TimeoutThread::DeferTimeout(int seconds) {
   RequestInjectionData &data = ThreadInfo::s_threadInfo->m_reqInjectionData;
   if (seconds > 0) {
@@ -43,27 +35,98 @@ void TimeoutThread::DeferTimeout(int seconds) {
   }
 }
 
+void TimeoutThread::SetDeadline(int64 ms) {
+  RequestInjectionData &data = ThreadInfo::s_threadInfo->m_reqInjectionData;
+  data.deadline = ms > 0 ? Now() + ms : 0;
+  if (data.timeoutThread) {
+    data.timeoutThread->wake(data.timeoutIndex);
+  }
+}
+
+void TimeoutThread::SetCpuBudget(int64 ms) {
+  RequestInjectionData &data = ThreadInfo::s_threadInfo->m_reqInjectionData;
+  data.cpuBudget = ms > 0 ? ms : 0;
+  if (data.timeoutThread) {
+    data.timeoutThread->wake(data.timeoutIndex);
+  }
+}
+
+// deadlines and the wheel are on a clock that doesn't jump with the time of
+// day, so setting the system clock neither fires nor postpones them
+int64 TimeoutThread::Now() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+// data.started is a time(0), so RequestTimeoutSeconds is still wall clock
+static int64 get_wall_time() {
+  struct timeval tv;
+  gettimeofday(&tv, 0);
+  return (int64)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+}
+
+static int64 get_cpu_time(clockid_t clock) {
+  struct timespec ts;
+  if (clock_gettime(clock, &ts) != 0) return 0;
+  return (int64)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+int64 TimeoutThread::GetCpuTime() {
+  RequestInjectionData &data = ThreadInfo::s_threadInfo->m_reqInjectionData;
+  return get_cpu_time(CLOCK_THREAD_CPUTIME_ID) - data.cpuStarted;
+}
+
+void TimeoutThread::OnRequestStart() {
+  RequestInjectionData &data = ThreadInfo::s_threadInfo->m_reqInjectionData;
+  data.active = true;
+  data.deadline = 0;
+  data.cpuBudget = RuntimeOption::RequestCpuBudgetMilliSeconds;
+  data.cpuStarted = get_cpu_time(CLOCK_THREAD_CPUTIME_ID);
+}
+
+void TimeoutThread::OnRequestEnd() {
+  RequestInjectionData &data = ThreadInfo::s_threadInfo->m_reqInjectionData;
+  if (data.deadline > 0 && Now() >= data.deadline) {
+    ServerStats::Log("request.deadline.missed", 1);
+  }
+  data.deadline = 0;
+  data.active = false;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 TimeoutThread::TimeoutThread(int timerCount, int timeoutSeconds)
-  : m_index(0), m_stopped(false), m_timeoutSeconds(timeoutSeconds) {
+  : Synchronizable(CLOCK_MONOTONIC), m_index(0), m_stopped(false), m_timeoutSeconds(timeoutSeconds),
+    m_wheel(timerCount, Now()) {
   ASSERT(timerCount > 0);
-
-  m_eventBase = event_base_new();
-  m_eventTimeouts.resize(timerCount);
   m_timeoutData.resize(timerCount);
+
+  // a new request's limits are picked up within this many milliseconds
+  m_idle = 10000;
+  if (m_timeoutSeconds > 0 && m_timeoutSeconds * 1000LL < m_idle) {
+    m_idle = m_timeoutSeconds * 1000LL;
+  }
+  int64 budget = RuntimeOption::RequestCpuBudgetMilliSeconds;
+  if (budget > 0 && budget < m_idle) {
+    m_idle = budget;
+  }
 }
 
 TimeoutThread::~TimeoutThread() {
-  event_base_free(m_eventBase);
 }
 
 void TimeoutThread::registerRequestThread(RequestInjectionData* data) {
   ASSERT(data);
   data->timeoutSeconds = m_timeoutSeconds;
+  if (pthread_getcpuclockid(pthread_self(), &data->cpuClock) != 0) {
+    data->cpuClock = CLOCK_THREAD_CPUTIME_ID; // CPU budget can't be checked
+  }
 
   Lock lock(this);
   ASSERT(m_index < (int)m_timeoutData.size());
+  data->timeoutThread = this;
+  data->timeoutIndex = m_index;
   m_timeoutData[m_index++] = data;
   if (m_index == (int)m_timeoutData.size()) {
     notify();
@@ -71,87 +134,91 @@ void TimeoutThread::registerRequestThread(RequestInjectionData* data) {
 }
 
 void TimeoutThread::run() {
-  {
-    Lock lock(this);
-    while (m_index < (int)m_timeoutData.size()) {
-      wait();
-    }
-    ASSERT(m_index == (int)m_timeoutData.size());
-  }
-
-  if (m_timeoutSeconds <= 0) {
-    return;
+  Lock lock(this);
+  while (m_index < (int)m_timeoutData.size() && !m_stopped) {
+    wait();
   }
 
-  struct timeval timeout;
-  timeout.tv_usec = 0;
-
-  // +2 to make sure when it times out, this equation always holds:
-  //   time(0) - RequestInjection::s_reqInjectionData->started >=
-  //     m_timeoutSeconds
-  timeout.tv_sec = m_timeoutSeconds + 2;
-
-  for (unsigned int i = 0; i < m_eventTimeouts.size(); i++) {
-    event *e = &m_eventTimeouts[i];
-    event_set(e, i, 0, on_timer, this);
-    event_base_set(m_eventBase, e);
-    event_add(e, &timeout);
+  vector<int> due;
+  int64 tick = Now();
+  m_wheel.advance(tick, due); // nothing on yet, only catches up
+  for (unsigned int i = 0; i < m_timeoutData.size(); i++) {
+    m_wheel.schedule(i, tick + m_idle * i / m_timeoutData.size());
   }
 
-  m_pipeStop.open();
-  event_set(&m_eventStop, m_pipeStop.getOut(), EV_READ|EV_PERSIST,
-            on_thread_stop, m_eventBase);
-  event_base_set(m_eventBase, &m_eventStop);
-  event_add(&m_eventStop, NULL);
-
   while (!m_stopped) {
-    event_base_loop(m_eventBase, EVLOOP_ONCE);
-  }
+    tick = Now();
+    due.swap(m_woken);
+    m_wheel.advance(tick, due);
+    for (unsigned int i = 0; i < due.size(); i++) {
+      m_wheel.schedule(due[i], tick + check(due[i], tick));
+    }
+    due.clear();
 
-  for (unsigned int i = 0; i < m_eventTimeouts.size(); i++) {
-    event_del(&m_eventTimeouts[i]);
+    int64 wait_ms = m_wheel.getNextTick() - Now();
+    if (wait_ms > 0 && m_woken.empty() && !m_stopped) {
+      wait(wait_ms / 1000, wait_ms % 1000 * 1000000);
+    }
   }
-  event_del(&m_eventStop);
 }
 
 void TimeoutThread::stop() {
+  Lock lock(this);
   m_stopped = true;
-  if (write(m_pipeStop.getIn(), "", 1) < 0) {
-    // an error occured but we're in shutdown already, so ignore
-  }
+  notify();
 }
 
-void TimeoutThread::onTimer(int index) {
-  ASSERT(index >= 0 && index < (int)m_eventTimeouts.size());
-
-  event *e = &m_eventTimeouts[index];
-  event_del(e);
+void TimeoutThread::wake(int index) {
+  Lock lock(this);
+  m_woken.push_back(index);
+  notify();
+}
 
+int64 TimeoutThread::check(int index, int64 now) {
+  ASSERT(index >= 0 && index < (int)m_timeoutData.size());
   RequestInjectionData *data = m_timeoutData[index];
   ASSERT(data);
-  struct timeval timeout;
-  timeout.tv_usec = 0;
-  if (data->started > 0) {
-    time_t now = time(0);
-    int delta = now - data->started;
-    if (delta >= m_timeoutSeconds) {
-      timeout.tv_sec = m_timeoutSeconds + 2;
-      data->timedout = true; // finally sure request is timed out
-    } else {
-      // Negative delta means start time was adjusted forward to give more time
-      if (delta < 0) delta = 0;
-
-      // otherwise, a new request started after we started the timer
-      timeout.tv_sec = m_timeoutSeconds - delta + 2;
+
+  int64 next = now + m_idle;
+  if (data->active) {
+    bool timedout = false;
+    if (m_timeoutSeconds > 0 && data->started > 0) {
+      // time(0) - data->started >= m_timeoutSeconds from then on
+      int64 due = now + (data->started + m_timeoutSeconds) * 1000LL -
+        get_wall_time();
+      if (now >= due) {
+        timedout = true;
+      } else if (due < next) {
+        next = due;
+      }
+    }
+
+    int64 deadline = data->deadline;
+    if (deadline > 0) {
+      if (now >= deadline) {
+        timedout = true;
+      } else if (deadline < next) {
+        next = deadline;
+      }
     }
-  } else {
-    // Another cycle of m_timeoutSeconds
-    timeout.tv_sec = m_timeoutSeconds;
-  }
 
-  event_set(e, index, 0, on_timer, this);
-  event_base_set(m_eventBase, e);
-  event_add(e, &timeout);
+    int64 budget = data->cpuBudget;
+    if (budget > 0 && data->cpuClock != CLOCK_THREAD_CPUTIME_ID) {
+      int64 left = budget - (get_cpu_time(data->cpuClock) - data->cpuStarted);
+      if (left <= 0) {
+        timedout = true;
+      } else if (now + left < next) {
+        next = now + left;
+      }
+    }
+
+    if (timedout) {
+      // finally sure request is timed out, unless a new one just started,
+      // which throw_request_timeout_exception() checks again
+      data->timedout = true;
+    }
+  }
+  return next - now;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -19,17 +19,53 @@
 
 #include <runtime/base/types.h>
 #include <util/base.h>
-#include <util/process.h>
 #include <util/synchronizable.h>
-#include <event.h>
+#include <util/timing_wheel.h>
 
 namespace HPHP {
 ///////////////////////////////////////////////////////////////////////////////
 
+/**
+ * Watches the request threads of one server and flags a request that went
+ * over one of its limits, for RequestInjection to stop it:
+ *
+ *   wall clock    RequestTimeoutSeconds since the request started
+ *   deadline      a time it has to be done by, set by the request itself
+ *   CPU budget    milliseconds of its thread's CPU time
+ *
+ * Each thread has a timer in a TimingWheel of milliseconds, due when its
+ * earliest limit could be reached: a CPU budget can't run out faster than
+ * wall time passes, so it's checked again after what's left of it. Requests
+ * starting don't tell this thread, so a thread's timer also fires every
+ * now and then to pick a new request's limits up; setting a deadline or a
+ * budget from a request has it looked at right away.
+ */
 class TimeoutThread : public Synchronizable {
 public:
   static void DeferTimeout(int seconds);
 
+  /**
+   * Limits of the current request, in milliseconds from now for a deadline
+   * and since the request started for a CPU budget; 0 removes them.
+   */
+  static void SetDeadline(int64 ms);
+  static void SetCpuBudget(int64 ms);
+
+  /**
+   * Milliseconds on CLOCK_MONOTONIC, which deadlines are kept on, and of
+   * CPU time the current request used.
+   */
+  static int64 Now();
+  static int64 GetCpuTime();
+
+  /**
+   * Called by hphp_session_init() and hphp_session_exit(), and also before
+   * an HTTP request is logged. OnRequestEnd() counts a deadline the request
+   * missed without being stopped for it, once.
+   */
+  static void OnRequestStart();
+  static void OnRequestEnd();
+
 public:
   TimeoutThread(int timerCount, int timeoutSeconds);
   ~TimeoutThread();
@@ -38,20 +74,27 @@ public:
   void run();
   void stop();
 
-  void onTimer(int index);
+  /**
+   * Have the timer of a thread fire now.
+   */
+  void wake(int index);
 
 private:
   int m_index;
   bool m_stopped;
 
-  event_base *m_eventBase;
-  std::vector<event> m_eventTimeouts;
   std::vector<RequestInjectionData*> m_timeoutData;
   int m_timeoutSeconds;
+  int64 m_idle; // how often a thread is looked at, whatever it runs
+
+  TimingWheel m_wheel;
+  std::vector<int> m_woken;
 
-  // signal to stop the thread
-  event m_eventStop;
-  CPipe m_pipeStop;
+  /**
+   * Flags the request of a thread if it's over a limit, and returns how many
+   * milliseconds later to look at it again.
+   */
+  int64 check(int index, int64 now); // now is a Now()
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -933,41 +933,179 @@ static void zend_qsort(void *base, size_t nmemb, size_t siz,
   }
 }
 
+/**
+ * When all the values (or keys) being sorted are of one simple type and the
+ * comparison is one of our own, we pull them out of the array once and
+ * compare them directly, instead of having cmp_func dispatch on Variant
+ * types on every comparison. zend_qsort() still does the sorting, so the
+ * resulting order, including that of equal elements, stays what PHP gives.
+ */
+enum SortKeyKind {
+  GenericKeys,
+  IntKeys,      // SORT_REGULAR over integers
+  DoubleKeys,   // SORT_REGULAR over doubles, SORT_NUMERIC over numbers
+  StringKeys,   // SORT_REGULAR over strings, numeric strings compare as such
+  StrcmpKeys,   // SORT_STRING
+  StrcollKeys,  // SORT_LOCALE_STRING
+};
+
+struct SortKeys {
+  SortKeyKind kind;
+  bool descending;
+  std::vector<int64> ints;
+  std::vector<double> doubles;
+  std::vector<String> strings;
+};
+
+static CVarRef sort_element(const Array::SortData &opaque, ssize_t pos,
+                            Variant &tmp) {
+  const ArrayData *arr = opaque.array->get();
+  if (opaque.by_key) {
+    tmp = arr->getKey(pos);
+    return tmp;
+  }
+  if (arr->supportValueRef()) {
+    return arr->getValueRef(pos);
+  }
+  tmp = arr->getValue(pos);
+  return tmp;
+}
+
+static void extract_sort_keys(const Array::SortData &opaque, SortKeys &keys) {
+  Array::PFUNC_CMP f = opaque.cmp_func;
+  keys.kind = GenericKeys;
+  keys.descending = (f == Array::SortRegularDescending ||
+                     f == Array::SortNumericDescending ||
+                     f == Array::SortStringDescending ||
+                     f == Array::SortLocaleStringDescending);
+  bool regular = (f == Array::SortRegularAscending ||
+                  f == Array::SortRegularDescending);
+  bool numeric = (f == Array::SortNumericAscending ||
+                  f == Array::SortNumericDescending);
+  bool string = (f == Array::SortStringAscending ||
+                 f == Array::SortStringDescending);
+  bool locale = (f == Array::SortLocaleStringAscending ||
+                 f == Array::SortLocaleStringDescending);
+  if (!regular && !numeric && !string && !locale) return;
+
+  int count = opaque.positions.size();
+  int ints = 0, doubles = 0, strings = 0;
+  for (int i = 0; i < count; i++) {
+    Variant tmp;
+    CVarRef v = sort_element(opaque, opaque.positions[i], tmp);
+    if (v.isInteger()) {
+      ints++;
+    } else if (v.isDouble()) {
+      doubles++;
+    } else if (v.isString()) {
+      strings++;
+    } else {
+      return;
+    }
+  }
+
+  if (regular) {
+    if (ints == count) {
+      keys.kind = IntKeys;
+    } else if (doubles == count) {
+      keys.kind = DoubleKeys;
+    } else if (strings == count) {
+      keys.kind = StringKeys;
+    } else {
+      return;
+    }
+  } else if (numeric) {
+    keys.kind = DoubleKeys;
+  } else {
+    keys.kind = string ? StrcmpKeys : StrcollKeys;
+  }
+
+  switch (keys.kind) {
+  case IntKeys:     keys.ints.reserve(count);    break;
+  case DoubleKeys:  keys.doubles.reserve(count); break;
+  default:          keys.strings.reserve(count); break;
+  }
+  for (int i = 0; i < count; i++) {
+    Variant tmp;
+    CVarRef v = sort_element(opaque, opaque.positions[i], tmp);
+    switch (keys.kind) {
+    case IntKeys:     keys.ints.push_back(v.toInt64());     break;
+    case DoubleKeys:  keys.doubles.push_back(v.toDouble()); break;
+    default:          keys.strings.push_back(v.toString()); break;
+    }
+  }
+}
+
+static int sort_keys_compare(const SortKeys &keys, int index1, int index2) {
+  int ret = 0;
+  switch (keys.kind) {
+  case IntKeys: {
+    int64 v1 = keys.ints[index1];
+    int64 v2 = keys.ints[index2];
+    ret = v1 < v2 ? -1 : (v1 == v2 ? 0 : 1);
+    break;
+  }
+  case DoubleKeys: {
+    double v1 = keys.doubles[index1];
+    double v2 = keys.doubles[index2];
+    ret = v1 < v2 ? -1 : (v1 == v2 ? 0 : 1);
+    break;
+  }
+  case StringKeys: {
+    // same as Variant::less() and Variant::equal() on two strings
+    CStrRef v1 = keys.strings[index1];
+    CStrRef v2 = keys.strings[index2];
+    ret = v2.more(v1) ? -1 : (v2.equal(v1) ? 0 : 1);
+    break;
+  }
+  case StrcmpKeys:
+    ret = strcmp(keys.strings[index1].data(), keys.strings[index2].data());
+    break;
+  case StrcollKeys:
+    ret = strcoll(keys.strings[index1].data(), keys.strings[index2].data());
+    break;
+  default:
+    ASSERT(false);
+    break;
+  }
+  return keys.descending ? -ret : ret;
+}
+
+static int sort_data_compare(const Array::SortData &opaque, int index1,
+                             int index2) {
+  ssize_t pos1 = opaque.positions[index1];
+  ssize_t pos2 = opaque.positions[index2];
+  const ArrayData *arr = opaque.array->get();
+  if (opaque.by_key) {
+    return opaque.cmp_func(arr->getKey(pos1), arr->getKey(pos2),
+                           opaque.data);
+  }
+  if (arr->supportValueRef()) {
+    return opaque.cmp_func(arr->getValueRef(pos1), arr->getValueRef(pos2),
+                           opaque.data);
+  }
+  return opaque.cmp_func(arr->getValue(pos1), arr->getValue(pos2),
+                         opaque.data);
+}
+
+struct SortColumn {
+  const Array::SortData *opaque;
+  SortKeys keys;
+};
+
 static int array_compare_func(const void *n1, const void *n2, const void *op) {
-  int index1 = *(int*)n1;
-  int index2 = *(int*)n2;
-  Array::SortData *opaque = (Array::SortData*)op;
-  ssize_t pos1 = opaque->positions[index1];
-  ssize_t pos2 = opaque->positions[index2];
-  if (opaque->by_key) {
-    return opaque->cmp_func((*opaque->array)->getKey(pos1),
-                            (*opaque->array)->getKey(pos2),
-                            opaque->data);
+  const SortColumn *column = (const SortColumn *)op;
+  if (column->keys.kind != GenericKeys) {
+    return sort_keys_compare(column->keys, *(int*)n1, *(int*)n2);
   }
-  return opaque->cmp_func((*opaque->array)->getValue(pos1),
-                          (*opaque->array)->getValue(pos2),
-                          opaque->data);
+  return sort_data_compare(*column->opaque, *(int*)n1, *(int*)n2);
 }
 
 static int multi_compare_func(const void *n1, const void *n2, const void *op) {
-  int index1 = *(int*)n1;
-  int index2 = *(int*)n2;
-  const std::vector<Array::SortData> *opaques =
-    (const std::vector<Array::SortData> *)op;
-  for (unsigned int i = 0; i < opaques->size(); i++) {
-    const Array::SortData *opaque = &opaques->at(i);
-    ssize_t pos1 = opaque->positions[index1];
-    ssize_t pos2 = opaque->positions[index2];
-    int result;
-    if (opaque->by_key) {
-      result = opaque->cmp_func((*opaque->array)->getKey(pos1),
-                                (*opaque->array)->getKey(pos2),
-                                opaque->data);
-    } else {
-      result = opaque->cmp_func((*opaque->array)->getValue(pos1),
-                                (*opaque->array)->getValue(pos2),
-                                opaque->data);
-    }
+  const std::vector<SortColumn> *columns =
+    (const std::vector<SortColumn> *)op;
+  for (unsigned int i = 0; i < columns->size(); i++) {
+    int result = array_compare_func(n1, n2, &columns->at(i));
     if (result != 0) return result;
   }
   return 0;
@@ -996,16 +1134,38 @@ static void _sort(vector<int> &indices, CArrRef source, Array::SortData &opaque,
        pos = source->iter_advance(pos)) {
     opaque.positions.push_back(pos);
   }
-  zend_qsort(&indices[0], count, sizeof(int), array_compare_func, &opaque);
+
+  SortColumn column;
+  column.opaque = &opaque;
+  extract_sort_keys(opaque, column.keys);
+  zend_qsort(&indices[0], count, sizeof(int), array_compare_func, &column);
+}
+
+/**
+ * Sorting relinks the elements of an array we own, so get one.
+ */
+static void own_for_sort(Array &arr) {
+  if (!arr.isNull() && arr->getCount() > 1) {
+    arr = arr->copy();
+  }
 }
 
 void Array::sort(PFUNC_CMP cmp_func, bool by_key, bool renumber,
                  const void *data /* = NULL */) {
-  Array sorted = Array::Create();
+  own_for_sort(*this);
   SortData opaque;
   vector<int> indices;
   _sort(indices, *this, opaque, cmp_func, by_key, data);
   int count = size();
+  if (count) {
+    vector<ssize_t> order(count);
+    for (int i = 0; i < count; i++) {
+      order[i] = opaque.positions[indices[i]];
+    }
+    if (m_px->reorder(order, renumber, false)) return;
+  }
+
+  Array sorted = Array::Create();
   for (int i = 0; i < count; i++) {
     ssize_t pos = opaque.positions[indices[i]];
     if (renumber) {
@@ -1033,34 +1193,48 @@ bool Array::MultiSort(std::vector<SortData> &data, bool renumber) {
       throw_invalid_argument("arrays: (inconsistent sizes)");
       return false;
     }
-
-    opaque.positions.reserve(size);
-    CArrRef arr = *opaque.array;
-    if (!arr.empty()) {
-      for (ssize_t pos = arr->iter_begin(); pos != ArrayData::invalid_index;
-           pos = arr->iter_advance(pos)) {
-        opaque.positions.push_back(pos);
-      }
-    }
   }
   if (count == 0) {
     return true;
   }
 
+  std::vector<SortColumn> columns(data.size());
+  for (unsigned int k = 0; k < data.size(); k++) {
+    SortData &opaque = data[k];
+    own_for_sort(const_cast<Array &>(*opaque.array));
+    CArrRef arr = *opaque.array;
+    opaque.positions.reserve(count);
+    for (ssize_t pos = arr->iter_begin(); pos != ArrayData::invalid_index;
+         pos = arr->iter_advance(pos)) {
+      opaque.positions.push_back(pos);
+    }
+    columns[k].opaque = &opaque;
+    extract_sort_keys(opaque, columns[k].keys);
+  }
+
   int *indices = (int *)malloc(sizeof(int) * count);
   for (int i = 0; i < count; i++) {
     indices[i] = i;
   }
 
-  zend_qsort(indices, count, sizeof(int), multi_compare_func, (void *)&data);
+  zend_qsort(indices, count, sizeof(int), multi_compare_func,
+             (void *)&columns);
 
+  vector<ssize_t> order(count);
   for (unsigned int k = 0; k < data.size(); k++) {
     SortData &opaque = data[k];
-    CArrRef arr = *opaque.array;
+    Array &arr = const_cast<Array &>(*opaque.array);
+    for (int i = 0; i < count; i++) {
+      order[i] = opaque.positions[indices[i]];
+    }
+    if (arr->reorder(order, renumber, true)) {
+      *opaque.original = arr;
+      continue;
+    }
 
     Array sorted;
     for (int i = 0; i < count; i++) {
-      ssize_t pos = opaque.positions[indices[i]];
+      ssize_t pos = order[i];
       Variant k(arr->getKey(pos));
       if (renumber && k.isInteger()) {
         sorted.append(arr->getValue(pos));
@@ -91,6 +91,9 @@ public:
   bool isNull() const {
     return m_px == NULL;
   }
+  int64 hash() const {
+    return m_px ? m_px->hash() : hash_string("", 0);
+  }
   bool isNumeric() const {
     return m_px ? m_px->isNumeric() : false;
   }
@@ -323,7 +326,7 @@ extern const String null_string;
 
 struct zend_hash {
   size_t operator()(CStrRef s) const {
-    return hash_string(s.data(), s.size());
+    return s.hash();
   }
 };
 
@@ -346,8 +349,7 @@ typedef hphp_hash_map<String, int, zend_hash, zend_eqstr> MapStringToInt;
 
 struct string_data_hash {
   size_t operator()(const StringData *s) const {
-    if (s->isStatic()) return s->getStaticHash();
-    return hash_string(s->data(), s->size());
+    return s->hash();
   }
 };
 
@@ -157,17 +157,30 @@ typedef const Variant & CVarRef;
 ///////////////////////////////////////////////////////////////////////////////
 // code injection classes
 
+class TimeoutThread;
 class RequestInjectionData {
 public:
   RequestInjectionData()
     : started(0), timeoutSeconds(-1), timedout(false), signaled(false),
-      memExceeded(false) {}
+      memExceeded(false), active(false), deadline(0), cpuBudget(0), cpuStarted(0),
+      cpuClock(CLOCK_THREAD_CPUTIME_ID), timeoutThread(NULL),
+      timeoutIndex(-1) {}
 
   time_t started;     // when a request was started
   int timeoutSeconds; // how many seconds to timeout
   bool timedout;      // flag to set when timeout is detected
   bool signaled;      // flag to set when a signal was raised
   bool memExceeded;   // memory limit was exceeded
+
+  // limits of TimeoutThread in milliseconds, 0 if there is none, checked
+  // while a request is active whatever set_time_limit() did to started
+  bool active;        // between hphp_session_init() and _exit()
+  int64 deadline;     // a TimeoutThread::Now()
+  int64 cpuBudget;    // of CPU time used since cpuStarted
+  int64 cpuStarted;   // thread's CPU time when the request was started
+  clockid_t cpuClock; // thread's CPU clock, readable from other threads
+  TimeoutThread *timeoutThread; // watching this thread, if any
+  int timeoutIndex;
 };
 
 class FrameInjection;
@@ -190,6 +203,7 @@ public:
   Profiler *m_profiler;
 
   ThreadInfo();
+  ~ThreadInfo();
   void reset();
 };
 
@@ -0,0 +1,140 @@
+/*
+   +----------------------------------------------------------------------+
+   | HipHop for PHP                                                       |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2010 Facebook, Inc. (http://www.facebook.com)          |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 3.01 of the PHP license,      |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available through the world-wide-web at the following url:           |
+   | http://www.php.net/license/3_01.txt                                  |
+   | If you did not receive a copy of the PHP license and are unable to   |
+   | obtain it through the world-wide-web, please send a note to          |
+   | license@php.net so we can mail you a copy immediately.               |
+   +----------------------------------------------------------------------+
+*/
+
+#include <runtime/base/util/chunked_buffer.h>
+#include <runtime/base/util/alloc.h>
+#include <util/thread_local.h>
+
+namespace HPHP {
+///////////////////////////////////////////////////////////////////////////////
+// per-thread free list
+
+class ChunkFreeList {
+public:
+  ~ChunkFreeList() {
+    for (unsigned int i = 0; i < m_chunks.size(); i++) {
+      free(m_chunks[i]);
+    }
+  }
+  std::vector<char*> m_chunks;
+};
+static IMPLEMENT_THREAD_LOCAL(ChunkFreeList, s_free_chunks);
+
+char *ChunkedBuffer::NewChunk() {
+  std::vector<char*> &chunks = s_free_chunks->m_chunks;
+  if (!chunks.empty()) {
+    char *data = chunks.back();
+    chunks.pop_back();
+    return data;
+  }
+  // one extra byte, so detach() can terminate a chunk in place
+  return (char *)Util::safe_malloc(ChunkSize + 1);
+}
+
+void ChunkedBuffer::FreeChunk(char *data) {
+  std::vector<char*> &chunks = s_free_chunks->m_chunks;
+  if ((int)chunks.size() < MaxFreeChunks) {
+    chunks.push_back(data);
+  } else {
+    free(data);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+ChunkedBuffer::ChunkedBuffer() : m_size(0) {
+}
+
+ChunkedBuffer::~ChunkedBuffer() {
+  reset();
+}
+
+void ChunkedBuffer::append(const char *s, int len) {
+  ASSERT(len >= 0);
+  while (len > 0) {
+    if (m_chunks.empty() || m_chunks.back().size == ChunkSize) {
+      Chunk chunk;
+      chunk.data = NewChunk();
+      chunk.size = 0;
+      m_chunks.push_back(chunk);
+    }
+    Chunk &chunk = m_chunks.back();
+    int n = ChunkSize - chunk.size;
+    if (n > len) n = len;
+    memcpy(chunk.data + chunk.size, s, n);
+    chunk.size += n;
+    m_size += n;
+    s += n;
+    len -= n;
+  }
+}
+
+void ChunkedBuffer::absorb(ChunkedBuffer &buf) {
+  m_chunks.insert(m_chunks.end(), buf.m_chunks.begin(), buf.m_chunks.end());
+  m_size += buf.m_size;
+  buf.m_chunks.clear();
+  buf.m_size = 0;
+}
+
+void ChunkedBuffer::reset() {
+  for (unsigned int i = 0; i < m_chunks.size(); i++) {
+    FreeChunk(m_chunks[i].data);
+  }
+  m_chunks.clear();
+  m_size = 0;
+}
+
+String ChunkedBuffer::copy() const {
+  if (m_size == 0) {
+    return String("");
+  }
+  char *data = (char *)Util::safe_malloc(m_size + 1);
+  char *p = data;
+  for (unsigned int i = 0; i < m_chunks.size(); i++) {
+    memcpy(p, m_chunks[i].data, m_chunks[i].size);
+    p += m_chunks[i].size;
+  }
+  *p = '\0';
+  return String(data, m_size, AttachString);
+}
+
+String ChunkedBuffer::detach() {
+  if (m_chunks.size() == 1) {
+    Chunk &chunk = m_chunks[0];
+    chunk.data[chunk.size] = '\0';
+    String ret(chunk.data, chunk.size, AttachString);
+    m_chunks.clear();
+    m_size = 0;
+    return ret;
+  }
+  String ret = copy();
+  reset();
+  return ret;
+}
+
+void ChunkedBuffer::getChunks(std::vector<iovec> &chunks) const {
+  for (unsigned int i = 0; i < m_chunks.size(); i++) {
+    if (m_chunks[i].size) {
+      iovec iov;
+      iov.iov_base = m_chunks[i].data;
+      iov.iov_len = m_chunks[i].size;
+      chunks.push_back(iov);
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+}
@@ -0,0 +1,96 @@
+/*
+   +----------------------------------------------------------------------+
+   | HipHop for PHP                                                       |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2010 Facebook, Inc. (http://www.facebook.com)          |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 3.01 of the PHP license,      |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available through the world-wide-web at the following url:           |
+   | http://www.php.net/license/3_01.txt                                  |
+   | If you did not receive a copy of the PHP license and are unable to   |
+   | obtain it through the world-wide-web, please send a note to          |
+   | license@php.net so we can mail you a copy immediately.               |
+   +----------------------------------------------------------------------+
+*/
+
+#ifndef __HPHP_CHUNKED_BUFFER_H__
+#define __HPHP_CHUNKED_BUFFER_H__
+
+#include <runtime/base/types.h>
+#include <runtime/base/complex_types.h>
+#include <sys/uio.h>
+
+namespace HPHP {
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * String concatenation into a list of fixed size chunks, for output buffers.
+ * Unlike StringBuffer, growing never reallocates or moves what was already
+ * written, and chunks are recycled through a per-thread free list, so a
+ * thread serving one page after another stops allocating once it has seen
+ * its largest page. Contents are only joined into one String when somebody
+ * asks for it; otherwise they can be handed out chunk by chunk with
+ * getChunks().
+ */
+class ChunkedBuffer {
+public:
+  static const int ChunkSize = 16 * 1024;
+  static const int MaxFreeChunks = 64; // kept per thread between requests
+
+public:
+  ChunkedBuffer();
+  ~ChunkedBuffer();
+
+  bool empty() const { return m_size == 0;}
+  int size() const { return m_size;}
+
+  void append(const char *s, int len);
+  void append(CStrRef s) { append(s.data(), s.size());}
+
+  /**
+   * Moves all of another buffer's chunks to the end of this one, without
+   * copying any data.
+   */
+  void absorb(ChunkedBuffer &buf);
+
+  /**
+   * Clears contents and gives all chunks back to the free list.
+   */
+  void reset();
+
+  /**
+   * Joins contents into one String. detach() also clears this buffer, and
+   * when everything fits in a single chunk, hands over that chunk instead of
+   * copying it.
+   */
+  String copy() const;
+  String detach();
+
+  /**
+   * Adds one entry per non-empty chunk, in order.
+   */
+  void getChunks(std::vector<iovec> &chunks) const;
+
+private:
+  struct Chunk {
+    char *data;
+    int size;
+  };
+  std::vector<Chunk> m_chunks;
+  int m_size;
+
+  static char *NewChunk();
+  static void FreeChunk(char *data);
+
+  ChunkedBuffer(const ChunkedBuffer &buf) { ASSERT(false);}
+  ChunkedBuffer &operator=(const ChunkedBuffer &buf) {
+    ASSERT(false);
+    return *this;
+  }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+}
+
+#endif // __HPHP_CHUNKED_BUFFER_H__
@@ -0,0 +1,202 @@
+/*
+   +----------------------------------------------------------------------+
+   | HipHop for PHP                                                       |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2010 Facebook, Inc. (http://www.facebook.com)          |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 3.01 of the PHP license,      |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available through the world-wide-web at the following url:           |
+   | http://www.php.net/license/3_01.txt                                  |
+   | If you did not receive a copy of the PHP license and are unable to   |
+   | obtain it through the world-wide-web, please send a note to          |
+   | license@php.net so we can mail you a copy immediately.               |
+   +----------------------------------------------------------------------+
+*/
+
+#include <runtime/base/util/curl_pool.h>
+#include <runtime/base/runtime_option.h>
+#include <runtime/base/server/server_stats.h>
+#include <util/lock.h>
+#include <util/logger.h>
+
+using namespace std;
+
+namespace HPHP {
+///////////////////////////////////////////////////////////////////////////////
+// share handle
+
+class CurlShare {
+public:
+  CurlShare() {
+    init();
+  }
+
+  ~CurlShare() {
+    curl_share_cleanup(m_share);
+  }
+
+  CURLSH *get() { return m_share;}
+
+  /**
+   * Starts over with a new share handle. Returns false and keeps the old
+   * one if an easy handle still uses it, as curl won't free it then.
+   */
+  bool reset() {
+    if (curl_share_cleanup(m_share) != CURLSHE_OK) {
+      return false;
+    }
+    init();
+    return true;
+  }
+
+private:
+  enum { MaxLocks = 8 };
+
+  CURLSH *m_share;
+  Mutex m_mutexes[MaxLocks]; // one per curl_lock_data
+
+  void init() {
+    m_share = curl_share_init();
+    curl_share_setopt(m_share, CURLSHOPT_LOCKFUNC, lock);
+    curl_share_setopt(m_share, CURLSHOPT_UNLOCKFUNC, unlock);
+    curl_share_setopt(m_share, CURLSHOPT_USERDATA, (void*)this);
+    curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+#if LIBCURL_VERSION_NUM >= 0x071700
+    curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+#endif
+#if LIBCURL_VERSION_NUM >= 0x073900
+    curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+#endif
+  }
+
+  static void lock(CURL *cp, curl_lock_data data, curl_lock_access access,
+                   void *ctx) {
+    ((CurlShare*)ctx)->m_mutexes[data % MaxLocks].lock();
+  }
+
+  static void unlock(CURL *cp, curl_lock_data data, void *ctx) {
+    ((CurlShare*)ctx)->m_mutexes[data % MaxLocks].unlock();
+  }
+};
+static CurlShare s_share;
+
+///////////////////////////////////////////////////////////////////////////////
+// idle handles
+
+struct IdleHandle {
+  CURL *cp;
+  time_t released;
+};
+typedef std::vector<IdleHandle> IdleHandleVec;
+typedef hphp_string_map<IdleHandleVec> IdleHandleMap;
+
+static Mutex s_mutex;
+static IdleHandleMap s_idle;
+
+string CurlHandlePool::GetKey(const char *url) {
+  const char *p = strstr(url, "://");
+  if (p == NULL) {
+    return "";
+  }
+  p += 3;
+  const char *end = p + strcspn(p, "/?#");
+  string key(url, end - url);
+  for (unsigned int i = 0; i < key.size(); i++) {
+    key[i] = tolower(key[i]);
+  }
+  return key;
+}
+
+void CurlHandlePool::Share(CURL *cp) {
+  curl_easy_setopt(cp, CURLOPT_SHARE, s_share.get());
+}
+
+CURL *CurlHandlePool::Get(const char *url) {
+  CURL *cp = NULL;
+  vector<CURL*> expired;
+  if (RuntimeOption::HttpConnectionPoolMaxIdlePerHost > 0) {
+    string key = GetKey(url);
+    time_t now = time(NULL);
+    Lock lock(s_mutex);
+    IdleHandleMap::iterator iter = s_idle.find(key);
+    if (iter != s_idle.end()) {
+      IdleHandleVec &handles = iter->second;
+      // most recently released first, as it is the least likely to have had
+      // its connection closed by the other end
+      while (!handles.empty()) {
+        IdleHandle h = handles.back();
+        handles.pop_back();
+        if (now - h.released < RuntimeOption::HttpConnectionPoolIdleTimeout) {
+          cp = h.cp;
+          break;
+        }
+        expired.push_back(h.cp);
+      }
+    }
+  }
+  for (unsigned int i = 0; i < expired.size(); i++) {
+    curl_easy_cleanup(expired[i]);
+  }
+
+  if (cp) {
+    ServerStats::Log("curl.pool.hit", 1);
+  } else {
+    ServerStats::Log("curl.pool.miss", 1);
+    cp = curl_easy_init();
+  }
+  Share(cp);
+  return cp;
+}
+
+void CurlHandlePool::Release(const char *url, CURL *cp) {
+  if (RuntimeOption::HttpConnectionPoolMaxIdlePerHost > 0) {
+    string key = GetKey(url);
+    if (!key.empty()) {
+      curl_easy_reset(cp);
+      IdleHandle h;
+      h.cp = cp;
+      h.released = time(NULL);
+
+      Lock lock(s_mutex);
+      IdleHandleVec &handles = s_idle[key];
+      if ((int)handles.size() <
+          RuntimeOption::HttpConnectionPoolMaxIdlePerHost) {
+        handles.push_back(h);
+        return;
+      }
+    }
+  }
+  curl_easy_cleanup(cp);
+}
+
+void CurlHandlePool::Reset() {
+  IdleHandleMap idle;
+  {
+    Lock lock(s_mutex);
+    idle.swap(s_idle);
+  }
+  for (IdleHandleMap::iterator iter = idle.begin(); iter != idle.end();
+       ++iter) {
+    IdleHandleVec &handles = iter->second;
+    for (unsigned int i = 0; i < handles.size(); i++) {
+      curl_easy_cleanup(handles[i].cp);
+    }
+  }
+  if (!s_share.reset()) {
+    Logger::Warning("curl share handle still in use, keeping its caches");
+  }
+}
+
+int CurlHandlePool::IdleCount(const char *url) {
+  string key = GetKey(url);
+  Lock lock(s_mutex);
+  IdleHandleMap::const_iterator iter = s_idle.find(key);
+  if (iter == s_idle.end()) {
+    return 0;
+  }
+  return iter->second.size();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+}
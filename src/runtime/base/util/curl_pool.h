@@ -0,0 +1,81 @@
+/*
+   +----------------------------------------------------------------------+
+   | HipHop for PHP                                                       |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2010 Facebook, Inc. (http://www.facebook.com)          |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 3.01 of the PHP license,      |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available through the world-wide-web at the following url:           |
+   | http://www.php.net/license/3_01.txt                                  |
+   | If you did not receive a copy of the PHP license and are unable to   |
+   | obtain it through the world-wide-web, please send a note to          |
+   | license@php.net so we can mail you a copy immediately.               |
+   +----------------------------------------------------------------------+
+*/
+
+#ifndef __HPHP_CURL_POOL_H__
+#define __HPHP_CURL_POOL_H__
+
+#include <util/base.h>
+#include <curl/curl.h>
+
+namespace HPHP {
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Process-wide pool of idle curl easy handles, keyed by scheme, host and
+ * port. An easy handle keeps its connections open after a transfer, so
+ * taking one that last talked to the same host skips the TCP and TLS
+ * handshakes. At most Http.ConnectionPool.MaxIdlePerHost handles are kept
+ * per host, and handles idle longer than Http.ConnectionPool.IdleTimeout
+ * seconds are closed instead of being reused.
+ *
+ * Every handle, pooled or not, can also be attached to one curl share
+ * handle, so DNS lookups and TLS sessions (and, with libcurl 7.57 or later,
+ * open connections) are cached once for all request threads.
+ */
+class CurlHandlePool {
+public:
+  /**
+   * Returns an idle handle that last talked to the same host as "url", or a
+   * new one. Either way, it has no options set other than the share handle.
+   */
+  static CURL *Get(const char *url);
+
+  /**
+   * Gives a handle back after a transfer to "url". Its options are reset,
+   * but its connections are kept open for the next Get().
+   */
+  static void Release(const char *url, CURL *cp);
+
+  /**
+   * Makes a handle use the process-wide DNS, TLS session and connection
+   * caches.
+   */
+  static void Share(CURL *cp);
+
+  /**
+   * Closes all idle handles and starts over with a new share handle, so no
+   * connection made so far is used again. Only while no transfer is running,
+   * like before forking processes that would otherwise all talk over the
+   * same sockets. If a handle outside the pool still uses the share handle,
+   * that one is kept and a warning is logged.
+   */
+  static void Reset();
+
+  /**
+   * Number of idle handles kept for the host of "url".
+   */
+  static int IdleCount(const char *url);
+
+  /**
+   * "scheme://host:port" part of an URL, which is what handles are pooled by.
+   */
+  static std::string GetKey(const char *url);
+};
+
+///////////////////////////////////////////////////////////////////////////////
+}
+
+#endif // __HPHP_CURL_POOL_H__
@@ -15,6 +15,7 @@
 */
 
 #include <runtime/base/util/http_client.h>
+#include <runtime/base/util/curl_pool.h>
 #include <runtime/base/runtime_option.h>
 #include <runtime/base/server/server_stats.h>
 #include <util/timer.h>
@@ -102,7 +103,7 @@ int HttpClient::impl(const char *url, const char *data, int size,
   char error_str[CURL_ERROR_SIZE + 1];
   memset(error_str, 0, sizeof(error_str));
 
-  CURL *cp = curl_easy_init();
+  CURL *cp = CurlHandlePool::Get(url);
   curl_easy_setopt(cp, CURLOPT_URL,               url);
   curl_easy_setopt(cp, CURLOPT_WRITEFUNCTION,     curl_write);
   curl_easy_setopt(cp, CURLOPT_WRITEDATA,         (void*)this);
@@ -186,7 +187,11 @@ int HttpClient::impl(const char *url, const char *data, int size,
     curl_slist_free_all(slist);
   }
 
-  curl_easy_cleanup(cp);
+  if (error_no == CURLE_OK) {
+    CurlHandlePool::Release(url, cp);
+  } else {
+    curl_easy_cleanup(cp);
+  }
   return code;
 }
 
@@ -112,6 +112,15 @@ public:
     operator=((T*)NULL);
   }
 
+  /**
+   * Exchange raw pointers without touching reference counts.
+   */
+  void swap(SmartPtr<T> &other) {
+    T *px = m_px;
+    m_px = other.m_px;
+    other.m_px = px;
+  }
+
  protected:
   T *m_px;  // raw pointer
 };
@@ -33,7 +33,7 @@ namespace HPHP {
 VariableSerializer::VariableSerializer(Type type, int option /* = 0 */)
   : m_type(type), m_option(option), m_buf(NULL), m_indent(0),
     m_valueCount(0), m_referenced(false), m_refCount(1), m_maxCount(3),
-    m_outputLimit(0) {
+    m_outputLimit(0), m_streaming(false), m_streamed(0) {
 }
 
 void VariableSerializer::setObjectInfo(const char *objClass, int objId) {
@@ -54,18 +54,24 @@ void VariableSerializer::setResourceInfo(const char *rsrcName, int rsrcId) {
 Variant VariableSerializer::serialize(CVarRef v, bool ret) {
   StringBuffer buf;
   m_buf = &buf;
-  if (ret) {
+  if (ret || m_type == JSON) {
+    // json_encode() is limited whether it's returned or echoed
     m_outputLimit = RuntimeOption::SerializationSizeLimit;
   }
+  if (!ret) {
+    m_streaming = true;
+    m_streamed = 0;
+  }
   m_valueCount = 1;
   if (m_type == VarDump && v.isContagious()) m_buf->append('&');
   write(v);
   if (ret) {
     return m_buf->detach();
-  } else {
-    String str = m_buf->detach();
-    g_context->write(str.c_str(), str.size());
   }
+  if (!m_buf->empty()) {
+    g_context->write(m_buf->data(), m_buf->size());
+  }
+  m_streaming = false;
   return true;
 }
 
@@ -747,9 +753,14 @@ void VariableSerializer::decNestedLevel(void *ptr) {
 }
 
 void VariableSerializer::checkOutputSize() {
-  if (m_outputLimit > 0 && m_buf->length() > m_outputLimit) {
+  if (m_outputLimit > 0 && m_streamed + m_buf->length() > m_outputLimit) {
     raise_error("Value too large for serialization");
   }
+  if (m_streaming && m_buf->size() >= StreamChunkSize) {
+    g_context->write(m_buf->data(), m_buf->size());
+    m_streamed += m_buf->size();
+    m_buf->reset();
+  }
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -51,10 +51,16 @@ public:
   VariableSerializer(Type type, int option = 0);
 
   /**
-   * Top level entry function called by f_ functions.
+   * Top level entry function called by f_ functions. When "ret" is false,
+   * output goes to g_context->write() in chunks of about StreamChunkSize
+   * bytes as it is produced, instead of being built up as one String first.
+   * SerializationSizeLimit applies to returned output and to JSON, counting
+   * what was already streamed.
    */
   Variant serialize(CVarRef v, bool ret);
 
+  static const int StreamChunkSize = 8192;
+
   /**
    * Type specialized output functions.
    */
@@ -110,6 +116,8 @@ private:
   int m_rsrcId;                  // for resource serialization
   int m_maxCount;                // for max recursive levels
   int64 m_outputLimit;             // Maximum size of output
+  bool m_streaming;              // flushing m_buf to output as it grows
+  int64 m_streamed;              // bytes flushed so far, for m_outputLimit
 
 
   struct ArrayInfo {
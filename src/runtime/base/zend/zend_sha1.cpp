@@ -16,6 +16,7 @@
 */
 
 #include <runtime/base/zend/zend_string.h>
+#include <util/checksum.h>
 
 namespace HPHP {
 ///////////////////////////////////////////////////////////////////////////////
@@ -113,6 +114,18 @@ void PHP_SHA1Init(PHP_SHA1_CTX * context) {
   context->state[4] = 0xc3d2e1f0;
 }
 
+/**
+ * Runs SHA1Transform over consecutive blocks, unless the CPU can do it.
+ */
+static void SHA1Blocks(uint32 state[5], const unsigned char *input,
+                       unsigned int blocks) {
+  if (!Checksum::Sha1Blocks(state, input, blocks)) {
+    for (; blocks; blocks--, input += 64) {
+      SHA1Transform(state, input);
+    }
+  }
+}
+
 /**
  * SHA1 block update operation. Continues an SHA1 message-digest
  * operation, processing another message block, and updating the context.
@@ -137,11 +150,9 @@ void PHP_SHA1Update(PHP_SHA1_CTX * context, const unsigned char *input,
   if (inputLen >= partLen) {
     memcpy((unsigned char*) & context->buffer[index],
            (unsigned char*) input, partLen);
-    SHA1Transform(context->state, context->buffer);
-
-    for (i = partLen; i + 63 < inputLen; i += 64) {
-      SHA1Transform(context->state, &input[i]);
-    }
+    SHA1Blocks(context->state, context->buffer, 1);
+    SHA1Blocks(context->state, &input[partLen], (inputLen - partLen) / 64);
+    i = partLen + (inputLen - partLen) / 64 * 64;
 
     index = 0;
   } else
@@ -57,9 +57,10 @@ VariableIndex::SuperGlobal VariableIndex::isSuperGlobal(CStrRef name) {
   return Normal;
 }
 
-Block::Block() {}
+Block::Block() : m_dynamicVariables(false) {}
 
-Block::Block(const vector<StaticStatementPtr> &stat) {
+Block::Block(const vector<StaticStatementPtr> &stat)
+  : m_dynamicVariables(false) {
   for (vector<StaticStatementPtr>::const_iterator it = stat.begin();
        it != stat.end(); ++it) {
     declareStaticStatement(*it);
@@ -80,7 +81,13 @@ int Block::declareVariable(CStrRef var) {
   VariableIndices::const_iterator it = m_variableIndices.find(svar);
   if (it == m_variableIndices.end()) {
     int i = m_variableIndices.size();
-    m_variableIndices[svar].set(svar, i);
+    VariableIndices::iterator nit =
+      m_variableIndices.insert(make_pair(svar, VariableIndex())).first;
+    nit->second.set(svar, i);
+    m_variableLookup[nit->first.c_str()] = &*nit;
+    if (nit->second.superGlobal() != VariableIndex::Normal) {
+      m_superGlobals.push_back(&*nit);
+    }
     return i;
   }
   return it->second.idx();
@@ -90,6 +97,17 @@ const Block::VariableIndices &Block::varIndices() const {
   return m_variableIndices;
 }
 
+const VariableIndex *Block::getVariableIndex(CStrRef var) const {
+  hphp_const_char_map<const VariableIndices::value_type*>::const_iterator it =
+    m_variableLookup.find(var.data());
+  // the lookup is by C string, so names with a NUL in them need the check
+  if (it != m_variableLookup.end() &&
+      it->second->first.size() == (size_t)var.size()) {
+    return &it->second->second;
+  }
+  return NULL;
+}
+
 // PHP is insane
 Variant Block::getStaticValue(VariableEnvironment &env,
                               const char *name) const {
@@ -66,9 +66,33 @@ public:
     const;
   int declareVariable(CStrRef var);
   const VariableIndices &varIndices() const;
+
+  /**
+   * The slot of a variable the body names literally, or NULL if it can only
+   * be reached through a dynamic name.
+   */
+  const VariableIndex *getVariableIndex(CStrRef var) const;
+
+  /**
+   * Declared variables that bind to superglobals rather than a local slot.
+   */
+  const std::vector<const VariableIndices::value_type*> &superGlobals() const {
+    return m_superGlobals;
+  }
+
+  /**
+   * Set by the parser when the body reaches its locals by name: $$var,
+   * ${expr}, extract(), compact() or get_defined_vars(). Such functions keep
+   * locals in a name-keyed list; all others get one slot per variable.
+   */
+  void setDynamicVariables() { m_dynamicVariables = true; }
+  bool hasDynamicVariables() const { return m_dynamicVariables; }
 protected:
   std::map<std::string, ExpressionPtr> m_staticStmts;
   VariableIndices m_variableIndices;
+  hphp_const_char_map<const VariableIndices::value_type*> m_variableLookup;
+  std::vector<const VariableIndices::value_type*> m_superGlobals;
+  bool m_dynamicVariables;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
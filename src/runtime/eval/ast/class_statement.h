@@ -84,6 +84,9 @@ public:
     m_variables[v->name().c_str()] = v;
     m_variablesVec.push_back(v);
   }
+  const std::vector<ClassVariablePtr> &getVariables() const {
+    return m_variablesVec;
+  }
   void addMethod(MethodStatementPtr m);
   void addConstant(const std::string &name, ExpressionPtr v);
 
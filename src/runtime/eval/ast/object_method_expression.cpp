@@ -28,7 +28,8 @@ namespace Eval {
 ObjectMethodExpression::ObjectMethodExpression(EXPRESSION_ARGS,
                                                ExpressionPtr obj, NamePtr name,
                                                std::vector<ExpressionPtr> param)
-  : SimpleFunctionCallExpression(EXPRESSION_PASS, name, param), m_obj(obj) {}
+  : SimpleFunctionCallExpression(EXPRESSION_PASS, name, param), m_obj(obj),
+    m_cacheable(!name->getStatic().isNull()) {}
 
 Variant ObjectMethodExpression::eval(VariableEnvironment &env) const {
   String name(m_name->get(env));
@@ -39,26 +40,38 @@ Variant ObjectMethodExpression::eval(VariableEnvironment &env) const {
   }
   EvalFrameInjection::EvalStaticClassNameHelper helper(obj.toObject());
 
+  ObjectData *od = obj.getObjectData();
   Variant cobj(env.currentObject());
+  const ClassStatement *cls = NULL;
+  if (cobj.is(KindOfObject) && od == cobj.getObjectData()) {
+    cls = env.currentClassStatement();
+  }
+  // Resolution only depends on the receiver's class and, for calls on
+  // $this, the calling class, so a constant method name can be cached
+  InlineCache *ic =
+    m_cacheable ? &RequestEvalState::getInlineCache(this) : NULL;
+  const void *cached;
   const MethodStatement *ms = NULL;
-  if (cobj.is(KindOfObject) && obj.getObjectData() == cobj.getObjectData()) {
-    // Have to try current class first for private method
-    const ClassStatement *cls = env.currentClassStatement();
+  if (ic && ic->find("method", od->o_getClassName(), cls, cached)) {
+    ms = (const MethodStatement *)cached;
+  } else {
     if (cls) {
+      // Have to try current class first for private method
       const MethodStatement *ccms = cls->findMethod(name.c_str());
       if (ccms && ccms->getModifiers() & ClassStatement::Private) {
         ms = ccms;
       }
     }
-  }
-  if (!ms) {
-    ms = obj.getObjectData()->getMethodStatement(name.data());
+    if (!ms) {
+      ms = od->getMethodStatement(name.data());
+    }
+    if (ic) ic->add(od->o_getClassName(), cls, ms);
   }
   SET_LINE;
   if (ms) {
     return ref(ms->invokeInstanceDirect(toObject(obj), env, this));
   }
-  return ref(obj.getObjectData()->o_invoke_from_eval(name.data(), env, this,
+  return ref(od->o_invoke_from_eval(name.data(), env, this,
                                                      m_name->hashLwr(), true));
 }
 
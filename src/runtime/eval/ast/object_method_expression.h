@@ -34,6 +34,7 @@ public:
   virtual void dump() const;
 private:
   ExpressionPtr m_obj;
+  bool m_cacheable;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
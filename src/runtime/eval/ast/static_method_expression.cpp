@@ -30,7 +30,8 @@ StaticMethodExpression::
 StaticMethodExpression(EXPRESSION_ARGS, const NamePtr &cname,
     const NamePtr &name, const vector<ExpressionPtr> &params) :
   SimpleFunctionCallExpression(EXPRESSION_PASS, name, params), m_cname(cname),
-  m_construct(name->getStatic() == "__construct") {}
+  m_construct(name->getStatic() == "__construct"),
+  m_cacheable(!cname->getStatic().isNull() && !name->getStatic().isNull()) {}
 
 Variant StaticMethodExpression::eval(VariableEnvironment &env) const {
   SET_LINE;
@@ -45,10 +46,20 @@ Variant StaticMethodExpression::eval(VariableEnvironment &env) const {
   Object co;
   if (!vco.isNull()) co = vco.toObject();
   bool withinClass = !co.isNull() && co->o_instanceof(cname.data());
-  bool foundClass;
-  const MethodStatement *ms = RequestEvalState::findMethod(cname.data(),
-                                                           name.data(),
-                                                           foundClass);
+  // With both names constant, a method once found stays the same for the
+  // rest of the request. Misses are not cached since the class may not be
+  // declared yet, or may be a builtin.
+  InlineCache *ic =
+    m_cacheable ? &RequestEvalState::getInlineCache(this) : NULL;
+  const void *cached;
+  const MethodStatement *ms;
+  if (ic && ic->find("static", NULL, NULL, cached)) {
+    ms = (const MethodStatement *)cached;
+  } else {
+    bool foundClass;
+    ms = RequestEvalState::findMethod(cname.data(), name.data(), foundClass);
+    if (ic && ms) ic->add(NULL, NULL, ms);
+  }
   if (withinClass) {
     if (m_construct) {
       String name = cname;
@@ -35,6 +35,7 @@ public:
 protected:
   NamePtr m_cname;
   bool m_construct;
+  bool m_cacheable;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -313,11 +313,13 @@ ExpressionPtr Parser::getDynamicVariable(ExpressionPtr exp, bool encap) {
     }
   } else {
     n = Name::fromExp(this, exp);
+    if (haveFunc()) peekFunc()->setDynamicVariables();
   }
   return NEW_EXP(Variable, n);
 }
 
 ExpressionPtr Parser::createDynamicVariable(ExpressionPtr exp) {
+  if (haveFunc()) peekFunc()->setDynamicVariables();
   return NEW_EXP(Variable, Name::fromExp(this, exp));
 }
 
@@ -347,6 +349,12 @@ void Parser::onCall(Token &out, bool dynamic, Token &name, Token &params,
        (s == "func_get_arg")) {
       m_hasCallToGetArgs = true;
     }
+    if (haveFunc() && !className &&
+        (strcasecmp(s.c_str(), "extract") == 0 ||
+         strcasecmp(s.c_str(), "compact") == 0 ||
+         strcasecmp(s.c_str(), "get_defined_vars") == 0)) {
+      peekFunc()->setDynamicVariables();
+    }
   }
   if (className) {
     NamePtr cn = procStaticClassName(*className, false);
@@ -1029,6 +1037,7 @@ void Parser::onGlobalVar(Token &out, Token *exprs, Token &expr) {
     break;
   case 1:
     names.push_back(Name::fromExp(this, expr->exp()));
+    if (haveFunc()) peekFunc()->setDynamicVariables();
     break;
   default:
     ASSERT(false);
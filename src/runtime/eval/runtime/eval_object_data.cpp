@@ -136,7 +136,7 @@ Variant EvalObjectData::o_get(CStrRef s, int64 hash, bool error /* = true */,
     return priv.rvalAt(s);
   }
   int mods;
-  if (!m_cls.getClass()->attemptPropertyAccess(s, context, mods)) {
+  if (!m_cls.attemptPropertyAccess(s, context, mods)) {
     const MethodStatement *ms = getMethodStatement("__get");
     if (ms) {
       return doGet(s, false);
@@ -168,7 +168,7 @@ Variant &EvalObjectData::o_lval(CStrRef s, int64 hash,
     }
   }
   int mods;
-  if (!m_cls.getClass()->attemptPropertyAccess(s, context, mods)) {
+  if (!m_cls.attemptPropertyAccess(s, context, mods)) {
     m_cls.getClass()->failPropertyAccess(s, context, mods);
   }
   return DynamicObjectData::o_lval(s, hash, context);
@@ -186,7 +186,7 @@ Variant EvalObjectData::o_set(CStrRef s, int64 hash, CVarRef v,
     }
   }
   int mods;
-  if (!forInit && !m_cls.getClass()->attemptPropertyAccess(s, context, mods)) {
+  if (!forInit && !m_cls.attemptPropertyAccess(s, context, mods)) {
     const MethodStatement *ms = getMethodStatement("__set");
     if (ms) {
       return t___set(s, v);
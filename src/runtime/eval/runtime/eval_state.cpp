@@ -63,6 +63,48 @@ void ClassEvalState::initializeStatics() {
   }
 }
 
+bool ClassEvalState::attemptPropertyAccess(CStrRef prop, const char *context,
+                                           int &mods) {
+  if (!m_initializedProperties) {
+    if (InlineCache::StatsEnabled()) InlineCache::LogStats("prop", false);
+    initializeProperties();
+  } else if (InlineCache::StatsEnabled()) {
+    InlineCache::LogStats("prop", true);
+  }
+  hphp_const_char_imap<PropertySlot>::const_iterator it =
+    m_propertyTable.find(prop.data());
+  if (it == m_propertyTable.end()) {
+    // Var doesn't exist
+    return true;
+  }
+  const PropertySlot &slot = it->second;
+  mods = slot.mods;
+  if (!slot.cls) return true;
+  ClassStatement::Modifier level = ClassStatement::Public;
+  if (mods & ClassStatement::Private) level = ClassStatement::Private;
+  else if (mods & ClassStatement::Protected) level = ClassStatement::Protected;
+  return slot.cls->hasAccess(context, level);
+}
+
+void ClassEvalState::initializeProperties() {
+  // The nearest declaration wins, as in ClassStatement::attemptPropertyAccess
+  for (const ClassStatement *cls = m_class; cls;
+       cls = cls->parentStatement()) {
+    const vector<ClassVariablePtr> &vars = cls->getVariables();
+    for (unsigned int i = 0; i < vars.size(); i++) {
+      const ClassVariable *cv = vars[i].get();
+      const char *name = cv->name().c_str();
+      if (m_propertyTable.find(name) != m_propertyTable.end()) continue;
+      PropertySlot &slot = m_propertyTable[name];
+      slot.mods = cv->getModifiers();
+      // Var is private in superclass, treat as new
+      slot.cls = (cls != m_class && (slot.mods & ClassStatement::Private)) ?
+        NULL : cls;
+    }
+  }
+  m_initializedProperties = true;
+}
+
 void ClassEvalState::semanticCheck() {
   if (!m_doneSemanticCheck) {
     m_class->semanticCheck(NULL);
@@ -100,6 +142,7 @@ void RequestEvalState::reset() {
   }
   m_codeContainers.clear();
   m_evaledFiles.clear();
+  m_inlineCaches.clear();
 }
 
 void RequestEvalState::DestructObjects() {
@@ -122,6 +165,10 @@ void RequestEvalState::destructObjects() {
   }
 }
 
+InlineCache &RequestEvalState::getInlineCache(const Construct *site) {
+  return s_res->m_inlineCaches[site];
+}
+
 void RequestEvalState::addCodeContainer(CodeContainer *cc) {
   RequestEvalState *self = s_res.get();
   self->m_codeContainers.push_back(cc);
@@ -20,6 +20,7 @@
 #include <runtime/eval/base/eval_base.h>
 #include <runtime/base/class_info.h>
 #include <runtime/eval/runtime/variant_stack.h>
+#include <runtime/eval/runtime/inline_cache.h>
 #include <util/case_insensitive.h>
 
 namespace HPHP {
@@ -30,6 +31,7 @@ DECLARE_AST_PTR(ClassStatement);
 DECLARE_AST_PTR(FunctionStatement);
 DECLARE_AST_PTR(MethodStatement);
 DECLARE_AST_PTR(Statement);
+class Construct;
 class PhpFile;
 class Function;
 class EvalObjectData;
@@ -39,7 +41,8 @@ public:
   ClassEvalState() : m_constructor(NULL),
                      m_initializedInstance(false),
                      m_initializedStatics(false),
-                     m_doneSemanticCheck(false)
+                     m_doneSemanticCheck(false),
+                     m_initializedProperties(false)
   {}
   void init(const ClassStatement *cls);
   const ClassStatement *getClass() const {
@@ -58,14 +61,34 @@ public:
   void initializeInstance();
   void initializeStatics();
   void semanticCheck();
+
+  /**
+   * Same answer as ClassStatement::attemptPropertyAccess(), but resolved
+   * against a table of every declared property in the hierarchy that is
+   * flattened on first use, instead of walking the parent chain each time.
+   */
+  bool attemptPropertyAccess(CStrRef prop, const char *context, int &mods);
 private:
+  /**
+   * Where a property name resolves to. cls is NULL when the nearest
+   * declaration is a superclass private, which the object treats as new.
+   */
+  struct PropertySlot {
+    const ClassStatement *cls;
+    int mods;
+  };
+
   const ClassStatement *m_class;
   hphp_const_char_imap<const MethodStatement*> m_methodTable;
+  hphp_const_char_imap<PropertySlot> m_propertyTable;
   const MethodStatement *m_constructor;
   LVariableTable m_statics;
   bool m_initializedInstance;
   bool m_initializedStatics;
   bool m_doneSemanticCheck;
+  bool m_initializedProperties;
+
+  void initializeProperties();
 };
 
 /**
@@ -149,6 +172,11 @@ public:
   static VariantStack &argStack();
   static VariantStack &bytecodeStack();
 
+  /**
+   * The inline cache of one AST node for the current request.
+   */
+  static InlineCache &getInlineCache(const Construct *site);
+
   static void registerObject(EvalObjectData *obj);
   static void deregisterObject(EvalObjectData *obj);
 private:
@@ -169,6 +197,8 @@ private:
   int64 m_ids;
   VariantStack m_argStack;
   VariantStack m_bytecodeStack;
+  hphp_hash_map<const Construct*, InlineCache, pointer_hash<Construct> >
+    m_inlineCaches;
   void reset();
   void destructObjects();
 };
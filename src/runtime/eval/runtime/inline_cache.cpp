@@ -0,0 +1,39 @@
+/*
+   +----------------------------------------------------------------------+
+   | HipHop for PHP                                                       |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2010 Facebook, Inc. (http://www.facebook.com)          |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 3.01 of the PHP license,      |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available through the world-wide-web at the following url:           |
+   | http://www.php.net/license/3_01.txt                                  |
+   | If you did not receive a copy of the PHP license and are unable to   |
+   | obtain it through the world-wide-web, please send a note to          |
+   | license@php.net so we can mail you a copy immediately.               |
+   +----------------------------------------------------------------------+
+*/
+
+#include <runtime/eval/runtime/inline_cache.h>
+#include <runtime/base/runtime_option.h>
+#include <runtime/base/server/server_stats.h>
+
+namespace HPHP {
+namespace Eval {
+using namespace std;
+///////////////////////////////////////////////////////////////////////////////
+
+bool InlineCache::StatsEnabled() {
+  return RuntimeOption::EnableStats && RuntimeOption::EnableEvalStats;
+}
+
+void InlineCache::LogStats(const char *kind, bool hit) {
+  string name("eval.ic.");
+  name += kind;
+  name += hit ? ".hit" : ".miss";
+  ServerStats::Log(name, 1);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+}
+}
@@ -0,0 +1,87 @@
+/*
+   +----------------------------------------------------------------------+
+   | HipHop for PHP                                                       |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2010 Facebook, Inc. (http://www.facebook.com)          |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 3.01 of the PHP license,      |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available through the world-wide-web at the following url:           |
+   | http://www.php.net/license/3_01.txt                                  |
+   | If you did not receive a copy of the PHP license and are unable to   |
+   | obtain it through the world-wide-web, please send a note to          |
+   | license@php.net so we can mail you a copy immediately.               |
+   +----------------------------------------------------------------------+
+*/
+
+#ifndef __EVAL_RUNTIME_INLINE_CACHE_H__
+#define __EVAL_RUNTIME_INLINE_CACHE_H__
+
+#include <runtime/eval/base/eval_base.h>
+
+namespace HPHP {
+namespace Eval {
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * A polymorphic inline cache for one call site. Entries map a receiver
+ * identity (normally the class name pointer of the object, which is unique
+ * per declared class) plus a context to whatever the site resolved last
+ * time. Once MaxEntries receivers have been seen the site is megamorphic
+ * and further receivers always take the slow path.
+ *
+ * AST nodes are shared by all requests, so caches are never stored on the
+ * nodes themselves: RequestEvalState hands them out per request and drops
+ * them in reset(), together with the classes they point to.
+ */
+class InlineCache {
+public:
+  static const int MaxEntries = 4;
+
+  InlineCache() : m_size(0) {}
+
+  /**
+   * Looks up (key, context). "kind" names the site for Stats.Eval, which
+   * logs eval.ic.<kind>.hit or eval.ic.<kind>.miss.
+   */
+  bool find(const char *kind, const void *key, const void *context,
+            const void *&value) const {
+    for (int i = 0; i < m_size; i++) {
+      const Entry &e = m_entries[i];
+      if (e.key == key && e.context == context) {
+        value = e.value;
+        if (StatsEnabled()) LogStats(kind, true);
+        return true;
+      }
+    }
+    if (StatsEnabled()) LogStats(kind, false);
+    return false;
+  }
+
+  void add(const void *key, const void *context, const void *value) {
+    if (m_size < MaxEntries) {
+      Entry &e = m_entries[m_size++];
+      e.key = key;
+      e.context = context;
+      e.value = value;
+    }
+  }
+
+  static bool StatsEnabled();
+  static void LogStats(const char *kind, bool hit);
+
+private:
+  struct Entry {
+    const void *key;
+    const void *context;
+    const void *value;
+  };
+  Entry m_entries[MaxEntries];
+  int m_size;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+}
+}
+
+#endif /* __EVAL_RUNTIME_INLINE_CACHE_H__ */
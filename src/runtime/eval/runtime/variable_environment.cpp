@@ -147,6 +147,24 @@ FuncScopeVariableEnvironment(const FunctionStatement *func, int argc)
 
   const Block::VariableIndices &vi = func->varIndices();
   m_byIdx.resize(vi.size());
+  if (!func->hasDynamicVariables()) {
+    m_slots.resize(vi.size());
+    for (unsigned int i = 0; i < m_slots.size(); i++) {
+      m_byIdx[i] = &m_slots[i];
+    }
+    const vector<const Block::VariableIndices::value_type*> &sgs =
+      func->superGlobals();
+    for (unsigned int i = 0; i < sgs.size(); i++) {
+      const VariableIndex &v = sgs[i]->second;
+      if (v.superGlobal() == VariableIndex::Globals) {
+        m_slots[v.idx()] = get_global_array_wrapper();
+      } else {
+        m_byIdx[v.idx()] = &get_globals()->get(String(sgs[i]->first.c_str(),
+              sgs[i]->first.size(), AttachLiteral), v.hash());
+      }
+    }
+    return;
+  }
   Globals *g = NULL;
   for (Block::VariableIndices::const_iterator it = vi.begin();
        it != vi.end(); ++it) {
@@ -198,10 +216,22 @@ Array FuncScopeVariableEnvironment::getParams() const {
 }
 
 bool FuncScopeVariableEnvironment::exists(const char *name, int64 hash) const {
+  if (!m_func->hasDynamicVariables()) {
+    const VariableIndex *v = m_func->getVariableIndex(name);
+    if (v) {
+      // superglobals never made it into the list
+      return v->superGlobal() == VariableIndex::Normal ||
+        v->superGlobal() == VariableIndex::Globals;
+    }
+  }
   return m_alist.exists(name);
   //return LVariableTable::exists(name, hash);
 }
 Variant &FuncScopeVariableEnvironment::getImpl(CStrRef s, int64 hash) {
+  if (!m_func->hasDynamicVariables()) {
+    const VariableIndex *v = m_func->getVariableIndex(s);
+    if (v) return *m_byIdx[v->idx()];
+  }
   {
     Variant *v = m_alist.getPtr(s);
     if (v) return *v;
@@ -219,7 +249,26 @@ Variant &FuncScopeVariableEnvironment::getImpl(CStrRef s, int64 hash) {
 }
 
 Array FuncScopeVariableEnvironment::getDefinedVariables() const {
-  return m_alist.toArray();
+  Array ret = m_alist.toArray();
+  if (!m_func->hasDynamicVariables()) {
+    // Same order as when the slots were list entries, prepended by name
+    // ahead of anything added later
+    const Block::VariableIndices &vi = m_func->varIndices();
+    for (Block::VariableIndices::const_reverse_iterator it = vi.rbegin();
+         it != vi.rend(); ++it) {
+      const VariableIndex &v = it->second;
+      if (v.superGlobal() != VariableIndex::Normal &&
+          v.superGlobal() != VariableIndex::Globals) {
+        continue;
+      }
+      const Variant &val = m_slots[v.idx()];
+      if (val.isInitialized()) {
+        ret.set(String(it->first.c_str(), it->first.size(), AttachLiteral),
+                val);
+      }
+    }
+  }
+  return ret;
 }
 
 MethScopeVariableEnvironment::
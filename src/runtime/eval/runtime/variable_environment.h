@@ -99,6 +99,10 @@ public:
 
 /**
  * Used by functions and methods. Pass in an env for statics.
+ *
+ * Locals live in slots numbered by the parser, and lookups by name go
+ * through the function's name -> slot table. Functions that reach their
+ * locals by dynamic names keep them all in the AssocList instead.
  */
 class FuncScopeVariableEnvironment : public VariableEnvironment {
 public:
@@ -117,6 +121,7 @@ private:
   const FunctionStatement *m_func;
   LVariableTable *m_staticEnv;
   std::vector<Variant*> m_byIdx;
+  std::vector<Variant> m_slots;
   AssocList m_alist;
   int m_argc;
   uint m_argStart;
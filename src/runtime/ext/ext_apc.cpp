@@ -19,9 +19,15 @@
 #include <runtime/ext/ext_variable.h>
 #include <runtime/ext/ext_fb.h>
 #include <runtime/base/runtime_option.h>
+#include <runtime/base/util/string_buffer.h>
 #include <util/async_job.h>
 #include <util/timer.h>
+#include <util/logger.h>
+#include <util/util.h>
 #include <dlfcn.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <runtime/base/program_functions.h>
 #include <runtime/base/builtin_functions.h>
 
@@ -213,16 +219,9 @@ public:
   void onThreadExit() {}
 };
 
-void apc_load(int thread) {
-  static void *handle = NULL;
-  if (handle ||
-      RuntimeOption::ApcPrimeLibrary.empty() ||
-      !RuntimeOption::EnableApc) {
-    return;
-  }
-
+static void apc_load_library(int thread) {
   Timer timer(Timer::WallTime, "loading APC data");
-  handle = dlopen(RuntimeOption::ApcPrimeLibrary.c_str(), RTLD_LAZY);
+  void *handle = dlopen(RuntimeOption::ApcPrimeLibrary.c_str(), RTLD_LAZY);
   if (!handle) {
     throw Exception("Unable to open apc prime library %s: %s",
                     RuntimeOption::ApcPrimeLibrary.c_str(), dlerror());
@@ -241,14 +240,32 @@ void apc_load(int thread) {
     JobDispatcher<ApcLoadJob, ApcLoadWorker>(jobs, thread).run();
   }
 
+  // We've copied all the data out, so close it out.
+  dlclose(handle);
+}
+
+void apc_load(int thread) {
+  static bool loaded = false;
+  if (loaded || !RuntimeOption::EnableApc ||
+      (RuntimeOption::ApcPrimeLibrary.empty() &&
+       RuntimeOption::ApcSnapshotFile.empty())) {
+    return;
+  }
+
+  if (!RuntimeOption::ApcPrimeLibrary.empty()) {
+    apc_load_library(thread);
+  }
+  // primed items win over snapshot ones, so the snapshot goes second
+  if (!RuntimeOption::ApcSnapshotFile.empty()) {
+    apc_load_snapshot(RuntimeOption::ApcSnapshotFile, thread);
+  }
+  loaded = true;
+
   for (set<string>::const_iterator iter =
          RuntimeOption::ApcCompletionKeys.begin();
        iter != RuntimeOption::ApcCompletionKeys.end(); ++iter) {
     f_apc_store(String(*iter), 1);
   }
-
-  // We've copied all the data out, so close it out.
-  dlclose(handle);
 }
 
 static int count_items(const char **p, int step) {
@@ -374,6 +391,262 @@ void apc_load_impl(const char **int_keys, int64 *int_values,
   }
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// APC snapshots
+//
+// A snapshot file is a header followed by entries, numbers in host order:
+//
+//   header: "HPHPAPC" magic, int32 format version, int32 entry count
+//   entry:  int8 kind, int32 key length, int32 value length, int64 expiry,
+//           key, '\0', value, '\0'
+//
+// Keys and values are NUL terminated so they can be used in place from the
+// mapped file. String values are saved as they are, everything else as
+// serialize() output.
+
+#define APC_SNAPSHOT_VERSION 1
+#define APC_SNAPSHOT_ENTRY_HEADER_SIZE 17
+#define APC_SNAPSHOT_ITEMS_PER_JOB 4096
+
+static const char APC_SNAPSHOT_MAGIC[8] = "HPHPAPC";
+
+enum ApcSnapshotKind {
+  ApcSnapshotString,
+  ApcSnapshotSerialized,
+};
+
+struct ApcSnapshotHeader {
+  char magic[8];
+  int32 version;
+  int32 count;
+};
+
+static bool write_snapshot_entry(FILE *f, char kind, const std::string &key,
+                                 CStrRef value, int64 expiry) {
+  char header[APC_SNAPSHOT_ENTRY_HEADER_SIZE];
+  int32 klen = key.size();
+  int32 vlen = value.size();
+  header[0] = kind;
+  memcpy(header + 1, &klen, sizeof(klen));
+  memcpy(header + 5, &vlen, sizeof(vlen));
+  memcpy(header + 9, &expiry, sizeof(expiry));
+  return fwrite(header, sizeof(header), 1, f) == 1 &&
+    fwrite(key.c_str(), klen + 1, 1, f) == 1 &&
+    (vlen == 0 || fwrite(value.data(), vlen, 1, f) == 1) &&
+    fputc('\0', f) != EOF;
+}
+
+bool apc_dump_snapshot(const std::string &filename) {
+  if (filename.empty() || !RuntimeOption::EnableApc) return false;
+
+  Timer timer(Timer::WallTime);
+  vector<SharedStore::SnapshotEntry> entries;
+  s_apc_store[SHARED_STORE_APPLICATION_CACHE].snapshot(entries);
+
+  // write next to the old snapshot and swap it in only when complete
+  string tmpfile = filename + ".tmp";
+  FILE *f = fopen(tmpfile.c_str(), "w");
+  bool ok = f != NULL;
+  ApcSnapshotHeader header;
+  memcpy(header.magic, APC_SNAPSHOT_MAGIC, sizeof(header.magic));
+  header.version = APC_SNAPSHOT_VERSION;
+  header.count = 0;
+  if (ok) {
+    ok = fwrite(&header, sizeof(header), 1, f) == 1;
+  }
+  // Values are written from their stored form. Making them request-local
+  // would run __sleep() and the autoloader on a thread without a request.
+  int skipped = 0;
+  for (unsigned int i = 0; i < entries.size(); i++) {
+    SharedStore::SnapshotEntry &entry = entries[i];
+    if (ok) {
+      if (entry.value->is(KindOfString)) {
+        String value(entry.value->stringData(), entry.value->stringLength(),
+                     AttachLiteral);
+        ok = write_snapshot_entry(f, ApcSnapshotString, entry.key, value,
+                                  entry.expiry);
+        header.count++;
+      } else {
+        StringBuffer value;
+        if (entry.value->serialize(value)) {
+          ok = write_snapshot_entry(f, ApcSnapshotSerialized, entry.key,
+                                    value.detach(), entry.expiry);
+          header.count++;
+        } else {
+          skipped++;
+        }
+      }
+    }
+    entry.value->decRef();
+  }
+  if (ok) {
+    ok = fseek(f, 0, SEEK_SET) == 0 &&
+      fwrite(&header, sizeof(header), 1, f) == 1 &&
+      fseek(f, 0, SEEK_END) == 0;
+  }
+  if (f) {
+    long size = ftell(f);
+    ok = fclose(f) == 0 && ok;
+    if (ok && rename(tmpfile.c_str(), filename.c_str()) == 0) {
+      Logger::Info("saved %d APC items (%ld bytes) to %s in %lld ms, "
+                   "skipped %d", header.count, size, filename.c_str(),
+                   timer.getMicroSeconds() / 1000, skipped);
+      return true;
+    }
+    unlink(tmpfile.c_str());
+  }
+  Logger::Error("Unable to save APC snapshot to %s: %s", filename.c_str(),
+                Util::safe_strerror(errno).c_str());
+  return false;
+}
+
+DECLARE_BOOST_TYPES(ApcSnapshotJob);
+class ApcSnapshotJob {
+public:
+  ApcSnapshotJob(const char *begin, const char *end)
+    : m_begin(begin), m_end(end), m_loaded(0), m_expired(0), m_existing(0),
+      m_failed(0) {}
+  const char *m_begin;
+  const char *m_end;
+  int m_loaded;
+  int m_expired;
+  int m_existing;
+  int m_failed;
+};
+
+class ApcSnapshotWorker {
+public:
+  void onThreadEnter() {}
+  void doJob(ApcSnapshotJobPtr job) {
+    SharedStore &s = s_apc_store[SHARED_STORE_APPLICATION_CACHE];
+    int64 now = time(NULL);
+    for (const char *p = job->m_begin; p < job->m_end; ) {
+      char kind = *p;
+      int32 klen, vlen;
+      int64 expiry;
+      memcpy(&klen, p + 1, sizeof(klen));
+      memcpy(&vlen, p + 5, sizeof(vlen));
+      memcpy(&expiry, p + 9, sizeof(expiry));
+      const char *key = p + APC_SNAPSHOT_ENTRY_HEADER_SIZE;
+      const char *value = key + klen + 1;
+      p = value + vlen + 1;
+
+      if (expiry && expiry <= now) {
+        job->m_expired++;
+        continue;
+      }
+      String k(key, klen, AttachLiteral);
+      String v(value, vlen, AttachLiteral);
+      bool stored;
+      if (kind == ApcSnapshotString) {
+        stored = s.store(k, v, expiry ? expiry - now : 0, false);
+      } else {
+        Variant var = f_unserialize(v);
+        if (same(var, false) && v != "b:0;") {
+          job->m_failed++;
+          continue;
+        }
+        stored = s.store(k, var, expiry ? expiry - now : 0, false);
+      }
+      if (stored) {
+        job->m_loaded++;
+      } else {
+        job->m_existing++;
+      }
+    }
+  }
+  void onThreadExit() {}
+};
+
+/**
+ * Walks entry headers only, cutting the file into jobs. Returns false if the
+ * entries don't add up to the file size.
+ */
+static bool split_snapshot(const char *p, const char *end, int count,
+                           ApcSnapshotJobPtrVec &jobs) {
+  const char *begin = p;
+  for (int i = 0; i < count; i++) {
+    if (end - p < APC_SNAPSHOT_ENTRY_HEADER_SIZE) return false;
+    int32 klen, vlen;
+    memcpy(&klen, p + 1, sizeof(klen));
+    memcpy(&vlen, p + 5, sizeof(vlen));
+    if (klen < 0 || vlen < 0 ||
+        end - p - APC_SNAPSHOT_ENTRY_HEADER_SIZE < (int64)klen + vlen + 2) {
+      return false;
+    }
+    p += APC_SNAPSHOT_ENTRY_HEADER_SIZE + klen + vlen + 2;
+    if ((i + 1) % APC_SNAPSHOT_ITEMS_PER_JOB == 0 || i + 1 == count) {
+      jobs.push_back(ApcSnapshotJobPtr(new ApcSnapshotJob(begin, p)));
+      begin = p;
+    }
+  }
+  return p == end;
+}
+
+void apc_load_snapshot(const std::string &filename, int thread) {
+  Timer timer(Timer::WallTime);
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    Logger::Info("no APC snapshot to load from %s", filename.c_str());
+    return;
+  }
+  struct stat sb;
+  void *data = MAP_FAILED;
+  if (fstat(fd, &sb) == 0 && sb.st_size >= (off_t)sizeof(ApcSnapshotHeader)) {
+    data = mmap(NULL, sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  close(fd);
+  if (data == MAP_FAILED) {
+    Logger::Warning("Unable to read APC snapshot %s", filename.c_str());
+    return;
+  }
+
+  const char *begin = (const char *)data;
+  const char *end = begin + sb.st_size;
+  ApcSnapshotHeader header;
+  memcpy(&header, begin, sizeof(header));
+  ApcSnapshotJobPtrVec jobs;
+  if (memcmp(header.magic, APC_SNAPSHOT_MAGIC, sizeof(header.magic)) ||
+      header.version != APC_SNAPSHOT_VERSION) {
+    Logger::Warning("Ignoring APC snapshot %s: not a version %d snapshot",
+                    filename.c_str(), APC_SNAPSHOT_VERSION);
+  } else if (!split_snapshot(begin + sizeof(header), end, header.count,
+                             jobs)) {
+    Logger::Warning("Ignoring APC snapshot %s: file is truncated or corrupt",
+                    filename.c_str());
+    jobs.clear();
+  } else if (thread <= 1 || jobs.size() <= 1) {
+    ApcSnapshotWorker worker;
+    for (unsigned int i = 0; i < jobs.size(); i++) {
+      worker.doJob(jobs[i]);
+    }
+  } else {
+    JobDispatcher<ApcSnapshotJob, ApcSnapshotWorker>(jobs, thread).run();
+  }
+  munmap(data, sb.st_size);
+  if (jobs.empty()) return;
+
+  int loaded = 0, expired = 0, existing = 0, failed = 0;
+  for (unsigned int i = 0; i < jobs.size(); i++) {
+    loaded += jobs[i]->m_loaded;
+    expired += jobs[i]->m_expired;
+    existing += jobs[i]->m_existing;
+    failed += jobs[i]->m_failed;
+  }
+
+  int64 us = timer.getMicroSeconds();
+  double seconds = us > 0 ? us / 1000000.0 : 1e-6;
+  Logger::Info("loaded %d APC items from %s in %lld ms "
+               "(%.1f MB/s, %.0f items/s); skipped %d expired, "
+               "%d existing, %d unreadable",
+               loaded, filename.c_str(), us / 1000,
+               sb.st_size / seconds / (1024 * 1024),
+               (loaded + expired + existing + failed) / seconds,
+               expired, existing, failed);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 static double my_time() {
   struct timeval a;
   double t;
@@ -80,6 +80,10 @@ inline bool f_apc_bin_loadfile(CStrRef filename, CObjRef context = null,
 
 void apc_load(int thread);
 
+// saving the application cache to a snapshot file and loading it back
+bool apc_dump_snapshot(const std::string &filename);
+void apc_load_snapshot(const std::string &filename, int thread);
+
 // needed by generated apc archive .cpp files
 void apc_load_impl(const char **int_keys, int64 *int_values,
                    const char **char_keys, char *char_values,
@@ -920,6 +920,47 @@ private:
 };
 IMPLEMENT_STATIC_REQUEST_LOCAL(Collator, s_collator);
 
+static bool all_scalars(CArrRef arr) {
+  for (ArrayIter iter(arr); iter; ++iter) {
+    DataType type = iter.secondRef().getType();
+    if (type == KindOfObject || type == KindOfArray) return false;
+  }
+  return true;
+}
+
+/**
+ * Takes the array out of the variable being sorted, so unless somebody else
+ * shares it, sorting relinks it in place instead of working on a copy. That
+ * is only done when comparing can't run user code, which would find the
+ * variable null: for keys, or values that are all scalars. If sorting still
+ * throws, the variable gets its array back.
+ */
+class TakenArray {
+public:
+  TakenArray(Variant &var, bool byKey)
+    : m_var(var), m_array(var.toArray()), m_taken(false) {
+    if (byKey || all_scalars(m_array)) {
+      m_var.setNull();
+      m_taken = true;
+    }
+  }
+  ~TakenArray() {
+    if (m_taken) m_var = m_array;
+  }
+
+  Array *operator->() { return &m_array;}
+
+  void put() {
+    m_var = m_array;
+    m_taken = false;
+  }
+
+private:
+  Variant &m_var;
+  Array m_array;
+  bool m_taken;
+};
+
 static Array::PFUNC_CMP get_cmp_func(int sort_flags, bool ascending) {
   switch (sort_flags) {
   case SORT_NUMERIC:
@@ -951,9 +992,9 @@ bool f_sort(Variant array, int sort_flags /* = 0 */,
       return collator_sort(array, sort_flags, true, coll, &errcode);
     }
   }
-  Array temp = array.toArray();
-  temp.sort(get_cmp_func(sort_flags, true), false, true);
-  array = temp;
+  TakenArray temp(array, false);
+  temp->sort(get_cmp_func(sort_flags, true), false, true);
+  temp.put();
   return true;
 }
 
@@ -970,9 +1011,9 @@ bool f_rsort(Variant array, int sort_flags /* = 0 */,
       return collator_sort(array, sort_flags, false, coll, &errcode);
     }
   }
-  Array temp = array.toArray();
-  temp.sort(get_cmp_func(sort_flags, false), false, true);
-  array = temp;
+  TakenArray temp(array, false);
+  temp->sort(get_cmp_func(sort_flags, false), false, true);
+  temp.put();
   return true;
 }
 
@@ -989,9 +1030,9 @@ bool f_asort(Variant array, int sort_flags /* = 0 */,
       return collator_asort(array, sort_flags, true, coll, &errcode);
     }
   }
-  Array temp = array.toArray();
-  temp.sort(get_cmp_func(sort_flags, true), false, false);
-  array = temp;
+  TakenArray temp(array, false);
+  temp->sort(get_cmp_func(sort_flags, true), false, false);
+  temp.put();
   return true;
 }
 
@@ -1008,9 +1049,9 @@ bool f_arsort(Variant array, int sort_flags /* = 0 */,
       return collator_asort(array, sort_flags, false, coll, &errcode);
     }
   }
-  Array temp = array.toArray();
-  temp.sort(get_cmp_func(sort_flags, false), false, false);
-  array = temp;
+  TakenArray temp(array, false);
+  temp->sort(get_cmp_func(sort_flags, false), false, false);
+  temp.put();
   return true;
 }
 
@@ -1019,9 +1060,9 @@ bool f_ksort(Variant array, int sort_flags /* = 0 */) {
     throw_bad_array_exception(__func__);
     return false;
   }
-  Array temp = array.toArray();
-  temp.sort(get_cmp_func(sort_flags, true), true, false);
-  array = temp;
+  TakenArray temp(array, true);
+  temp->sort(get_cmp_func(sort_flags, true), true, false);
+  temp.put();
   return true;
 }
 
@@ -1030,9 +1071,9 @@ bool f_krsort(Variant array, int sort_flags /* = 0 */) {
     throw_bad_array_exception(__func__);
     return false;
   }
-  Array temp = array.toArray();
-  temp.sort(get_cmp_func(sort_flags, false), true, false);
-  array = temp;
+  TakenArray temp(array, true);
+  temp->sort(get_cmp_func(sort_flags, false), true, false);
+  temp.put();
   return true;
 }
 
@@ -1076,9 +1117,9 @@ Variant f_natsort(Variant array) {
     throw_bad_array_exception(__func__);
     return null;
   }
-  Array temp = array.toArray();
-  temp.sort(Array::SortNatural, false, false);
-  array = temp;
+  TakenArray temp(array, false);
+  temp->sort(Array::SortNatural, false, false);
+  temp.put();
   return true;
 }
 
@@ -1089,9 +1130,9 @@ Variant f_natcasesort(Variant array) {
     throw_bad_array_exception(__func__);
     return null;
   }
-  Array temp = array.toArray();
-  temp.sort(Array::SortNaturalCase, false, false);
-  array = temp;
+  TakenArray temp(array, false);
+  temp->sort(Array::SortNaturalCase, false, false);
+  temp.put();
   return true;
 }
 
@@ -1140,6 +1181,21 @@ bool f_array_multisort(int _argc, Variant ar1,
   sd.cmp_func = get_cmp_func(sort_flags, ascending);
   data.push_back(sd);
 
+  // let MultiSort() relink unshared arrays in place, unless it's going to
+  // reject them for having different sizes, or comparing them could run
+  // user code that would find the variables null, as with TakenArray
+  bool take = true;
+  for (unsigned int i = 0; i < data.size(); i++) {
+    if (data[i].array->size() != data[0].array->size() ||
+        !all_scalars(*data[i].array)) {
+      take = false;
+    }
+  }
+  if (take) {
+    for (unsigned int i = 0; i < data.size(); i++) {
+      data[i].original->setNull();
+    }
+  }
   return Array::MultiSort(data, true);
 }
 
@@ -19,6 +19,7 @@
 #include <runtime/ext/ext_function.h>
 #include <runtime/base/util/string_buffer.h>
 #include <runtime/base/util/libevent_http_client.h>
+#include <runtime/base/util/curl_pool.h>
 #include <runtime/base/runtime_option.h>
 
 using namespace std;
@@ -114,6 +115,7 @@ public:
     curl_easy_setopt(m_cp, CURLOPT_DNS_CACHE_TIMEOUT, 120);
     curl_easy_setopt(m_cp, CURLOPT_MAXREDIRS, 20); // no infinite redirects
     curl_easy_setopt(m_cp, CURLOPT_NOSIGNAL, 1); // for multithreading mode
+    CurlHandlePool::Share(m_cp);
 
     curl_easy_setopt(m_cp, CURLOPT_TIMEOUT,
                      RuntimeOption::HttpDefaultTimeout);
@@ -25,6 +25,7 @@
 #include <runtime/base/util/http_client.h>
 #include <runtime/base/util/request_local.h>
 #include <runtime/base/server/static_content_cache.h>
+#include <runtime/base/shared/file_content_cache.h>
 #include <runtime/base/zend/zend_scanf.h>
 #include <runtime/base/file/pipe.h>
 #include <util/logger.h>
@@ -306,6 +307,12 @@ Variant f_file_get_contents(CStrRef filename,
                             CObjRef context /* = null_object */,
                             int64 offset /* = 0 */,
                             int64 maxlen /* = 0 */) {
+  if (offset == 0 && maxlen == 0 && !use_include_path && context.isNull()) {
+    String content;
+    if (FileContentCache::Read(filename, content)) {
+      return content;
+    }
+  }
   Variant stream = f_fopen(filename, "rb");
   if (same(stream, false)) return false;
   return f_stream_get_contents(stream, maxlen, offset);
@@ -437,6 +444,12 @@ Variant f_file(CStrRef filename, int flags /* = 0 */,
 
 Variant f_readfile(CStrRef filename, bool use_include_path /* = false */,
                    CObjRef context /* = null_object */) {
+  String content;
+  if (!use_include_path && context.isNull() &&
+      FileContentCache::Read(filename, content)) {
+    echo(content);
+    return content.size();
+  }
   Variant f = f_fopen(filename, "rb");
   if (same(f, false)) {
     Logger::Verbose("%s/%d: %s", __FUNCTION__, __LINE__,
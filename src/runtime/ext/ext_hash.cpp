@@ -61,6 +61,7 @@ public:
     HashEngines["adler32"]    = HashEnginePtr(new hash_adler32());
     HashEngines["crc32"]      = HashEnginePtr(new hash_crc32(false));
     HashEngines["crc32b"]     = HashEnginePtr(new hash_crc32(true));
+    HashEngines["crc32c"]     = HashEnginePtr(new hash_crc32c());
     HashEngines["haval128,3"] = HashEnginePtr(new hash_haval(3,128));
     HashEngines["haval160,3"] = HashEnginePtr(new hash_haval(3,160));
     HashEngines["haval192,3"] = HashEnginePtr(new hash_haval(3,192));
@@ -17,6 +17,7 @@
 
 #include <runtime/ext/ext_fb.h>
 #include <runtime/base/memory/memory_manager.h>
+#include <runtime/base/memory/heap_profiler.h>
 #include <runtime/base/util/request_local.h>
 #include <runtime/base/zend/zend_math.h>
 
@@ -939,6 +940,31 @@ Variant f_xhprof_sample_disable() {
 #endif
 }
 
+void f_xhprof_heap_enable(int64 sample_bytes /* = 0 */) {
+  HeapProfiler::TheHeapProfiler()->enable(sample_bytes);
+}
+
+Variant f_xhprof_heap_disable() {
+  HeapProfiler::SiteMap sites;
+  if (!HeapProfiler::TheHeapProfiler()->disable(sites)) {
+    return null;
+  }
+
+  HeapProfiler::SiteVec sorted;
+  HeapProfiler::Sort(sites, sorted);
+  Array ret = Array::Create();
+  for (unsigned int i = 0; i < sorted.size(); i++) {
+    const HeapProfiler::Site &site = sorted[i].second;
+    Array arr = Array::Create();
+    arr.set("live", site.live);
+    arr.set("peak", site.peak);
+    arr.set("total", site.total);
+    arr.set("samples", site.samples);
+    ret.set(String(sorted[i].first), arr);
+  }
+  return ret;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // constants
 const int64 k_XHPROF_FLAGS_NO_BUILTINS = HierarchicalProfiler::TrackBuiltins;
@@ -727,6 +727,18 @@ void f_set_time_limit(int seconds) {
   g_context->setRequestTimeLimit(seconds);
 }
 
+void f_hphp_set_request_deadline(int64 milliseconds) {
+  TimeoutThread::SetDeadline(milliseconds);
+}
+
+void f_hphp_set_request_cpu_budget(int64 milliseconds) {
+  TimeoutThread::SetCpuBudget(milliseconds);
+}
+
+int64 f_hphp_get_request_cpu_time() {
+  return TimeoutThread::GetCpuTime();
+}
+
 String f_sys_get_temp_dir() {
   char *env = getenv("TMPDIR");
   if (env && *env) return String(env, CopyString);
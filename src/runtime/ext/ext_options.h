@@ -69,6 +69,9 @@ String f_phpversion(CStrRef extension = null_string);
 bool f_putenv(CStrRef setting);
 bool f_set_magic_quotes_runtime(bool new_setting);
 void f_set_time_limit(int seconds);
+void f_hphp_set_request_deadline(int64 milliseconds);
+void f_hphp_set_request_cpu_budget(int64 milliseconds);
+int64 f_hphp_get_request_cpu_time();
 String f_sys_get_temp_dir();
 Variant f_version_compare(CStrRef version1, CStrRef version2, CStrRef sop = null_string);
 String f_zend_logo_guid();
@@ -210,6 +210,11 @@ static void add_registered_namespaces(Array &out, xmlNodePtr node,
   }
 }
 
+Object simplexml_from_doc(xmlDocPtr doc) {
+  return create_element(Object(NEW(XmlDocWrapper)(doc)),
+                        xmlDocGetRootElement(doc), "", false);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // simplexml
 
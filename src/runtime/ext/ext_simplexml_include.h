@@ -29,4 +29,16 @@
 #include <libxml/xpointer.h>
 #include <libxml/xmlschemas.h>
 
+namespace HPHP {
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Wraps a document as a SimpleXMLElement of its root element. The element
+ * takes over the document and frees it once nothing refers to it.
+ */
+Object simplexml_from_doc(xmlDocPtr doc);
+
+///////////////////////////////////////////////////////////////////////////////
+}
+
 #endif // __EXT_SIMPLEXML_INCLUDE_H__
@@ -0,0 +1,446 @@
+/*
+   +----------------------------------------------------------------------+
+   | HipHop for PHP                                                       |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2010 Facebook, Inc. (http://www.facebook.com)          |
+   | Copyright (c) 1997-2010 The PHP Group                                |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 3.01 of the PHP license,      |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available through the world-wide-web at the following url:           |
+   | http://www.php.net/license/3_01.txt                                  |
+   | If you did not receive a copy of the PHP license and are unable to   |
+   | obtain it through the world-wide-web, please send a note to          |
+   | license@php.net so we can mail you a copy immediately.               |
+   +----------------------------------------------------------------------+
+*/
+
+#include <runtime/ext/ext_xmlreader.h>
+#include <runtime/ext/ext_simplexml.h>
+
+namespace HPHP {
+IMPLEMENT_DEFAULT_EXTENSION(xmlreader);
+///////////////////////////////////////////////////////////////////////////////
+
+const int64 q_xmlreader_NONE = XML_READER_TYPE_NONE;
+const int64 q_xmlreader_ELEMENT = XML_READER_TYPE_ELEMENT;
+const int64 q_xmlreader_ATTRIBUTE = XML_READER_TYPE_ATTRIBUTE;
+const int64 q_xmlreader_TEXT = XML_READER_TYPE_TEXT;
+const int64 q_xmlreader_CDATA = XML_READER_TYPE_CDATA;
+const int64 q_xmlreader_ENTITY_REF = XML_READER_TYPE_ENTITY_REFERENCE;
+const int64 q_xmlreader_ENTITY = XML_READER_TYPE_ENTITY;
+const int64 q_xmlreader_PI = XML_READER_TYPE_PROCESSING_INSTRUCTION;
+const int64 q_xmlreader_COMMENT = XML_READER_TYPE_COMMENT;
+const int64 q_xmlreader_DOC = XML_READER_TYPE_DOCUMENT;
+const int64 q_xmlreader_DOC_TYPE = XML_READER_TYPE_DOCUMENT_TYPE;
+const int64 q_xmlreader_DOC_FRAGMENT = XML_READER_TYPE_DOCUMENT_FRAGMENT;
+const int64 q_xmlreader_NOTATION = XML_READER_TYPE_NOTATION;
+const int64 q_xmlreader_WHITESPACE = XML_READER_TYPE_WHITESPACE;
+const int64 q_xmlreader_SIGNIFICANT_WHITESPACE =
+  XML_READER_TYPE_SIGNIFICANT_WHITESPACE;
+const int64 q_xmlreader_END_ELEMENT = XML_READER_TYPE_END_ELEMENT;
+const int64 q_xmlreader_END_ENTITY = XML_READER_TYPE_END_ENTITY;
+const int64 q_xmlreader_XML_DECLARATION = XML_READER_TYPE_XML_DECLARATION;
+const int64 q_xmlreader_LOADDTD = XML_PARSER_LOADDTD;
+const int64 q_xmlreader_DEFAULTATTRS = XML_PARSER_DEFAULTATTRS;
+const int64 q_xmlreader_VALIDATE = XML_PARSER_VALIDATE;
+const int64 q_xmlreader_SUBST_ENTITIES = XML_PARSER_SUBST_ENTITIES;
+
+///////////////////////////////////////////////////////////////////////////////
+// helpers
+
+static int read_file(void *context, char *buffer, int len) {
+  int64 ret = ((c_xmlreader*)context)->m_uri->readImpl(buffer, len);
+  return ret < 0 ? -1 : (int)ret;
+}
+
+static int close_file(void *context) {
+  return 0;
+}
+
+static const char *xmls(CStrRef s) {
+  return s.isNull() ? NULL : s.data();
+}
+
+/**
+ * Takes over a string libxml allocated for us.
+ */
+static Variant take_string(xmlChar *s) {
+  if (s == NULL) {
+    return null;
+  }
+  String ret((const char *)s, CopyString);
+  xmlFree(s);
+  return ret;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// properties
+
+struct XMLReaderProperty {
+  const char *name;
+  int (*intFunc)(xmlTextReaderPtr);
+  const xmlChar *(*charFunc)(xmlTextReaderPtr);
+  DataType type;
+};
+
+static XMLReaderProperty xmlreader_properties[] = {
+  { "attributeCount", xmlTextReaderAttributeCount,   NULL, KindOfInt64   },
+  { "baseURI",        NULL, xmlTextReaderConstBaseUri,      KindOfString  },
+  { "depth",          xmlTextReaderDepth,            NULL, KindOfInt64   },
+  { "hasAttributes",  xmlTextReaderHasAttributes,    NULL, KindOfBoolean },
+  { "hasValue",       xmlTextReaderHasValue,         NULL, KindOfBoolean },
+  { "isDefault",      xmlTextReaderIsDefault,        NULL, KindOfBoolean },
+  { "isEmptyElement", xmlTextReaderIsEmptyElement,   NULL, KindOfBoolean },
+  { "localName",      NULL, xmlTextReaderConstLocalName,    KindOfString  },
+  { "name",           NULL, xmlTextReaderConstName,         KindOfString  },
+  { "namespaceURI",   NULL, xmlTextReaderConstNamespaceUri, KindOfString  },
+  { "nodeType",       xmlTextReaderNodeType,         NULL, KindOfInt64   },
+  { "prefix",         NULL, xmlTextReaderConstPrefix,       KindOfString  },
+  { "value",          NULL, xmlTextReaderConstValue,        KindOfString  },
+  { "xmlLang",        NULL, xmlTextReaderConstXmlLang,      KindOfString  },
+  { NULL, NULL, NULL, KindOfNull }
+};
+
+static const XMLReaderProperty *find_property(CVarRef name) {
+  if (name.isString()) {
+    String s = name.toString();
+    for (XMLReaderProperty *p = xmlreader_properties; p->name; p++) {
+      if (strcmp(p->name, s.data()) == 0) {
+        return p;
+      }
+    }
+  }
+  return NULL;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+c_xmlreader::c_xmlreader() : m_ptr(NULL) {
+}
+
+c_xmlreader::~c_xmlreader() {
+  if (m_ptr) {
+    xmlFreeTextReader(m_ptr);
+  }
+}
+
+void c_xmlreader::t___construct() {
+}
+
+bool c_xmlreader::t_open(CStrRef uri, CStrRef encoding /* = null_string */,
+                         int64 options /* = 0 */) {
+  INSTANCE_METHOD_INJECTION_BUILTIN(xmlreader, xmlreader::open);
+  if (uri.empty()) {
+    raise_warning("Empty string supplied as input");
+    return false;
+  }
+  t_close();
+
+  Variant file = File::Open(uri, "rb");
+  if (same(file, false)) {
+    raise_warning("Unable to open source data");
+    return false;
+  }
+  m_uri = file.toObject().getTyped<File>();
+
+  // libxml pulls input through read_file() a chunk at a time as the caller
+  // advances, so only the current node and its ancestors are ever held in
+  // memory, however big the document is.
+  m_ptr = xmlReaderForIO(read_file, close_file, this, uri.data(),
+                         xmls(encoding), options);
+  if (m_ptr == NULL) {
+    raise_warning("Unable to open source data");
+    t_close();
+    return false;
+  }
+  return true;
+}
+
+bool c_xmlreader::t_xml(CStrRef source, CStrRef encoding /* = null_string */,
+                        int64 options /* = 0 */) {
+  INSTANCE_METHOD_INJECTION_BUILTIN(xmlreader, xmlreader::xml);
+  if (source.empty()) {
+    raise_warning("Empty string supplied as input");
+    return false;
+  }
+  t_close();
+
+  // libxml reads straight out of the string's buffer, so we hold onto it
+  m_source = source;
+  m_ptr = xmlReaderForMemory(m_source.data(), m_source.size(), NULL,
+                             xmls(encoding), options);
+  if (m_ptr == NULL) {
+    raise_warning("Unable to load source data");
+    t_close();
+    return false;
+  }
+  return true;
+}
+
+bool c_xmlreader::t_close() {
+  INSTANCE_METHOD_INJECTION_BUILTIN(xmlreader, xmlreader::close);
+  if (m_ptr) {
+    xmlFreeTextReader(m_ptr);
+    m_ptr = NULL;
+  }
+  if (!m_uri.isNull()) {
+    m_uri->close();
+    m_uri.reset();
+  }
+  m_source.reset();
+  return true;
+}
+
+bool c_xmlreader::t_read() {
+  INSTANCE_METHOD_INJECTION_BUILTIN(xmlreader, xmlreader::read);
+  if (m_ptr == NULL) {
+    raise_warning("Load Data before trying to read");
+    return false;
+  }
+  int ret = xmlTextReaderRead(m_ptr);
+  if (ret == -1) {
+    raise_warning("An Error Occured while reading");
+    return false;
+  }
+  return ret == 1;
+}
+
+bool c_xmlreader::t_next(CStrRef localname /* = null_string */) {
+  INSTANCE_METHOD_INJECTION_BUILTIN(xmlreader, xmlreader::next);
+  if (m_ptr == NULL) {
+    raise_warning("Load Data before trying to read");
+    return false;
+  }
+  // skips whole subtrees without building them
+  int ret = xmlTextReaderNext(m_ptr);
+  while (!localname.isNull() && ret == 1) {
+    if (xmlStrEqual(xmlTextReaderConstLocalName(m_ptr),
+                    (const xmlChar *)localname.data())) {
+      return true;
+    }
+    ret = xmlTextReaderNext(m_ptr);
+  }
+  if (ret == -1) {
+    raise_warning("An Error Occured while reading");
+    return false;
+  }
+  return ret == 1;
+}
+
+String c_xmlreader::t_readstring() {
+  INSTANCE_METHOD_INJECTION_BUILTIN(xmlreader, xmlreader::readstring);
+  if (m_ptr == NULL) {
+    return "";
+  }
+  return take_string(xmlTextReaderReadString(m_ptr)).toString();
+}
+
+String c_xmlreader::t_readinnerxml() {
+  INSTANCE_METHOD_INJECTION_BUILTIN(xmlreader, xmlreader::readinnerxml);
+  if (m_ptr == NULL) {
+    return "";
+  }
+  return take_string(xmlTextReaderReadInnerXml(m_ptr)).toString();
+}
+
+String c_xmlreader::t_readouterxml() {
+  INSTANCE_METHOD_INJECTION_BUILTIN(xmlreader, xmlreader::readouterxml);
+  if (m_ptr == NULL) {
+    return "";
+  }
+  return take_string(xmlTextReaderReadOuterXml(m_ptr)).toString();
+}
+
+Variant c_xmlreader::t_getattribute(CStrRef name) {
+  INSTANCE_METHOD_INJECTION_BUILTIN(xmlreader, xmlreader::getattribute);
+  if (m_ptr == NULL || name.empty()) {
+    return null;
+  }
+  return take_string(xmlTextReaderGetAttribute(m_ptr,
+                                               (const xmlChar *)name.data()));
+}
+
+Variant c_xmlreader::t_getattributeno(int64 index) {
+  INSTANCE_METHOD_INJECTION_BUILTIN(xmlreader, xmlreader::getattributeno);
+  if (m_ptr == NULL) {
+    return null;
+  }
+  return take_string(xmlTextReaderGetAttributeNo(m_ptr, index));
+}
+
+Variant c_xmlreader::t_getattributens(CStrRef localname,
+                                      CStrRef namespaceuri) {
+  INSTANCE_METHOD_INJECTION_BUILTIN(xmlreader, xmlreader::getattributens);
+  if (m_ptr == NULL || localname.empty() || namespaceuri.empty()) {
+    return null;
+  }
+  return take_string(xmlTextReaderGetAttributeNs
+                     (m_ptr, (const xmlChar *)localname.data(),
+                      (const xmlChar *)namespaceuri.data()));
+}
+
+bool c_xmlreader::t_movetoattribute(CStrRef name) {
+  INSTANCE_METHOD_INJECTION_BUILTIN(xmlreader, xmlreader::movetoattribute);
+  if (name.empty()) {
+    raise_warning("Attribute Name is required");
+    return false;
+  }
+  return m_ptr &&
+    xmlTextReaderMoveToAttribute(m_ptr, (const xmlChar *)name.data()) == 1;
+}
+
+bool c_xmlreader::t_movetoattributeno(int64 index) {
+  INSTANCE_METHOD_INJECTION_BUILTIN(xmlreader, xmlreader::movetoattributeno);
+  return m_ptr && xmlTextReaderMoveToAttributeNo(m_ptr, index) == 1;
+}
+
+bool c_xmlreader::t_movetoattributens(CStrRef localname,
+                                      CStrRef namespaceuri) {
+  INSTANCE_METHOD_INJECTION_BUILTIN(xmlreader, xmlreader::movetoattributens);
+  if (localname.empty() || namespaceuri.empty()) {
+    raise_warning("Attribute Name and Namespace URI cannot be empty");
+    return false;
+  }
+  return m_ptr &&
+    xmlTextReaderMoveToAttributeNs(m_ptr, (const xmlChar *)localname.data(),
+                                   (const xmlChar *)namespaceuri.data()) == 1;
+}
+
+bool c_xmlreader::t_movetoelement() {
+  INSTANCE_METHOD_INJECTION_BUILTIN(xmlreader, xmlreader::movetoelement);
+  return m_ptr && xmlTextReaderMoveToElement(m_ptr) == 1;
+}
+
+bool c_xmlreader::t_movetofirstattribute() {
+  INSTANCE_METHOD_INJECTION_BUILTIN(xmlreader, xmlreader::movetofirstattribute);
+  return m_ptr && xmlTextReaderMoveToFirstAttribute(m_ptr) == 1;
+}
+
+bool c_xmlreader::t_movetonextattribute() {
+  INSTANCE_METHOD_INJECTION_BUILTIN(xmlreader, xmlreader::movetonextattribute);
+  return m_ptr && xmlTextReaderMoveToNextAttribute(m_ptr) == 1;
+}
+
+bool c_xmlreader::t_isvalid() {
+  INSTANCE_METHOD_INJECTION_BUILTIN(xmlreader, xmlreader::isvalid);
+  return m_ptr && xmlTextReaderIsValid(m_ptr) == 1;
+}
+
+Variant c_xmlreader::t_lookupnamespace(CStrRef prefix) {
+  INSTANCE_METHOD_INJECTION_BUILTIN(xmlreader, xmlreader::lookupnamespace);
+  if (m_ptr == NULL) {
+    return false;
+  }
+  return take_string(xmlTextReaderLookupNamespace
+                     (m_ptr, prefix.empty() ? NULL :
+                      (const xmlChar *)prefix.data()));
+}
+
+bool c_xmlreader::t_getparserproperty(int64 property) {
+  INSTANCE_METHOD_INJECTION_BUILTIN(xmlreader, xmlreader::getparserproperty);
+  int ret = -1;
+  if (m_ptr) {
+    ret = xmlTextReaderGetParserProp(m_ptr, property);
+  }
+  if (ret == -1) {
+    raise_warning("Invalid parser property");
+    return false;
+  }
+  return ret;
+}
+
+bool c_xmlreader::t_setparserproperty(int64 property, bool value) {
+  INSTANCE_METHOD_INJECTION_BUILTIN(xmlreader, xmlreader::setparserproperty);
+  int ret = -1;
+  if (m_ptr) {
+    ret = xmlTextReaderSetParserProp(m_ptr, property, value);
+  }
+  if (ret == -1) {
+    raise_warning("Invalid parser property");
+    return false;
+  }
+  return true;
+}
+
+Variant c_xmlreader::t_expand() {
+  INSTANCE_METHOD_INJECTION_BUILTIN(xmlreader, xmlreader::expand);
+  if (m_ptr == NULL) {
+    raise_warning("Load Data before trying to expand");
+    return false;
+  }
+  xmlNodePtr node = xmlTextReaderExpand(m_ptr);
+  if (node == NULL) {
+    raise_warning("An Error Occured while expanding");
+    return false;
+  }
+  if (node->type != XML_ELEMENT_NODE) {
+    raise_warning("Only element nodes can be expanded");
+    return false;
+  }
+
+  // The subtree is copied into a document of its own, so the reader is still
+  // free to release it once it moves on, while the SimpleXMLElement lives as
+  // long as the script keeps it.
+  xmlDocPtr doc = xmlNewDoc((const xmlChar *)"1.0");
+  xmlNodePtr copy = xmlDocCopyNode(node, doc, 1);
+  if (copy == NULL) {
+    xmlFreeDoc(doc);
+    raise_warning("An Error Occured while expanding");
+    return false;
+  }
+  xmlDocSetRootElement(doc, copy);
+  return simplexml_from_doc(doc);
+}
+
+Variant c_xmlreader::t___get(Variant name) {
+  INSTANCE_METHOD_INJECTION_BUILTIN(xmlreader, xmlreader::__get);
+  const XMLReaderProperty *p = find_property(name);
+  if (p == NULL) {
+    return ObjectData::doGet(name, true);
+  }
+
+  int retint = 0;
+  const xmlChar *retchar = NULL;
+  if (m_ptr) {
+    if (p->charFunc) {
+      retchar = p->charFunc(m_ptr);
+    } else {
+      retint = p->intFunc(m_ptr);
+      if (retint == -1) {
+        raise_warning("Internal libxml error returned");
+        return false;
+      }
+    }
+  }
+
+  switch (p->type) {
+  case KindOfBoolean:
+    return retint != 0;
+  case KindOfInt64:
+    return retint;
+  default:
+    break;
+  }
+  if (retchar == NULL) {
+    return "";
+  }
+  return String((const char *)retchar, CopyString);
+}
+
+Variant c_xmlreader::t___set(Variant name, Variant value) {
+  INSTANCE_METHOD_INJECTION_BUILTIN(xmlreader, xmlreader::__set);
+  if (find_property(name)) {
+    raise_warning("Cannot write to read-only property");
+    return null;
+  }
+  return ObjectData::t___set(name, value);
+}
+
+Variant c_xmlreader::t___destruct() {
+  INSTANCE_METHOD_INJECTION_BUILTIN(xmlreader, xmlreader::__destruct);
+  return null;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+}
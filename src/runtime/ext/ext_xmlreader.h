@@ -0,0 +1,113 @@
+/*
+   +----------------------------------------------------------------------+
+   | HipHop for PHP                                                       |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2010 Facebook, Inc. (http://www.facebook.com)          |
+   | Copyright (c) 1997-2010 The PHP Group                                |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 3.01 of the PHP license,      |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available through the world-wide-web at the following url:           |
+   | http://www.php.net/license/3_01.txt                                  |
+   | If you did not receive a copy of the PHP license and are unable to   |
+   | obtain it through the world-wide-web, please send a note to          |
+   | license@php.net so we can mail you a copy immediately.               |
+   +----------------------------------------------------------------------+
+*/
+
+#ifndef __EXT_XMLREADER_H__
+#define __EXT_XMLREADER_H__
+
+// >>>>>> Generated by idl.php. Do NOT modify. <<<<<<
+#include <libxml/xmlreader.h>
+#include <runtime/base/file/file.h>
+
+#include <runtime/base/base_includes.h>
+
+namespace HPHP {
+///////////////////////////////////////////////////////////////////////////////
+
+extern const int64 q_xmlreader_NONE;
+extern const int64 q_xmlreader_ELEMENT;
+extern const int64 q_xmlreader_ATTRIBUTE;
+extern const int64 q_xmlreader_TEXT;
+extern const int64 q_xmlreader_CDATA;
+extern const int64 q_xmlreader_ENTITY_REF;
+extern const int64 q_xmlreader_ENTITY;
+extern const int64 q_xmlreader_PI;
+extern const int64 q_xmlreader_COMMENT;
+extern const int64 q_xmlreader_DOC;
+extern const int64 q_xmlreader_DOC_TYPE;
+extern const int64 q_xmlreader_DOC_FRAGMENT;
+extern const int64 q_xmlreader_NOTATION;
+extern const int64 q_xmlreader_WHITESPACE;
+extern const int64 q_xmlreader_SIGNIFICANT_WHITESPACE;
+extern const int64 q_xmlreader_END_ELEMENT;
+extern const int64 q_xmlreader_END_ENTITY;
+extern const int64 q_xmlreader_XML_DECLARATION;
+extern const int64 q_xmlreader_LOADDTD;
+extern const int64 q_xmlreader_DEFAULTATTRS;
+extern const int64 q_xmlreader_VALIDATE;
+extern const int64 q_xmlreader_SUBST_ENTITIES;
+
+///////////////////////////////////////////////////////////////////////////////
+// class XMLReader
+
+FORWARD_DECLARE_CLASS(xmlreader);
+class c_xmlreader : public ExtObjectData {
+ public:
+  BEGIN_CLASS_MAP(xmlreader)
+  END_CLASS_MAP(xmlreader)
+  DECLARE_CLASS(xmlreader, XMLReader, ObjectData)
+  DECLARE_INVOKES_FROM_EVAL
+  ObjectData* dynCreate(CArrRef params, bool init = true);
+
+  // need to implement
+  public: c_xmlreader();
+  public: ~c_xmlreader();
+  public: void t___construct();
+  public: bool t_open(CStrRef uri, CStrRef encoding = null_string, int64 options = 0);
+  public: bool t_xml(CStrRef source, CStrRef encoding = null_string, int64 options = 0);
+  public: bool t_close();
+  public: bool t_read();
+  public: bool t_next(CStrRef localname = null_string);
+  public: String t_readstring();
+  public: String t_readinnerxml();
+  public: String t_readouterxml();
+  public: Variant t_getattribute(CStrRef name);
+  public: Variant t_getattributeno(int64 index);
+  public: Variant t_getattributens(CStrRef localname, CStrRef namespaceuri);
+  public: bool t_movetoattribute(CStrRef name);
+  public: bool t_movetoattributeno(int64 index);
+  public: bool t_movetoattributens(CStrRef localname, CStrRef namespaceuri);
+  public: bool t_movetoelement();
+  public: bool t_movetofirstattribute();
+  public: bool t_movetonextattribute();
+  public: bool t_isvalid();
+  public: Variant t_lookupnamespace(CStrRef prefix);
+  public: bool t_getparserproperty(int64 property);
+  public: bool t_setparserproperty(int64 property, bool value);
+  public: Variant t_expand();
+  public: Variant t___get(Variant name);
+  public: Variant doGet(Variant v_name, bool error);
+  public: Variant t___set(Variant name, Variant value);
+  public: Variant t___destruct();
+
+  // implemented by HPHP
+  public: c_xmlreader *create();
+  public: void dynConstruct(CArrRef Params);
+  public: void dynConstructFromEval(Eval::VariableEnvironment &env,
+                                    const Eval::FunctionCallExpression *call);
+  public: virtual void destruct();
+
+ public:
+  SmartObject<File> m_uri;
+ private:
+  xmlTextReaderPtr  m_ptr;
+  String            m_source;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+}
+
+#endif // __EXT_XMLREADER_H__
@@ -16,6 +16,7 @@
 */
 
 #include <runtime/ext/hash/hash_adler32.h>
+#include <util/checksum.h>
 
 namespace HPHP {
 ///////////////////////////////////////////////////////////////////////////////
@@ -35,14 +36,7 @@ void hash_adler32::hash_init(void *context) {
 void hash_adler32::hash_update(void *context, const unsigned char *buf,
                                unsigned int count) {
   unsigned int &state = ((PHP_ADLER32_CTX *)context)->state;
-  unsigned int s[2];
-  s[0] = state & 0xffff;
-  s[1] = (state >> 16) & 0xffff;
-  for (unsigned int i = 0; i < count; ++i) {
-    s[0] = (s[0] + buf[i]) % 65521;
-    s[1] = (s[1] + s[0]) % 65521;
-  }
-  state = s[0] + (s[1] << 16);
+  state = Checksum::Adler32(state, buf, count);
 }
 
 void hash_adler32::hash_final(unsigned char *digest, void *context) {
@@ -16,7 +16,7 @@
 */
 
 #include <runtime/ext/hash/hash_crc32.h>
-#include <runtime/ext/hash/php_hash_crc32_tables.h>
+#include <util/checksum.h>
 
 namespace HPHP {
 ///////////////////////////////////////////////////////////////////////////////
@@ -37,17 +37,10 @@ void hash_crc32::hash_init(void *context_) {
 void hash_crc32::hash_update(void *context_, const unsigned char *input,
                              unsigned int len) {
   PHP_CRC32_CTX *context = (PHP_CRC32_CTX*)context_;
-  size_t i;
   if (m_b) {
-    for (i = 0; i < len; ++i) {
-      context->state = (context->state >> 8) ^
-        crc32b_table[(context->state ^ input[i]) & 0xff];
-    }
+    context->state = Checksum::Crc32(context->state, input, len);
   } else {
-    for (i = 0; i < len; ++i) {
-      context->state = (context->state << 8) ^
-        crc32_table[(context->state >> 24) ^ (input[i] & 0xff)];
-    }
+    context->state = Checksum::Crc32Bzip2(context->state, input, len);
   }
 }
 
@@ -76,5 +69,32 @@ void hash_crc32::hash_final(unsigned char *digest, void *context_) {
   context->state = 0;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+
+hash_crc32c::hash_crc32c()
+  : HashEngine(4, 4, sizeof(PHP_CRC32_CTX)) {
+}
+
+void hash_crc32c::hash_init(void *context_) {
+  PHP_CRC32_CTX *context = (PHP_CRC32_CTX*)context_;
+  context->state = ~0;
+}
+
+void hash_crc32c::hash_update(void *context_, const unsigned char *input,
+                              unsigned int len) {
+  PHP_CRC32_CTX *context = (PHP_CRC32_CTX*)context_;
+  context->state = Checksum::Crc32c(context->state, input, len);
+}
+
+void hash_crc32c::hash_final(unsigned char *digest, void *context_) {
+  PHP_CRC32_CTX *context = (PHP_CRC32_CTX*)context_;
+  context->state = ~context->state;
+  digest[0] = (unsigned char) ((context->state >> 24) & 0xff);
+  digest[1] = (unsigned char) ((context->state >> 16) & 0xff);
+  digest[2] = (unsigned char) ((context->state >> 8) & 0xff);
+  digest[3] = (unsigned char) (context->state & 0xff);
+  context->state = 0;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 }
@@ -36,6 +36,16 @@ private:
   bool m_b;
 };
 
+class hash_crc32c : public HashEngine {
+public:
+  hash_crc32c();
+
+  virtual void hash_init(void *context);
+  virtual void hash_update(void *context, const unsigned char *buf,
+                           unsigned int count);
+  virtual void hash_final(unsigned char *digest, void *context);
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 }
 
@@ -16,6 +16,7 @@
 */
 
 #include <runtime/ext/hash/hash_sha.h>
+#include <util/checksum.h>
 
 namespace HPHP {
 ///////////////////////////////////////////////////////////////////////////////
@@ -268,6 +269,18 @@ static void SHA1Transform(unsigned int state[5],
   memset((unsigned char*) x, 0, sizeof(x));
 }
 
+/*
+ * Runs SHA1Transform over consecutive blocks, unless the CPU can do it.
+ */
+static void SHA1Blocks(unsigned int state[5], const unsigned char *input,
+                       unsigned int blocks) {
+  if (!Checksum::Sha1Blocks(state, input, blocks)) {
+    for (; blocks; blocks--, input += 64) {
+      SHA1Transform(state, input);
+    }
+  }
+}
+
 /*
    SHA1 block update operation. Continues an SHA1 message-digest
    operation, processing another message block, and updating the
@@ -295,10 +308,9 @@ void hash_sha1::hash_update(void *context_, const unsigned char *input,
   if (inputLen >= partLen) {
     memcpy((unsigned char*) & context->buffer[index], (unsigned char*) input,
            partLen);
-    SHA1Transform(context->state, context->buffer);
-
-    for (i = partLen; i + 63 < inputLen; i += 64)
-      SHA1Transform(context->state, &input[i]);
+    SHA1Blocks(context->state, context->buffer, 1);
+    SHA1Blocks(context->state, &input[partLen], (inputLen - partLen) / 64);
+    i = partLen + (inputLen - partLen) / 64 * 64;
 
     index = 0;
   } else
@@ -432,6 +444,18 @@ static void SHA256Transform(unsigned int state[8],
   memset((unsigned char*) x, 0, sizeof(x));
 }
 
+/*
+ * Runs SHA256Transform over consecutive blocks, unless the CPU can do it.
+ */
+static void SHA256Blocks(unsigned int state[8], const unsigned char *input,
+                         unsigned int blocks) {
+  if (!Checksum::Sha256Blocks(state, input, blocks)) {
+    for (; blocks; blocks--, input += 64) {
+      SHA256Transform(state, input);
+    }
+  }
+}
+
 /*
   SHA256 block update operation. Continues an SHA256 message-digest
   operation, processing another message block, and updating the
@@ -459,11 +483,9 @@ void hash_sha256::hash_update(void *context_, const unsigned char *input,
   if (inputLen >= partLen) {
     memcpy((unsigned char*) & context->buffer[index],
            (unsigned char*) input, partLen);
-    SHA256Transform(context->state, context->buffer);
-
-    for (i = partLen; i + 63 < inputLen; i += 64) {
-      SHA256Transform(context->state, &input[i]);
-    }
+    SHA256Blocks(context->state, context->buffer, 1);
+    SHA256Blocks(context->state, &input[partLen], (inputLen - partLen) / 64);
+    i = partLen + (inputLen - partLen) / 64 * 64;
 
     index = 0;
   } else {
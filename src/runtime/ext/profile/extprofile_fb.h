@@ -100,6 +100,16 @@ inline Variant x_xhprof_sample_disable() {
   return f_xhprof_sample_disable();
 }
 
+inline void x_xhprof_heap_enable(int64 sample_bytes = 0) {
+  FUNCTION_INJECTION_BUILTIN(xhprof_heap_enable);
+  f_xhprof_heap_enable(sample_bytes);
+}
+
+inline Variant x_xhprof_heap_disable() {
+  FUNCTION_INJECTION_BUILTIN(xhprof_heap_disable);
+  return f_xhprof_heap_disable();
+}
+
 inline void x_fb_load_local_databases(CArrRef servers) {
   FUNCTION_INJECTION_BUILTIN(fb_load_local_databases);
   f_fb_load_local_databases(servers);
@@ -245,6 +245,21 @@ inline void x_set_time_limit(int seconds) {
   f_set_time_limit(seconds);
 }
 
+inline void x_hphp_set_request_deadline(int64 milliseconds) {
+  FUNCTION_INJECTION_BUILTIN(hphp_set_request_deadline);
+  f_hphp_set_request_deadline(milliseconds);
+}
+
+inline void x_hphp_set_request_cpu_budget(int64 milliseconds) {
+  FUNCTION_INJECTION_BUILTIN(hphp_set_request_cpu_budget);
+  f_hphp_set_request_cpu_budget(milliseconds);
+}
+
+inline int64 x_hphp_get_request_cpu_time() {
+  FUNCTION_INJECTION_BUILTIN(hphp_get_request_cpu_time);
+  return f_hphp_get_request_cpu_time();
+}
+
 inline String x_sys_get_temp_dir() {
   FUNCTION_INJECTION_BUILTIN(sys_get_temp_dir);
   return f_sys_get_temp_dir();
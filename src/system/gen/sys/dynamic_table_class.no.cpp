@@ -19833,6 +19833,1014 @@ struct ObjectStaticCallbacks cw_domentity = {
   c_domentity::os_invoke,
   c_domentity::os_constant,
 };
+Object co_xmlreader(CArrRef params, bool init /* = true */) {
+  return Object((NEW(c_xmlreader)())->dynCreate(params, init));
+}
+#ifndef OMIT_JUMP_TABLE_CLASS_STATIC_GETINIT_xmlreader
+Variant c_xmlreader::os_getInit(const char *s, int64 hash) {
+  return c_ObjectData::os_getInit(s, hash);
+}
+#endif // OMIT_JUMP_TABLE_CLASS_STATIC_GETINIT_xmlreader
+#ifndef OMIT_JUMP_TABLE_CLASS_STATIC_GET_xmlreader
+Variant c_xmlreader::os_get(const char *s, int64 hash) {
+  return c_ObjectData::os_get(s, hash);
+}
+#endif // OMIT_JUMP_TABLE_CLASS_STATIC_GET_xmlreader
+#ifndef OMIT_JUMP_TABLE_CLASS_STATIC_LVAL_xmlreader
+Variant &c_xmlreader::os_lval(const char *s, int64 hash) {
+  return c_ObjectData::os_lval(s, hash);
+}
+#endif // OMIT_JUMP_TABLE_CLASS_STATIC_LVAL_xmlreader
+#ifndef OMIT_JUMP_TABLE_CLASS_GETARRAY_xmlreader
+void c_xmlreader::o_get(Array &props) const {
+  c_ObjectData::o_get(props);
+}
+#endif // OMIT_JUMP_TABLE_CLASS_GETARRAY_xmlreader
+#ifndef OMIT_JUMP_TABLE_CLASS_get_xmlreader
+Variant c_xmlreader::o_get(CStrRef prop, int64 phash, bool error /* = true */, const char *context /* = NULL */) {
+  return c_xmlreader::o_getPublic(prop, phash, error);
+}
+#endif // OMIT_JUMP_TABLE_CLASS_get_xmlreader
+#ifndef OMIT_JUMP_TABLE_CLASS_get_PUBLIC_xmlreader
+Variant c_xmlreader::o_getPublic(CStrRef s, int64 hash, bool error /* = true */) {
+  return c_ObjectData::o_getPublic(s, hash, error);
+}
+#endif // OMIT_JUMP_TABLE_CLASS_get_PUBLIC_xmlreader
+#ifndef OMIT_JUMP_TABLE_CLASS_get_PRIVATE_xmlreader
+Variant c_xmlreader::o_getPrivate(CStrRef s, int64 hash, bool error /* = true */) {
+  return o_getPublic(s, hash, error);
+}
+#endif // OMIT_JUMP_TABLE_CLASS_get_PRIVATE_xmlreader
+#ifndef OMIT_JUMP_TABLE_CLASS_exists_xmlreader
+bool c_xmlreader::o_exists(CStrRef prop, int64 phash, const char *context /* = NULL */) const {
+  return c_xmlreader::o_existsPublic(prop, phash);
+}
+#endif // OMIT_JUMP_TABLE_CLASS_exists_xmlreader
+#ifndef OMIT_JUMP_TABLE_CLASS_exists_PUBLIC_xmlreader
+bool c_xmlreader::o_existsPublic(CStrRef s, int64 hash) const {
+  return c_ObjectData::o_existsPublic(s, hash);
+}
+#endif // OMIT_JUMP_TABLE_CLASS_exists_PUBLIC_xmlreader
+#ifndef OMIT_JUMP_TABLE_CLASS_exists_PRIVATE_xmlreader
+bool c_xmlreader::o_existsPrivate(CStrRef s, int64 hash) const {
+  return o_existsPublic(s, hash);
+}
+#endif // OMIT_JUMP_TABLE_CLASS_exists_PRIVATE_xmlreader
+#ifndef OMIT_JUMP_TABLE_CLASS_set_xmlreader
+Variant c_xmlreader::o_set(CStrRef prop, int64 phash, CVarRef v, bool forInit /* = false */, const char *context /* = NULL */) {
+  return c_xmlreader::o_setPublic(prop, phash, v, forInit);
+}
+#endif // OMIT_JUMP_TABLE_CLASS_set_xmlreader
+#ifndef OMIT_JUMP_TABLE_CLASS_set_PUBLIC_xmlreader
+Variant c_xmlreader::o_setPublic(CStrRef s, int64 hash, CVarRef v, bool forInit /* = false */) {
+  return c_ObjectData::o_setPublic(s, hash, v, forInit);
+}
+#endif // OMIT_JUMP_TABLE_CLASS_set_PUBLIC_xmlreader
+#ifndef OMIT_JUMP_TABLE_CLASS_set_PRIVATE_xmlreader
+Variant c_xmlreader::o_setPrivate(CStrRef s, int64 hash, CVarRef v, bool forInit /* = false */) {
+  return o_setPublic(s, hash, v, forInit);
+}
+#endif // OMIT_JUMP_TABLE_CLASS_set_PRIVATE_xmlreader
+#ifndef OMIT_JUMP_TABLE_CLASS_lval_xmlreader
+Variant& c_xmlreader::o_lval(CStrRef prop, int64 phash, const char *context /* = NULL */) {
+  return c_xmlreader::o_lvalPublic(prop, phash);
+}
+#endif // OMIT_JUMP_TABLE_CLASS_lval_xmlreader
+#ifndef OMIT_JUMP_TABLE_CLASS_lval_PUBLIC_xmlreader
+Variant& c_xmlreader::o_lvalPublic(CStrRef s, int64 hash) {
+  return c_ObjectData::o_lvalPublic(s, hash);
+}
+#endif // OMIT_JUMP_TABLE_CLASS_lval_PUBLIC_xmlreader
+#ifndef OMIT_JUMP_TABLE_CLASS_lval_PRIVATE_xmlreader
+Variant& c_xmlreader::o_lvalPrivate(CStrRef s, int64 hash) {
+  return o_lvalPublic(s, hash);
+}
+#endif // OMIT_JUMP_TABLE_CLASS_lval_PRIVATE_xmlreader
+#ifndef OMIT_JUMP_TABLE_CLASS_CONSTANT_xmlreader
+Variant c_xmlreader::os_constant(const char *s) {
+  int64 hash = hash_string(s);
+  switch (hash & 63) {
+    case 1:
+      HASH_RETURN(0x13B3121CBF212DC1LL, q_xmlreader_DOC_FRAGMENT, "DOC_FRAGMENT");
+      break;
+    case 4:
+      HASH_RETURN(0x408ED7C761FF47C4LL, q_xmlreader_ENTITY, "ENTITY");
+      break;
+    case 9:
+      HASH_RETURN(0x6071F0A4D7F152C9LL, q_xmlreader_NOTATION, "NOTATION");
+      HASH_RETURN(0x3EE501B147457449LL, q_xmlreader_END_ENTITY, "END_ENTITY");
+      break;
+    case 13:
+      HASH_RETURN(0x62DD77C5D6C2DE0DLL, q_xmlreader_CDATA, "CDATA");
+      HASH_RETURN(0x3EDDB11DE1375B8DLL, q_xmlreader_DEFAULTATTRS, "DEFAULTATTRS");
+      break;
+    case 15:
+      HASH_RETURN(0x5BB72110C0F94F8FLL, q_xmlreader_ELEMENT, "ELEMENT");
+      HASH_RETURN(0x4431B68F8477210FLL, q_xmlreader_SUBST_ENTITIES, "SUBST_ENTITIES");
+      break;
+    case 21:
+      HASH_RETURN(0x3B88EDDFD061F3D5LL, q_xmlreader_ENTITY_REF, "ENTITY_REF");
+      break;
+    case 29:
+      HASH_RETURN(0x507641F239996F9DLL, q_xmlreader_WHITESPACE, "WHITESPACE");
+      break;
+    case 31:
+      HASH_RETURN(0x7A139FC5BAE9039FLL, q_xmlreader_ATTRIBUTE, "ATTRIBUTE");
+      HASH_RETURN(0x7EB865DC91D6AC1FLL, q_xmlreader_DOC_TYPE, "DOC_TYPE");
+      break;
+    case 34:
+      HASH_RETURN(0x109A60248CB637E2LL, q_xmlreader_LOADDTD, "LOADDTD");
+      break;
+    case 35:
+      HASH_RETURN(0x6F1A1E27C5AA3F63LL, q_xmlreader_COMMENT, "COMMENT");
+      break;
+    case 36:
+      HASH_RETURN(0x74BA2D38EFFFC224LL, q_xmlreader_TEXT, "TEXT");
+      break;
+    case 37:
+      HASH_RETURN(0x4A21896B12C238E5LL, q_xmlreader_SIGNIFICANT_WHITESPACE, "SIGNIFICANT_WHITESPACE");
+      break;
+    case 44:
+      HASH_RETURN(0x18CF3E4A60E4AAACLL, q_xmlreader_PI, "PI");
+      break;
+    case 45:
+      HASH_RETURN(0x5C1091C88F8EB6EDLL, q_xmlreader_DOC, "DOC");
+      break;
+    case 48:
+      HASH_RETURN(0x3EBBF7FE181568B0LL, q_xmlreader_END_ELEMENT, "END_ELEMENT");
+      HASH_RETURN(0x2907A7E1425D0970LL, q_xmlreader_XML_DECLARATION, "XML_DECLARATION");
+      break;
+    case 51:
+      HASH_RETURN(0x2EFDCA1922BFB273LL, q_xmlreader_NONE, "NONE");
+      break;
+    case 55:
+      HASH_RETURN(0x1CA408E02262F737LL, q_xmlreader_VALIDATE, "VALIDATE");
+      break;
+    default:
+      break;
+  }
+  return c_ObjectData::os_constant(s);
+}
+#endif // OMIT_JUMP_TABLE_CLASS_CONSTANT_xmlreader
+IMPLEMENT_CLASS(xmlreader)
+c_xmlreader *c_xmlreader::create() {
+  CountableHelper h(this);
+  init();
+  t___construct();
+  return this;
+}
+ObjectData *c_xmlreader::dynCreate(CArrRef params, bool construct /* = true */) {
+  init();
+  if (construct) {
+    CountableHelper h(this);
+    int count __attribute__((__unused__)) = params.size();
+    if (count > 0) throw_toomany_arguments("__construct", 0, 2);
+    (t___construct());
+  }
+  return this;
+}
+void c_xmlreader::dynConstruct(CArrRef params) {
+  int count __attribute__((__unused__)) = params.size();
+  if (count > 0) throw_toomany_arguments("__construct", 0, 2);
+  (t___construct());
+}
+void c_xmlreader::dynConstructFromEval(Eval::VariableEnvironment &env, const Eval::FunctionCallExpression *caller) {
+  const std::vector<Eval::ExpressionPtr> &params = caller->params();
+  int count __attribute__((__unused__)) = params.size();
+  if (count > 0) throw_toomany_arguments("__construct", 0, 1);
+  std::vector<Eval::ExpressionPtr>::const_iterator it = params.begin();
+  do {
+  } while(false);
+  for (; it != params.end(); ++it) {
+    (*it)->eval(env);
+  }
+  (t___construct(), null);
+}
+void c_xmlreader::destruct() {
+  if (!inCtorDtor()) {
+    incRefCount();
+    try {
+      t___destruct();
+    } catch (...) { handle_destructor_exception();}
+  }
+}
+ObjectData *c_xmlreader::cloneImpl() {
+  c_xmlreader *obj = NEW(c_xmlreader)();
+  cloneSet(obj);
+  return obj;
+}
+void c_xmlreader::cloneSet(c_xmlreader *clone) {
+  ObjectData::cloneSet(clone);
+}
+Variant c_xmlreader::doGet(Variant v_name, bool error) {
+  return t___get(v_name);
+}
+#ifndef OMIT_JUMP_TABLE_CLASS_INVOKE_xmlreader
+Variant c_xmlreader::o_invoke(const char *s, CArrRef params, int64 hash, bool fatal) {
+  int count __attribute__((__unused__)) = params.size();
+  if (hash < 0) hash = hash_string_i(s);
+  switch (hash & 63) {
+    case 1:
+      HASH_GUARD(0x78AE97BFBEBF5341LL, close) {
+        if (count > 0) return throw_toomany_arguments("close", 0, 1);
+        return (t_close());
+      }
+      HASH_GUARD(0x1F479267E49EF301LL, read) {
+        if (count > 0) return throw_toomany_arguments("read", 0, 1);
+        return (t_read());
+      }
+      break;
+    case 4:
+      HASH_GUARD(0x21F68C010C124BC4LL, open) {
+        if (count < 1 || count > 3) return throw_wrong_arguments("open", count, 1, 3, 1);
+        if (count <= 1) return (t_open(params[0]));
+        if (count == 2) return (t_open(params[0], params[1]));
+        return (t_open(params[0], params[1], params[2]));
+      }
+      break;
+    case 6:
+      HASH_GUARD(0x0C1F965FD1079AC6LL, movetofirstattribute) {
+        if (count > 0) return throw_toomany_arguments("movetofirstattribute", 0, 1);
+        return (t_movetofirstattribute());
+      }
+      break;
+    case 7:
+      HASH_GUARD(0x0D2003842AF83A07LL, getparserproperty) {
+        if (count != 1) return throw_wrong_arguments("getparserproperty", count, 1, 1, 1);
+        return (t_getparserproperty(params[0]));
+      }
+      break;
+    case 13:
+      HASH_GUARD(0x39B7BB05F05A37CDLL, expand) {
+        if (count > 0) return throw_toomany_arguments("expand", 0, 1);
+        return (t_expand());
+      }
+      break;
+    case 14:
+      HASH_GUARD(0x797E2A56E560520ELL, readinnerxml) {
+        if (count > 0) return throw_toomany_arguments("readinnerxml", 0, 1);
+        return (t_readinnerxml());
+      }
+      break;
+    case 15:
+      HASH_GUARD(0x26B6E00C74FA338FLL, __get) {
+        if (count != 1) return throw_wrong_arguments("__get", count, 1, 1, 1);
+        return (t___get(params[0]));
+      }
+      break;
+    case 19:
+      HASH_GUARD(0x7BA9DD90E7AE3A13LL, setparserproperty) {
+        if (count != 2) return throw_wrong_arguments("setparserproperty", count, 2, 2, 1);
+        return (t_setparserproperty(params[0], params[1]));
+      }
+      break;
+    case 20:
+      HASH_GUARD(0x1986122197FD4B14LL, xml) {
+        if (count < 1 || count > 3) return throw_wrong_arguments("xml", count, 1, 3, 1);
+        if (count <= 1) return (t_xml(params[0]));
+        if (count == 2) return (t_xml(params[0], params[1]));
+        return (t_xml(params[0], params[1], params[2]));
+      }
+      break;
+    case 21:
+      HASH_GUARD(0x52F3DAD783340395LL, __set) {
+        if (count != 2) return throw_wrong_arguments("__set", count, 2, 2, 1);
+        return (t___set(params[0], params[1]));
+      }
+      break;
+    case 25:
+      HASH_GUARD(0x33982845A5250499LL, getattributeno) {
+        if (count != 1) return throw_wrong_arguments("getattributeno", count, 1, 1, 1);
+        return (t_getattributeno(params[0]));
+      }
+      HASH_GUARD(0x34E103E06D3F0899LL, getattributens) {
+        if (count != 2) return throw_wrong_arguments("getattributens", count, 2, 2, 1);
+        return (t_getattributens(params[0], params[1]));
+      }
+      break;
+    case 27:
+      HASH_GUARD(0x06697B31313080DBLL, readouterxml) {
+        if (count > 0) return throw_toomany_arguments("readouterxml", 0, 1);
+        return (t_readouterxml());
+      }
+      break;
+    case 29:
+      HASH_GUARD(0x182BF31CCB09E11DLL, lookupnamespace) {
+        if (count != 1) return throw_wrong_arguments("lookupnamespace", count, 1, 1, 1);
+        return (t_lookupnamespace(params[0]));
+      }
+      break;
+    case 31:
+      HASH_GUARD(0x0D31D0AC229C615FLL, __construct) {
+        if (count > 0) return throw_toomany_arguments("__construct", 0, 1);
+        return (t___construct(), null);
+      }
+      break;
+    case 39:
+      HASH_GUARD(0x72A8D1997F7E0F67LL, movetonextattribute) {
+        if (count > 0) return throw_toomany_arguments("movetonextattribute", 0, 1);
+        return (t_movetonextattribute());
+      }
+      break;
+    case 40:
+      HASH_GUARD(0x49F89C466612FC28LL, getattribute) {
+        if (count != 1) return throw_wrong_arguments("getattribute", count, 1, 1, 1);
+        return (t_getattribute(params[0]));
+      }
+      break;
+    case 43:
+      HASH_GUARD(0x71E1A6F1ACA9872BLL, isvalid) {
+        if (count > 0) return throw_toomany_arguments("isvalid", 0, 1);
+        return (t_isvalid());
+      }
+      break;
+    case 47:
+      HASH_GUARD(0x0CFE207982641D6FLL, movetoelement) {
+        if (count > 0) return throw_toomany_arguments("movetoelement", 0, 1);
+        return (t_movetoelement());
+      }
+      break;
+    case 51:
+      HASH_GUARD(0x7F974836AACC1EF3LL, __destruct) {
+        if (count > 0) return throw_toomany_arguments("__destruct", 0, 1);
+        return (t___destruct());
+      }
+      break;
+    case 52:
+      HASH_GUARD(0x062D7D5B55654634LL, readstring) {
+        if (count > 0) return throw_toomany_arguments("readstring", 0, 1);
+        return (t_readstring());
+      }
+      HASH_GUARD(0x4E53414CB3A073B4LL, movetoattributeno) {
+        if (count != 1) return throw_wrong_arguments("movetoattributeno", count, 1, 1, 1);
+        return (t_movetoattributeno(params[0]));
+      }
+      break;
+    case 54:
+      HASH_GUARD(0x7DA2728AC230DFF6LL, movetoattribute) {
+        if (count != 1) return throw_wrong_arguments("movetoattribute", count, 1, 1, 1);
+        return (t_movetoattribute(params[0]));
+      }
+      break;
+    case 56:
+      HASH_GUARD(0x3C6D50F3BB8102B8LL, next) {
+        if (count > 1) return throw_toomany_arguments("next", 1, 1);
+        if (count <= 0) return (t_next());
+        return (t_next(params[0]));
+      }
+      break;
+    case 61:
+      HASH_GUARD(0x0661BC19E05663FDLL, movetoattributens) {
+        if (count != 2) return throw_wrong_arguments("movetoattributens", count, 2, 2, 1);
+        return (t_movetoattributens(params[0], params[1]));
+      }
+      break;
+    default:
+      break;
+  }
+  return c_ObjectData::o_invoke(s, params, hash, fatal);
+}
+#endif // OMIT_JUMP_TABLE_CLASS_INVOKE_xmlreader
+#ifndef OMIT_JUMP_TABLE_CLASS_INVOKE_xmlreader
+Variant c_xmlreader::o_invoke_few_args(const char *s, int64 hash, int count, CVarRef a0, CVarRef a1, CVarRef a2, CVarRef a3, CVarRef a4, CVarRef a5) {
+  if (hash < 0) hash = hash_string_i(s);
+  switch (hash & 63) {
+    case 1:
+      HASH_GUARD(0x78AE97BFBEBF5341LL, close) {
+        if (count > 0) return throw_toomany_arguments("close", 0, 1);
+        return (t_close());
+      }
+      HASH_GUARD(0x1F479267E49EF301LL, read) {
+        if (count > 0) return throw_toomany_arguments("read", 0, 1);
+        return (t_read());
+      }
+      break;
+    case 4:
+      HASH_GUARD(0x21F68C010C124BC4LL, open) {
+        if (count < 1 || count > 3) return throw_wrong_arguments("open", count, 1, 3, 1);
+        if (count <= 1) return (t_open(a0));
+        if (count == 2) return (t_open(a0, a1));
+        return (t_open(a0, a1, a2));
+      }
+      break;
+    case 6:
+      HASH_GUARD(0x0C1F965FD1079AC6LL, movetofirstattribute) {
+        if (count > 0) return throw_toomany_arguments("movetofirstattribute", 0, 1);
+        return (t_movetofirstattribute());
+      }
+      break;
+    case 7:
+      HASH_GUARD(0x0D2003842AF83A07LL, getparserproperty) {
+        if (count != 1) return throw_wrong_arguments("getparserproperty", count, 1, 1, 1);
+        return (t_getparserproperty(a0));
+      }
+      break;
+    case 13:
+      HASH_GUARD(0x39B7BB05F05A37CDLL, expand) {
+        if (count > 0) return throw_toomany_arguments("expand", 0, 1);
+        return (t_expand());
+      }
+      break;
+    case 14:
+      HASH_GUARD(0x797E2A56E560520ELL, readinnerxml) {
+        if (count > 0) return throw_toomany_arguments("readinnerxml", 0, 1);
+        return (t_readinnerxml());
+      }
+      break;
+    case 15:
+      HASH_GUARD(0x26B6E00C74FA338FLL, __get) {
+        if (count != 1) return throw_wrong_arguments("__get", count, 1, 1, 1);
+        return (t___get(a0));
+      }
+      break;
+    case 19:
+      HASH_GUARD(0x7BA9DD90E7AE3A13LL, setparserproperty) {
+        if (count != 2) return throw_wrong_arguments("setparserproperty", count, 2, 2, 1);
+        return (t_setparserproperty(a0, a1));
+      }
+      break;
+    case 20:
+      HASH_GUARD(0x1986122197FD4B14LL, xml) {
+        if (count < 1 || count > 3) return throw_wrong_arguments("xml", count, 1, 3, 1);
+        if (count <= 1) return (t_xml(a0));
+        if (count == 2) return (t_xml(a0, a1));
+        return (t_xml(a0, a1, a2));
+      }
+      break;
+    case 21:
+      HASH_GUARD(0x52F3DAD783340395LL, __set) {
+        if (count != 2) return throw_wrong_arguments("__set", count, 2, 2, 1);
+        return (t___set(a0, a1));
+      }
+      break;
+    case 25:
+      HASH_GUARD(0x33982845A5250499LL, getattributeno) {
+        if (count != 1) return throw_wrong_arguments("getattributeno", count, 1, 1, 1);
+        return (t_getattributeno(a0));
+      }
+      HASH_GUARD(0x34E103E06D3F0899LL, getattributens) {
+        if (count != 2) return throw_wrong_arguments("getattributens", count, 2, 2, 1);
+        return (t_getattributens(a0, a1));
+      }
+      break;
+    case 27:
+      HASH_GUARD(0x06697B31313080DBLL, readouterxml) {
+        if (count > 0) return throw_toomany_arguments("readouterxml", 0, 1);
+        return (t_readouterxml());
+      }
+      break;
+    case 29:
+      HASH_GUARD(0x182BF31CCB09E11DLL, lookupnamespace) {
+        if (count != 1) return throw_wrong_arguments("lookupnamespace", count, 1, 1, 1);
+        return (t_lookupnamespace(a0));
+      }
+      break;
+    case 31:
+      HASH_GUARD(0x0D31D0AC229C615FLL, __construct) {
+        if (count > 0) return throw_toomany_arguments("__construct", 0, 1);
+        return (t___construct(), null);
+      }
+      break;
+    case 39:
+      HASH_GUARD(0x72A8D1997F7E0F67LL, movetonextattribute) {
+        if (count > 0) return throw_toomany_arguments("movetonextattribute", 0, 1);
+        return (t_movetonextattribute());
+      }
+      break;
+    case 40:
+      HASH_GUARD(0x49F89C466612FC28LL, getattribute) {
+        if (count != 1) return throw_wrong_arguments("getattribute", count, 1, 1, 1);
+        return (t_getattribute(a0));
+      }
+      break;
+    case 43:
+      HASH_GUARD(0x71E1A6F1ACA9872BLL, isvalid) {
+        if (count > 0) return throw_toomany_arguments("isvalid", 0, 1);
+        return (t_isvalid());
+      }
+      break;
+    case 47:
+      HASH_GUARD(0x0CFE207982641D6FLL, movetoelement) {
+        if (count > 0) return throw_toomany_arguments("movetoelement", 0, 1);
+        return (t_movetoelement());
+      }
+      break;
+    case 51:
+      HASH_GUARD(0x7F974836AACC1EF3LL, __destruct) {
+        if (count > 0) return throw_toomany_arguments("__destruct", 0, 1);
+        return (t___destruct());
+      }
+      break;
+    case 52:
+      HASH_GUARD(0x062D7D5B55654634LL, readstring) {
+        if (count > 0) return throw_toomany_arguments("readstring", 0, 1);
+        return (t_readstring());
+      }
+      HASH_GUARD(0x4E53414CB3A073B4LL, movetoattributeno) {
+        if (count != 1) return throw_wrong_arguments("movetoattributeno", count, 1, 1, 1);
+        return (t_movetoattributeno(a0));
+      }
+      break;
+    case 54:
+      HASH_GUARD(0x7DA2728AC230DFF6LL, movetoattribute) {
+        if (count != 1) return throw_wrong_arguments("movetoattribute", count, 1, 1, 1);
+        return (t_movetoattribute(a0));
+      }
+      break;
+    case 56:
+      HASH_GUARD(0x3C6D50F3BB8102B8LL, next) {
+        if (count > 1) return throw_toomany_arguments("next", 1, 1);
+        if (count <= 0) return (t_next());
+        return (t_next(a0));
+      }
+      break;
+    case 61:
+      HASH_GUARD(0x0661BC19E05663FDLL, movetoattributens) {
+        if (count != 2) return throw_wrong_arguments("movetoattributens", count, 2, 2, 1);
+        return (t_movetoattributens(a0, a1));
+      }
+      break;
+    default:
+      break;
+  }
+  return c_ObjectData::o_invoke_few_args(s, hash, count, a0, a1, a2, a3, a4, a5);
+}
+#endif // OMIT_JUMP_TABLE_CLASS_INVOKE_xmlreader
+#ifndef OMIT_JUMP_TABLE_CLASS_STATIC_INVOKE_xmlreader
+Variant c_xmlreader::os_invoke(const char *c, const char *s, CArrRef params, int64 hash, bool fatal) {
+  int count __attribute__((__unused__)) = params.size();
+  return c_ObjectData::os_invoke(c, s, params, hash, fatal);
+}
+#endif // OMIT_JUMP_TABLE_CLASS_STATIC_INVOKE_xmlreader
+Variant c_xmlreader::o_invoke_from_eval(const char *s, Eval::VariableEnvironment &env, const Eval::FunctionCallExpression *caller, int64 hash, bool fatal) {
+  if (hash < 0) hash = hash_string_i(s);
+  switch (hash & 63) {
+    case 1:
+      HASH_GUARD(0x78AE97BFBEBF5341LL, close) {
+        const std::vector<Eval::ExpressionPtr> &params = caller->params();
+        int count __attribute__((__unused__)) = params.size();
+        if (count > 0) return throw_toomany_arguments("close", 0, 1);
+        std::vector<Eval::ExpressionPtr>::const_iterator it = params.begin();
+        do {
+        } while(false);
+        for (; it != params.end(); ++it) {
+          (*it)->eval(env);
+        }
+        return (t_close());
+      }
+      HASH_GUARD(0x1F479267E49EF301LL, read) {
+        const std::vector<Eval::ExpressionPtr> &params = caller->params();
+        int count __attribute__((__unused__)) = params.size();
+        if (count > 0) return throw_toomany_arguments("read", 0, 1);
+        std::vector<Eval::ExpressionPtr>::const_iterator it = params.begin();
+        do {
+        } while(false);
+        for (; it != params.end(); ++it) {
+          (*it)->eval(env);
+        }
+        return (t_read());
+      }
+      break;
+    case 4:
+      HASH_GUARD(0x21F68C010C124BC4LL, open) {
+        Variant a0;
+        Variant a1;
+        Variant a2;
+        const std::vector<Eval::ExpressionPtr> &params = caller->params();
+        int count __attribute__((__unused__)) = params.size();
+        if (count < 1 || count > 3) return throw_wrong_arguments("open", count, 1, 3, 1);
+        std::vector<Eval::ExpressionPtr>::const_iterator it = params.begin();
+        do {
+          if (it == params.end()) break;
+          a0 = (*it)->eval(env);
+          it++;
+          if (it == params.end()) break;
+          a1 = (*it)->eval(env);
+          it++;
+          if (it == params.end()) break;
+          a2 = (*it)->eval(env);
+          it++;
+        } while(false);
+        for (; it != params.end(); ++it) {
+          (*it)->eval(env);
+        }
+        if (count <= 1) return (t_open(a0));
+        else if (count == 2) return (t_open(a0, a1));
+        else return (t_open(a0, a1, a2));
+      }
+      break;
+    case 6:
+      HASH_GUARD(0x0C1F965FD1079AC6LL, movetofirstattribute) {
+        const std::vector<Eval::ExpressionPtr> &params = caller->params();
+        int count __attribute__((__unused__)) = params.size();
+        if (count > 0) return throw_toomany_arguments("movetofirstattribute", 0, 1);
+        std::vector<Eval::ExpressionPtr>::const_iterator it = params.begin();
+        do {
+        } while(false);
+        for (; it != params.end(); ++it) {
+          (*it)->eval(env);
+        }
+        return (t_movetofirstattribute());
+      }
+      break;
+    case 7:
+      HASH_GUARD(0x0D2003842AF83A07LL, getparserproperty) {
+        Variant a0;
+        const std::vector<Eval::ExpressionPtr> &params = caller->params();
+        int count __attribute__((__unused__)) = params.size();
+        if (count != 1) return throw_wrong_arguments("getparserproperty", count, 1, 1, 1);
+        std::vector<Eval::ExpressionPtr>::const_iterator it = params.begin();
+        do {
+          if (it == params.end()) break;
+          a0 = (*it)->eval(env);
+          it++;
+        } while(false);
+        for (; it != params.end(); ++it) {
+          (*it)->eval(env);
+        }
+        return (t_getparserproperty(a0));
+      }
+      break;
+    case 13:
+      HASH_GUARD(0x39B7BB05F05A37CDLL, expand) {
+        const std::vector<Eval::ExpressionPtr> &params = caller->params();
+        int count __attribute__((__unused__)) = params.size();
+        if (count > 0) return throw_toomany_arguments("expand", 0, 1);
+        std::vector<Eval::ExpressionPtr>::const_iterator it = params.begin();
+        do {
+        } while(false);
+        for (; it != params.end(); ++it) {
+          (*it)->eval(env);
+        }
+        return (t_expand());
+      }
+      break;
+    case 14:
+      HASH_GUARD(0x797E2A56E560520ELL, readinnerxml) {
+        const std::vector<Eval::ExpressionPtr> &params = caller->params();
+        int count __attribute__((__unused__)) = params.size();
+        if (count > 0) return throw_toomany_arguments("readinnerxml", 0, 1);
+        std::vector<Eval::ExpressionPtr>::const_iterator it = params.begin();
+        do {
+        } while(false);
+        for (; it != params.end(); ++it) {
+          (*it)->eval(env);
+        }
+        return (t_readinnerxml());
+      }
+      break;
+    case 15:
+      HASH_GUARD(0x26B6E00C74FA338FLL, __get) {
+        Variant a0;
+        const std::vector<Eval::ExpressionPtr> &params = caller->params();
+        int count __attribute__((__unused__)) = params.size();
+        if (count != 1) return throw_wrong_arguments("__get", count, 1, 1, 1);
+        std::vector<Eval::ExpressionPtr>::const_iterator it = params.begin();
+        do {
+          if (it == params.end()) break;
+          a0 = (*it)->eval(env);
+          it++;
+        } while(false);
+        for (; it != params.end(); ++it) {
+          (*it)->eval(env);
+        }
+        return (t___get(a0));
+      }
+      break;
+    case 19:
+      HASH_GUARD(0x7BA9DD90E7AE3A13LL, setparserproperty) {
+        Variant a0;
+        Variant a1;
+        const std::vector<Eval::ExpressionPtr> &params = caller->params();
+        int count __attribute__((__unused__)) = params.size();
+        if (count != 2) return throw_wrong_arguments("setparserproperty", count, 2, 2, 1);
+        std::vector<Eval::ExpressionPtr>::const_iterator it = params.begin();
+        do {
+          if (it == params.end()) break;
+          a0 = (*it)->eval(env);
+          it++;
+          if (it == params.end()) break;
+          a1 = (*it)->eval(env);
+          it++;
+        } while(false);
+        for (; it != params.end(); ++it) {
+          (*it)->eval(env);
+        }
+        return (t_setparserproperty(a0, a1));
+      }
+      break;
+    case 20:
+      HASH_GUARD(0x1986122197FD4B14LL, xml) {
+        Variant a0;
+        Variant a1;
+        Variant a2;
+        const std::vector<Eval::ExpressionPtr> &params = caller->params();
+        int count __attribute__((__unused__)) = params.size();
+        if (count < 1 || count > 3) return throw_wrong_arguments("xml", count, 1, 3, 1);
+        std::vector<Eval::ExpressionPtr>::const_iterator it = params.begin();
+        do {
+          if (it == params.end()) break;
+          a0 = (*it)->eval(env);
+          it++;
+          if (it == params.end()) break;
+          a1 = (*it)->eval(env);
+          it++;
+          if (it == params.end()) break;
+          a2 = (*it)->eval(env);
+          it++;
+        } while(false);
+        for (; it != params.end(); ++it) {
+          (*it)->eval(env);
+        }
+        if (count <= 1) return (t_xml(a0));
+        else if (count == 2) return (t_xml(a0, a1));
+        else return (t_xml(a0, a1, a2));
+      }
+      break;
+    case 21:
+      HASH_GUARD(0x52F3DAD783340395LL, __set) {
+        Variant a0;
+        Variant a1;
+        const std::vector<Eval::ExpressionPtr> &params = caller->params();
+        int count __attribute__((__unused__)) = params.size();
+        if (count != 2) return throw_wrong_arguments("__set", count, 2, 2, 1);
+        std::vector<Eval::ExpressionPtr>::const_iterator it = params.begin();
+        do {
+          if (it == params.end()) break;
+          a0 = (*it)->eval(env);
+          it++;
+          if (it == params.end()) break;
+          a1 = (*it)->eval(env);
+          it++;
+        } while(false);
+        for (; it != params.end(); ++it) {
+          (*it)->eval(env);
+        }
+        return (t___set(a0, a1));
+      }
+      break;
+    case 25:
+      HASH_GUARD(0x33982845A5250499LL, getattributeno) {
+        Variant a0;
+        const std::vector<Eval::ExpressionPtr> &params = caller->params();
+        int count __attribute__((__unused__)) = params.size();
+        if (count != 1) return throw_wrong_arguments("getattributeno", count, 1, 1, 1);
+        std::vector<Eval::ExpressionPtr>::const_iterator it = params.begin();
+        do {
+          if (it == params.end()) break;
+          a0 = (*it)->eval(env);
+          it++;
+        } while(false);
+        for (; it != params.end(); ++it) {
+          (*it)->eval(env);
+        }
+        return (t_getattributeno(a0));
+      }
+      HASH_GUARD(0x34E103E06D3F0899LL, getattributens) {
+        Variant a0;
+        Variant a1;
+        const std::vector<Eval::ExpressionPtr> &params = caller->params();
+        int count __attribute__((__unused__)) = params.size();
+        if (count != 2) return throw_wrong_arguments("getattributens", count, 2, 2, 1);
+        std::vector<Eval::ExpressionPtr>::const_iterator it = params.begin();
+        do {
+          if (it == params.end()) break;
+          a0 = (*it)->eval(env);
+          it++;
+          if (it == params.end()) break;
+          a1 = (*it)->eval(env);
+          it++;
+        } while(false);
+        for (; it != params.end(); ++it) {
+          (*it)->eval(env);
+        }
+        return (t_getattributens(a0, a1));
+      }
+      break;
+    case 27:
+      HASH_GUARD(0x06697B31313080DBLL, readouterxml) {
+        const std::vector<Eval::ExpressionPtr> &params = caller->params();
+        int count __attribute__((__unused__)) = params.size();
+        if (count > 0) return throw_toomany_arguments("readouterxml", 0, 1);
+        std::vector<Eval::ExpressionPtr>::const_iterator it = params.begin();
+        do {
+        } while(false);
+        for (; it != params.end(); ++it) {
+          (*it)->eval(env);
+        }
+        return (t_readouterxml());
+      }
+      break;
+    case 29:
+      HASH_GUARD(0x182BF31CCB09E11DLL, lookupnamespace) {
+        Variant a0;
+        const std::vector<Eval::ExpressionPtr> &params = caller->params();
+        int count __attribute__((__unused__)) = params.size();
+        if (count != 1) return throw_wrong_arguments("lookupnamespace", count, 1, 1, 1);
+        std::vector<Eval::ExpressionPtr>::const_iterator it = params.begin();
+        do {
+          if (it == params.end()) break;
+          a0 = (*it)->eval(env);
+          it++;
+        } while(false);
+        for (; it != params.end(); ++it) {
+          (*it)->eval(env);
+        }
+        return (t_lookupnamespace(a0));
+      }
+      break;
+    case 31:
+      HASH_GUARD(0x0D31D0AC229C615FLL, __construct) {
+        const std::vector<Eval::ExpressionPtr> &params = caller->params();
+        int count __attribute__((__unused__)) = params.size();
+        if (count > 0) return throw_toomany_arguments("__construct", 0, 1);
+        std::vector<Eval::ExpressionPtr>::const_iterator it = params.begin();
+        do {
+        } while(false);
+        for (; it != params.end(); ++it) {
+          (*it)->eval(env);
+        }
+        return (t___construct(), null);
+      }
+      break;
+    case 39:
+      HASH_GUARD(0x72A8D1997F7E0F67LL, movetonextattribute) {
+        const std::vector<Eval::ExpressionPtr> &params = caller->params();
+        int count __attribute__((__unused__)) = params.size();
+        if (count > 0) return throw_toomany_arguments("movetonextattribute", 0, 1);
+        std::vector<Eval::ExpressionPtr>::const_iterator it = params.begin();
+        do {
+        } while(false);
+        for (; it != params.end(); ++it) {
+          (*it)->eval(env);
+        }
+        return (t_movetonextattribute());
+      }
+      break;
+    case 40:
+      HASH_GUARD(0x49F89C466612FC28LL, getattribute) {
+        Variant a0;
+        const std::vector<Eval::ExpressionPtr> &params = caller->params();
+        int count __attribute__((__unused__)) = params.size();
+        if (count != 1) return throw_wrong_arguments("getattribute", count, 1, 1, 1);
+        std::vector<Eval::ExpressionPtr>::const_iterator it = params.begin();
+        do {
+          if (it == params.end()) break;
+          a0 = (*it)->eval(env);
+          it++;
+        } while(false);
+        for (; it != params.end(); ++it) {
+          (*it)->eval(env);
+        }
+        return (t_getattribute(a0));
+      }
+      break;
+    case 43:
+      HASH_GUARD(0x71E1A6F1ACA9872BLL, isvalid) {
+        const std::vector<Eval::ExpressionPtr> &params = caller->params();
+        int count __attribute__((__unused__)) = params.size();
+        if (count > 0) return throw_toomany_arguments("isvalid", 0, 1);
+        std::vector<Eval::ExpressionPtr>::const_iterator it = params.begin();
+        do {
+        } while(false);
+        for (; it != params.end(); ++it) {
+          (*it)->eval(env);
+        }
+        return (t_isvalid());
+      }
+      break;
+    case 47:
+      HASH_GUARD(0x0CFE207982641D6FLL, movetoelement) {
+        const std::vector<Eval::ExpressionPtr> &params = caller->params();
+        int count __attribute__((__unused__)) = params.size();
+        if (count > 0) return throw_toomany_arguments("movetoelement", 0, 1);
+        std::vector<Eval::ExpressionPtr>::const_iterator it = params.begin();
+        do {
+        } while(false);
+        for (; it != params.end(); ++it) {
+          (*it)->eval(env);
+        }
+        return (t_movetoelement());
+      }
+      break;
+    case 51:
+      HASH_GUARD(0x7F974836AACC1EF3LL, __destruct) {
+        const std::vector<Eval::ExpressionPtr> &params = caller->params();
+        int count __attribute__((__unused__)) = params.size();
+        if (count > 0) return throw_toomany_arguments("__destruct", 0, 1);
+        std::vector<Eval::ExpressionPtr>::const_iterator it = params.begin();
+        do {
+        } while(false);
+        for (; it != params.end(); ++it) {
+          (*it)->eval(env);
+        }
+        return (t___destruct());
+      }
+      break;
+    case 52:
+      HASH_GUARD(0x062D7D5B55654634LL, readstring) {
+        const std::vector<Eval::ExpressionPtr> &params = caller->params();
+        int count __attribute__((__unused__)) = params.size();
+        if (count > 0) return throw_toomany_arguments("readstring", 0, 1);
+        std::vector<Eval::ExpressionPtr>::const_iterator it = params.begin();
+        do {
+        } while(false);
+        for (; it != params.end(); ++it) {
+          (*it)->eval(env);
+        }
+        return (t_readstring());
+      }
+      HASH_GUARD(0x4E53414CB3A073B4LL, movetoattributeno) {
+        Variant a0;
+        const std::vector<Eval::ExpressionPtr> &params = caller->params();
+        int count __attribute__((__unused__)) = params.size();
+        if (count != 1) return throw_wrong_arguments("movetoattributeno", count, 1, 1, 1);
+        std::vector<Eval::ExpressionPtr>::const_iterator it = params.begin();
+        do {
+          if (it == params.end()) break;
+          a0 = (*it)->eval(env);
+          it++;
+        } while(false);
+        for (; it != params.end(); ++it) {
+          (*it)->eval(env);
+        }
+        return (t_movetoattributeno(a0));
+      }
+      break;
+    case 54:
+      HASH_GUARD(0x7DA2728AC230DFF6LL, movetoattribute) {
+        Variant a0;
+        const std::vector<Eval::ExpressionPtr> &params = caller->params();
+        int count __attribute__((__unused__)) = params.size();
+        if (count != 1) return throw_wrong_arguments("movetoattribute", count, 1, 1, 1);
+        std::vector<Eval::ExpressionPtr>::const_iterator it = params.begin();
+        do {
+          if (it == params.end()) break;
+          a0 = (*it)->eval(env);
+          it++;
+        } while(false);
+        for (; it != params.end(); ++it) {
+          (*it)->eval(env);
+        }
+        return (t_movetoattribute(a0));
+      }
+      break;
+    case 56:
+      HASH_GUARD(0x3C6D50F3BB8102B8LL, next) {
+        Variant a0;
+        const std::vector<Eval::ExpressionPtr> &params = caller->params();
+        int count __attribute__((__unused__)) = params.size();
+        if (count > 1) return throw_toomany_arguments("next", 1, 1);
+        std::vector<Eval::ExpressionPtr>::const_iterator it = params.begin();
+        do {
+          if (it == params.end()) break;
+          a0 = (*it)->eval(env);
+          it++;
+        } while(false);
+        for (; it != params.end(); ++it) {
+          (*it)->eval(env);
+        }
+        if (count <= 0) return (t_next());
+        else return (t_next(a0));
+      }
+      break;
+    case 61:
+      HASH_GUARD(0x0661BC19E05663FDLL, movetoattributens) {
+        Variant a0;
+        Variant a1;
+        const std::vector<Eval::ExpressionPtr> &params = caller->params();
+        int count __attribute__((__unused__)) = params.size();
+        if (count != 2) return throw_wrong_arguments("movetoattributens", count, 2, 2, 1);
+        std::vector<Eval::ExpressionPtr>::const_iterator it = params.begin();
+        do {
+          if (it == params.end()) break;
+          a0 = (*it)->eval(env);
+          it++;
+          if (it == params.end()) break;
+          a1 = (*it)->eval(env);
+          it++;
+        } while(false);
+        for (; it != params.end(); ++it) {
+          (*it)->eval(env);
+        }
+        return (t_movetoattributens(a0, a1));
+      }
+      break;
+    default:
+      break;
+  }
+  return c_ObjectData::o_invoke_from_eval(s, env, caller, hash, fatal);
+}
+Variant c_xmlreader::os_invoke_from_eval(const char *c, const char *s, Eval::VariableEnvironment &env, const Eval::FunctionCallExpression *caller, int64 hash, bool fatal) {
+  return c_ObjectData::os_invoke_from_eval(c, s, env, caller, hash, fatal);
+}
+struct ObjectStaticCallbacks cw_xmlreader = {
+  c_xmlreader::os_getInit,
+  c_xmlreader::os_get,
+  c_xmlreader::os_lval,
+  c_xmlreader::os_invoke,
+  c_xmlreader::os_constant,
+};
 Object co_xmlwriter(CArrRef params, bool init /* = true */) {
   return Object((NEW(c_xmlwriter)())->dynCreate(params, init));
 }
@@ -27681,6 +28689,9 @@ Variant get_builtin_class_var_init(const char *s, const char *var) {
     case 30:
       HASH_GET_CLASS_VAR_INIT(0x3DB8FB455A602A1ELL, datetime);
       break;
+    case 37:
+      HASH_GET_CLASS_VAR_INIT(0x1C85D092180A6325LL, xmlreader);
+      break;
     case 43:
       HASH_GET_CLASS_VAR_INIT(0x7E66D362EAB5BF2BLL, simplexmlelementiterator);
       break;
@@ -27900,6 +28911,9 @@ Object create_builtin_object(const char *s, CArrRef params, bool init /* = true
     case 30:
       HASH_CREATE_OBJECT(0x3DB8FB455A602A1ELL, datetime);
       break;
+    case 37:
+      HASH_CREATE_OBJECT(0x1C85D092180A6325LL, xmlreader);
+      break;
     case 43:
       HASH_CREATE_OBJECT(0x7E66D362EAB5BF2BLL, simplexmlelementiterator);
       break;
@@ -28119,6 +29133,9 @@ Variant invoke_builtin_static_method(const char *s, const char *method, CArrRef
     case 30:
       HASH_INVOKE_STATIC_METHOD(0x3DB8FB455A602A1ELL, datetime);
       break;
+    case 37:
+      HASH_INVOKE_STATIC_METHOD(0x1C85D092180A6325LL, xmlreader);
+      break;
     case 43:
       HASH_INVOKE_STATIC_METHOD(0x7E66D362EAB5BF2BLL, simplexmlelementiterator);
       break;
@@ -28343,6 +29360,9 @@ const ObjectStaticCallbacks * get_builtin_object_static_callbacks(const char *s)
     case 30:
       HASH_GET_OBJECT_STATIC_CALLBACKS(0x3DB8FB455A602A1ELL, datetime);
       break;
+    case 37:
+      HASH_GET_OBJECT_STATIC_CALLBACKS(0x1C85D092180A6325LL, xmlreader);
+      break;
     case 43:
       HASH_GET_OBJECT_STATIC_CALLBACKS(0x7E66D362EAB5BF2BLL, simplexmlelementiterator);
       break;
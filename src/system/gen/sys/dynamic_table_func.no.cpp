@@ -4511,6 +4511,24 @@ Variant i_set_time_limit(CArrRef params) {
   if (count != 1) return throw_wrong_arguments("set_time_limit", count, 1, 1, 1);
   return (f_set_time_limit(params[0]), null);
 }
+Variant i_hphp_set_request_deadline(CArrRef params) {
+  FUNCTION_INJECTION(hphp_set_request_deadline);
+  int count __attribute__((__unused__)) = params.size();
+  if (count != 1) return throw_wrong_arguments("hphp_set_request_deadline", count, 1, 1, 1);
+  return (f_hphp_set_request_deadline(params[0]), null);
+}
+Variant i_hphp_set_request_cpu_budget(CArrRef params) {
+  FUNCTION_INJECTION(hphp_set_request_cpu_budget);
+  int count __attribute__((__unused__)) = params.size();
+  if (count != 1) return throw_wrong_arguments("hphp_set_request_cpu_budget", count, 1, 1, 1);
+  return (f_hphp_set_request_cpu_budget(params[0]), null);
+}
+Variant i_hphp_get_request_cpu_time(CArrRef params) {
+  FUNCTION_INJECTION(hphp_get_request_cpu_time);
+  int count __attribute__((__unused__)) = params.size();
+  if (count > 0) return throw_toomany_arguments("hphp_get_request_cpu_time", 0, 1);
+  return (f_hphp_get_request_cpu_time());
+}
 Variant i_libxml_get_errors(CArrRef params) {
   FUNCTION_INJECTION(libxml_get_errors);
   int count __attribute__((__unused__)) = params.size();
@@ -11807,6 +11825,19 @@ Variant i_xhprof_sample_disable(CArrRef params) {
   if (count > 0) return throw_toomany_arguments("xhprof_sample_disable", 0, 1);
   return (f_xhprof_sample_disable());
 }
+Variant i_xhprof_heap_enable(CArrRef params) {
+  FUNCTION_INJECTION(xhprof_heap_enable);
+  int count __attribute__((__unused__)) = params.size();
+  if (count > 1) return throw_toomany_arguments("xhprof_heap_enable", 1, 1);
+  if (count <= 0) return (f_xhprof_heap_enable(), null);
+  return (f_xhprof_heap_enable(params[0]), null);
+}
+Variant i_xhprof_heap_disable(CArrRef params) {
+  FUNCTION_INJECTION(xhprof_heap_disable);
+  int count __attribute__((__unused__)) = params.size();
+  if (count > 0) return throw_toomany_arguments("xhprof_heap_disable", 0, 1);
+  return (f_xhprof_heap_disable());
+}
 Variant i_ldap_compare(CArrRef params) {
   FUNCTION_INJECTION(ldap_compare);
   int count __attribute__((__unused__)) = params.size();
@@ -12921,6 +12952,9 @@ Variant invoke_builtin(const char *s, CArrRef params, int64 hash, bool fatal) {
     case 301:
       HASH_INVOKE(0x7579DBE83CE5812DLL, imagerectangle);
       break;
+    case 302:
+      HASH_INVOKE(0x500D8EA31191412ELL, hphp_get_request_cpu_time);
+      break;
     case 307:
       HASH_INVOKE(0x6A7E0B15FF689133LL, mb_ereg_search_init);
       break;
@@ -14088,6 +14122,9 @@ Variant invoke_builtin(const char *s, CArrRef params, int64 hash, bool fatal) {
     case 1224:
       HASH_INVOKE(0x1B8BBFC882FDB4C8LL, magicktintimage);
       break;
+    case 1228:
+      HASH_INVOKE(0x2C11A49DF835F4CCLL, hphp_set_request_deadline);
+      break;
     case 1230:
       HASH_INVOKE(0x60783C20BF7724CELL, mailparse_msg_free);
       break;
@@ -14708,6 +14745,9 @@ Variant invoke_builtin(const char *s, CArrRef params, int64 hash, bool fatal) {
     case 1767:
       HASH_INVOKE(0x44201A16F3D876E7LL, trim);
       break;
+    case 1768:
+      HASH_INVOKE(0x38A640B07A03B6E8LL, hphp_set_request_cpu_budget);
+      break;
     case 1772:
       HASH_INVOKE(0x0A5EFECAE87EA6ECLL, hphp_splfileobject_eof);
       break;
@@ -15510,6 +15550,9 @@ Variant invoke_builtin(const char *s, CArrRef params, int64 hash, bool fatal) {
     case 2435:
       HASH_INVOKE(0x3DA64BF893DBF983LL, strncmp);
       break;
+    case 2437:
+      HASH_INVOKE(0x05004D4568AD1985LL, xhprof_heap_disable);
+      break;
     case 2438:
       HASH_INVOKE(0x6ECE4BDB8842E986LL, posix_strerror);
       break;
@@ -16673,6 +16716,9 @@ Variant invoke_builtin(const char *s, CArrRef params, int64 hash, bool fatal) {
     case 3332:
       HASH_INVOKE(0x1248250E701DAD04LL, magickgaussianblurimage);
       break;
+    case 3333:
+      HASH_INVOKE(0x58458D13D2190D05LL, xhprof_heap_enable);
+      break;
     case 3334:
       HASH_INVOKE(0x2BA9FB0F8B76DD06LL, number_format);
       break;
@@ -31807,6 +31853,50 @@ Variant ei_set_time_limit(Eval::VariableEnvironment &env, const Eval::FunctionCa
   }
   return (x_set_time_limit(a0), null);
 }
+Variant ei_hphp_set_request_deadline(Eval::VariableEnvironment &env, const Eval::FunctionCallExpression *caller) {
+  Variant a0;
+  const std::vector<Eval::ExpressionPtr> &params = caller->params();
+  int count __attribute__((__unused__)) = params.size();
+  if (count != 1) return throw_wrong_arguments("hphp_set_request_deadline", count, 1, 1, 1);
+  std::vector<Eval::ExpressionPtr>::const_iterator it = params.begin();
+  do {
+    if (it == params.end()) break;
+    a0 = (*it)->eval(env);
+    it++;
+  } while(false);
+  for (; it != params.end(); ++it) {
+    (*it)->eval(env);
+  }
+  return (x_hphp_set_request_deadline(a0), null);
+}
+Variant ei_hphp_set_request_cpu_budget(Eval::VariableEnvironment &env, const Eval::FunctionCallExpression *caller) {
+  Variant a0;
+  const std::vector<Eval::ExpressionPtr> &params = caller->params();
+  int count __attribute__((__unused__)) = params.size();
+  if (count != 1) return throw_wrong_arguments("hphp_set_request_cpu_budget", count, 1, 1, 1);
+  std::vector<Eval::ExpressionPtr>::const_iterator it = params.begin();
+  do {
+    if (it == params.end()) break;
+    a0 = (*it)->eval(env);
+    it++;
+  } while(false);
+  for (; it != params.end(); ++it) {
+    (*it)->eval(env);
+  }
+  return (x_hphp_set_request_cpu_budget(a0), null);
+}
+Variant ei_hphp_get_request_cpu_time(Eval::VariableEnvironment &env, const Eval::FunctionCallExpression *caller) {
+  const std::vector<Eval::ExpressionPtr> &params = caller->params();
+  int count __attribute__((__unused__)) = params.size();
+  if (count > 0) return throw_toomany_arguments("hphp_get_request_cpu_time", 0, 1);
+  std::vector<Eval::ExpressionPtr>::const_iterator it = params.begin();
+  do {
+  } while(false);
+  for (; it != params.end(); ++it) {
+    (*it)->eval(env);
+  }
+  return (x_hphp_get_request_cpu_time());
+}
 Variant ei_libxml_get_errors(Eval::VariableEnvironment &env, const Eval::FunctionCallExpression *caller) {
   const std::vector<Eval::ExpressionPtr> &params = caller->params();
   int count __attribute__((__unused__)) = params.size();
@@ -55194,6 +55284,35 @@ Variant ei_xhprof_sample_disable(Eval::VariableEnvironment &env, const Eval::Fun
   }
   return (x_xhprof_sample_disable());
 }
+Variant ei_xhprof_heap_enable(Eval::VariableEnvironment &env, const Eval::FunctionCallExpression *caller) {
+  Variant a0;
+  const std::vector<Eval::ExpressionPtr> &params = caller->params();
+  int count __attribute__((__unused__)) = params.size();
+  if (count > 1) return throw_toomany_arguments("xhprof_heap_enable", 1, 1);
+  std::vector<Eval::ExpressionPtr>::const_iterator it = params.begin();
+  do {
+    if (it == params.end()) break;
+    a0 = (*it)->eval(env);
+    it++;
+  } while(false);
+  for (; it != params.end(); ++it) {
+    (*it)->eval(env);
+  }
+  if (count <= 0) return (x_xhprof_heap_enable(), null);
+  else return (x_xhprof_heap_enable(a0), null);
+}
+Variant ei_xhprof_heap_disable(Eval::VariableEnvironment &env, const Eval::FunctionCallExpression *caller) {
+  const std::vector<Eval::ExpressionPtr> &params = caller->params();
+  int count __attribute__((__unused__)) = params.size();
+  if (count > 0) return throw_toomany_arguments("xhprof_heap_disable", 0, 1);
+  std::vector<Eval::ExpressionPtr>::const_iterator it = params.begin();
+  do {
+  } while(false);
+  for (; it != params.end(); ++it) {
+    (*it)->eval(env);
+  }
+  return (x_xhprof_heap_disable());
+}
 Variant ei_ldap_compare(Eval::VariableEnvironment &env, const Eval::FunctionCallExpression *caller) {
   Variant a0;
   Variant a1;
@@ -58034,6 +58153,9 @@ Variant Eval::invoke_from_eval_builtin(const char *s, Eval::VariableEnvironment
     case 301:
       HASH_INVOKE_FROM_EVAL(0x7579DBE83CE5812DLL, imagerectangle);
       break;
+    case 302:
+      HASH_INVOKE_FROM_EVAL(0x500D8EA31191412ELL, hphp_get_request_cpu_time);
+      break;
     case 307:
       HASH_INVOKE_FROM_EVAL(0x6A7E0B15FF689133LL, mb_ereg_search_init);
       break;
@@ -59201,6 +59323,9 @@ Variant Eval::invoke_from_eval_builtin(const char *s, Eval::VariableEnvironment
     case 1224:
       HASH_INVOKE_FROM_EVAL(0x1B8BBFC882FDB4C8LL, magicktintimage);
       break;
+    case 1228:
+      HASH_INVOKE_FROM_EVAL(0x2C11A49DF835F4CCLL, hphp_set_request_deadline);
+      break;
     case 1230:
       HASH_INVOKE_FROM_EVAL(0x60783C20BF7724CELL, mailparse_msg_free);
       break;
@@ -59821,6 +59946,9 @@ Variant Eval::invoke_from_eval_builtin(const char *s, Eval::VariableEnvironment
     case 1767:
       HASH_INVOKE_FROM_EVAL(0x44201A16F3D876E7LL, trim);
       break;
+    case 1768:
+      HASH_INVOKE_FROM_EVAL(0x38A640B07A03B6E8LL, hphp_set_request_cpu_budget);
+      break;
     case 1772:
       HASH_INVOKE_FROM_EVAL(0x0A5EFECAE87EA6ECLL, hphp_splfileobject_eof);
       break;
@@ -60623,6 +60751,9 @@ Variant Eval::invoke_from_eval_builtin(const char *s, Eval::VariableEnvironment
     case 2435:
       HASH_INVOKE_FROM_EVAL(0x3DA64BF893DBF983LL, strncmp);
       break;
+    case 2437:
+      HASH_INVOKE_FROM_EVAL(0x05004D4568AD1985LL, xhprof_heap_disable);
+      break;
     case 2438:
       HASH_INVOKE_FROM_EVAL(0x6ECE4BDB8842E986LL, posix_strerror);
       break;
@@ -61786,6 +61917,9 @@ Variant Eval::invoke_from_eval_builtin(const char *s, Eval::VariableEnvironment
     case 3332:
       HASH_INVOKE_FROM_EVAL(0x1248250E701DAD04LL, magickgaussianblurimage);
       break;
+    case 3333:
+      HASH_INVOKE_FROM_EVAL(0x58458D13D2190D05LL, xhprof_heap_enable);
+      break;
     case 3334:
       HASH_INVOKE_FROM_EVAL(0x2BA9FB0F8B76DD06LL, number_format);
       break;
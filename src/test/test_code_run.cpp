@@ -1478,6 +1478,23 @@ bool TestCodeRun::TestScalarArray() {
       "function test1() { $a = array(__FUNCTION__, __LINE__); return $a; }\n"
       "function test2() { $a = array(__FUNCTION__, __LINE__); return $a; }\n"
       "var_dump(test1()); var_dump(test2());");
+  MVCR("<?php "
+      "var_dump(strtolower('ABC'), strtoupper('abc'), trim('  x  '));"
+      "var_dump(implode(',', array('a', 'b', 'c')));"
+      "var_dump(explode(',', 'a,b,c'));"
+      "var_dump(str_pad('5', 3, '0', STR_PAD_LEFT), substr('hello', 1, 3));"
+      "var_dump(array_flip(array('a', 'b')));"
+      "var_dump(array_merge(array(1, 2), array('k' => 3)));"
+      "var_dump(strlen(str_repeat('ab', 5000)));");
+  // never run, and not evaluated at compile time either
+  MVCR("<?php "
+      "function big() {"
+      "  return array(str_repeat('x', 1000000000),"
+      "               str_pad('x', 1000000000),"
+      "               sprintf('%01000000000d', 1),"
+      "               range(1, 1000000000));"
+      "}"
+      "var_dump(function_exists('big'));");
 
   return true;
 }
@@ -3348,6 +3365,32 @@ bool TestCodeRun::TestObjectMethod() {
       "$obj->b_sf();"
       "$obj->a_f();"
       "$obj->b_f();");
+
+  // one call site seeing more receivers than its inline cache holds,
+  // private methods that shadow public ones, and repeated static calls
+  MVCR("<?php "
+      "class A { function f() { return 'A'; } "
+      "  function g() { return $this->h(); } "
+      "  private function h() { return 'A::h'; } "
+      "  static function s($i) { return $i * 2; } "
+      "  protected $p = 'A::p'; "
+      "  function p() { return $this->p; } }"
+      "class B extends A { function f() { return 'B'; } "
+      "  function h() { return 'B::h'; } }"
+      "class C extends B { function f() { return 'C'; } "
+      "  protected $p = 'C::p'; }"
+      "class D extends A { }"
+      "class E extends D { function f() { return 'E'; } }"
+      "class F extends E { function f() { return 'F'; } }"
+      "$objs = array(new A, new B, new C, new D, new E, new F);"
+      "for ($i = 0; $i < 3; $i++) {"
+      "  foreach ($objs as $obj) {"
+      "    echo $obj->f(), ' ', $obj->g(), ' ', $obj->p(), ' ';"
+      "    echo A::s($i), \"\\n\";"
+      "  }"
+      "}"
+      "$b = new B;"
+      "echo $b->h(), \"\\n\";");
   return true;
 }
 
@@ -4625,6 +4668,22 @@ bool TestCodeRun::TestDynamicVariables() {
        "}"
        "test('b');");
 
+  // locals reached by name from functions without $$var or extract()
+  MVCR("<?php "
+       "function test($a) {"
+       "  $b = $a + 1;"
+       "  var_dump($b);"
+       "  unset($b);"
+       "  var_dump(isset($b), $GLOBALS['g'], isset($_SERVER));"
+       "  global $g;"
+       "  $g++;"
+       "  static $s = 0;"
+       "  $s += $a;"
+       "  return $s;"
+       "}"
+       "$g = 10;"
+       "var_dump(test(1), test(2), $g);");
+
   return true;
 }
 
@@ -8987,6 +9046,14 @@ bool TestCodeRun::TestJson() {
        "$obj = new A();"
        "$obj->aaaa();");
 
+  MVCR("<?php "
+       "$a = array();"
+       "for ($i = 0; $i < 2000; $i++) {"
+       "  $a['key' . $i] = array($i, 'value' . $i, $i * 0.5, $i % 2 == 0);"
+       "}"
+       "echo '[', json_encode($a), ']';"
+       "echo json_encode(array()), json_encode('tail');");
+
 #if 0
   MVCR("<?php "
       "$a = array(1);"
@@ -10244,6 +10311,42 @@ bool TestCodeRun::TestAssignment() {
        "  var_dump($expected, $list_expected);"
        "}"
        "foo();");
+
+  // value hand-over of dead locals
+  MVCR("<?php ;"
+       "class X"
+       "{"
+       "  public $n;"
+       "  function __construct($n) { $this->n = $n; }"
+       "  function __destruct() { var_dump('destruct '.$this->n); }"
+       "}"
+       "function foo($n) {"
+       "  $a = new X($n);"
+       "  $b = new X($n + 1);"
+       "  var_dump('before');"
+       "  $b = $a;"
+       "  var_dump('after');"
+       "  var_dump($b->n);"
+       "}"
+       "function bar($s) {"
+       "  $a = $s . 'x';"
+       "  $b = array($a);"
+       "  $c = $b;"
+       "  if ($s) {"
+       "    $d = $a;"
+       "    var_dump($d);"
+       "  } else {"
+       "    var_dump($a);"
+       "  }"
+       "  var_dump($c, $b);"
+       "  for ($i = 0; $i < 2; $i++) {"
+       "    $e = $a;"
+       "    var_dump($e);"
+       "  }"
+       "}"
+       "foo(1);"
+       "bar('y');"
+       "bar('');");
   return true;
 }
 
@@ -11292,6 +11395,37 @@ bool TestCodeRun::TestSwitchStatement() {
       "case 'foo': "
       "default:"
       "}");
+
+  MVCR("<?php "
+      "function route($p) {"
+      "  switch ($p) {"
+      "  case 'home': return 1;"
+      "  case 'login': return 2;"
+      "  case 'logout': return 3;"
+      "  case 'profile':"
+      "  case 'settings': return 4;"
+      "  default: return 0;"
+      "  case 'search': return 5;"
+      "  case 'login': return 6;"
+      "  case 'photos': return 7;"
+      "  case '': return 8;"
+      "  case 'help': return 9;"
+      "  }"
+      "}"
+      "foreach (array('home', 'login', 'settings', 'search', 'photos', 'x',"
+      "               '', null, 0, false, true, 'HELP', 'help') as $p) {"
+      "  var_dump(route($p));"
+      "}"
+      "function tag($t) {"
+      "  $s = (string)$t;"
+      "  switch ($s) {"
+      "  case 'a': case 'b': case 'c': case 'd': echo 'low'; break;"
+      "  case 'e': case 'f': case 'g': echo 'mid'; break;"
+      "  case 'h': case 'i': echo 'high'; break;"
+      "  }"
+      "  echo \"\\n\";"
+      "}"
+      "tag('a'); tag('g'); tag('i'); tag('z'); tag(null);");
   return true;
 }
 
@@ -11395,6 +11529,48 @@ bool TestCodeRun::TestExtArray() {
       "var_dump(array_chunk(array()));"
       "$a = array(1, 2);"
       "var_dump(asort($a, 100000));");
+  MVCR("<?php "
+      "$ints = array('x' => 3, 1, 'y' => -7, 3, 10, 2, 'z' => 1);"
+      "$doubles = array(2.5, -1.0, 2.5, 1e10, 0.1, 'k' => 3.25);"
+      "$strings = array('b' => 'pear', 'apple', '10', '9', '1e1', 'Apple',"
+      "                 'a' => 'apple');"
+      "$mixed = array(3, '3', 'three', 2.5, null, true);"
+      "foreach (array($ints, $doubles, $strings, $mixed) as $arr) {"
+      "  foreach (array(SORT_REGULAR, SORT_NUMERIC, SORT_STRING) as $f) {"
+      "    $a = $arr; sort($a, $f); var_dump($a);"
+      "    $a = $arr; rsort($a, $f); var_dump($a);"
+      "    $a = $arr; asort($a, $f); var_dump($a);"
+      "    $a = $arr; arsort($a, $f); var_dump($a);"
+      "    $a = $arr; ksort($a, $f); var_dump($a);"
+      "    $a = $arr; krsort($a, $f); var_dump($a);"
+      "  }"
+      "}"
+      "$a = $ints; $b = $a; sort($a); var_dump($a, $b);"
+      "$a = $ints; sort($a); $a[] = 'next'; var_dump($a);"
+      "$a = $ints; unset($a[3]); asort($a); $a[] = 'next'; var_dump($a);"
+      "function cmp($x, $y) { return $x == $y ? 0 : ($x < $y ? 1 : -1); }"
+      "$a = $ints; usort($a, 'cmp'); var_dump($a);"
+      "$a = $strings; uasort($a, 'cmp'); var_dump($a);"
+      "$a = $strings; uksort($a, 'cmp'); var_dump($a);"
+      "$a = array(3, 1, 3, 2); $b = array('c', 'a', 'b', 'd');"
+      "$c = array('x' => 1, 'y' => 2, 5 => 3, 4);"
+      "array_multisort($a, $b, SORT_DESC, $c); var_dump($a, $b, $c);"
+      "$a = array(1.5, 0.5, 1.5); $b = array(3, 2, 1);"
+      "array_multisort($a, SORT_DESC, $b, SORT_STRING); var_dump($a, $b);");
+  // user code run by comparisons still sees the array being sorted
+  MVCR("<?php "
+      "class S {"
+      "  public $v;"
+      "  function __construct($v) { $this->v = $v; }"
+      "  function __toString() { global $a; return count($a) . $this->v; }"
+      "}"
+      "$a = array(new S('b'), new S('c'), new S('a'));"
+      "sort($a, SORT_STRING);"
+      "foreach ($a as $o) echo $o, ' ';"
+      "$b = array(2, 1, 3);"
+      "array_multisort($a, SORT_STRING, $b);"
+      "foreach ($a as $o) echo $o, ' ';"
+      "var_dump($b);");
 
   return true;
 }
@@ -26,6 +26,9 @@
 #include <runtime/base/shared/shared_store.h>
 #include <runtime/base/runtime_option.h>
 #include <runtime/base/server/ip_block_map.h>
+#include <runtime/base/server/upload.h>
+#include <runtime/base/util/chunked_buffer.h>
+#include <runtime/base/server/server_stats_shm.h>
 #include <test/test_mysql_info.inc>
 
 using namespace std;
@@ -40,6 +43,8 @@ TestCppBase::TestCppBase() {
 bool TestCppBase::RunTests(const std::string &which) {
   bool ret = true;
   RUN_TEST(TestSmartAllocator);
+  RUN_TEST(TestObjectSizeClasses);
+  RUN_TEST(TestChunkedBuffer);
   RUN_TEST(TestString);
   RUN_TEST(TestArray);
   RUN_TEST(TestObject);
@@ -49,6 +54,8 @@ bool TestCppBase::RunTests(const std::string &which) {
   RUN_TEST(TestMemoryManager);
 #endif
   RUN_TEST(TestIpBlockMap);
+  RUN_TEST(TestRfc1867);
+  RUN_TEST(TestServerStatsShm);
   return ret;
 }
 
@@ -127,6 +134,86 @@ bool TestCppBase::TestSmartAllocator() {
 ///////////////////////////////////////////////////////////////////////////////
 // data types
 
+bool TestCppBase::TestObjectSizeClasses() {
+  bool saved = RuntimeOption::ObjectSizeClasses;
+  int last = -1;
+  int step = sizeof(ObjectData);
+  for (int size = (int)sizeof(ObjectData); size <= 8192; size += 8) {
+    int seqno = ObjectAllocatorWrapper::getAllocatorSeqno(size);
+    VERIFY(seqno > last);
+    last = seqno;
+    VS(ObjectAllocatorWrapper::getSeqnoSize(seqno), size);
+
+    // the smallest size class that fits
+    RuntimeOption::ObjectSizeClasses = true;
+    int itemSize = ObjectAllocatorWrapper::getItemSize(seqno);
+    VS(itemSize % 16, 0);
+    VERIFY(itemSize >= size);
+    if (size <= 1024) {
+      VERIFY(itemSize - size < 16);
+    } else {
+      VERIFY(itemSize - size <= size / 4 + 16);
+    }
+
+    // the older 50% steps, exactly
+    while (step < size) {
+      step += (step >> 1);
+      step = ALIGN_WORD(step);
+    }
+    RuntimeOption::ObjectSizeClasses = false;
+    VS(ObjectAllocatorWrapper::getItemSize(seqno), step);
+  }
+  int sizes[] = { 72, 168, 1288, 1608 };
+  int steps[] = { 72, 168, 1296, 1944 };
+  for (int i = 0; i < 4; i++) {
+    int seqno = ObjectAllocatorWrapper::getAllocatorSeqno(sizes[i]);
+    VS(ObjectAllocatorWrapper::getItemSize(seqno), steps[i]);
+  }
+  RuntimeOption::ObjectSizeClasses = saved;
+  return Count(true);
+}
+
+bool TestCppBase::TestChunkedBuffer() {
+  std::string expected;
+  ChunkedBuffer buf;
+  VERIFY(buf.empty());
+  VS(buf.detach(), "");
+
+  buf.append("small", 5);
+  VS(buf.copy(), "small");
+  VS(buf.detach(), "small"); // handing over the only chunk
+  VERIFY(buf.empty());
+
+  std::string line = "0123456789abcdefghijklmnopqrstuvwxyz\n";
+  while ((int)expected.size() < ChunkedBuffer::ChunkSize * 3) {
+    buf.append(line.data(), line.size());
+    expected += line;
+  }
+  VS(buf.size(), (int)expected.size());
+
+  ChunkedBuffer more;
+  more.append("tail", 4);
+  buf.absorb(more);
+  expected += "tail";
+  VERIFY(more.empty());
+  buf.append("!", 1);
+  expected += "!";
+
+  std::vector<iovec> chunks;
+  buf.getChunks(chunks);
+  VS((int)chunks.size(), 5);
+  std::string joined;
+  for (unsigned int i = 0; i < chunks.size(); i++) {
+    joined.append((const char *)chunks[i].iov_base, chunks[i].iov_len);
+  }
+  VS(joined, expected);
+
+  VS(buf.copy(), String(expected));
+  VS(buf.detach(), String(expected));
+  VERIFY(buf.empty());
+  return Count(true);
+}
+
 bool TestCppBase::TestString() {
   // constructors
   {
@@ -213,6 +300,41 @@ bool TestCppBase::TestString() {
     VS((const char *)s, "tez q");
   }
 
+  // hash codes, cached until the string changes
+  {
+    VERIFY(String().hash() == hash_string("", 0));
+    String s = String("user_") + "12";
+    VERIFY(s.hash() == hash_string("user_12", 7));
+    VERIFY(s.hash() == hash_string("user_12", 7));
+    s += "3";
+    VERIFY(s.hash() == hash_string("user_123", 8));
+    s.lvalAt(0) = "U";
+    VERIFY(s.hash() == hash_string("User_123", 8));
+    s = ~s;
+    VERIFY(s.hash() == String(~String("User_123")).hash());
+    s = "a9";
+    s.get()->inc();
+    VERIFY(s.hash() == hash_string("b0", 2));
+
+    Array arr;
+    arr.set(String("user_") + "12", 1);
+    VERIFY(arr.exists(String("user_") + "12"));
+    VERIFY(arr[String("user_12")].toInt32() == 1);
+  }
+
+  // an interned key doesn't hold on to a literal's buffer
+  {
+    int saved = RuntimeOption::InternArrayKeys;
+    RuntimeOption::InternArrayKeys = 16;
+    char buf[] = "transient";
+    Array arr;
+    arr.set(String(buf, AttachLiteral), 1);
+    memcpy(buf, "clobbered", 9);
+    VS(arr.begin().first(), "transient");
+    VERIFY(arr.exists(String("trans") + "ient"));
+    RuntimeOption::InternArrayKeys = saved;
+  }
+
   return Count(true);
 }
 
@@ -993,3 +1115,133 @@ bool TestCppBase::TestIpBlockMap() {
 
   return Count(true);
 }
+
+/**
+ * Hands out POST data in fixed size chunks, the way LibEventTransport does
+ * with read limiting turned on.
+ */
+class ChunkedPostTransport : public Transport {
+public:
+  ChunkedPostTransport(const std::string &body, int chunkSize)
+    : m_body(body), m_chunkSize(chunkSize), m_offset(0) {}
+
+  virtual const char *getUrl() { return "/upload";}
+  virtual const char *getRemoteHost() { return "127.0.0.1";}
+  virtual const void *getPostData(int &size) {
+    m_offset = 0;
+    return getMorePostData(size);
+  }
+  virtual bool hasMorePostData() { return m_offset < (int)m_body.size();}
+  virtual const void *getMorePostData(int &size) {
+    size = m_body.size() - m_offset;
+    if (size > m_chunkSize) size = m_chunkSize;
+    m_chunk = m_body.substr(m_offset, size);
+    m_offset += size;
+    return m_chunk.c_str();
+  }
+  virtual Method getMethod() { return Transport::POST;}
+  virtual std::string getHeader(const char *name) { return "";}
+  virtual void getHeaders(HeaderMap &headers) {}
+  virtual void addHeaderImpl(const char *name, const char *value) {}
+  virtual void removeHeaderImpl(const char *name) {}
+  virtual void sendImpl(const void *data, int size, int code, bool chunked) {}
+
+private:
+  std::string m_body;
+  std::string m_chunk;
+  int m_chunkSize;
+  int m_offset;
+};
+
+static std::string make_multipart(const std::string &boundary, int fileSize) {
+  std::string body;
+  body += "--" + boundary + "\r\n";
+  body += "Content-Disposition: form-data; name=\"name\"\r\n\r\n";
+  body += "value\r\n";
+  body += "--" + boundary + "\r\n";
+  body += "Content-Disposition: form-data; name=\"f\"; "
+          "filename=\"photo.jpg\"\r\n";
+  body += "Content-Type: image/jpeg\r\n\r\n";
+  for (int i = 0; i < fileSize; i++) {
+    body += (char)('a' + i % 26);
+  }
+  body += "\r\n--" + boundary + "--\r\n";
+  return body;
+}
+
+bool TestCppBase::TestRfc1867() {
+  if (RuntimeOption::UploadTmpDir.empty()) {
+    RuntimeOption::UploadTmpDir = "/tmp";
+  }
+  RuntimeOption::EnableFileUploads = true;
+
+  std::string boundary = "----HPHPTestBoundary";
+  int fileSize = 8 * 1024 * 1024;
+  std::string body = make_multipart(boundary, fileSize);
+
+  int chunkSizes[] = {4096, 64 * 1024, 1024 * 1024};
+  for (unsigned int i = 0; i < sizeof(chunkSizes)/sizeof(int); i++) {
+    ChunkedPostTransport transport(body, chunkSizes[i]);
+    Variant post, files;
+    int size = 0;
+    const void *data = transport.getPostData(size);
+
+    Timer t;
+    rfc1867PostHandler(&transport, post, files, body.size(), data, size,
+                       boundary);
+    int64 us = t.getMicroSeconds();
+    if (!Test::s_quiet) {
+      printf("rfc1867 %d byte chunks: %lld us, %lld MB/s\n", chunkSizes[i],
+             us, us ? (int64)body.size() / us : 0LL);
+    }
+
+    VS(post["name"], "value");
+    VS(files["f"]["name"], "photo.jpg");
+    VS(files["f"]["error"], 0);
+    VS(files["f"]["size"], fileSize);
+    String tmp = files["f"]["tmp_name"].toString();
+    struct stat sb;
+    VERIFY(stat(tmp.data(), &sb) == 0);
+    VS((int64)sb.st_size, (int64)fileSize);
+    unlink(tmp.data());
+  }
+
+  return Count(true);
+}
+
+bool TestCppBase::TestServerStatsShm() {
+  std::string path = "/tmp/test_server_stats_shm";
+
+  ServerStatsShm writer;
+  VERIFY(writer.create(path, 2, 1, 1));
+  writer.beginUpdate();
+  ServerStatsShm::Slot *slot = writer.slot(0);
+  slot->time = 600;
+  slot->hits = 3;
+  VS(writer.findOrAddKey("mem"), 0);
+  VS(writer.findOrAddKey("sql"), 1);
+  VS(writer.findOrAddKey("mem"), 0);
+  VS(writer.findOrAddKey("apc"), -1); // key table is full
+  VS(writer.findOrAddKey("apc"), -1); // not counted again
+  slot->values[0] = 100;
+  slot->values[1] = 7;
+  writer.header()->slotCount = 1;
+  writer.endUpdate();
+
+  ServerStatsShm reader;
+  VERIFY(reader.attach(path));
+  std::string snapshot;
+  VS(reader.snapshot(snapshot), 0);
+  std::ostringstream out;
+  ServerStatsShm::Report(out, snapshot);
+  std::string report = out.str();
+  VERIFY(report.find("keys.dropped: 1\n") != std::string::npos);
+  VERIFY(report.find("hit: 3\nmem: 100\nsql: 7\n") != std::string::npos);
+
+  // a writer that died in the middle of an update
+  writer.beginUpdate();
+  VS(reader.snapshot(snapshot, 10), -1);
+
+  unlink(path.c_str());
+  return Count(true);
+}
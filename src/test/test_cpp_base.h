@@ -39,8 +39,12 @@ class TestCppBase : public TestBase {
 
   // building blocks
   bool TestSmartAllocator();
+  bool TestObjectSizeClasses();
+  bool TestChunkedBuffer();
   bool TestMemoryManager();
   bool TestIpBlockMap();
+  bool TestRfc1867();
+  bool TestServerStatsShm();
 
   /**
    * Date types. This in turn tests StringData, ArrayData, StringOffset,
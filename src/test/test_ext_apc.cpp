@@ -29,6 +29,11 @@ namespace HPHP {
 bool TestExtApc::RunTests(const std::string &which) {
   bool ret = true;
 
+  // a table of its own, so entries left by an earlier run don't show up
+  std::string shmFile = "/tmp/test_ext_apc." +
+    boost::lexical_cast<std::string>(getpid());
+  RuntimeOption::ApcSharedMemoryFile = shmFile;
+  RuntimeOption::ApcSharedMemorySize = 64;
   RuntimeOption::ApcUseSharedMemory = true;
   s_apc_store.reset();
   printf("Shared memory version:\n");
@@ -51,10 +56,15 @@ bool TestExtApc::RunTests(const std::string &which) {
   RUN_TEST(test_apc_bin_load);
   RUN_TEST(test_apc_bin_dumpfile);
   RUN_TEST(test_apc_bin_loadfile);
+  RUN_TEST(test_apc_snapshot);
+  RUN_TEST(test_apc_prime);
 
   RuntimeOption::ApcUseSharedMemory = false;
   RuntimeOption::ApcTableType = RuntimeOption::ApcHashTable;
   s_apc_store.reset();
+  for (int i = 0; i < MAX_SHARED_STORE; i++) {
+    unlink((shmFile + "." + boost::lexical_cast<std::string>(i)).c_str());
+  }
   printf("\nNon shared-memory version:\n");
   RUN_TEST(test_apc_add);
   RUN_TEST(test_apc_store);
@@ -75,6 +85,7 @@ bool TestExtApc::RunTests(const std::string &which) {
   RUN_TEST(test_apc_bin_load);
   RUN_TEST(test_apc_bin_dumpfile);
   RUN_TEST(test_apc_bin_loadfile);
+  RUN_TEST(test_apc_snapshot);
 
   RuntimeOption::ApcTableType = RuntimeOption::ApcConcurrentTable;
   s_apc_store.reset();
@@ -98,6 +109,7 @@ bool TestExtApc::RunTests(const std::string &which) {
   RUN_TEST(test_apc_bin_load);
   RUN_TEST(test_apc_bin_dumpfile);
   RUN_TEST(test_apc_bin_loadfile);
+  RUN_TEST(test_apc_snapshot);
 
   s_apc_store.clear();
   RuntimeOption::ApcTableType = RuntimeOption::ApcHashTable;
@@ -123,6 +135,7 @@ bool TestExtApc::RunTests(const std::string &which) {
   RUN_TEST(test_apc_bin_load);
   RUN_TEST(test_apc_bin_dumpfile);
   RUN_TEST(test_apc_bin_loadfile);
+  RUN_TEST(test_apc_snapshot);
 
   return ret;
 }
@@ -322,6 +335,14 @@ bool TestExtApc::test_apc_inc() {
   VS(f_apc_inc("ts"), 13);
   VS(f_apc_inc("ts", 5), 18);
   VS(f_apc_inc("ts", -3), 15);
+
+  // in shared memory, an array is not unserialized with its bucket owned
+  if (RuntimeOption::ApcUseSharedMemory) {
+    f_apc_store("ta", CREATE_VECTOR1(1));
+    VERIFY(same(f_apc_inc("ta"), false));
+    VERIFY(!f_apc_cas("ta", 1, 2));
+    VS(f_apc_fetch("ta"), CREATE_VECTOR1(1));
+  }
   return Count(true);
 }
 
@@ -377,3 +398,65 @@ bool TestExtApc::test_apc_bin_loadfile() {
   }
   return Count(false);
 }
+
+bool TestExtApc::test_apc_snapshot() {
+  std::string file = "/tmp/test_apc_snapshot";
+  f_apc_clear_cache();
+  f_apc_store("ss", "TestString");
+  f_apc_store("si", 123, 3600);
+  f_apc_store("sa", CREATE_MAP2("a", 1, "b", CREATE_VECTOR1(2.5)));
+  f_apc_store("sb", false);
+  f_apc_store("se", "");
+  Object obj(NEW(c_stdclass)());
+  obj->o_set("name", -1, "value");
+  Array objs = CREATE_MAP2("o", obj, "n", null);
+  f_apc_store("so", objs);
+  // an object numbering its back references on its own can't be nested
+  Object self(NEW(c_stdclass)());
+  self->o_set("self", -1, self);
+  f_apc_store("sr", CREATE_VECTOR1(self));
+  self->o_set("self", -1, null);
+  VERIFY(apc_dump_snapshot(file));
+
+  f_apc_clear_cache();
+  f_apc_store("ss", "Existing");
+  apc_load_snapshot(file, 1);
+  VS(f_apc_fetch("ss"), "Existing");
+  VS(f_apc_fetch("si"), 123);
+  VS(f_apc_fetch("sa"), CREATE_MAP2("a", 1, "b", CREATE_VECTOR1(2.5)));
+  Variant success;
+  VS(f_apc_fetch("sb", ref(success)), false);
+  VS(success, true);
+  VS(f_apc_fetch("se"), "");
+  VS(f_serialize(f_apc_fetch("so")), f_serialize(objs));
+  VS(f_apc_fetch("sr"), false);
+
+  f_apc_clear_cache();
+  apc_load_snapshot(file, 4);
+  VS(f_apc_fetch("ss"), "TestString");
+  VS(f_apc_fetch("si"), 123);
+
+  unlink(file.c_str());
+  f_apc_clear_cache();
+  return Count(true);
+}
+
+bool TestExtApc::test_apc_prime() {
+  // values already in shared memory are newer than the prime file
+  f_apc_clear_cache();
+  f_apc_store("pk", "Newer");
+  SharedStore &store = s_apc_store[0];
+  std::vector<SharedStore::KeyValuePair> vars(2);
+  vars[0].key = "pk";
+  vars[0].len = 2;
+  vars[0].value = store.construct("pk", 2, String("Primed"));
+  vars[1].key = "pn";
+  vars[1].len = 2;
+  vars[1].value = store.construct("pn", 2, String("Primed"));
+  store.prime(vars);
+  VS(f_apc_fetch("pk"), "Newer");
+  VS(f_apc_fetch("pn"), "Primed");
+
+  f_apc_clear_cache();
+  return Count(true);
+}
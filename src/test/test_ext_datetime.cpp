@@ -269,6 +269,15 @@ bool TestExtDatetime::test_date() {
 
   VS(f_mktime(0, 0, 0, 2, 26 - 91, 2010), 1259308800);
 
+  // the same timestamp again, in another timezone and then back
+  d = f_strtotime("2008-09-10 12:34:56");
+  VERIFY(f_date_default_timezone_set("Asia/Shanghai"));
+  VS(f_date("Y-m-d H:i:s", d), "2008-09-11 03:34:56");
+  VS(f_date("Y-m-d H:i:s u", d), "2008-09-11 03:34:56 000000");
+  VERIFY(f_date_default_timezone_set("America/Los_Angeles"));
+  VS(f_date("Y-m-d H:i:s", d), "2008-09-10 12:34:56");
+  VS(f_date("B", d), "857");
+
   return Count(true);
 }
 
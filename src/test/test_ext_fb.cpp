@@ -16,6 +16,8 @@
 
 #include <test/test_ext_fb.h>
 #include <runtime/ext/ext_fb.h>
+#include <runtime/base/memory/memory_manager.h>
+#include <runtime/base/memory/heap_profiler.h>
 
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -29,6 +31,8 @@ bool TestExtFb::RunTests(const std::string &which) {
   RUN_TEST(test_fb_call_user_func_safe);
   RUN_TEST(test_fb_call_user_func_safe_return);
   RUN_TEST(test_fb_call_user_func_array_safe);
+  RUN_TEST(test_xhprof_heap_enable);
+  RUN_TEST(test_xhprof_heap_disable);
   RUN_TEST(test_fb_load_local_databases);
   RUN_TEST(test_fb_parallel_query);
   RUN_TEST(test_fb_crossall_query);
@@ -122,6 +126,57 @@ bool TestExtFb::test_fb_call_user_func_array_safe() {
   return Count(true);
 }
 
+static Variant heap_site(CVarRef sites, const char *type) {
+  for (ArrayIter iter(sites); iter; ++iter) {
+    if (iter.first().toString().find(type) >= 0) {
+      return iter.second();
+    }
+  }
+  return null;
+}
+
+bool TestExtFb::test_xhprof_heap_enable() {
+  VS(f_xhprof_heap_disable(), null);
+
+#ifndef DEBUGGING_SMART_ALLOCATOR
+  // sampling every byte charges each allocation exactly its own size
+  int size = StringData::Allocator->getItemSize();
+  f_xhprof_heap_enable(1);
+  {
+    Array kept = Array::Create();
+    for (int64 i = 0; i < 100; i++) {
+      kept.append(String(i));
+      String temp(i);
+    }
+    Variant sites = f_xhprof_heap_disable();
+    Variant strings = heap_site(sites, "(StringData)");
+    VS(strings["samples"], 200);
+    VS(strings["total"], 200 * size);
+    VS(strings["live"], 100 * size);
+    VS(strings["peak"], 101 * size);
+  }
+  VERIFY(MemoryManager::TheMemoryManager()->getStats().sampleFilter == NULL);
+
+  // sites of all requests are summed up while the server-wide profile is on
+  HeapProfiler::ServerEnable(1);
+  for (int n = 0; n < 2; n++) {
+    HeapProfiler::TheHeapProfiler()->beginRequest();
+    String temp((int64)n);
+    HeapProfiler::TheHeapProfiler()->endRequest();
+  }
+  HeapProfiler::ServerDisable();
+  std::string report = HeapProfiler::ServerReport(0);
+  VERIFY(report.find("off, 2 requests") == 0);
+  VERIFY(report.find("(StringData)") != std::string::npos);
+#endif
+  return Count(true);
+}
+
+bool TestExtFb::test_xhprof_heap_disable() {
+  // tested above
+  return Count(true);
+}
+
 bool TestExtFb::test_fb_load_local_databases() {
   // tested with PHP unit tests
   return Count(true);
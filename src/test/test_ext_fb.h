@@ -34,6 +34,8 @@ class TestExtFb : public TestCppExt {
   bool test_fb_call_user_func_safe();
   bool test_fb_call_user_func_safe_return();
   bool test_fb_call_user_func_array_safe();
+  bool test_xhprof_heap_enable();
+  bool test_xhprof_heap_disable();
   bool test_fb_load_local_databases();
   bool test_fb_parallel_query();
   bool test_fb_crossall_query();
@@ -19,6 +19,7 @@
 #include <runtime/ext/ext_output.h>
 #include <runtime/ext/ext_string.h>
 #include <runtime/base/runtime_option.h>
+#include <runtime/base/shared/file_content_cache.h>
 #include <util/light_process.h>
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -123,7 +124,8 @@ bool TestExtFile::RunTests(const std::string &which) {
   RUN_TEST(test_closedir);
 
   LightProcess::Initialize(RuntimeOption::LightProcessFilePrefix,
-                           RuntimeOption::LightProcessCount);
+                           RuntimeOption::LightProcessCount,
+                           RuntimeOption::LightProcessMaxCount);
   RUN_TEST(test_popen);
   RUN_TEST(test_pclose);
   LightProcess::Close();
@@ -433,6 +435,41 @@ bool TestExtFile::test_file_get_contents() {
 
   VS(f_unserialize(f_file_get_contents("compress.zlib://test/test_zlib_file")),
      CREATE_VECTOR1("rblock:216105"));
+
+  RuntimeOption::EnableFileContentCache = true;
+  {
+    VS(f_file_get_contents("test/test_ext_file.tmp"),
+       "testing file_get_contents");
+    VS(f_file_get_contents("test/test_ext_file.tmp"),
+       "testing file_get_contents");
+    VS(FileContentCache::GetCount(), 1);
+
+    // replaced files are reloaded
+    f_file_put_contents("test/test_ext_file.tmp2", "replaced");
+    f_rename("test/test_ext_file.tmp2", "test/test_ext_file.tmp");
+    VS(f_file_get_contents("test/test_ext_file.tmp"), "replaced");
+    VS(f_file("test/test_ext_file.tmp"), CREATE_VECTOR1("replaced"));
+    VS(FileContentCache::GetCount(), 1);
+
+    // a file rewritten in place doesn't change what was read before
+    String page = f_str_repeat("x", getpagesize());
+    f_file_put_contents("test/test_ext_file.tmp", page);
+    VS(f_file_get_contents("test/test_ext_file.tmp"), page);
+    String cached = f_file_get_contents("test/test_ext_file.tmp");
+    f_file_put_contents("test/test_ext_file.tmp", "short");
+    VS(cached, page);
+    VS(f_file_get_contents("test/test_ext_file.tmp"), "short");
+
+    f_ob_start();
+    VS(f_readfile("test/test_ext_file.txt"), 17);
+    VS(f_ob_get_clean(), "Testing Ext File\n");
+    f_ob_end_clean();
+    VS(FileContentCache::GetCount(), 2);
+  }
+  RuntimeOption::EnableFileContentCache = false;
+  FileContentCache::Clear();
+  VS(FileContentCache::GetCount(), 0);
+  VS(FileContentCache::GetSize(), 0);
   return Count(true);
 }
 
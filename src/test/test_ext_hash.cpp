@@ -120,6 +120,7 @@ bool TestExtHash::test_hash() {
   VS(f_hash("haval192,5", data), expected[i++]);
   VS(f_hash("haval224,5", data), expected[i++]);
   VS(f_hash("haval256,5", data), expected[i++]);
+  VS(f_hash("crc32c",     data), "1fe6425d");
 
   return Count(true);
 }
@@ -16,6 +16,7 @@
 
 #include <test/test_ext_json.h>
 #include <runtime/ext/ext_json.h>
+#include <runtime/base/runtime_option.h>
 
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -45,6 +46,29 @@ bool TestExtJson::test_json_encode() {
   VS(f_json_encode(CREATE_VECTOR1(CREATE_MAP1("a", "apple"))),
      "[{\"a\":\"apple\"}]");
 
+  Array big;
+  for (int i = 0; i < 5000; i++) {
+    big.append(CREATE_MAP2("id", i, "name", "apple"));
+  }
+  g_context->obStart();
+  echo_json_encode(big);
+  String output = g_context->obCopyContents();
+  g_context->obEnd();
+  VS(output, f_json_encode(big));
+
+  // what was streamed counts towards the limit
+  RuntimeOption::SerializationSizeLimit = output.size() - 1;
+  bool limited = false;
+  g_context->obStart();
+  try {
+    echo_json_encode(big);
+  } catch (FatalErrorException e) {
+    limited = true;
+  }
+  g_context->obEnd();
+  RuntimeOption::SerializationSizeLimit = 0;
+  VERIFY(limited);
+
   return Count(true);
 }
 
@@ -21,6 +21,8 @@
 #include <runtime/base/util/string_buffer.h>
 #include <runtime/base/runtime_option.h>
 #include <util/light_process.h>
+#include <util/async_func.h>
+#include <sys/wait.h>
 
 using namespace std;
 
@@ -57,7 +59,8 @@ bool TestExtProcess::RunTests(const std::string &which) {
   RUN_TEST(test_escapeshellcmd);
 
   LightProcess::Initialize(RuntimeOption::LightProcessFilePrefix,
-                           RuntimeOption::LightProcessCount);
+                           RuntimeOption::LightProcessCount,
+                           RuntimeOption::LightProcessMaxCount);
   RUN_TEST(test_pcntl_alarm);
   //RUN_TEST(test_pcntl_exec); // this has to run manually
   RUN_TEST(test_pcntl_fork);
@@ -84,6 +87,8 @@ bool TestExtProcess::RunTests(const std::string &which) {
   RUN_TEST(test_proc_nice);
   LightProcess::Close();
 
+  RUN_TEST(test_light_process);
+
   return ret;
 }
 
@@ -380,3 +385,94 @@ bool TestExtProcess::test_escapeshellcmd() {
   VS(f_escapeshellcmd("perl \""), "perl \\\"");
   return Count(true);
 }
+
+namespace {
+class LightWaiter {
+public:
+  LightWaiter(pid_t pid) : m_pid(pid), m_stat(-1), m_ret(0), m_done(false) {}
+  void wait() {
+    m_ret = LightProcess::waitpid(m_pid, &m_stat, 0);
+    m_done = true;
+  }
+  pid_t m_pid;
+  int m_stat;
+  pid_t m_ret;
+  volatile bool m_done;
+};
+
+class LightPopener {
+public:
+  LightPopener() : m_id(0), m_failed(0) {}
+  void run() {
+    for (int i = 0; i < 10; i++) {
+      char cmd[64], expected[64], buf[64];
+      snprintf(cmd, sizeof(cmd), "echo %d-%d", m_id, i);
+      snprintf(expected, sizeof(expected), "%d-%d\n", m_id, i);
+      FILE *f = LightProcess::popen(cmd, "r");
+      if (!f) {
+        m_failed++;
+        continue;
+      }
+      if (!fgets(buf, sizeof(buf), f) || strcmp(buf, expected)) m_failed++;
+      if (LightProcess::pclose(f) != 0) m_failed++;
+    }
+  }
+  int m_id;
+  int m_failed;
+};
+}
+
+bool TestExtProcess::test_light_process() {
+  LightProcess::Initialize(RuntimeOption::LightProcessFilePrefix, 1, 2);
+  VERIFY(LightProcess::Available());
+
+  // a blocking wait on one child must not hold up other requests
+  vector<int> none;
+  vector<string> env;
+  pid_t pid = LightProcess::proc_open("sleep 2", none, none, NULL, env);
+  VERIFY(pid > 0);
+  LightWaiter waiter(pid);
+  AsyncFunc<LightWaiter> func(&waiter, &LightWaiter::wait);
+  func.start();
+
+  FILE *f = LightProcess::popen("echo hello", "r");
+  VERIFY(f != NULL);
+  char buf[64];
+  VERIFY(fgets(buf, sizeof(buf), f) != NULL);
+  VS(buf, "hello\n");
+  VS(LightProcess::pclose(f), 0);
+  int stat;
+  VS(LightProcess::waitpid(pid, &stat, WNOHANG), 0);
+  VERIFY(!waiter.m_done);
+
+  func.waitForEnd();
+  VS(waiter.m_ret, pid);
+  VERIFY(WIFEXITED(waiter.m_stat));
+  VS(WEXITSTATUS(waiter.m_stat), 0);
+
+  // failures before exec come back as errors
+  pid = LightProcess::proc_open("true", none, none, "/no/such/dir", env);
+  int err = errno;
+  VS(pid, -1);
+  VS(err, ENOENT);
+
+  // concurrent callers all get their own output, and the pool stays bounded
+  LightPopener popeners[4];
+  vector<AsyncFunc<LightPopener> *> funcs;
+  for (int i = 0; i < 4; i++) {
+    popeners[i].m_id = i;
+    funcs.push_back(new AsyncFunc<LightPopener>(&popeners[i],
+                                                &LightPopener::run));
+    funcs.back()->start();
+  }
+  for (int i = 0; i < 4; i++) {
+    funcs[i]->waitForEnd();
+    delete funcs[i];
+    VS(popeners[i].m_failed, 0);
+  }
+  VERIFY(LightProcess::GetCount() >= 1 && LightProcess::GetCount() <= 2);
+
+  LightProcess::Close();
+  VERIFY(!LightProcess::Available());
+  return Count(true);
+}
@@ -53,6 +53,7 @@ class TestExtProcess : public TestCppExt {
   bool test_proc_nice();
   bool test_escapeshellarg();
   bool test_escapeshellcmd();
+  bool test_light_process();
 };
 
 ///////////////////////////////////////////////////////////////////////////////
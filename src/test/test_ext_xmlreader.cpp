@@ -0,0 +1,103 @@
+/*
+   +----------------------------------------------------------------------+
+   | HipHop for PHP                                                       |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2010 Facebook, Inc. (http://www.facebook.com)          |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 3.01 of the PHP license,      |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available through the world-wide-web at the following url:           |
+   | http://www.php.net/license/3_01.txt                                  |
+   | If you did not receive a copy of the PHP license and are unable to   |
+   | obtain it through the world-wide-web, please send a note to          |
+   | license@php.net so we can mail you a copy immediately.               |
+   +----------------------------------------------------------------------+
+*/
+
+
+#include <test/test_ext_xmlreader.h>
+#include <runtime/ext/ext_xmlreader.h>
+#include <runtime/ext/ext_simplexml.h>
+#include <runtime/ext/ext_file.h>
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool TestExtXmlreader::RunTests(const std::string &which) {
+  bool ret = true;
+
+  RUN_TEST(test_XMLReader);
+
+  return ret;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static const char *s_feed =
+  "<?xml version=\"1.0\"?>\n"
+  "<feed xmlns:f=\"urn:feed\">"
+  "<item id=\"1\" f:kind=\"a\"><title>one</title></item>"
+  "<skip><item id=\"x\"/></skip>"
+  "<item id=\"2\"><title>two</title><body>b<i>2</i></body></item>"
+  "</feed>";
+
+bool TestExtXmlreader::test_XMLReader() {
+  {
+    sp_xmlreader r(NEW(c_xmlreader)());
+    VERIFY(r->t_xml(s_feed));
+    VERIFY(r->t_read());
+    VS(r->t___get("name"), "feed");
+    VS(r->t___get("nodeType"), q_xmlreader_ELEMENT);
+    VS(r->t___get("depth"), 0);
+
+    VERIFY(r->t_read());
+    VS(r->t___get("name"), "item");
+    VS(r->t___get("attributeCount"), 2);
+    VS(r->t___get("hasAttributes"), true);
+    VS(r->t_getattribute("id"), "1");
+    VS(r->t_getattributens("kind", "urn:feed"), "a");
+    VS(r->t_getattribute("missing"), null);
+    VERIFY(r->t_movetoattribute("id"));
+    VS(r->t___get("value"), "1");
+    VERIFY(r->t_movetoelement());
+    VS(r->t_readouterxml(),
+       "<item xmlns:f=\"urn:feed\" id=\"1\" f:kind=\"a\">"
+       "<title>one</title></item>");
+    VS(r->t_readstring(), "one");
+
+    // next() skips <skip> and everything in it without visiting the inner
+    // <item>
+    VERIFY(r->t_next("item"));
+    VS(r->t_getattribute("id"), "2");
+    VS(r->t_readinnerxml(), "<title>two</title><body>b<i>2</i></body>");
+
+    Variant sxml = r->t_expand();
+    VERIFY(sxml.isObject());
+    c_simplexmlelement *elem = sxml.toObject().getTyped<c_simplexmlelement>();
+    VS(elem->t_getname(), "item");
+    VS(elem->t_asxml(),
+       "<?xml version=\"1.0\"?>\n"
+       "<item id=\"2\"><title>two</title><body>b<i>2</i></body></item>\n");
+
+    VERIFY(!r->t_next("item"));
+    VERIFY(r->t_close());
+    VS(r->t___get("name"), "");
+  }
+
+  {
+    f_file_put_contents("test/test_ext_xmlreader.tmp", s_feed);
+    sp_xmlreader r(NEW(c_xmlreader)());
+    VERIFY(r->t_open("test/test_ext_xmlreader.tmp"));
+    int items = 0;
+    while (r->t_read()) {
+      if (same(r->t___get("nodeType"), q_xmlreader_ELEMENT) &&
+          same(r->t___get("localName"), "item")) {
+        items++;
+      }
+    }
+    VS(items, 3);
+    VERIFY(r->t_close());
+    f_unlink("test/test_ext_xmlreader.tmp");
+  }
+
+  return Count(true);
+}
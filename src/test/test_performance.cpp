@@ -16,6 +16,8 @@
 
 #include <test/test_performance.h>
 #include <util/util.h>
+#include <util/shared_memory_table.h>
+#include <sys/wait.h>
 
 using namespace std;
 
@@ -49,6 +51,8 @@ bool TestPerformance::RunTests(const std::string &which) {
   bool ret = true;
   RUN_TEST(TestBasicOperations);
   RUN_TEST(TestMemoryUsage);
+  RUN_TEST(TestChecksums);
+  RUN_TEST(TestSharedMemoryTable);
   RUN_TEST(TestAdHocFile);
   RUN_TEST(TestAdHoc);
   return ret;
@@ -136,6 +140,75 @@ bool TestPerformance::TestBasicOperations() {
       "\n\n/* Taking an object's property */"
       PERF_END);
 
+  VCR(PERF_START
+      "$cases = array('alpha', 'bravo', 'charlie', 'delta', 'echo',"
+      "  'foxtrot', 'golf', 'hotel', 'india', 'juliet', 'kilo', 'lima');\n"
+      "function sw($s) {"
+      "  switch ($s) {"
+      "  case 'alpha': return 1; case 'bravo': return 2;"
+      "  case 'charlie': return 3; case 'delta': return 4;"
+      "  case 'echo': return 5; case 'foxtrot': return 6;"
+      "  case 'golf': return 7; case 'hotel': return 8;"
+      "  case 'india': return 9; case 'juliet': return 10;"
+      "  case 'kilo': return 11; case 'lima': return 12;"
+      "  }"
+      "  return 0;"
+      "}\n"
+      "for ($i = 0; $i < " PERF_LOOP_COUNT "; $i++) "
+      "{ $b = sw($cases[$i % 12]);}"
+      "\n\n/* Switch over string cases, raise SwitchHashThreshold to compare */"
+      PERF_END);
+
+  VCR(PERF_START
+      "$a = array(); $b = array();\n"
+      "for ($i = 0; $i < " PERF_LOOP_COUNT "; $i++) {\n"
+      "  $k = 'user_profile_' . ($i % 1000);\n"
+      "  $a[$k] = $i; $b[$k] = isset($a[$k]) ? $a[$k] : 0;\n"
+      "}"
+      "\n\n/* Dynamic string keys, set Server.InternArrayKeys to compare */"
+      PERF_END);
+
+  VCR(PERF_START
+      "$now = time();\n"
+      "for ($i = 0; $i < " PERF_LOOP_COUNT "; $i++) {\n"
+      "  $a = date('Y-m-d H:i:s', $now); $b = date('D, d M Y H:i:s O');\n"
+      "  $c = date('M j, Y g:ia', $now - $i % 60);\n"
+      "}"
+      "\n\n/* date() on the current second and on nearby timestamps */"
+      PERF_END);
+
+  static const char *sortTypes[][2] = {
+    {"mt_rand()", "integers"},
+    {"mt_rand() / 7.0", "doubles"},
+    {"'k' . mt_rand()", "strings"},
+    {"($i % 2 ? mt_rand() : 'k' . mt_rand())", "mixed values"},
+  };
+  static const char *sortCalls[] = {
+    "sort($b);", "asort($b);", "ksort($c);", "usort($b, 'cmp');",
+    "array_multisort($b, $d);",
+  };
+  for (unsigned int t = 0; t < sizeof(sortTypes)/sizeof(sortTypes[0]); t++) {
+    for (unsigned int c = 0; c < sizeof(sortCalls)/sizeof(sortCalls[0]);
+         c++) {
+      string input = PERF_START;
+      input += "function cmp($x, $y) { return $x == $y ? 0 : "
+        "($x < $y ? -1 : 1); }\n"
+        "mt_srand(1); $a = array(); $k = array();\n"
+        "for ($i = 0; $i < 10000; $i++) { $v = ";
+      input += sortTypes[t][0];
+      input += "; $a[] = $v; $k[$v] = $i; }\n"
+        "for ($i = 0; $i < 10; $i++) { $b = $a; $c = $k; $d = $a; ";
+      input += sortCalls[c];
+      input += "}\n\n/* ";
+      input += sortCalls[c];
+      input += " over 10000 ";
+      input += sortTypes[t][1];
+      input += " */";
+      input += PERF_END;
+      VCR(input.c_str());
+    }
+  }
+
   return true;
 }
 
@@ -144,6 +217,119 @@ bool TestPerformance::TestMemoryUsage() {
       "$a = array();\n"
       "for ($i = 0; $i < 3000000; $i++) { $a[] = 'test';} sleep(5);"
       PERF_END);
+
+  static const char *xmlLoads[][2] = {
+    {"$r = new XMLReader(); $r->open('/tmp/perf_xmlreader.xml');"
+     "$r->read(); $r->read();"
+     "while ($r->name == 'item') {"
+     "  $x = $r->expand(); $n += (int)$x->id; $r->next('item');"
+     "}", "XMLReader"},
+    {"$x = simplexml_load_file('/tmp/perf_xmlreader.xml');"
+     "foreach ($x->item as $item) { $n += (int)$item->id; }",
+     "simplexml_load_file"},
+  };
+  for (unsigned int i = 0; i < sizeof(xmlLoads)/sizeof(xmlLoads[0]); i++) {
+    string input = PERF_START;
+    input += "$f = fopen('/tmp/perf_xmlreader.xml', 'w');"
+      "fwrite($f, '<feed>');"
+      "for ($i = 0; $i < 200000; $i++) {"
+      "  fwrite($f, \"<item><id>$i</id><title>item $i</title></item>\");"
+      "}"
+      "fwrite($f, '</feed>'); fclose($f); $n = 0;\n"
+      "$ru = getrusage(); $rss = $ru['ru_maxrss'];\n";
+    input += xmlLoads[i][0];
+    // libxml's tree is malloc'ed, so only the process's RSS shows it
+    input += "\n$ru = getrusage();"
+      "print $n.' '.($ru['ru_maxrss'] - $rss).\"KB peak RSS growth\\n\";"
+      "unlink('/tmp/perf_xmlreader.xml');\n\n/* 200000 items through ";
+    input += xmlLoads[i][1];
+    input += " */";
+    input += PERF_END;
+    VCR(input.c_str());
+  }
+  return true;
+}
+
+bool TestPerformance::TestChecksums() {
+  static const char *hashCalls[] = {
+    "crc32($s);", "md5($s);", "sha1($s);", "hash('crc32b', $s);",
+    "hash('crc32c', $s);", "hash('adler32', $s);", "hash('sha256', $s);",
+  };
+  static const int sizes[] = { 64, 1024, 65536, 1048576 };
+  for (unsigned int c = 0; c < sizeof(hashCalls)/sizeof(hashCalls[0]); c++) {
+    for (unsigned int i = 0; i < sizeof(sizes)/sizeof(sizes[0]); i++) {
+      // 64MB through each call, whatever the buffer size
+      string size = boost::lexical_cast<string>(sizes[i]);
+      string count = boost::lexical_cast<string>((64 << 20) / sizes[i]);
+      string input = PERF_START;
+      input += "$s = ''; while (strlen($s) < " + size + ") "
+        "$s .= md5(strlen($s), true);\n"
+        "$s = substr($s, 0, " + size + ");\n"
+        "for ($i = 0; $i < " + count + "; $i++) { ";
+      input += hashCalls[c];
+      input += " }\n\n/* ";
+      input += hashCalls[c];
+      input += " over 64MB in " + size + "-byte strings */";
+      input += PERF_END;
+      VCR(input.c_str());
+    }
+  }
+  return true;
+}
+
+bool TestPerformance::TestSharedMemoryTable() {
+  // processes sharing one table, as server processes sharing APC do
+  string path = "/tmp/test_performance_shm." +
+    boost::lexical_cast<string>(getpid());
+  SharedMemoryTable *table = SharedMemoryTable::Open(path, 256 << 20);
+  if (!table) return false;
+  unlink(path.c_str());
+
+  const int keys = 100000;
+  const int ops = 1000000;
+  string value(200, 'v');
+  for (int i = 0; i < keys; i++) {
+    string key = "key" + boost::lexical_cast<string>(i);
+    table->store(key.data(), key.size(), value.data(), value.size(), 0, 0,
+                 true, 0);
+  }
+
+  static const int writePercents[] = { 0, 5, 50 };
+  for (unsigned int w = 0; w < sizeof(writePercents)/sizeof(int); w++) {
+    for (int procs = 1; procs <= 8; procs *= 2) {
+      timeval start, end;
+      gettimeofday(&start, NULL);
+      for (int p = 0; p < procs; p++) {
+        if (fork() == 0) {
+          uint32 seed = p + 1;
+          string out;
+          int type;
+          char key[32];
+          for (int i = 0; i < ops; i++) {
+            seed = seed * 1103515245 + 12345;
+            int len = snprintf(key, sizeof(key), "key%d", (seed >> 8) % keys);
+            if ((int)(seed % 100) < writePercents[w]) {
+              table->store(key, len, value.data(), value.size(), 0, 0, true,
+                           0);
+            } else {
+              table->get(key, len, out, type, 0);
+            }
+          }
+          _exit(0);
+        }
+      }
+      for (int p = 0; p < procs; p++) {
+        wait(NULL);
+      }
+      gettimeofday(&end, NULL);
+      int64 us = (end.tv_sec - start.tv_sec) * 1000000LL +
+        (end.tv_usec - start.tv_usec);
+      printf("SharedMemoryTable: %d%% stores, %d processes: "
+             "%lld ops/ms in all\n", writePercents[w], procs,
+             procs * (int64)ops * 1000 / (us ? us : 1));
+    }
+  }
+  delete table;
   return true;
 }
 
@@ -32,6 +32,8 @@ class TestPerformance : public TestCodeRun {
 
   bool TestBasicOperations();
   bool TestMemoryUsage();
+  bool TestChecksums();
+  bool TestSharedMemoryTable();
   bool TestAdHocFile();
   bool TestAdHoc();
 };
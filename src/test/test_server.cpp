@@ -27,6 +27,7 @@
 #include <runtime/ext/ext_options.h>
 #include <runtime/base/server/http_request_handler.h>
 #include <runtime/base/util/http_client.h>
+#include <runtime/base/util/curl_pool.h>
 #include <runtime/base/runtime_option.h>
 
 using namespace std;
@@ -39,14 +40,7 @@ TestServer::TestServer() {
   TestCodeRun::FastMode = false;
 }
 
-bool TestServer::VerifyServerResponse(const char *input, const char *output,
-                                      const char *url, const char *method,
-                                      const char *header, const char *postdata,
-                                      bool responseHeader,
-                                      const char *file /* = "" */,
-                                      int line /* = 0 */) {
-  ASSERT(input);
-
+bool TestServer::PrepareServer(const char *input) {
   if (!CleanUp()) return false;
   if (Option::EnableEval < Option::FullEval) {
     if (!GenerateFiles(input, "TestServer") || !CompileFiles()) {
@@ -64,6 +58,17 @@ bool TestServer::VerifyServerResponse(const char *input, const char *output,
     f << input;
     f.close();
   }
+  return true;
+}
+
+bool TestServer::VerifyServerResponse(const char *input, const char *output,
+                                      const char *url, const char *method,
+                                      const char *header, const char *postdata,
+                                      bool responseHeader,
+                                      const char *file /* = "" */,
+                                      int line /* = 0 */) {
+  ASSERT(input);
+  if (!PrepareServer(input)) return false;
 
   AsyncFunc<TestServer> func(this, &TestServer::RunServer);
   func.start();
@@ -122,15 +127,27 @@ bool TestServer::VerifyServerResponse(const char *input, const char *output,
 
 void TestServer::RunServer() {
   string out, err;
+  vector<const char *> argv;
+  argv.push_back("");
+  if (Option::EnableEval >= Option::FullEval) {
+    argv.push_back("--file=/unittest/rootdoc/string");
+  }
+  argv.push_back("--mode=server");
   if (Option::EnableEval < Option::FullEval) {
-    const char *argv[] = {"", "--mode=server",
-                          "--config=test/config-server.hdf", NULL};
-    Process::Exec("runtime/tmp/TestServer/test", argv, NULL, out, &err);
+    argv.push_back("--config=test/config-server.hdf");
   } else {
-    const char *argv[] = {"", "--file=/unittest/rootdoc/string",
-                          "--mode=server",
-                          "--config=test/config-eval.hdf", NULL};
-    Process::Exec("hphpi/hphpi", argv, NULL, out, &err);
+    argv.push_back("--config=test/config-eval.hdf");
+  }
+  for (unsigned int i = 0; i < m_serverOptions.size(); i++) {
+    argv.push_back("-v");
+    argv.push_back(m_serverOptions[i].c_str());
+  }
+  argv.push_back(NULL);
+
+  if (Option::EnableEval < Option::FullEval) {
+    Process::Exec("runtime/tmp/TestServer/test", &argv[0], NULL, out, &err);
+  } else {
+    Process::Exec("hphpi/hphpi", &argv[0], NULL, out, &err);
   }
 }
 
@@ -166,6 +183,9 @@ bool TestServer::RunTests(const std::string &which) {
   //RUN_TEST(TestRequestHandling);
   //RUN_TEST(TestLibeventServer);
   RUN_TEST(TestHttpClient);
+  RUN_TEST(TestWarmRestart);
+  RUN_TEST(TestReplayBenchmark);
+  RUN_TEST(TestRequestDeadline);
 
   return ret;
 }
@@ -268,6 +288,19 @@ bool TestServer::TestPost() {
   VSPOST("<?php print $HTTP_RAW_POST_DATA;",
          "name=value", "string", params);
 
+  // an oversized multipart body is dropped without its raw data
+  string body = "--xYz\r\nContent-Disposition: form-data; name=\"name\"\r\n"
+    "\r\n" + string(2 << 20, 'v') + "\r\n--xYz--\r\n";
+  m_serverOptions.push_back("Server.MaxPostSize = 1");
+  m_serverOptions.push_back("Server.AlwaysPopulateRawPostData = false");
+  bool passed = VerifyServerResponse
+    ("<?php var_dump(isset($HTTP_RAW_POST_DATA), $_POST);",
+     "bool(false)\narray(0) {\n}\n", "string", "POST",
+     "Content-Type: multipart/form-data; boundary=xYz", body.c_str(),
+     false, __FILE__, __LINE__);
+  m_serverOptions.clear();
+  if (!Count(passed)) return false;
+
   return true;
 }
 
@@ -501,7 +534,206 @@ bool TestServer::TestHttpClient() {
     VERIFY(found);
   }
 
+  // one request at a time keeps reusing the same pooled handle
+  VS(CurlHandlePool::IdleCount(url.c_str()), 1);
+  VS(CurlHandlePool::GetKey(url.c_str()), "http://127.0.0.1:8080");
+  VS(CurlHandlePool::GetKey("HTTPS://Host/a?b"), "https://host");
+  VS(CurlHandlePool::GetKey("no-scheme"), "");
+
+  // no more than MaxIdlePerHost handles are kept
+  vector<CURL*> handles;
+  int max = RuntimeOption::HttpConnectionPoolMaxIdlePerHost;
+  for (int i = 0; i < max + 2; i++) {
+    handles.push_back(CurlHandlePool::Get(url.c_str()));
+  }
+  VS(CurlHandlePool::IdleCount(url.c_str()), 0);
+  for (unsigned int i = 0; i < handles.size(); i++) {
+    CurlHandlePool::Release(url.c_str(), handles[i]);
+  }
+  VS(CurlHandlePool::IdleCount(url.c_str()), max);
+
   server->stop();
   server->waitForEnd();
   return Count(true);
 }
+
+///////////////////////////////////////////////////////////////////////////////
+
+static int64 now_usec() {
+  struct timeval tv;
+  gettimeofday(&tv, 0);
+  return (int64)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+static int warm_get(int port, const char *path, string &body) {
+  string url = "http://";
+  url += f_php_uname("n").data();
+  url += ":" + lexical_cast<string>(port) + path;
+  HttpClient http;
+  StringBuffer response;
+  int code = http.get(url.c_str(), response);
+  body = response.size() ? response.data() : "";
+  return code;
+}
+
+static int warm_throughput(const string &pid) {
+  int count = 0;
+  string body;
+  for (int64 start = now_usec(); now_usec() - start < 1000000; ) {
+    if (warm_get(8080, "/string", body) == 200 && body == pid) count++;
+  }
+  return count;
+}
+
+bool TestServer::TestWarmRestart() {
+  // every request, warmup ones included, keeps a pooled connection to the
+  // echo server, which children mustn't inherit from the supervisor
+  if (!PrepareServer("<?php "
+                     "$r = file_get_contents("
+                     "  'http://127.0.0.1:8090/echo?name=warm');"
+                     "echo strpos($r, 'name = warm') ? getmypid() : 'failed';")) {
+    return false;
+  }
+  ServerPtr echo(new TypedServer<LibEventServer, EchoHandler>
+                 ("127.0.0.1", 8090, 50, -1));
+  echo->start();
+
+  string takeover = "/tmp/hphp_test_takeover." +
+    lexical_cast<string>(getpid());
+  m_serverOptions.push_back("Server.WarmSnapshot.Enabled = true");
+  m_serverOptions.push_back("Server.WarmSnapshot.Documents.0 = /string");
+  m_serverOptions.push_back("Server.WarmSnapshot.Requests = 2");
+  m_serverOptions.push_back("Server.TakeoverFilename = " + takeover);
+  AsyncFunc<TestServer> func(this, &TestServer::RunServer);
+  func.start();
+
+  string pid0, pid1, body;
+  for (int i = 0; i < 10 && pid0.empty(); i++) {
+    if (warm_get(8080, "/string", body) == 200) {
+      pid0 = body;
+    } else {
+      sleep(1); // wait until HTTP server is up and running
+    }
+  }
+
+  int before = 0, after = 0, failed = 0, code = 0;
+  int64 restarted = 0, full = 0;
+  if (!pid0.empty()) {
+    before = warm_throughput(pid0);
+
+    // the old child keeps serving until the new one takes its socket over
+    int64 start = now_usec();
+    code = warm_get(8088, "/warm-restart", body);
+    while (now_usec() - start < 30000000) {
+      if (warm_get(8080, "/string", body) != 200) {
+        failed++;
+      } else if (body != pid0) {
+        pid1 = body;
+        restarted = now_usec() - start;
+        break;
+      }
+    }
+    if (!pid1.empty()) {
+      // full throughput: a 100ms window at 90% of the rate before restart
+      int64 serving = now_usec();
+      while (now_usec() - serving < 10000000) {
+        int count = 0;
+        int64 window = now_usec();
+        while (now_usec() - window < 100000) {
+          if (warm_get(8080, "/string", body) == 200 && body == pid1) {
+            count++;
+          }
+        }
+        if (count * 10 * 10 >= before * 9) {
+          full = now_usec() - start;
+          break;
+        }
+      }
+      after = warm_throughput(pid1);
+    }
+    if (!Test::s_quiet) {
+      printf("warm restart: new child serving %.3fs and at full throughput "
+             "%.3fs after /warm-restart, %d requests failed, %d requests/s "
+             "before and %d after\n", restarted / 1000000.0,
+             full / 1000000.0, failed, before, after);
+    }
+  }
+
+  AsyncFunc<TestServer>(this, &TestServer::StopServer).run();
+  func.waitForEnd();
+  m_serverOptions.clear();
+  unlink(takeover.c_str());
+  echo->stop();
+  echo->waitForEnd();
+
+  VERIFY(!pid0.empty() && pid0 != "failed");
+  VS(code, 200);
+  VERIFY(!pid1.empty() && pid1 != "failed");
+  VS(failed, 0);
+  VERIFY(after > 0);
+  return Count(true);
+}
+
+bool TestServer::TestReplayBenchmark() {
+  if (!PrepareServer("<?php $a = array();"
+                     "for ($i = 0; $i < 10000; $i++) $a[] = 'k' . $i;"
+                     "echo count($a);")) {
+    return false;
+  }
+
+  string dir = "/tmp/hphp_test_bench." + lexical_cast<string>(getpid());
+  string output = "--bench-output=" + dir + ".hdf";
+  mkdir(dir.c_str(), 0777);
+  Hdf request;
+  request["get"] = 1;
+  request["url"] = "/string";
+  request["remote_host"] = "127.0.0.1";
+  request.write(dir + "/request");
+
+  string out, err;
+  vector<const char *> argv;
+  argv.push_back("");
+  if (Option::EnableEval >= Option::FullEval) {
+    argv.push_back("--file=/unittest/rootdoc/string");
+    argv.push_back("--config=test/config-eval.hdf");
+  } else {
+    argv.push_back("--config=test/config-server.hdf");
+  }
+  argv.push_back("--mode=bench");
+  argv.push_back("--count=4");
+  argv.push_back(output.c_str());
+  argv.push_back(dir.c_str());
+  argv.push_back(NULL);
+  if (Option::EnableEval < Option::FullEval) {
+    Process::Exec("runtime/tmp/TestServer/test", &argv[0], NULL, out, &err);
+  } else {
+    Process::Exec("hphpi/hphpi", &argv[0], NULL, out, &err);
+  }
+
+  unlink((dir + "/request").c_str());
+  rmdir(dir.c_str());
+  VERIFY(access((dir + ".hdf").c_str(), R_OK) == 0);
+  Hdf result(dir + ".hdf");
+  unlink((dir + ".hdf").c_str());
+
+  VS(result["requests"].getInt32(), 4);
+  VS(result["errors"].getInt32(), 0);
+  // peak usage is taken before the request's memory stats are reset
+  VERIFY(result["memory_bytes"]["avg"].getInt64() > 0);
+  VERIFY(result["memory_bytes"]["max"].getInt64() > 0);
+  return Count(true);
+}
+
+bool TestServer::TestRequestDeadline() {
+  // set_time_limit(0) lifts RequestTimeoutSeconds, not a deadline
+  m_serverOptions.push_back("Debug.ServerErrorMessage = true");
+  bool passed = VerifyServerResponse
+    ("<?php set_time_limit(0); hphp_set_request_deadline(100);"
+     "$t = microtime(true); while (microtime(true) - $t < 5); echo 'late';",
+     "request has missed its deadline", "string", "GET", NULL, NULL,
+     true, __FILE__, __LINE__);
+  m_serverOptions.clear();
+  if (!Count(passed)) return false;
+
+  return true;
+}
@@ -51,9 +51,21 @@ public:
   // test HttpClient class that proxy server uses
   bool TestHttpClient();
 
+  // test restarting from a warm snapshot
+  bool TestWarmRestart();
+
+  // test replaying recorded requests as a benchmark
+  bool TestReplayBenchmark();
+
+  // test limits TimeoutThread stops a request at
+  bool TestRequestDeadline();
+
 protected:
+  std::vector<std::string> m_serverOptions; // -v options to start with
+
   void RunServer();
   void StopServer();
+  bool PrepareServer(const char *input);
   bool VerifyServerResponse(const char *input, const char *output,
                             const char *url, const char *method,
                             const char *header, const char *postdata,
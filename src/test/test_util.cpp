@@ -20,6 +20,11 @@
 #include <util/logger.h>
 #include <runtime/base/shared/shared_string.h>
 #include <runtime/base/zend/zend_string.h>
+#include <runtime/ext/hash/hash_sha.h>
+#include <util/checksum.h>
+#include <util/shared_memory_table.h>
+#include <util/timing_wheel.h>
+#include <sys/wait.h>
 
 using namespace std;
 
@@ -43,6 +48,9 @@ bool TestUtil::RunTests(const std::string &which) {
   //RUN_TEST(TestLFUTable);
   RUN_TEST(TestSharedString);
   RUN_TEST(TestCanonicalize);
+  RUN_TEST(TestChecksum);
+  RUN_TEST(TestSharedMemoryTable);
+  RUN_TEST(TestTimingWheel);
   return ret;
 }
 
@@ -260,3 +268,250 @@ bool TestUtil::TestCanonicalize() {
   VERIFY(Util::canonicalize("./../../") == "../../");
   return Count(true);
 }
+
+static string sha_digest(HashEngine &engine, const unsigned char *data,
+                         int len, int chunk) {
+  char context[256];
+  unsigned char digest[64];
+  engine.hash_init(context);
+  for (int i = 0; i < len; i += chunk) {
+    engine.hash_update(context, data + i, len - i < chunk ? len - i : chunk);
+  }
+  engine.hash_final(digest, context);
+  return string((char *)digest, engine.digest_size);
+}
+
+bool TestUtil::TestChecksum() {
+  const char *check = "123456789";
+  VERIFY(~Checksum::Crc32(~0, check, 9) == 0xcbf43926);
+  VERIFY(~Checksum::Crc32Bzip2(~0, check, 9) == 0xfc891918);
+  VERIFY(~Checksum::Crc32c(~0, check, 9) == 0xe3069283);
+  VERIFY(Checksum::Adler32(1, "Wikipedia", 9) == 0x11e60398);
+
+  // hardware and portable code have to agree at every length and alignment
+  const int size = 70000;
+  unsigned char *data = (unsigned char *)malloc(size + 16);
+  uint32 seed = 1;
+  for (int i = 0; i < size + 16; i++) {
+    seed = seed * 1103515245 + 12345;
+    data[i] = seed >> 16;
+  }
+  static const int lens[] = {
+    0, 1, 7, 8, 15, 16, 31, 32, 33, 63, 64, 65, 127, 128, 129, 1000, 5552,
+    5553, 65536, size
+  };
+  hash_sha1 sha1;
+  hash_sha256 sha256;
+  int supported = Checksum::Supported();
+  for (unsigned int i = 0; i < sizeof(lens) / sizeof(lens[0]); i++) {
+    for (int offset = 0; offset < 16; offset += 5) {
+      const unsigned char *p = data + offset;
+      int len = lens[i];
+      uint32 crc[2], bzip2[2], crc32c[2], adler[2];
+      string digest1[2], digest256[2];
+      for (int hw = 0; hw < 2; hw++) {
+        Checksum::Enabled = hw ? supported : 0;
+        crc[hw] = Checksum::Crc32(~0, p, len);
+        bzip2[hw] = Checksum::Crc32Bzip2(~0, p, len);
+        crc32c[hw] = Checksum::Crc32c(~0, p, len);
+        adler[hw] = Checksum::Adler32(1, p, len);
+        digest1[hw] = sha_digest(sha1, p, len, 1000);
+        digest256[hw] = sha_digest(sha256, p, len, 1000);
+      }
+      VERIFY(crc[0] == crc[1]);
+      VERIFY(bzip2[0] == bzip2[1]);
+      VERIFY(crc32c[0] == crc32c[1]);
+      VERIFY(adler[0] == adler[1]);
+      VERIFY(digest1[0] == digest1[1]);
+      VERIFY(digest256[0] == digest256[1]);
+
+      // and checksums computed piecewise match the one-shot values
+      if (len > 100) {
+        VERIFY(Checksum::Crc32(Checksum::Crc32(~0, p, 100), p + 100,
+                               len - 100) == crc[0]);
+        VERIFY(Checksum::Adler32(Checksum::Adler32(1, p, 100), p + 100,
+                                 len - 100) == adler[0]);
+      }
+    }
+  }
+  Checksum::Enabled = supported;
+  free(data);
+  return Count(true);
+}
+
+
+class IncUpdater : public SharedMemoryTable::Updater {
+public:
+  bool update(string &value, int &type) {
+    value = boost::lexical_cast<string>(atoi(value.c_str()) + 1);
+    return true;
+  }
+};
+
+bool TestUtil::TestSharedMemoryTable() {
+  string path = "/tmp/test_shared_memory_table." +
+    boost::lexical_cast<string>(getpid());
+  SharedMemoryTable *table = SharedMemoryTable::Open(path, 32 << 20);
+  VERIFY(table);
+  unlink(path.c_str());
+
+  string value;
+  int type;
+  VERIFY(!table->get("k", 1, value, type, 0));
+  VERIFY(table->store("k", 1, "v1", 2, 3, 0, true, 0));
+  VERIFY(table->get("k", 1, value, type, 0));
+  VS(value, "v1");
+  VS(type, 3);
+  VERIFY(!table->store("k", 1, "v2", 2, 3, 0, false, 0));
+  VERIFY(table->store("k", 1, "v2", 2, 4, 0, true, 0));
+  VERIFY(table->get("k", 1, value, type, 0));
+  VS(value, "v2");
+  VS(type, 4);
+
+  // expiry
+  VERIFY(table->store("e", 1, "", 0, 0, 100, true, 0));
+  VERIFY(table->get("e", 1, value, type, 99));
+  VERIFY(!table->get("e", 1, value, type, 100));
+  VERIFY(!table->erase("e", 1, true, 99));
+  VERIFY(table->erase("e", 1, true, 100));
+
+  // read-modify-write
+  VERIFY(table->store("n", 1, "41", 2, 0, 0, true, 0));
+  IncUpdater inc;
+  VERIFY(table->update("n", 1, inc, 0));
+  VERIFY(table->get("n", 1, value, type, 0));
+  VS(value, "42");
+  VERIFY(!table->update("m", 1, inc, 0));
+
+  // every size class, chains longer than one, and blocks reused
+  table->clear();
+  VS(table->getEntryCount(), 0);
+  for (int round = 0; round < 2; round++) {
+    for (int i = 0; i < 4000; i++) {
+      string key = "key" + boost::lexical_cast<string>(i);
+      string v((i * 37) % 2000, 'a' + i % 26);
+      VERIFY(table->store(key.data(), key.size(), v.data(), v.size(), i, 0,
+                          true, 0));
+    }
+    for (int i = 0; i < 4000; i++) {
+      string key = "key" + boost::lexical_cast<string>(i);
+      VERIFY(table->get(key.data(), key.size(), value, type, 0));
+      VERIFY(value == string((i * 37) % 2000, 'a' + i % 26));
+      VS(type, i);
+    }
+    VS(table->getEntryCount(), 4000);
+    vector<SharedMemoryTable::Entry> entries;
+    table->dump(entries);
+    VS((int)entries.size(), 4000);
+    table->clear();
+  }
+  int64 slabs = table->getSlabCount();
+  string big(SharedMemoryTable::MaxValueSize(1), 'b');
+  VERIFY(table->store("b", 1, big.data(), big.size(), 0, 0, true, 0));
+  VERIFY(table->get("b", 1, value, type, 0));
+  VERIFY(value == big);
+  big += 'b';
+  VERIFY(!table->store("b", 1, big.data(), big.size(), 0, 0, true, 0));
+  VS(table->getFailedStores(), 1);
+
+  // until the table runs out
+  int stored = 0;
+  for (int i = 0; i < 100; i++) {
+    string key = boost::lexical_cast<string>(i);
+    if (table->store(key.data(), key.size(), big.data(), 500000, 0, 0, true,
+                     0)) {
+      stored++;
+    }
+  }
+  VERIFY(stored > 0 && stored < 100);
+  VERIFY(table->getSlabCount() > slabs);
+  table->clear();
+
+  // a child's writes are seen by the parent
+  pid_t pid = fork();
+  if (pid == 0) {
+    table->store("child", 5, "yes", 3, 0, 0, true, 0);
+    _exit(0);
+  }
+  waitpid(pid, NULL, 0);
+  VERIFY(table->get("child", 5, value, type, 0));
+  VS(value, "yes");
+
+  // a child dying with a bucket owned doesn't keep it from readers or
+  // writers
+  for (int i = 0; i < 2; i++) {
+    pid = fork();
+    if (pid == 0) {
+      table->abandonBucket("child", 5);
+      _exit(0);
+    }
+    waitpid(pid, NULL, 0);
+    if (i == 0) {
+      VERIFY(table->get("child", 5, value, type, 0));
+      VS(value, "yes");
+    } else {
+      VERIFY(table->store("child", 5, "again", 5, 0, 0, true, 0));
+    }
+    VS(table->getRecoveredBuckets(), i + 1);
+  }
+  VERIFY(table->get("child", 5, value, type, 0));
+  VS(value, "again");
+
+  delete table;
+  return Count(true);
+}
+
+bool TestUtil::TestTimingWheel() {
+  TimingWheel wheel(4, 1000);
+  vector<int> expired;
+  VS(wheel.getNextTick(), 1024); // first wheel turning over
+  wheel.advance(1100, expired);
+  VS((int)expired.size(), 0);
+
+  wheel.schedule(0, 1110);
+  wheel.schedule(1, 1105);
+  wheel.schedule(2, 1105);
+  VERIFY(wheel.scheduled(0));
+  VS(wheel.getNextTick(), 1105);
+  wheel.advance(1104, expired);
+  VS((int)expired.size(), 0);
+  wheel.advance(1110, expired);
+  VS((int)expired.size(), 3);
+  VS(expired[2], 0);
+  VERIFY(!wheel.scheduled(0));
+
+  // moving and canceling
+  expired.clear();
+  wheel.schedule(0, 1120);
+  wheel.schedule(0, 1130);
+  wheel.schedule(1, 1125);
+  wheel.cancel(1);
+  wheel.advance(1129, expired);
+  VS((int)expired.size(), 0);
+  wheel.advance(1130, expired);
+  VS((int)expired.size(), 1);
+  VS(expired[0], 0);
+
+  // past due fires with the next tick
+  expired.clear();
+  wheel.schedule(3, 1000);
+  wheel.advance(1131, expired);
+  VS((int)expired.size(), 1);
+  VS(expired[0], 3);
+
+  // cascading down from every wheel, in order
+  expired.clear();
+  int64 due[] = { 1131 + 300, 1131 + 20000, 1131 + 3000000, 1131 + 200000000 };
+  for (int i = 0; i < 4; i++) {
+    wheel.schedule(3 - i, due[i]);
+  }
+  for (int i = 0; i < 4; i++) {
+    wheel.advance(due[i] - 1, expired);
+    VS((int)expired.size(), i);
+    VERIFY(wheel.getNextTick() <= due[i]);
+    wheel.advance(due[i], expired);
+    VS((int)expired.size(), i + 1);
+    VS(expired[i], 3 - i);
+  }
+  return Count(true);
+}
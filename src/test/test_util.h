@@ -31,6 +31,9 @@ class TestUtil : public TestBase {
   bool TestLFUTable();
   bool TestSharedString();
   bool TestCanonicalize();
+  bool TestChecksum();
+  bool TestSharedMemoryTable();
+  bool TestTimingWheel();
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,600 @@
+/*
+   +----------------------------------------------------------------------+
+   | HipHop for PHP                                                       |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2010 Facebook, Inc. (http://www.facebook.com)          |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 3.01 of the PHP license,      |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available through the world-wide-web at the following url:           |
+   | http://www.php.net/license/3_01.txt                                  |
+   | If you did not receive a copy of the PHP license and are unable to   |
+   | obtain it through the world-wide-web, please send a note to          |
+   | license@php.net so we can mail you a copy immediately.               |
+   +----------------------------------------------------------------------+
+*/
+
+#include <util/checksum.h>
+
+// Hardware paths are compiled per function with target attributes, so the
+// rest of the build keeps its baseline flags. Older compilers cannot mix
+// targets in one file and only get the portable code.
+#if defined(__x86_64__) && \
+  (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#define CHECKSUM_X86 1
+#include <immintrin.h>
+#define CHECKSUM_TARGET(isa) __attribute__((__target__(isa)))
+#endif
+
+namespace HPHP {
+///////////////////////////////////////////////////////////////////////////////
+// cpu features
+
+int Checksum::Supported() {
+  int features = 0;
+#ifdef CHECKSUM_X86
+  uint32 a, b, c, d;
+  asm volatile("cpuid" : "=a"(a), "=b"(b), "=c"(c), "=d"(d) : "a"(0), "c"(0));
+  uint32 maxLeaf = a;
+  asm volatile("cpuid" : "=a"(a), "=b"(b), "=c"(c), "=d"(d) : "a"(1), "c"(0));
+  bool sse41 = c & (1 << 19);
+  if (c & (1 << 9)) features |= SSSE3;
+  if (c & (1 << 20)) features |= SSE42;
+  if ((c & (1 << 1)) && sse41) features |= PCLMUL;
+  if (maxLeaf >= 7 && (features & SSSE3) && sse41) {
+    asm volatile("cpuid" : "=a"(a), "=b"(b), "=c"(c), "=d"(d)
+                 : "a"(7), "c"(0));
+    if (b & (1 << 29)) features |= SHA;
+  }
+#endif
+  return features;
+}
+
+int Checksum::Enabled = Checksum::Supported();
+
+///////////////////////////////////////////////////////////////////////////////
+// portable crc, eight bytes per step ("slicing-by-8")
+
+struct CrcTables {
+  uint32 crc32[8][256];
+  uint32 crc32c[8][256];
+  uint32 bzip2[8][256];
+
+  CrcTables() {
+    reflected(crc32, 0xEDB88320);
+    reflected(crc32c, 0x82F63B78);
+    for (int i = 0; i < 256; i++) {
+      uint32 crc = i << 24;
+      for (int j = 0; j < 8; j++) {
+        crc = (crc & 0x80000000) ? (crc << 1) ^ 0x04C11DB7 : crc << 1;
+      }
+      bzip2[0][i] = crc;
+    }
+    for (int k = 1; k < 8; k++) {
+      for (int i = 0; i < 256; i++) {
+        uint32 crc = bzip2[k - 1][i];
+        bzip2[k][i] = (crc << 8) ^ bzip2[0][crc >> 24];
+      }
+    }
+  }
+
+  static void reflected(uint32 t[8][256], uint32 poly) {
+    for (int i = 0; i < 256; i++) {
+      uint32 crc = i;
+      for (int j = 0; j < 8; j++) {
+        crc = (crc & 1) ? (crc >> 1) ^ poly : crc >> 1;
+      }
+      t[0][i] = crc;
+    }
+    for (int k = 1; k < 8; k++) {
+      for (int i = 0; i < 256; i++) {
+        uint32 crc = t[k - 1][i];
+        t[k][i] = (crc >> 8) ^ t[0][crc & 0xff];
+      }
+    }
+  }
+};
+
+static const CrcTables &crc_tables() {
+  static CrcTables tables;
+  return tables;
+}
+
+static inline uint32 load_le32(const unsigned char *p) {
+  return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32)p[3] << 24);
+}
+
+static inline uint32 load_be32(const unsigned char *p) {
+  return ((uint32)p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+static uint32 crc_reflected(const uint32 t[8][256], uint32 crc,
+                            const unsigned char *p, size_t len) {
+  for (; len && ((uintptr_t)p & 7); len--) {
+    crc = (crc >> 8) ^ t[0][(crc ^ *p++) & 0xff];
+  }
+  for (; len >= 8; len -= 8, p += 8) {
+    uint32 lo = crc ^ load_le32(p);
+    uint32 hi = load_le32(p + 4);
+    crc = t[7][lo & 0xff] ^ t[6][(lo >> 8) & 0xff] ^
+          t[5][(lo >> 16) & 0xff] ^ t[4][lo >> 24] ^
+          t[3][hi & 0xff] ^ t[2][(hi >> 8) & 0xff] ^
+          t[1][(hi >> 16) & 0xff] ^ t[0][hi >> 24];
+  }
+  for (; len; len--) {
+    crc = (crc >> 8) ^ t[0][(crc ^ *p++) & 0xff];
+  }
+  return crc;
+}
+
+static uint32 crc_normal(const uint32 t[8][256], uint32 crc,
+                         const unsigned char *p, size_t len) {
+  for (; len && ((uintptr_t)p & 7); len--) {
+    crc = (crc << 8) ^ t[0][(crc >> 24) ^ *p++];
+  }
+  for (; len >= 8; len -= 8, p += 8) {
+    uint32 hi = crc ^ load_be32(p);
+    uint32 lo = load_be32(p + 4);
+    crc = t[7][hi >> 24] ^ t[6][(hi >> 16) & 0xff] ^
+          t[5][(hi >> 8) & 0xff] ^ t[4][hi & 0xff] ^
+          t[3][lo >> 24] ^ t[2][(lo >> 16) & 0xff] ^
+          t[1][(lo >> 8) & 0xff] ^ t[0][lo & 0xff];
+  }
+  for (; len; len--) {
+    crc = (crc << 8) ^ t[0][(crc >> 24) ^ *p++];
+  }
+  return crc;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// hardware crc
+
+#ifdef CHECKSUM_X86
+
+/**
+ * Folds 64 bytes at a time with carry-less multiplies, then reduces the
+ * remaining 128 bits with Barrett's method; see Intel's "Fast CRC Computation
+ * for Generic Polynomials Using PCLMULQDQ Instruction". len must be a multiple
+ * of 16 and at least 64.
+ */
+CHECKSUM_TARGET("pclmul,sse4.1")
+static uint32 crc32_pclmul(uint32 crc, const unsigned char *p, size_t len) {
+  static const uint64 k1k2[2] __attribute__((aligned(16))) =
+    { 0x0154442bd4ULL, 0x01c6e41596ULL };
+  static const uint64 k3k4[2] __attribute__((aligned(16))) =
+    { 0x01751997d0ULL, 0x00ccaa009eULL };
+  static const uint64 k5k0[2] __attribute__((aligned(16))) =
+    { 0x0163cd6124ULL, 0 };
+  static const uint64 poly[2] __attribute__((aligned(16))) =
+    { 0x01db710641ULL, 0x01f7011641ULL };
+
+  __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8;
+
+  x1 = _mm_loadu_si128((const __m128i *)(p + 0x00));
+  x2 = _mm_loadu_si128((const __m128i *)(p + 0x10));
+  x3 = _mm_loadu_si128((const __m128i *)(p + 0x20));
+  x4 = _mm_loadu_si128((const __m128i *)(p + 0x30));
+  x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(crc));
+  x0 = _mm_load_si128((const __m128i *)k1k2);
+  p += 64;
+  len -= 64;
+
+  // four lanes in parallel
+  for (; len >= 64; p += 64, len -= 64) {
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+    x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+    x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+    x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+    x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x5),
+                       _mm_loadu_si128((const __m128i *)(p + 0x00)));
+    x2 = _mm_xor_si128(_mm_xor_si128(x2, x6),
+                       _mm_loadu_si128((const __m128i *)(p + 0x10)));
+    x3 = _mm_xor_si128(_mm_xor_si128(x3, x7),
+                       _mm_loadu_si128((const __m128i *)(p + 0x20)));
+    x4 = _mm_xor_si128(_mm_xor_si128(x4, x8),
+                       _mm_loadu_si128((const __m128i *)(p + 0x30)));
+  }
+
+  // fold the lanes into one, then any 16-byte blocks left
+  x0 = _mm_load_si128((const __m128i *)k3k4);
+  x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+  x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+  x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+  x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+  x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+  x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+  x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+  x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+  x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+  for (; len >= 16; p += 16, len -= 16) {
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x5),
+                       _mm_loadu_si128((const __m128i *)p));
+  }
+
+  // 128 bits down to 64
+  x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+  x3 = _mm_setr_epi32(~0, 0, ~0, 0);
+  x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+  x0 = _mm_loadl_epi64((const __m128i *)k5k0);
+  x2 = _mm_srli_si128(x1, 4);
+  x1 = _mm_and_si128(x1, x3);
+  x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+  x1 = _mm_xor_si128(x1, x2);
+
+  // Barrett reduction to 32 bits
+  x0 = _mm_load_si128((const __m128i *)poly);
+  x2 = _mm_and_si128(x1, x3);
+  x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+  x2 = _mm_and_si128(x2, x3);
+  x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+  x1 = _mm_xor_si128(x1, x2);
+  return _mm_extract_epi32(x1, 1);
+}
+
+CHECKSUM_TARGET("sse4.2")
+static uint32 crc32c_sse42(uint32 crc, const unsigned char *p, size_t len) {
+  for (; len && ((uintptr_t)p & 7); len--) {
+    crc = _mm_crc32_u8(crc, *p++);
+  }
+  uint64 crc64 = crc;
+  for (; len >= 8; len -= 8, p += 8) {
+    crc64 = _mm_crc32_u64(crc64, *(const uint64 *)p);
+  }
+  crc = crc64;
+  for (; len; len--) {
+    crc = _mm_crc32_u8(crc, *p++);
+  }
+  return crc;
+}
+
+#endif
+
+uint32 Checksum::Crc32(uint32 crc, const void *data, size_t len) {
+  const unsigned char *p = (const unsigned char *)data;
+#ifdef CHECKSUM_X86
+  if ((Enabled & PCLMUL) && len >= 64) {
+    size_t n = len & ~(size_t)15;
+    crc = crc32_pclmul(crc, p, n);
+    p += n;
+    len -= n;
+  }
+#endif
+  return crc_reflected(crc_tables().crc32, crc, p, len);
+}
+
+uint32 Checksum::Crc32Bzip2(uint32 crc, const void *data, size_t len) {
+  return crc_normal(crc_tables().bzip2, crc, (const unsigned char *)data, len);
+}
+
+uint32 Checksum::Crc32c(uint32 crc, const void *data, size_t len) {
+  const unsigned char *p = (const unsigned char *)data;
+#ifdef CHECKSUM_X86
+  if (Enabled & SSE42) {
+    return crc32c_sse42(crc, p, len);
+  }
+#endif
+  return crc_reflected(crc_tables().crc32c, crc, p, len);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// adler32
+
+#define ADLER_BASE 65521
+// largest n such that 255n(n+1)/2 + (n+1)(BASE-1) fits in 32 bits, i.e. how
+// many bytes can be summed before either half has to be reduced
+#define ADLER_NMAX 5552
+
+#ifdef CHECKSUM_X86
+
+/**
+ * Sums 32 bytes per step: psadbw adds them up for s1, and pmaddubsw weighs
+ * them by their distance from the end of the block for s2.
+ */
+CHECKSUM_TARGET("ssse3")
+static void adler32_ssse3(uint32 &s1, uint32 &s2, const unsigned char *&p,
+                          size_t &len) {
+  const __m128i tap1 = _mm_setr_epi8(32, 31, 30, 29, 28, 27, 26, 25,
+                                     24, 23, 22, 21, 20, 19, 18, 17);
+  const __m128i tap2 = _mm_setr_epi8(16, 15, 14, 13, 12, 11, 10, 9,
+                                     8, 7, 6, 5, 4, 3, 2, 1);
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i ones = _mm_set1_epi16(1);
+
+  size_t blocks = len / 32;
+  len -= blocks * 32;
+  while (blocks) {
+    size_t n = ADLER_NMAX / 32;
+    if (n > blocks) n = blocks;
+    blocks -= n;
+
+    __m128i vps = _mm_cvtsi32_si128(s1 * n);
+    __m128i vs2 = _mm_cvtsi32_si128(s2);
+    __m128i vs1 = zero;
+    for (; n; n--, p += 32) {
+      __m128i bytes1 = _mm_loadu_si128((const __m128i *)p);
+      __m128i bytes2 = _mm_loadu_si128((const __m128i *)(p + 16));
+      vps = _mm_add_epi32(vps, vs1);
+      vs1 = _mm_add_epi32(vs1, _mm_sad_epu8(bytes1, zero));
+      vs2 = _mm_add_epi32(vs2, _mm_madd_epi16(_mm_maddubs_epi16(bytes1, tap1),
+                                              ones));
+      vs1 = _mm_add_epi32(vs1, _mm_sad_epu8(bytes2, zero));
+      vs2 = _mm_add_epi32(vs2, _mm_madd_epi16(_mm_maddubs_epi16(bytes2, tap2),
+                                              ones));
+    }
+    vs2 = _mm_add_epi32(vs2, _mm_slli_epi32(vps, 5));
+
+    vs1 = _mm_add_epi32(vs1, _mm_shuffle_epi32(vs1, _MM_SHUFFLE(1, 0, 3, 2)));
+    s1 += _mm_cvtsi128_si32(vs1);
+    vs2 = _mm_add_epi32(vs2, _mm_shuffle_epi32(vs2, _MM_SHUFFLE(2, 3, 0, 1)));
+    vs2 = _mm_add_epi32(vs2, _mm_shuffle_epi32(vs2, _MM_SHUFFLE(1, 0, 3, 2)));
+    s2 = _mm_cvtsi128_si32(vs2);
+
+    s1 %= ADLER_BASE;
+    s2 %= ADLER_BASE;
+  }
+}
+
+#endif
+
+uint32 Checksum::Adler32(uint32 adler, const void *data, size_t len) {
+  const unsigned char *p = (const unsigned char *)data;
+  uint32 s1 = adler & 0xffff;
+  uint32 s2 = (adler >> 16) & 0xffff;
+#ifdef CHECKSUM_X86
+  if ((Enabled & SSSE3) && len >= 32) {
+    adler32_ssse3(s1, s2, p, len);
+  }
+#endif
+  while (len) {
+    size_t n = len < ADLER_NMAX ? len : ADLER_NMAX;
+    len -= n;
+    for (; n; n--) {
+      s1 += *p++;
+      s2 += s1;
+    }
+    s1 %= ADLER_BASE;
+    s2 %= ADLER_BASE;
+  }
+  return s1 | (s2 << 16);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// sha
+
+#ifdef CHECKSUM_X86
+
+CHECKSUM_TARGET("sha,sse4.1")
+static void sha1_shani(uint32 state[5], const unsigned char *data,
+                       size_t blocks) {
+  const __m128i mask = _mm_set_epi64x(0x0001020304050607ULL,
+                                      0x08090a0b0c0d0e0fULL);
+  __m128i abcd = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)state),
+                                   0x1B);
+  __m128i e0 = _mm_set_epi32(state[4], 0, 0, 0);
+  __m128i e1, m0, m1, m2, m3;
+
+  for (; blocks; blocks--, data += 64) {
+    __m128i abcdSave = abcd;
+    __m128i e0Save = e0;
+
+    // Each step runs four rounds and works the message schedule a few
+    // steps ahead: msg1/xor/msg2 compute W[t] from W[t-3], W[t-8], W[t-14]
+    // and W[t-16].
+#define SHA1_STEP(ecur, eother, w, f)           \
+    ecur = _mm_sha1nexte_epu32(ecur, w);        \
+    eother = abcd;                              \
+    abcd = _mm_sha1rnds4_epu32(abcd, ecur, f);
+
+    // rounds 0-15 on the block itself
+    m0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)data), mask);
+    e0 = _mm_add_epi32(e0, m0);
+    e1 = abcd;
+    abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+
+    m1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data + 16)),
+                          mask);
+    SHA1_STEP(e1, e0, m1, 0);
+    m0 = _mm_sha1msg1_epu32(m0, m1);
+
+    m2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data + 32)),
+                          mask);
+    SHA1_STEP(e0, e1, m2, 0);
+    m1 = _mm_sha1msg1_epu32(m1, m2);
+    m0 = _mm_xor_si128(m0, m2);
+
+    m3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data + 48)),
+                          mask);
+    SHA1_STEP(e1, e0, m3, 0);
+    m0 = _mm_sha1msg2_epu32(m0, m3);
+    m2 = _mm_sha1msg1_epu32(m2, m3);
+    m1 = _mm_xor_si128(m1, m3);
+
+    // rounds 16-67, with the schedule in full swing
+#define SHA1_SCHEDULE(ecur, eother, w, next, after, prev, f)    \
+    SHA1_STEP(ecur, eother, w, f);                              \
+    next = _mm_sha1msg2_epu32(next, w);                         \
+    prev = _mm_sha1msg1_epu32(prev, w);                         \
+    after = _mm_xor_si128(after, w);
+
+    SHA1_SCHEDULE(e0, e1, m0, m1, m2, m3, 0);  // 16-19
+    SHA1_SCHEDULE(e1, e0, m1, m2, m3, m0, 1);  // 20-23
+    SHA1_SCHEDULE(e0, e1, m2, m3, m0, m1, 1);
+    SHA1_SCHEDULE(e1, e0, m3, m0, m1, m2, 1);
+    SHA1_SCHEDULE(e0, e1, m0, m1, m2, m3, 1);
+    SHA1_SCHEDULE(e1, e0, m1, m2, m3, m0, 1);
+    SHA1_SCHEDULE(e0, e1, m2, m3, m0, m1, 2);  // 40-43
+    SHA1_SCHEDULE(e1, e0, m3, m0, m1, m2, 2);
+    SHA1_SCHEDULE(e0, e1, m0, m1, m2, m3, 2);
+    SHA1_SCHEDULE(e1, e0, m1, m2, m3, m0, 2);
+    SHA1_SCHEDULE(e0, e1, m2, m3, m0, m1, 2);
+    SHA1_SCHEDULE(e1, e0, m3, m0, m1, m2, 3);  // 60-63
+    SHA1_SCHEDULE(e0, e1, m0, m1, m2, m3, 3);
+
+    // rounds 68-79, winding the schedule down
+    SHA1_STEP(e1, e0, m1, 3);
+    m2 = _mm_sha1msg2_epu32(m2, m1);
+    m3 = _mm_xor_si128(m3, m1);
+
+    SHA1_STEP(e0, e1, m2, 3);
+    m3 = _mm_sha1msg2_epu32(m3, m2);
+
+    SHA1_STEP(e1, e0, m3, 3);
+
+#undef SHA1_SCHEDULE
+#undef SHA1_STEP
+
+    e0 = _mm_sha1nexte_epu32(e0, e0Save);
+    abcd = _mm_add_epi32(abcd, abcdSave);
+  }
+
+  _mm_storeu_si128((__m128i *)state, _mm_shuffle_epi32(abcd, 0x1B));
+  state[4] = _mm_extract_epi32(e0, 3);
+}
+
+static const uint32 s_sha256_k[64] __attribute__((aligned(16))) = {
+  0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
+  0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+  0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+  0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+  0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+  0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+  0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+  0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+  0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+  0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+  0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3,
+  0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+  0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5,
+  0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+  0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+  0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+CHECKSUM_TARGET("sha,sse4.1")
+static void sha256_shani(uint32 state[8], const unsigned char *data,
+                         size_t blocks) {
+  const __m128i mask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL,
+                                      0x0405060700010203ULL);
+  const __m128i *k = (const __m128i *)s_sha256_k;
+
+  // the instructions want the state as ABEF and CDGH
+  __m128i tmp = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)state),
+                                  0xB1);
+  __m128i state1 = _mm_shuffle_epi32(
+    _mm_loadu_si128((const __m128i *)(state + 4)), 0x1B);
+  __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);
+  state1 = _mm_blend_epi16(state1, tmp, 0xF0);
+
+  __m128i msg, m0, m1, m2, m3;
+  for (; blocks; blocks--, data += 64) {
+    __m128i abefSave = state0;
+    __m128i cdghSave = state1;
+
+    // four rounds per step, two per sha256rnds2
+#define SHA256_ROUNDS(w, i)                                     \
+    msg = _mm_add_epi32(w, _mm_load_si128(k + i));              \
+    state1 = _mm_sha256rnds2_epu32(state1, state0, msg);        \
+    msg = _mm_shuffle_epi32(msg, 0x0E);                         \
+    state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+
+    // W[t] for the step after next, from W[t-16], W[t-15], W[t-7] and W[t-2]
+#define SHA256_SCHEDULE(w, next, prev)                          \
+    next = _mm_sha256msg2_epu32(                                \
+      _mm_add_epi32(next, _mm_alignr_epi8(w, prev, 4)), w);
+
+    m0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)data), mask);
+    SHA256_ROUNDS(m0, 0);
+    m1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data + 16)),
+                          mask);
+    SHA256_ROUNDS(m1, 1);
+    m0 = _mm_sha256msg1_epu32(m0, m1);
+    m2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data + 32)),
+                          mask);
+    SHA256_ROUNDS(m2, 2);
+    m1 = _mm_sha256msg1_epu32(m1, m2);
+    m3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data + 48)),
+                          mask);
+    SHA256_ROUNDS(m3, 3);
+    SHA256_SCHEDULE(m3, m0, m2);
+    m2 = _mm_sha256msg1_epu32(m2, m3);
+
+    SHA256_ROUNDS(m0, 4);
+    SHA256_SCHEDULE(m0, m1, m3);
+    m3 = _mm_sha256msg1_epu32(m3, m0);
+    SHA256_ROUNDS(m1, 5);
+    SHA256_SCHEDULE(m1, m2, m0);
+    m0 = _mm_sha256msg1_epu32(m0, m1);
+    SHA256_ROUNDS(m2, 6);
+    SHA256_SCHEDULE(m2, m3, m1);
+    m1 = _mm_sha256msg1_epu32(m1, m2);
+    SHA256_ROUNDS(m3, 7);
+    SHA256_SCHEDULE(m3, m0, m2);
+    m2 = _mm_sha256msg1_epu32(m2, m3);
+
+    SHA256_ROUNDS(m0, 8);
+    SHA256_SCHEDULE(m0, m1, m3);
+    m3 = _mm_sha256msg1_epu32(m3, m0);
+    SHA256_ROUNDS(m1, 9);
+    SHA256_SCHEDULE(m1, m2, m0);
+    m0 = _mm_sha256msg1_epu32(m0, m1);
+    SHA256_ROUNDS(m2, 10);
+    SHA256_SCHEDULE(m2, m3, m1);
+    m1 = _mm_sha256msg1_epu32(m1, m2);
+    SHA256_ROUNDS(m3, 11);
+    SHA256_SCHEDULE(m3, m0, m2);
+    m2 = _mm_sha256msg1_epu32(m2, m3);
+
+    SHA256_ROUNDS(m0, 12);
+    SHA256_SCHEDULE(m0, m1, m3);
+    m3 = _mm_sha256msg1_epu32(m3, m0);
+    SHA256_ROUNDS(m1, 13);
+    SHA256_SCHEDULE(m1, m2, m0);
+    SHA256_ROUNDS(m2, 14);
+    SHA256_SCHEDULE(m2, m3, m1);
+    SHA256_ROUNDS(m3, 15);
+
+#undef SHA256_SCHEDULE
+#undef SHA256_ROUNDS
+
+    state0 = _mm_add_epi32(state0, abefSave);
+    state1 = _mm_add_epi32(state1, cdghSave);
+  }
+
+  tmp = _mm_shuffle_epi32(state0, 0x1B);
+  state1 = _mm_shuffle_epi32(state1, 0xB1);
+  _mm_storeu_si128((__m128i *)state, _mm_blend_epi16(tmp, state1, 0xF0));
+  _mm_storeu_si128((__m128i *)(state + 4), _mm_alignr_epi8(state1, tmp, 8));
+}
+
+#endif
+
+bool Checksum::Sha1Blocks(uint32 state[5], const unsigned char *data,
+                          size_t blocks) {
+#ifdef CHECKSUM_X86
+  if (Enabled & SHA) {
+    sha1_shani(state, data, blocks);
+    return true;
+  }
+#endif
+  return false;
+}
+
+bool Checksum::Sha256Blocks(uint32 state[8], const unsigned char *data,
+                            size_t blocks) {
+#ifdef CHECKSUM_X86
+  if (Enabled & SHA) {
+    sha256_shani(state, data, blocks);
+    return true;
+  }
+#endif
+  return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+}
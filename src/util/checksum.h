@@ -0,0 +1,85 @@
+/*
+   +----------------------------------------------------------------------+
+   | HipHop for PHP                                                       |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2010 Facebook, Inc. (http://www.facebook.com)          |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 3.01 of the PHP license,      |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available through the world-wide-web at the following url:           |
+   | http://www.php.net/license/3_01.txt                                  |
+   | If you did not receive a copy of the PHP license and are unable to   |
+   | obtain it through the world-wide-web, please send a note to          |
+   | license@php.net so we can mail you a copy immediately.               |
+   +----------------------------------------------------------------------+
+*/
+
+#ifndef __HPHP_CHECKSUM_H__
+#define __HPHP_CHECKSUM_H__
+
+#include <util/base.h>
+
+namespace HPHP {
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Checksums and digest compression functions that use whatever the running
+ * CPU offers: PCLMULQDQ folding for crc32, the SSE4.2 crc32 instruction for
+ * crc32c, SSSE3 for adler32 and the SHA extensions for SHA-1 and SHA-256.
+ * Portable versions produce the same bits and are used on other hosts, and
+ * for everything when Enabled is cleared.
+ *
+ * CRC functions take and return the running register: callers start from
+ * 0xFFFFFFFF and invert the final value, the same way PHP's own crc32 code
+ * keeps its state, so a checksum can be computed over several calls.
+ */
+class Checksum {
+public:
+  enum Feature {
+    SSSE3  = 0x01,
+    SSE42  = 0x02,
+    PCLMUL = 0x04,
+    SHA    = 0x08,
+  };
+
+  /**
+   * Features this CPU has, and the ones the functions below may use.
+   * Enabled starts out as Supported(); tests clear it to run the portable
+   * code on the same input.
+   */
+  static int Supported();
+  static int Enabled;
+
+  /**
+   * Reflected CRC-32 (0x04C11DB7), as in zlib, crc32() and hash('crc32b').
+   */
+  static uint32 Crc32(uint32 crc, const void *data, size_t len);
+
+  /**
+   * Non-reflected CRC-32 over the same polynomial, as in bzip2 and
+   * hash('crc32').
+   */
+  static uint32 Crc32Bzip2(uint32 crc, const void *data, size_t len);
+
+  /**
+   * Castagnoli CRC-32 (0x1EDC6F41), as in iSCSI and SSE4.2.
+   */
+  static uint32 Crc32c(uint32 crc, const void *data, size_t len);
+
+  static uint32 Adler32(uint32 adler, const void *data, size_t len);
+
+  /**
+   * Runs the compression function over whole 64-byte blocks. Returns false
+   * without touching state when the CPU has no SHA extensions, so callers
+   * can fall back to their own transforms.
+   */
+  static bool Sha1Blocks(uint32 state[5], const unsigned char *data,
+                         size_t blocks);
+  static bool Sha256Blocks(uint32 state[8], const unsigned char *data,
+                           size_t blocks);
+};
+
+///////////////////////////////////////////////////////////////////////////////
+}
+
+#endif // __HPHP_CHECKSUM_H__
@@ -21,8 +21,12 @@
 #include <afdt.h>
 #include <string>
 #include <vector>
+#include <list>
 #include <stdlib.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/socket.h>
 #include <sys/wait.h>
 #include <poll.h>
 #include <pwd.h>
@@ -32,18 +36,99 @@ using namespace std;
 namespace HPHP {
 
 ///////////////////////////////////////////////////////////////////////////////
-// helper functions
+// protocol
+//
+// A request is a header line followed by its string arguments, each prefixed
+// with its length so commands and environments may hold any bytes:
+//
+//   <tag> <command> <argc> <fdc>\n
+//   <length>\n<bytes>                  (argc times)
+//
+// with fdc descriptors following on the afdt socket. A reply is
+//
+//   <tag> <ret> <errno> <status> <fdc>\n
+//
+// again followed by fdc descriptors. Writers hold the shadow's write lock
+// for a whole request, so the shadow receives descriptors in the order it
+// reads requests; the shadow writes every reply from its one thread, and a
+// reader thread on our side hands each to whoever is waiting on its tag.
+// Replies with tag 0 have nobody waiting for them.
 
 static const unsigned int BUFFER_SIZE = 4096;
 Mutex LightProcess::s_mutex;
 
-static void read_buf(FILE *fin, char *buf) {
-  if (!fgets(buf, BUFFER_SIZE, fin)) {
-    buf[0] = '\0';
-    return;
+/**
+ * Buffered reads from a pipe, without stdio, so poll() can tell whether a
+ * whole request is already waiting in the buffer.
+ */
+class Channel {
+public:
+  explicit Channel(int fd) : m_fd(fd), m_pos(0), m_len(0) {}
+
+  bool buffered() const { return m_pos < m_len; }
+
+  bool readLine(string &line) {
+    line.clear();
+    while (true) {
+      if (!buffered() && !fill()) return false;
+      char *start = m_buf + m_pos;
+      char *nl = (char *)memchr(start, '\n', m_len - m_pos);
+      if (nl) {
+        line.append(start, nl - start);
+        m_pos += nl - start + 1;
+        return true;
+      }
+      line.append(start, m_len - m_pos);
+      m_pos = m_len;
+    }
   }
-  // get rid of '\n'
-  buf[strlen(buf) - 1] = '\0';
+
+  bool readBytes(string &out, int len) {
+    out.clear();
+    while (len > 0) {
+      if (!buffered() && !fill()) return false;
+      int n = m_len - m_pos;
+      if (n > len) n = len;
+      out.append(m_buf + m_pos, n);
+      m_pos += n;
+      len -= n;
+    }
+    return true;
+  }
+
+private:
+  int m_fd;
+  char m_buf[BUFFER_SIZE];
+  int m_pos;
+  int m_len;
+
+  bool fill() {
+    while (true) {
+      ssize_t n = ::read(m_fd, m_buf, sizeof(m_buf));
+      if (n > 0) {
+        m_pos = 0;
+        m_len = n;
+        return true;
+      }
+      if (n < 0 && errno == EINTR) continue;
+      return false;
+    }
+  }
+};
+
+static bool write_all(int fd, const string &s) {
+  const char *p = s.data();
+  size_t left = s.size();
+  while (left) {
+    ssize_t n = ::write(fd, p, left);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    p += n;
+    left -= n;
+  }
+  return true;
 }
 
 static bool send_fd(int afdt_fd, int fd) {
@@ -79,181 +164,326 @@ static char **build_envp(const vector<string> &env) {
 
 static void close_fds(const vector<int> &fds) {
   for (unsigned int i = 0; i < fds.size(); i++) {
-    ::close(fds[i]);
+    if (fds[i] >= 0) ::close(fds[i]);
   }
 }
 
-///////////////////////////////////////////////////////////////////////////////
-// shadow process tasks
-
-static void do_popen(FILE *fin, FILE *fout, int afdt_fd) {
-  char buf[BUFFER_SIZE];
-  char cwd[BUFFER_SIZE];
-
-  if (!fgets(buf, BUFFER_SIZE, fin)) buf[0] = '\0';
-  bool read_only = (buf[0] == 'r');
-
-  read_buf(fin, buf);
+static void set_cloexec(int fd) {
+  fcntl(fd, F_SETFD, FD_CLOEXEC);
+}
 
-  string old_cwd = Process::GetCurrentDirectory();
-  read_buf(fin, cwd);
-  if (old_cwd != cwd) {
-    chdir(cwd);
+static string encode_request(int64 tag, const char *cmd,
+                             const vector<string> &args, int fdc) {
+  char buf[128];
+  snprintf(buf, sizeof(buf), "%lld %s %d %d\n", tag, cmd, (int)args.size(),
+           fdc);
+  string out = buf;
+  for (unsigned int i = 0; i < args.size(); i++) {
+    snprintf(buf, sizeof(buf), "%d\n", (int)args[i].size());
+    out += buf;
+    out += args[i];
   }
+  return out;
+}
 
-  FILE *f = buf[0] ? ::popen(buf, read_only ? "r" : "w") : NULL;
+///////////////////////////////////////////////////////////////////////////////
+// shadow process tasks
 
-  if (old_cwd != cwd) {
-    chdir(old_cwd.c_str());
+struct ShadowRequest {
+  int64 tag;
+  string cmd;
+  vector<string> args;
+  vector<int> fds;
+};
+
+struct PendingWait {
+  int64 tag;
+  pid_t pid;
+  int options;
+};
+
+static bool read_request(Channel &in, int afdt_fd, ShadowRequest &req) {
+  string line;
+  if (!in.readLine(line)) return false;
+  long long tag = 0;
+  char cmd[64];
+  int argc = 0, fdc = 0;
+  if (sscanf(line.c_str(), "%lld %63s %d %d", &tag, cmd, &argc, &fdc) != 4) {
+    return false;
   }
+  req.tag = tag;
+  req.cmd = cmd;
+  req.args.resize(argc);
+  for (int i = 0; i < argc; i++) {
+    if (!in.readLine(line) || !in.readBytes(req.args[i], atoi(line.c_str()))) {
+      return false;
+    }
+  }
+  for (int i = 0; i < fdc; i++) {
+    int fd = recv_fd(afdt_fd);
+    if (fd >= 0) set_cloexec(fd);
+    req.fds.push_back(fd);
+  }
+  return true;
+}
 
-  if (f == NULL) {
-    // no need to send the errno back, as the main process will try ::popen
-    fprintf(fout, "error\n");
-    fflush(fout);
-  } else {
-    fprintf(fout, "success\n%lld\n", (int64)f);
-    fflush(fout);
-    int fd = fileno(f);
-    send_fd(afdt_fd, fd);
+static void write_reply(int fdout, int afdt_fd, int64 tag, int64 ret,
+                        int err, int status,
+                        const vector<int> &fds = vector<int>()) {
+  char buf[128];
+  snprintf(buf, sizeof(buf), "%lld %lld %d %d %d\n", tag, ret, err, status,
+           (int)fds.size());
+  write_all(fdout, buf);
+  for (unsigned int i = 0; i < fds.size(); i++) {
+    send_fd(afdt_fd, fds[i]);
   }
 }
 
-static void do_pclose(FILE *fin, FILE *fout) {
-  char buf[BUFFER_SIZE];
+/**
+ * Starts "sh -c cmd" with fds[i] as descriptor desired[i] in the child.
+ * vfork() keeps this cheap however the shadow is doing; a chdir() or exec
+ * failure in the child comes back through a close-on-exec pipe.
+ */
+static pid_t spawn(const string &cmd, const vector<int> &fds,
+                   const vector<int> &desired, const string &cwd,
+                   const vector<string> &env, int &err) {
+  err = 0;
+  int status[2];
+  if (pipe(status) < 0) {
+    err = errno;
+    return -1;
+  }
+  set_cloexec(status[0]);
+  set_cloexec(status[1]);
+  char **envp = build_envp(env);
 
-  int64 fptr = 0;
-  read_buf(fin, buf);
-  sscanf(buf, "%lld", &fptr);
-  FILE *f = (FILE *)fptr;
-  int ret = ::pclose(f);
+  pid_t child = vfork();
+  if (child == 0) {
+    for (unsigned int i = 0; i < fds.size(); i++) {
+      if (fds[i] == desired[i]) {
+        fcntl(fds[i], F_SETFD, 0);
+      } else {
+        dup2(fds[i], desired[i]);
+      }
+    }
+    if (cwd.empty() || chdir(cwd.c_str()) == 0) {
+      if (envp) {
+        execle("/bin/sh", "sh", "-c", cmd.c_str(), NULL, envp);
+      } else {
+        execl("/bin/sh", "sh", "-c", cmd.c_str(), NULL);
+      }
+    }
+    int e = errno;
+    if (write(status[1], &e, sizeof(e))) {}
+    _exit(127);
+  }
 
-  fprintf(fout, "%d\n", ret);
-  if (ret < 0) {
-    fprintf(fout, "%d\n", errno);
+  if (child < 0) err = errno;
+  ::close(status[1]);
+  if (child > 0) {
+    int e;
+    ssize_t n;
+    do {
+      n = read(status[0], &e, sizeof(e));
+    } while (n < 0 && errno == EINTR);
+    if (n == sizeof(e)) {
+      ::waitpid(child, NULL, 0);
+      err = e;
+      child = -1;
+    }
   }
-  fflush(fout);
+  ::close(status[0]);
+  free(envp);
+  return child;
 }
 
-static void do_proc_open(FILE *fin, FILE *fout, int afdt_fd) {
-  char cmd[BUFFER_SIZE];
-  read_buf(fin, cmd);
-  if (strlen(cmd) == 0) {
-    fprintf(fout, "error\n%d\n", ENOENT);
-    fflush(fout);
+static void do_popen(const ShadowRequest &req, int fdout, int afdt_fd) {
+  // type, cmd, cwd
+  if (req.args.size() != 3 || req.args[1].empty()) {
+    write_reply(fdout, afdt_fd, req.tag, -1, ENOENT, 0);
     return;
   }
-
-  char cwd[BUFFER_SIZE];
-  read_buf(fin, cwd);
-
-  char buf[BUFFER_SIZE];
-  int env_size = 0;
-  vector<string> env;
-  read_buf(fin, buf);
-  sscanf(buf, "%d", &env_size);
-  for (int i = 0; i < env_size; i++) {
-    read_buf(fin, buf);
-    env.push_back(buf);
+  int fds[2];
+  if (pipe(fds) < 0) {
+    write_reply(fdout, afdt_fd, req.tag, -1, errno, 0);
+    return;
   }
-
-  int pipe_size = 0;
-  read_buf(fin, buf);
-  sscanf(buf, "%d", &pipe_size);
-  vector<int> pvals;
-  for (int i = 0; i < pipe_size; i++) {
-    int fd_value;
-    read_buf(fin, buf);
-    sscanf(buf, "%d", &fd_value);
-    pvals.push_back(fd_value);
+  set_cloexec(fds[0]);
+  set_cloexec(fds[1]);
+  bool read_only = (req.args[0][0] == 'r');
+  int ours = read_only ? fds[0] : fds[1];
+  vector<int> theirs(1, read_only ? fds[1] : fds[0]);
+  vector<int> desired(1, read_only ? 1 : 0);
+
+  int err;
+  pid_t child = spawn(req.args[1], theirs, desired, req.args[2],
+                      vector<string>(), err);
+  ::close(theirs[0]);
+  if (child < 0) {
+    ::close(ours);
+    write_reply(fdout, afdt_fd, req.tag, -1, err, 0);
+    return;
   }
+  write_reply(fdout, afdt_fd, req.tag, child, 0, 0, vector<int>(1, ours));
+  ::close(ours);
+}
 
-  vector<int> pkeys;
-  for (int i = 0; i < pipe_size; i++) {
-    int fd = recv_fd(afdt_fd);
-    if (fd < 0) {
-      fprintf(fout, "error\n%d\n", errno);
-      fflush(fout);
-      close_fds(pkeys);
+static void do_proc_open(const ShadowRequest &req, int fdout, int afdt_fd) {
+  // cmd, cwd, one desired fd for each descriptor sent, then the environment
+  unsigned int npipes = req.fds.size();
+  if (req.args.size() < 2 + npipes || req.args[0].empty()) {
+    close_fds(req.fds);
+    write_reply(fdout, afdt_fd, req.tag, -1, ENOENT, 0);
+    return;
+  }
+  for (unsigned int i = 0; i < npipes; i++) {
+    if (req.fds[i] < 0) {
+      close_fds(req.fds);
+      write_reply(fdout, afdt_fd, req.tag, -1, EBADF, 0);
       return;
     }
-    pkeys.push_back(fd);
   }
-
-  // now ready to start the child process
-  pid_t child = fork();
-  if (child == 0) {
-    for (int i = 0; i < pipe_size; i++) {
-      dup2(pkeys[i], pvals[i]);
-    }
-    if (strlen(cwd) > 0) {
-      if (chdir(cwd)) { // non-zero for error
-        fprintf(fout, "error\n%d\n", errno);
-        fflush(fout);
-        close_fds(pkeys);
-        return;
-      }
-    }
-    if (!env.empty()) {
-      char **envp = build_envp(env);
-      execle("/bin/sh", "sh", "-c", cmd, NULL, envp);
-      free(envp);
-    } else {
-      execl("/bin/sh", "sh", "-c", cmd, NULL);
-    }
-    _exit(127);
-  } else if (child > 0) {
-    // successfully created the child process
-    fprintf(fout, "%lld\n", (int64)child);
-    fflush(fout);
-  } else {
-    // failed creating the child process
-    fprintf(fout, "error\n%d\n", errno);
-    fflush(fout);
+  vector<int> desired;
+  for (unsigned int i = 0; i < npipes; i++) {
+    desired.push_back(atoi(req.args[2 + i].c_str()));
   }
+  vector<string> env(req.args.begin() + 2 + npipes, req.args.end());
 
-  close_fds(pkeys);
+  int err;
+  pid_t child = spawn(req.args[0], req.fds, desired, req.args[1], env, err);
+  close_fds(req.fds);
+  write_reply(fdout, afdt_fd, req.tag, child, err, 0);
 }
 
-static void do_waitpid(FILE *fin, FILE *fout) {
-  char buf[BUFFER_SIZE];
-  read_buf(fin, buf);
-  int64 p = -1;
-  int options = 0;
-  sscanf(buf, "%lld %d", &p, &options);
-  pid_t pid = (pid_t)p;
-  int stat;
-  pid_t ret = ::waitpid(pid, &stat, options);
-  fprintf(fout, "%lld %d\n", (int64)ret, stat);
-  if (ret < 0) {
-    fprintf(fout, "%d\n", errno);
-  }
-  fflush(fout);
+/**
+ * Replies to the request if the child changed state or the caller does not
+ * want to block; returns false if it has to wait for another SIGCHLD.
+ */
+static bool do_waitpid(const PendingWait &w, int fdout, int afdt_fd,
+                       bool block) {
+  int stat = 0;
+  pid_t ret;
+  do {
+    ret = ::waitpid(w.pid, &stat, w.options | WNOHANG);
+  } while (ret < 0 && errno == EINTR);
+  if (ret == 0 && block) return false;
+  write_reply(fdout, afdt_fd, w.tag, ret, ret < 0 ? errno : 0, stat);
+  return true;
 }
 
-static void do_change_user(FILE *fin, FILE *fout) {
-  char uname[BUFFER_SIZE];
-  read_buf(fin, uname);
-  if (strlen(uname) > 0) {
-    struct passwd *pw = getpwnam(uname);
+static void do_change_user(const ShadowRequest &req) {
+  if (!req.args.empty() && !req.args[0].empty()) {
+    struct passwd *pw = getpwnam(req.args[0].c_str());
     if (pw && pw->pw_uid) {
       setuid(pw->pw_uid);
     }
   }
 }
 
+static int s_sigchld_pipe[2] = { -1, -1 };
+
+static void on_sigchld(int) {
+  int saved = errno;
+  if (write(s_sigchld_pipe[1], "", 1)) {}
+  errno = saved;
+}
+
+/**
+ * Starts another shadow as a sibling of this one, so it is nobody's child
+ * we would reap by accident, and hands our end of its pipes and afdt socket
+ * back to the server. Returns true in the new shadow, with the descriptors
+ * it should serve in shadow_fds.
+ */
+static bool do_spawn_shadow(const ShadowRequest &req, int fdin, int fdout,
+                            int afdt_fd, int shadow_fds[3]) {
+  int to[2], from[2], sv[2];
+  if (pipe(to) < 0) {
+    write_reply(fdout, afdt_fd, req.tag, -1, errno, 0);
+    return false;
+  }
+  if (pipe(from) < 0) {
+    int err = errno;
+    ::close(to[0]); ::close(to[1]);
+    write_reply(fdout, afdt_fd, req.tag, -1, err, 0);
+    return false;
+  }
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) < 0) {
+    int err = errno;
+    ::close(to[0]); ::close(to[1]); ::close(from[0]); ::close(from[1]);
+    write_reply(fdout, afdt_fd, req.tag, -1, err, 0);
+    return false;
+  }
+
+  pid_t child = fork();
+  if (child == 0) {
+    if (fork() == 0) {
+      ::close(fdin);
+      ::close(fdout);
+      ::close(afdt_fd);
+      ::close(s_sigchld_pipe[0]);
+      ::close(s_sigchld_pipe[1]);
+      ::close(to[1]);
+      ::close(from[0]);
+      ::close(sv[0]);
+      shadow_fds[0] = to[0];
+      shadow_fds[1] = from[1];
+      shadow_fds[2] = sv[1];
+      return true;
+    }
+    _exit(0);
+  }
+
+  int err = child < 0 ? errno : 0;
+  if (child > 0) ::waitpid(child, NULL, 0);
+  ::close(to[0]);
+  ::close(from[1]);
+  ::close(sv[1]);
+  vector<int> fds;
+  fds.push_back(to[1]);
+  fds.push_back(from[0]);
+  fds.push_back(sv[0]);
+  if (child < 0) {
+    write_reply(fdout, afdt_fd, req.tag, -1, err, 0);
+  } else {
+    write_reply(fdout, afdt_fd, req.tag, 0, 0, 0, fds);
+  }
+  close_fds(fds);
+  return false;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // light-weight process
 
-static vector<LightProcess> g_procs;
+struct LightProcess::Request : public Synchronizable {
+  Request() : done(false), lost(false), ret(-1), err(0), status(0) {}
+  bool done;
+  bool lost;  // the shadow went away before replying
+  int64 ret;
+  int err;
+  int status;
+  vector<int> fds;
+};
+
+// Shadows are never removed before Close(), and the array never moves, so
+// Pick() can look at the first g_count of them without a lock.
+static vector<LightProcess*> g_procs;
+static volatile int g_count = 0;
+static Mutex s_growMutex;
+
+// Children started through a shadow, so waits go to the right one.
+static Mutex s_ownerMutex;
+static map<pid_t, LightProcess*> s_owners;
+static map<FILE*, pid_t> s_popens;
 
 LightProcess::LightProcess()
-: m_shadowProcess(0), m_fin(NULL), m_fout(NULL), m_afdt_fd(-1) { }
+: m_shadowProcess(0), m_fin(-1), m_fout(-1), m_afdt_fd(-1), m_alive(false),
+  m_lastTag(0), m_spawning(0), m_reader(NULL) { }
 
 LightProcess::~LightProcess() {
 }
 
-void LightProcess::Initialize(const std::string &prefix, int count) {
+void LightProcess::Initialize(const std::string &prefix, int count,
+                              int maxCount /* = 0 */) {
   if (prefix.empty() || count <= 0) {
     return;
   }
@@ -263,22 +493,27 @@ void LightProcess::Initialize(const std::string &prefix, int count) {
     return;
   }
 
-  g_procs.resize(count);
+  if (maxCount < count) maxCount = count;
+  g_procs.resize(maxCount);
 
   for (int i = 0; i < count; i++) {
-    if (!g_procs[i].initShadow(prefix, i)) {
+    LightProcess *proc = new LightProcess();
+    if (!proc->initShadow(prefix, i)) {
+      delete proc;
       for (int j = 0; j < i; j++) {
-        g_procs[j].closeShadow();
+        g_procs[j]->closeShadow();
+        delete g_procs[j];
       }
       g_procs.clear();
-      break;
+      g_count = 0;
+      return;
     }
+    g_procs[i] = proc;
+    g_count = i + 1;
   }
 }
 
 bool LightProcess::initShadow(const std::string &prefix, int id) {
-  Lock lock(m_procMutex);
-
   ostringstream os;
   os << prefix << "." << getpid() << "." << id;
   m_afdtFilename = os.str();
@@ -297,6 +532,7 @@ bool LightProcess::initShadow(const std::string &prefix, int id) {
   if (!p1.open() || !p2.open()) {
     Logger::Warning("Unable to create pipe: %d %s", errno,
                     Util::safe_strerror(errno).c_str());
+    ::close(lfd);
     return false;
   }
 
@@ -308,54 +544,98 @@ bool LightProcess::initShadow(const std::string &prefix, int id) {
       Logger::Warning("Unable to setsid");
       exit(-1);
     }
-    m_afdt_fd =
-      afdt_connect(m_afdtFilename.c_str(), &err);
-    if (m_afdt_fd < 0) {
+    int afdt_fd = afdt_connect(m_afdtFilename.c_str(), &err);
+    if (afdt_fd < 0) {
       Logger::Warning("Unable to afdt_connect");
       exit(-1);
     }
+    ::close(lfd);
+    // don't keep the earlier shadows talking to a server that went away
+    for (int i = 0; i < id; i++) {
+      ::close(g_procs[i]->m_fin);
+      ::close(g_procs[i]->m_fout);
+      ::close(g_procs[i]->m_afdt_fd);
+    }
     int fd1 = p1.detachOut();
     int fd2 = p2.detachIn();
     p1.close();
     p2.close();
-    runShadow(fd1, fd2);
+    RunShadow(fd1, fd2, afdt_fd);
   } else if (child < 0) {
     // failed
     Logger::Warning("Unable to fork lightly: %d %s", errno,
                     Util::safe_strerror(errno).c_str());
+    ::close(lfd);
+    return false;
+  }
+
+  // parent
+  m_shadowProcess = child;
+  int fin = p2.detachOut();
+  int fout = p1.detachIn();
+
+  sockaddr addr;
+  socklen_t addrlen = sizeof(addr);
+  int afdt_fd = accept(lfd, &addr, &addrlen);
+  ::close(lfd);
+  remove(m_afdtFilename.c_str());
+  if (afdt_fd < 0) {
+    Logger::Warning("Unable to establish afdt connection");
+    ::close(fin);
+    ::close(fout);
+    closeShadow();
     return false;
-  } else {
-    // parent
-    m_fin = fdopen(p2.detachOut(), "r");
-    m_fout = fdopen(p1.detachIn(), "w");
-    m_shadowProcess = child;
-
-    sockaddr addr;
-    socklen_t addrlen;
-    m_afdt_fd = accept(lfd, &addr, &addrlen);
-    if (m_afdt_fd < 0) {
-      Logger::Warning("Unable to establish afdt connection");
-      closeShadow();
-      return false;
-    }
   }
+  return attach(fin, fout, afdt_fd);
+}
+
+bool LightProcess::attach(int fin, int fout, int afdt_fd) {
+  m_fin = fin;
+  m_fout = fout;
+  m_afdt_fd = afdt_fd;
+  set_cloexec(m_fin);
+  set_cloexec(m_fout);
+  set_cloexec(m_afdt_fd);
+  m_alive = true;
+  m_reader = new AsyncFunc<LightProcess>(this, &LightProcess::readReplies);
+  m_reader->start();
   return true;
 }
 
 void LightProcess::Close() {
-  for (unsigned int i = 0; i < g_procs.size(); i++) {
-    g_procs[i].closeShadow();
+  Lock lock(s_growMutex);
+  for (int i = 0; i < g_count; i++) {
+    g_procs[i]->closeShadow();
+  }
+  for (int i = 0; i < g_count; i++) {
+    delete g_procs[i];
   }
   g_procs.clear();
+  g_count = 0;
+
+  Lock olock(s_ownerMutex);
+  s_owners.clear();
+  s_popens.clear();
 }
 
 void LightProcess::closeShadow() {
-  Lock lock(m_procMutex);
+  if (m_fout >= 0) {
+    {
+      Lock lock(m_writeMutex);
+      write_all(m_fout, encode_request(0, "exit", vector<string>(), 0));
+      ::close(m_fout);
+      m_fout = -1;
+    }
+    if (m_reader) {
+      // the shadow closes its end on the way out
+      m_reader->waitForEnd();
+      delete m_reader;
+      m_reader = NULL;
+    }
+    ::close(m_fin);
+    m_fin = -1;
+  }
   if (m_shadowProcess) {
-    fprintf(m_fout, "exit\n");
-    fflush(m_fout);
-    fclose(m_fin);
-    fclose(m_fout);
     // removes the "zombie" process, so not to interfere with later waits
     ::waitpid(m_shadowProcess, NULL, 0);
   }
@@ -370,51 +650,269 @@ void LightProcess::closeShadow() {
 }
 
 bool LightProcess::Available() {
-  return !g_procs.empty();
+  return g_count > 0;
 }
 
-void LightProcess::runShadow(int fdin, int fdout) {
-  FILE *fin = fdopen(fdin, "r");
-  FILE *fout = fdopen(fdout, "w");
+int LightProcess::GetCount() {
+  return g_count;
+}
+
+void LightProcess::RunShadow(int fdin, int fdout, int afdt_fd) {
+  set_cloexec(fdin);
+  set_cloexec(fdout);
+  set_cloexec(afdt_fd);
+
+  if (pipe(s_sigchld_pipe) == 0) {
+    for (int i = 0; i < 2; i++) {
+      set_cloexec(s_sigchld_pipe[i]);
+      fcntl(s_sigchld_pipe[i], F_SETFL, O_NONBLOCK);
+    }
+  }
+  struct sigaction sa;
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_handler = on_sigchld;
+  sa.sa_flags = SA_RESTART;
+  sigemptyset(&sa.sa_mask);
+  sigaction(SIGCHLD, &sa, NULL);
 
-  char buf[BUFFER_SIZE];
+  Channel in(fdin);
+  list<PendingWait> waits;
 
-  pollfd pfd[1];
+  pollfd pfd[2];
   pfd[0].fd = fdin;
   pfd[0].events = POLLIN;
+  pfd[1].fd = s_sigchld_pipe[0];
+  pfd[1].events = POLLIN;
   while (true) {
-    poll(pfd, 1, -1);
-    if (pfd[0].revents & POLLHUP) {
+    if (!in.buffered()) {
+      pfd[0].revents = pfd[1].revents = 0;
+      if (poll(pfd, 2, -1) < 0) {
+        if (errno == EINTR) continue;
+        break;
+      }
+      if (pfd[1].revents & POLLIN) {
+        char buf[64];
+        while (read(s_sigchld_pipe[0], buf, sizeof(buf)) > 0) {}
+        for (list<PendingWait>::iterator it = waits.begin();
+             it != waits.end(); ) {
+          if (do_waitpid(*it, fdout, afdt_fd, true)) {
+            it = waits.erase(it);
+          } else {
+            ++it;
+          }
+        }
+      }
+      if (!(pfd[0].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+    }
+
+    ShadowRequest req;
+    if (!read_request(in, afdt_fd, req)) {
       // no more command can come in
       break;
     }
-    else if (pfd[0].revents & POLLIN) {
-      if (!fgets(buf, BUFFER_SIZE, fin)) buf[0] = '\0';
-      if (strncmp(buf, "exit", 4) == 0) {
-        break;
-      } else if (strncmp(buf, "popen", 5) == 0) {
-        do_popen(fin, fout, m_afdt_fd);
-      } else if (strncmp(buf, "pclose", 6) == 0) {
-        do_pclose(fin, fout);
-      } else if (strncmp(buf, "proc_open", 9) == 0) {
-        do_proc_open(fin, fout, m_afdt_fd);
-      } else if (strncmp(buf, "waitpid", 7) == 0) {
-        do_waitpid(fin, fout);
-      } else if (strncmp(buf, "change_user", 11) == 0) {
-        do_change_user(fin, fout);
+    if (req.cmd == "exit") {
+      break;
+    } else if (req.cmd == "popen") {
+      do_popen(req, fdout, afdt_fd);
+    } else if (req.cmd == "proc_open") {
+      do_proc_open(req, fdout, afdt_fd);
+    } else if (req.cmd == "waitpid" && req.args.size() == 2) {
+      PendingWait w;
+      w.tag = req.tag;
+      w.pid = (pid_t)atoll(req.args[0].c_str());
+      w.options = atoi(req.args[1].c_str());
+      bool block = !(w.options & WNOHANG);
+      if (!do_waitpid(w, fdout, afdt_fd, block)) {
+        waits.push_back(w);
       }
+    } else if (req.cmd == "change_user") {
+      do_change_user(req);
+      write_reply(fdout, afdt_fd, req.tag, 0, 0, 0);
+    } else if (req.cmd == "spawn_shadow") {
+      int fds[3];
+      if (do_spawn_shadow(req, fdin, fdout, afdt_fd, fds)) {
+        RunShadow(fds[0], fds[1], fds[2]);
+      }
+    } else {
+      close_fds(req.fds);
+      write_reply(fdout, afdt_fd, req.tag, -1, EINVAL, 0);
     }
   }
 
-  fclose(fin);
-  fclose(fout);
-  ::close(m_afdt_fd);
-  remove(m_afdtFilename.c_str());
+  ::close(fdin);
+  ::close(fdout);
+  ::close(afdt_fd);
   exit(0);
 }
 
-int LightProcess::GetId() {
-  return (int)pthread_self() % g_procs.size();
+bool LightProcess::call(Request *req, const char *cmd,
+                        const vector<string> &args, const vector<int> &fds,
+                        bool spawn /* = false */) {
+  int64 tag = 0;
+  {
+    Lock lock(m_mutex);
+    if (!m_alive) {
+      errno = EPIPE;
+      return false;
+    }
+    if (req) {
+      tag = ++m_lastTag;
+      m_pending[tag] = req;
+      if (spawn) m_spawning++;
+    }
+  }
+
+  bool ok;
+  {
+    Lock lock(m_writeMutex);
+    ok = m_fout >= 0 &&
+      write_all(m_fout, encode_request(tag, cmd, args, fds.size()));
+    for (unsigned int i = 0; ok && i < fds.size(); i++) {
+      ok = send_fd(m_afdt_fd, fds[i]);
+    }
+  }
+
+  if (!req) return ok;
+
+  if (!ok) {
+    // the reader thread fails whatever is pending once the shadow is gone,
+    // but this one may never have reached it
+    Lock lock(m_mutex);
+    if (m_pending.erase(tag)) {
+      if (spawn) m_spawning--;
+      errno = EPIPE;
+      return false;
+    }
+  }
+
+  {
+    Lock lock(req->getMutex());
+    while (!req->done) {
+      req->wait();
+    }
+  }
+  if (spawn) {
+    Lock lock(m_mutex);
+    m_spawning--;
+  }
+  if (req->ret < 0) errno = req->err;
+  return !req->lost;
+}
+
+void LightProcess::readReplies() {
+  Channel in(m_fin);
+  string line;
+  while (in.readLine(line)) {
+    long long tag = 0, ret = -1;
+    int err = 0, status = 0, fdc = 0;
+    if (sscanf(line.c_str(), "%lld %lld %d %d %d",
+               &tag, &ret, &err, &status, &fdc) != 5) {
+      break;
+    }
+    vector<int> fds;
+    for (int i = 0; i < fdc; i++) {
+      fds.push_back(recv_fd(m_afdt_fd));
+    }
+
+    Request *req = NULL;
+    {
+      Lock lock(m_mutex);
+      map<int64, Request*>::iterator it = m_pending.find(tag);
+      if (it != m_pending.end()) {
+        req = it->second;
+        m_pending.erase(it);
+      }
+    }
+    if (!req) {
+      close_fds(fds);
+      continue;
+    }
+
+    Lock lock(req->getMutex());
+    req->ret = ret;
+    req->err = err;
+    req->status = status;
+    req->fds.swap(fds);
+    req->done = true;
+    req->notify();
+  }
+  failPending();
+}
+
+void LightProcess::failPending() {
+  map<int64, Request*> pending;
+  {
+    Lock lock(m_mutex);
+    m_alive = false;
+    pending.swap(m_pending);
+  }
+  for (map<int64, Request*>::iterator it = pending.begin();
+       it != pending.end(); ++it) {
+    Request *req = it->second;
+    Lock lock(req->getMutex());
+    req->ret = -1;
+    req->err = EPIPE;
+    req->lost = true;
+    req->done = true;
+    req->notify();
+  }
+}
+
+LightProcess *LightProcess::Pick() {
+  int count = g_count;
+  LightProcess *best = NULL;
+  for (int i = 0; i < count; i++) {
+    LightProcess *proc = g_procs[i];
+    if (proc->m_alive &&
+        (best == NULL || proc->m_spawning < best->m_spawning)) {
+      best = proc;
+    }
+  }
+  if (best && best->m_spawning >= GrowThreshold &&
+      count < (int)g_procs.size()) {
+    LightProcess *grown = Grow();
+    if (grown) best = grown;
+  }
+  return best;
+}
+
+LightProcess *LightProcess::Grow() {
+  Lock lock(s_growMutex);
+  int count = g_count;
+  if (count == 0 || count >= (int)g_procs.size()) return NULL;
+  for (int i = 0; i < count; i++) {
+    if (g_procs[i]->m_spawning < GrowThreshold) {
+      // somebody else grew the pool, or a shadow freed up meanwhile
+      return g_procs[i];
+    }
+  }
+
+  Request req;
+  if (!g_procs[0]->call(&req, "spawn_shadow", vector<string>(),
+                        vector<int>())) {
+    return NULL;
+  }
+  if (req.ret < 0 || req.fds.size() != 3 ||
+      req.fds[0] < 0 || req.fds[1] < 0 || req.fds[2] < 0) {
+    close_fds(req.fds);
+    Logger::Warning("Unable to start another light process: %d %s",
+                    req.err, Util::safe_strerror(req.err).c_str());
+    return NULL;
+  }
+
+  LightProcess *proc = new LightProcess();
+  // the shadow sent its ends of the request pipe, reply pipe and socket
+  proc->attach(req.fds[1], req.fds[0], req.fds[2]);
+  g_procs[count] = proc;
+  __sync_synchronize();
+  g_count = count + 1;
+  return proc;
+}
+
+LightProcess *LightProcess::Owner(pid_t pid) {
+  Lock lock(s_ownerMutex);
+  map<pid_t, LightProcess*>::const_iterator it = s_owners.find(pid);
+  return it == s_owners.end() ? NULL : it->second;
 }
 
 FILE *LightProcess::popen(const char *cmd, const char *type,
@@ -450,125 +948,121 @@ FILE *LightProcess::HeavyPopenImpl(const char *cmd, const char *type,
 
 FILE *LightProcess::LightPopenImpl(const char *cmd, const char *type,
                                    const char *cwd) {
-  int id = GetId();
-  Lock lock(g_procs[id].m_procMutex);
+  LightProcess *proc = Pick();
+  if (!proc) return NULL;
 
-  fprintf(g_procs[id].m_fout, "popen\n%s\n%s\n%s\n", type, cmd, cwd);
-  fflush(g_procs[id].m_fout);
+  vector<string> args;
+  args.push_back(type);
+  args.push_back(cmd);
+  args.push_back(cwd ? cwd : "");
 
-  char buf[BUFFER_SIZE];
-  read_buf(g_procs[id].m_fin, buf);
-  if (strncmp(buf, "error", 5) == 0) {
+  Request req;
+  if (!proc->call(&req, "popen", args, vector<int>(), true)) {
     return NULL;
   }
-
-  int64 fptr = 0;
-  read_buf(g_procs[id].m_fin, buf);
-  sscanf(buf, "%lld", &fptr);
-  if (!fptr) {
+  if (req.ret <= 0 || req.fds.size() != 1 || req.fds[0] < 0) {
+    // no need to keep the errno, as the caller will try ::popen
+    close_fds(req.fds);
     return NULL;
   }
 
-  int fd = recv_fd(g_procs[id].m_afdt_fd);
-  if (fd < 0) {
+  pid_t pid = (pid_t)req.ret;
+  {
+    Lock lock(s_ownerMutex);
+    s_owners[pid] = proc;
+  }
+  FILE *f = fdopen(req.fds[0], type);
+  if (!f) {
+    ::close(req.fds[0]);
+    int stat;
+    waitpid(pid, &stat, 0);
     return NULL;
   }
-  FILE *f = fdopen(fd, type);
-  g_procs[id].m_popenMap[(int64)f] = fptr;
-
+  Lock lock(s_ownerMutex);
+  s_popens[f] = pid;
   return f;
 }
 
 int LightProcess::pclose(FILE *f) {
-  if (!Available()) {
-    return ::pclose(f);
-  }
-
-  int id = GetId();
-  Lock lock(g_procs[id].m_procMutex);
-
-  map<int64, int64>::iterator it = g_procs[id].m_popenMap.find((int64)f);
-  if (it == g_procs[id].m_popenMap.end()) {
-    // try to close it with normal pclose
-    return ::pclose(f);
+  pid_t pid;
+  {
+    Lock lock(s_ownerMutex);
+    map<FILE*, pid_t>::iterator it = s_popens.find(f);
+    if (it == s_popens.end()) {
+      // try to close it with normal pclose
+      return ::pclose(f);
+    }
+    pid = it->second;
+    s_popens.erase(it);
   }
 
-  g_procs[id].m_popenMap.erase((int64)f);
   fclose(f);
-  fprintf(g_procs[id].m_fout, "pclose\n%lld\n", it->second);
-  fflush(g_procs[id].m_fout);
-
-  char buf[BUFFER_SIZE];
-  read_buf(g_procs[id].m_fin, buf);
-  int ret = -1;
-  sscanf(buf, "%d", &ret);
-  if (ret < 0) {
-    read_buf(g_procs[id].m_fin, buf);
-    sscanf(buf, "%d", &errno);
+  int stat;
+  if (waitpid(pid, &stat, 0) != pid) {
+    return -1;
   }
-  return ret;
+  return stat;
 }
 
 pid_t LightProcess::proc_open(const char *cmd, const vector<int> &created,
                               const vector<int> &desired,
                               const char *cwd, const vector<string> &env) {
-  int id = GetId();
-  Lock lock(g_procs[id].m_procMutex);
   assert(Available());
   assert(created.size() == desired.size());
 
-  fprintf(g_procs[id].m_fout, "proc_open\n%s\n%s\n", cmd, cwd);
-  fprintf(g_procs[id].m_fout, "%d\n", (int)env.size());
-  for (unsigned int i = 0; i < env.size(); i++) {
-    fprintf(g_procs[id].m_fout, "%s\n", env[i].c_str());
+  LightProcess *proc = Pick();
+  if (!proc) {
+    errno = EPIPE;
+    return -1;
   }
 
-  fprintf(g_procs[id].m_fout, "%d\n", (int)created.size());
-
+  vector<string> args;
+  args.push_back(cmd);
+  args.push_back(cwd ? cwd : "");
   for (unsigned int i = 0; i < desired.size(); i++) {
-    fprintf(g_procs[id].m_fout, "%d\n", desired[i]);
-  }
-  fflush(g_procs[id].m_fout);
-  char buf[BUFFER_SIZE];
-  for (unsigned int i = 0; i < created.size(); i++) {
-    if (!send_fd(g_procs[id].m_afdt_fd, created[i])) break;
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%d", desired[i]);
+    args.push_back(buf);
   }
+  args.insert(args.end(), env.begin(), env.end());
 
-  read_buf(g_procs[id].m_fin, buf);
-  if (strncmp(buf, "error", 5) == 0) {
-    read_buf(g_procs[id].m_fin, buf);
-    sscanf(buf, "%d", &errno);
+  Request req;
+  if (!proc->call(&req, "proc_open", args, created, true)) {
+    return -1;
+  }
+  if (req.ret < 0) {
     return -1;
   }
-  int64 pid = -1;
-  sscanf(buf, "%lld", &pid);
-  return (pid_t)pid;
+  Lock lock(s_ownerMutex);
+  s_owners[(pid_t)req.ret] = proc;
+  return (pid_t)req.ret;
 }
 
 pid_t LightProcess::waitpid(pid_t pid, int *stat_loc, int options) {
-  if (!Available()) {
-    // light process is not really there
+  LightProcess *proc = pid > 0 ? Owner(pid) : NULL;
+  if (!proc) {
+    // not started through a shadow, or light process is not really there
     return ::waitpid(pid, stat_loc, options);
   }
 
-  int id = GetId();
-  Lock lock(g_procs[id].m_procMutex);
-
-  fprintf(g_procs[id].m_fout, "waitpid\n%lld %d\n", (int64)pid, options);
-  fflush(g_procs[id].m_fout);
+  vector<string> args;
+  char buf[32];
+  snprintf(buf, sizeof(buf), "%lld", (int64)pid);
+  args.push_back(buf);
+  snprintf(buf, sizeof(buf), "%d", options);
+  args.push_back(buf);
 
-  char buf[BUFFER_SIZE];
-  read_buf(g_procs[id].m_fin, buf);
-  if (!buf[0]) return -1;
-  int64 ret;
-  int stat;
-  sscanf(buf, "%lld %d", &ret, &stat);
-  *stat_loc = stat;
-  if (ret < 0) {
-    read_buf(g_procs[id].m_fin, buf);
-    sscanf(buf, "%d", &errno);
+  Request req;
+  if (!proc->call(&req, "waitpid", args, vector<int>())) {
+    errno = ECHILD;
+    return -1;
+  }
+  *stat_loc = req.status;
+  if (req.ret == pid && (WIFEXITED(req.status) || WIFSIGNALED(req.status))) {
+    Lock lock(s_ownerMutex);
+    s_owners.erase(pid);
   }
-  return (pid_t)ret;
+  return (pid_t)req.ret;
 }
 
 pid_t LightProcess::pcntl_waitpid(pid_t pid, int *stat_loc, int options) {
@@ -576,13 +1070,13 @@ pid_t LightProcess::pcntl_waitpid(pid_t pid, int *stat_loc, int options) {
     return ::waitpid(pid, stat_loc, options);
   }
 
-  int id = GetId();
-  Lock lock(g_procs[id].m_procMutex);
-
   pid_t p = ::waitpid(pid, stat_loc, options);
-  if (p == g_procs[id].m_shadowProcess) {
-    // got the shadow process, wait again
-    p = ::waitpid(pid, stat_loc, options);
+  for (int i = 0; p > 0 && i < g_count; i++) {
+    if (p == g_procs[i]->m_shadowProcess) {
+      // got the shadow process, wait again
+      p = ::waitpid(pid, stat_loc, options);
+      break;
+    }
   }
 
   return p;
@@ -590,10 +1084,9 @@ pid_t LightProcess::pcntl_waitpid(pid_t pid, int *stat_loc, int options) {
 
 void LightProcess::ChangeUser(const string &username) {
   if (username.empty()) return;
-  for (unsigned i = 0; i < g_procs.size(); i++) {
-    Lock lock(g_procs[i].m_procMutex);
-    fprintf(g_procs[i].m_fout, "change_user\n%s\n", username.c_str());
-    fflush(g_procs[i].m_fout);
+  vector<string> args(1, username);
+  for (int i = 0; i < g_count; i++) {
+    g_procs[i]->call(NULL, "change_user", args, vector<int>());
   }
 }
 
@@ -19,6 +19,7 @@
 
 #include "process.h"
 #include "lock.h"
+#include "async_func.h"
 #include <string>
 #include <vector>
 
@@ -26,6 +27,18 @@ namespace HPHP {
 ///////////////////////////////////////////////////////////////////////////////
 // light-weight process
 
+/**
+ * Small "shadow" processes forked early, while the server is still small,
+ * that start children on its behalf so a shell-out never has to fork the
+ * whole server.
+ *
+ * Requests to a shadow are tagged and pipelined: any number of threads can
+ * have requests out to the same shadow, and it answers each one when it is
+ * done rather than in order, so a proc_close() waiting on a slow child does
+ * not hold up everybody else's popen(). Spawns go to the least busy shadow,
+ * and more shadows are started, up to the maximum given to Initialize(),
+ * when all of them have several spawns in flight.
+ */
 class LightProcess {
 public:
   LightProcess();
@@ -33,9 +46,16 @@ public:
 
   static void Close();
   static bool Available();
-  static void Initialize(const std::string &prefix, int count);
+  static void Initialize(const std::string &prefix, int count,
+                         int maxCount = 0);
   static void ChangeUser(const std::string &username);
 
+  /**
+   * Number of shadow processes currently running, including the ones
+   * started on demand.
+   */
+  static int GetCount();
+
   static FILE *popen(const char *cmd, const char *type,
                      const char *cwd = NULL);
   static int pclose(FILE *f);
@@ -61,12 +81,33 @@ public:
 
   static pid_t pcntl_waitpid(pid_t pid, int *stat_loc, int options);
 
+  /**
+   * A new shadow is started when every running one already has this many
+   * popen() or proc_open() requests in flight.
+   */
+  static const int GrowThreshold = 2;
+
 private:
-  static int GetId();
+  struct Request;
+
+  static LightProcess *Pick();
+  static LightProcess *Grow();
+  static LightProcess *Owner(pid_t pid);
 
   bool initShadow(const std::string &prefix, int id);
-  void runShadow(int fdin, int fdout);
+  bool attach(int fin, int fout, int afdt_fd);
   void closeShadow();
+  static void RunShadow(int fdin, int fdout, int afdt_fd);
+
+  /**
+   * Sends one request and, unless req is NULL, waits for its reply.
+   * Returns false when the shadow is gone; errno is set either way.
+   */
+  bool call(Request *req, const char *cmd,
+            const std::vector<std::string> &args,
+            const std::vector<int> &fds, bool spawn = false);
+  void readReplies();
+  void failPending();
 
   static FILE *LightPopenImpl(const char *cmd, const char *type,
                               const char *cwd);
@@ -74,13 +115,20 @@ private:
                               const char *cwd);
 
   static Mutex s_mutex;
-  pid_t m_shadowProcess;
-  FILE *m_fin;   // the pipe to read from the child
-  FILE *m_fout;  // the pipe to write to the child
-  Mutex m_procMutex;
-  std::string m_afdtFilename;
+  pid_t m_shadowProcess; // 0 for shadows started by another shadow
+  int m_fin;   // the pipe to read from the child
+  int m_fout;  // the pipe to write to the child
   int m_afdt_fd;
-  std::map<int64, int64> m_popenMap;
+  std::string m_afdtFilename;
+  Mutex m_writeMutex; // held for a whole request, descriptors included
+
+  Mutex m_mutex;      // guards everything below
+  bool m_alive;
+  int64 m_lastTag;
+  std::map<int64, Request*> m_pending;
+  int m_spawning;     // popen() and proc_open() calls in flight
+
+  AsyncFunc<LightProcess> *m_reader;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,669 @@
+/*
+   +----------------------------------------------------------------------+
+   | HipHop for PHP                                                       |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2010 Facebook, Inc. (http://www.facebook.com)          |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 3.01 of the PHP license,      |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available through the world-wide-web at the following url:           |
+   | http://www.php.net/license/3_01.txt                                  |
+   | If you did not receive a copy of the PHP license and are unable to   |
+   | obtain it through the world-wide-web, please send a note to          |
+   | license@php.net so we can mail you a copy immediately.               |
+   +----------------------------------------------------------------------+
+*/
+
+#include <util/shared_memory_table.h>
+#include <util/hash.h>
+#include <util/logger.h>
+#include <util/util.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+namespace HPHP {
+///////////////////////////////////////////////////////////////////////////////
+// layout
+
+static const int64 PageSize = 4096; // the header's, before the buckets
+
+// free list heads: a 24-bit counter above a 40-bit offset
+static const int OffsetBits = 40;
+static const uint64 OffsetMask = (1ULL << OffsetBits) - 1;
+
+struct SharedMemoryTable::Header {
+  int32 magic;
+  int32 version;
+  volatile int32 ready;   // set by the creator after everything else
+  int32 creator;          // pid
+  int64 size;
+  int64 bucketCount;
+  int64 slabStart;
+  volatile int64 slabNext;
+  volatile int64 slabs;
+  volatile int64 entries;
+  volatile int64 failed;
+  volatile int64 recovered;
+  volatile uint64 freeLists[NumSizeClasses];
+};
+
+struct SharedMemoryTable::Bucket {
+  volatile uint64 word;       // sequence number << 32 | writer's pid
+  volatile int64 head;
+  volatile int64 pendingNew;  // being linked in by the writer
+  volatile int64 pendingOld;  // being linked out by the writer
+};
+
+struct SharedMemoryTable::Record {
+  volatile int64 next;        // in a chain or a free list
+  int64 expiry;
+  uint32 hash;
+  int32 keyLen;
+  int32 valueLen;
+  int16 sizeClass;
+  int16 type;
+
+  char *data() { return (char*)(this + 1);}
+  const char *data() const { return (const char*)(this + 1);}
+};
+
+static uint64 bucket_word(uint32 seq, uint32 pid) {
+  return ((uint64)seq << 32) | pid;
+}
+
+static uint64 list_head(uint64 oldHead, int64 offset) {
+  return (((oldHead >> OffsetBits) + 1) << OffsetBits) | offset;
+}
+
+// Readers only load, and x86 doesn't reorder loads with loads, so keeping
+// the compiler from moving them across the sequence checks is enough.
+static inline void compiler_barrier() {
+  asm volatile("" ::: "memory");
+}
+
+int SharedMemoryTable::GetBlockSize(int sizeClass) {
+  return ((sizeClass & 1) ? 96 : 64) << (sizeClass >> 1);
+}
+
+int SharedMemoryTable::GetSizeClass(int bytes) {
+  if (bytes <= MinBlockSize) return 0;
+  if (bytes > SlabSize) return -1;
+  int bits = 63 - __builtin_clzll(bytes - 1); // 2^bits < bytes <= 2^(bits+1)
+  if (bytes <= 3 << (bits - 1)) {
+    return (bits - 6) * 2 + 1;
+  }
+  return (bits - 5) * 2;
+}
+
+int SharedMemoryTable::MaxValueSize(int keyLen) {
+  return SlabSize - sizeof(Record) - keyLen;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// mapping
+
+SharedMemoryTable *SharedMemoryTable::Open(const string &path, int64 size) {
+  size &= ~(PageSize - 1);
+  for (int attempt = 0; attempt < 10; attempt++) {
+    int fd = open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd >= 0) {
+      return Create(path, fd, size);
+    }
+    if (errno != EEXIST) {
+      Logger::Error("Unable to create %s: %s", path.c_str(),
+                    Util::safe_strerror(errno).c_str());
+      return NULL;
+    }
+    fd = open(path.c_str(), O_RDWR);
+    if (fd < 0) {
+      if (errno == ENOENT) continue; // just removed as stale
+      Logger::Error("Unable to open %s: %s", path.c_str(),
+                    Util::safe_strerror(errno).c_str());
+      return NULL;
+    }
+    bool stale = false;
+    SharedMemoryTable *table = Attach(path, fd, stale);
+    if (table || !stale) {
+      return table;
+    }
+    Logger::Warning("Replacing %s, which was made by an older or another "
+                    "build, or was not finished", path.c_str());
+    ::unlink(path.c_str());
+  }
+  Logger::Error("Unable to open %s: kept being replaced", path.c_str());
+  return NULL;
+}
+
+SharedMemoryTable *SharedMemoryTable::Create(const string &path, int fd,
+                                             int64 size) {
+  int64 bucketCount = 1024;
+  while (bucketCount * 1024 < size) bucketCount <<= 1;
+  int64 slabStart = PageSize + bucketCount * sizeof(Bucket);
+  slabStart = (slabStart + PageSize - 1) & ~(PageSize - 1);
+  if (slabStart + SlabSize > size) {
+    Logger::Error("Unable to create %s: %lld bytes are too few",
+                  path.c_str(), size);
+    close(fd);
+    ::unlink(path.c_str());
+    return NULL;
+  }
+
+  // ftruncate() zero-fills, which is what empty buckets and lists are
+  void *base = MAP_FAILED;
+  if (ftruncate(fd, size) == 0) {
+    base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  }
+  if (base == MAP_FAILED) {
+    Logger::Error("Unable to map %s: %s", path.c_str(),
+                  Util::safe_strerror(errno).c_str());
+    close(fd);
+    ::unlink(path.c_str());
+    return NULL;
+  }
+  close(fd);
+
+  Header *h = (Header*)base;
+  h->creator = getpid();
+  h->magic = Magic;
+  h->version = Version;
+  h->size = size;
+  h->bucketCount = bucketCount;
+  h->slabStart = slabStart;
+  h->slabNext = slabStart;
+  __sync_synchronize();
+  h->ready = 1;
+  return new SharedMemoryTable(path, (char*)base, size);
+}
+
+SharedMemoryTable *SharedMemoryTable::Attach(const string &path, int fd,
+                                             bool &stale) {
+  // wait up to a second for the creator to finish
+  void *page = MAP_FAILED;
+  for (int i = 0; ; i++) {
+    struct stat sb;
+    if (page == MAP_FAILED && fstat(fd, &sb) == 0 && sb.st_size >= PageSize) {
+      page = mmap(NULL, PageSize, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    if (page != MAP_FAILED && ((Header*)page)->ready) break;
+    if (i == 100) {
+      int creator = page != MAP_FAILED ? ((Header*)page)->creator : 0;
+      stale = creator <= 0 || (kill(creator, 0) < 0 && errno == ESRCH);
+      if (!stale) {
+        Logger::Error("Unable to open %s: pid %d is still creating it",
+                      path.c_str(), creator);
+      }
+      if (page != MAP_FAILED) munmap(page, PageSize);
+      close(fd);
+      return NULL;
+    }
+    usleep(10000);
+  }
+
+  Header h = *(Header*)page;
+  munmap(page, PageSize);
+  if (h.magic != Magic || h.version != Version) {
+    stale = true;
+    close(fd);
+    return NULL;
+  }
+
+  struct stat sb;
+  void *base = MAP_FAILED;
+  if (fstat(fd, &sb) == 0 && sb.st_size >= h.size) {
+    base = mmap(NULL, h.size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  }
+  close(fd);
+  if (base == MAP_FAILED) {
+    Logger::Error("Unable to map %s: %s", path.c_str(),
+                  Util::safe_strerror(errno).c_str());
+    return NULL;
+  }
+  return new SharedMemoryTable(path, (char*)base, h.size);
+}
+
+SharedMemoryTable::SharedMemoryTable(const string &path, char *base,
+                                     int64 size)
+  : m_path(path), m_base(base), m_size(size) {
+  m_header = (Header*)m_base;
+  m_buckets = (Bucket*)(m_base + PageSize);
+  m_bucketMask = m_header->bucketCount - 1;
+}
+
+SharedMemoryTable::~SharedMemoryTable() {
+  munmap(m_base, m_size);
+}
+
+int64 SharedMemoryTable::getEntryCount() const {
+  return m_header->entries;
+}
+
+int64 SharedMemoryTable::getFailedStores() const {
+  return m_header->failed;
+}
+
+int64 SharedMemoryTable::getRecoveredBuckets() const {
+  return m_header->recovered;
+}
+
+int64 SharedMemoryTable::getSlabCount() const {
+  return m_header->slabs;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// readers
+
+SharedMemoryTable::Bucket *SharedMemoryTable::getBucket(uint32 hash) const {
+  return &m_buckets[hash & m_bucketMask];
+}
+
+bool SharedMemoryTable::isValidBlock(int64 offset) const {
+  int64 end = m_header->slabNext;
+  if (end > m_size) end = m_size;
+  return offset >= m_header->slabStart &&
+    offset + (int64)sizeof(Record) <= end && (offset & 31) == 0;
+}
+
+const SharedMemoryTable::Record *
+SharedMemoryTable::readRecord(int64 offset, Record &copy) const {
+  // a reader may be looking at a block that was just reused, so nothing in
+  // it is trusted before it's checked
+  if (!isValidBlock(offset)) return NULL;
+  const Record *r = getRecord(offset);
+  memcpy(&copy, (const void*)r, sizeof(Record));
+  if (copy.sizeClass < 0 || copy.sizeClass >= NumSizeClasses ||
+      copy.keyLen < 0 || copy.valueLen < 0) {
+    return NULL;
+  }
+  int64 blockSize = GetBlockSize(copy.sizeClass);
+  if (offset + blockSize > m_size ||
+      (int64)sizeof(Record) + copy.keyLen + copy.valueLen > blockSize) {
+    return NULL;
+  }
+  return r;
+}
+
+bool SharedMemoryTable::Expired(const Record *r, int64 now) {
+  return r->expiry && now >= r->expiry;
+}
+
+void SharedMemoryTable::wait(Bucket *b, uint64 word, int tries) const {
+  if (tries % 64) return;
+  // a reader doesn't write unless the writer it waits for has died
+  if (tries % 1024 == 0 &&
+      const_cast<SharedMemoryTable*>(this)->takeOver(b, word)) {
+    const_cast<SharedMemoryTable*>(this)->unlock(b);
+    return;
+  }
+  sched_yield();
+}
+
+bool SharedMemoryTable::get(const char *key, int len, string &value,
+                            int &type, int64 now) const {
+  uint32 hash = hash_string(key, len);
+  Bucket *b = getBucket(hash);
+  for (int tries = 1; ; tries++) {
+    uint64 word = b->word;
+    if ((word >> 32) & 1) {
+      wait(b, word, tries);
+      continue;
+    }
+    compiler_barrier();
+
+    bool found = false;
+    int64 expiry = 0;
+    int64 offset = b->head;
+    for (int n = 0; offset && n < MaxChain; n++) {
+      Record copy;
+      const Record *r = readRecord(offset, copy);
+      if (!r) break;
+      if (copy.hash == hash && copy.keyLen == len &&
+          memcmp(r->data(), key, len) == 0) {
+        value.assign(r->data() + len, copy.valueLen);
+        type = copy.type;
+        expiry = copy.expiry;
+        found = true;
+        break;
+      }
+      offset = copy.next;
+    }
+
+    compiler_barrier();
+    if (b->word == word) {
+      return found && !(expiry && now >= expiry);
+    }
+  }
+}
+
+void SharedMemoryTable::dump(vector<Entry> &entries) const {
+  vector<Entry> chain;
+  for (int64 i = 0; i <= m_bucketMask; i++) {
+    Bucket *b = &m_buckets[i];
+    for (int tries = 1; ; tries++) {
+      uint64 word = b->word;
+      if ((word >> 32) & 1) {
+        wait(b, word, tries);
+        continue;
+      }
+      compiler_barrier();
+
+      chain.clear();
+      int64 offset = b->head;
+      for (int n = 0; offset && n < MaxChain; n++) {
+        Record copy;
+        const Record *r = readRecord(offset, copy);
+        if (!r) break;
+        chain.resize(chain.size() + 1);
+        Entry &entry = chain.back();
+        entry.key.assign(r->data(), copy.keyLen);
+        entry.value.assign(r->data() + copy.keyLen, copy.valueLen);
+        entry.type = copy.type;
+        entry.expiry = copy.expiry;
+        offset = copy.next;
+      }
+
+      compiler_barrier();
+      if (b->word == word) break;
+    }
+    entries.insert(entries.end(), chain.begin(), chain.end());
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// writers
+
+void SharedMemoryTable::lock(Bucket *b) {
+  uint32 pid = getpid();
+  for (int spins = 1; ; spins++) {
+    uint64 word = b->word;
+    uint32 seq = word >> 32;
+    if (!(seq & 1)) {
+      if (__sync_bool_compare_and_swap(&b->word, word,
+                                       bucket_word(seq + 1, pid))) {
+        return;
+      }
+      continue;
+    }
+    if (spins % 1024 == 0) {
+      if (takeOver(b, word)) return;
+      sched_yield();
+    }
+  }
+}
+
+bool SharedMemoryTable::takeOver(Bucket *b, uint64 word) {
+  uint32 pid = getpid();
+  pid_t owner = (uint32)word;
+  if (owner <= 0 || (uint32)owner == pid ||
+      kill(owner, 0) == 0 || errno != ESRCH) {
+    return false;
+  }
+  // still odd, so readers keep waiting until recovery is done
+  if (!__sync_bool_compare_and_swap(&b->word, word,
+                                    bucket_word((word >> 32) + 2, pid))) {
+    return false;
+  }
+  __sync_fetch_and_add(&m_header->recovered, 1);
+  recover(b);
+  return true;
+}
+
+void SharedMemoryTable::unlock(Bucket *b) {
+  uint32 seq = b->word >> 32;
+  __sync_synchronize();
+  b->word = bucket_word(seq + 1, 0);
+}
+
+void SharedMemoryTable::recover(Bucket *b) {
+  // The chain itself is whole, since it only ever changes by one store.
+  // A block named as pending and not in it is either one that never made
+  // it in, or one that was linked out and not freed yet.
+  int64 pendingNew = b->pendingNew;
+  int64 pendingOld = b->pendingOld;
+  if (pendingNew && isValidBlock(pendingNew) && !inChain(b, pendingNew)) {
+    free(pendingNew);
+  }
+  if (pendingOld && isValidBlock(pendingOld) && !inChain(b, pendingOld)) {
+    free(pendingOld);
+  }
+  b->pendingNew = 0;
+  b->pendingOld = 0;
+}
+
+bool SharedMemoryTable::inChain(Bucket *b, int64 offset) const {
+  int64 cur = b->head;
+  for (int n = 0; cur && n < MaxChain; n++) {
+    if (cur == offset) return true;
+    if (!isValidBlock(cur)) break;
+    cur = getRecord(cur)->next;
+  }
+  return false;
+}
+
+volatile int64 *SharedMemoryTable::find(Bucket *b, uint32 hash,
+                                        const char *key, int len, int64 now) {
+  volatile int64 *at = &b->head;
+  while (int64 offset = *at) {
+    Record *r = getRecord(offset);
+    if (r->hash == hash && r->keyLen == len &&
+        memcmp(r->data(), key, len) == 0) {
+      return at;
+    }
+    if (Expired(r, now)) {
+      unlink(b, at);
+      continue;
+    }
+    at = &r->next;
+  }
+  return NULL;
+}
+
+void SharedMemoryTable::insert(Bucket *b, int64 offset) {
+  getRecord(offset)->next = b->head;
+  b->pendingNew = offset;
+  __sync_synchronize();
+  b->head = offset;
+  __sync_synchronize();
+  b->pendingNew = 0;
+  __sync_fetch_and_add(&m_header->entries, 1);
+}
+
+void SharedMemoryTable::replace(Bucket *b, volatile int64 *at,
+                                int64 offset) {
+  int64 old = *at;
+  getRecord(offset)->next = getRecord(old)->next;
+  b->pendingNew = offset;
+  b->pendingOld = old;
+  __sync_synchronize();
+  *at = offset;
+  __sync_synchronize();
+  b->pendingNew = 0;
+  b->pendingOld = 0;
+  free(old);
+}
+
+void SharedMemoryTable::unlink(Bucket *b, volatile int64 *at) {
+  int64 old = *at;
+  b->pendingOld = old;
+  __sync_synchronize();
+  *at = getRecord(old)->next;
+  __sync_synchronize();
+  b->pendingOld = 0;
+  __sync_fetch_and_add(&m_header->entries, -1);
+  free(old);
+}
+
+bool SharedMemoryTable::store(const char *key, int len, const char *value,
+                              int valueLen, int type, int64 expiry,
+                              bool overwrite, int64 now,
+                              bool *replaced /* = NULL */) {
+  uint32 hash = hash_string(key, len);
+  int64 offset = newRecord(hash, key, len, value, valueLen, type, expiry);
+  if (!offset) {
+    __sync_fetch_and_add(&m_header->failed, 1);
+    return false;
+  }
+
+  Bucket *b = getBucket(hash);
+  lock(b);
+  volatile int64 *at = find(b, hash, key, len, now);
+  bool stored = true;
+  if (!at) {
+    insert(b, offset);
+  } else if (overwrite || Expired(getRecord(*at), now)) {
+    replace(b, at, offset);
+    if (replaced) *replaced = true;
+  } else {
+    stored = false;
+  }
+  unlock(b);
+
+  if (!stored) free(offset);
+  return stored;
+}
+
+bool SharedMemoryTable::erase(const char *key, int len, bool expired,
+                              int64 now) {
+  uint32 hash = hash_string(key, len);
+  Bucket *b = getBucket(hash);
+  lock(b);
+  volatile int64 *at = find(b, hash, key, len, now);
+  bool erased = at && (!expired || Expired(getRecord(*at), now));
+  if (erased) unlink(b, at);
+  unlock(b);
+  return erased;
+}
+
+bool SharedMemoryTable::update(const char *key, int len, Updater &updater,
+                               int64 now) {
+  uint32 hash = hash_string(key, len);
+  Bucket *b = getBucket(hash);
+  lock(b);
+  volatile int64 *at = find(b, hash, key, len, now);
+  bool updated = false;
+  if (at && !Expired(getRecord(*at), now)) {
+    Record *r = getRecord(*at);
+    string value(r->data() + len, r->valueLen);
+    int type = r->type;
+    bool changed;
+    try {
+      changed = updater.update(value, type);
+    } catch (...) {
+      unlock(b);
+      throw;
+    }
+    if (changed) {
+      int64 offset = newRecord(hash, key, len, value.data(), value.size(),
+                               type, r->expiry);
+      if (offset) {
+        replace(b, at, offset);
+        updated = true;
+      } else {
+        __sync_fetch_and_add(&m_header->failed, 1);
+      }
+    }
+  }
+  unlock(b);
+  return updated;
+}
+
+void SharedMemoryTable::clear() {
+  for (int64 i = 0; i <= m_bucketMask; i++) {
+    Bucket *b = &m_buckets[i];
+    if (!b->head) continue;
+    lock(b);
+    while (b->head) {
+      unlink(b, &b->head);
+    }
+    unlock(b);
+  }
+}
+
+void SharedMemoryTable::abandonBucket(const char *key, int len) {
+  lock(getBucket(hash_string(key, len)));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// blocks
+
+int64 SharedMemoryTable::alloc(int sizeClass) {
+  volatile uint64 *list = &m_header->freeLists[sizeClass];
+  while (true) {
+    uint64 head = *list;
+    int64 offset = head & OffsetMask;
+    if (!offset) break;
+    // "next" may be stale if another process pops the block first, in which
+    // case the counter in the head has moved and the CAS fails
+    int64 next = getRecord(offset)->next;
+    if (__sync_bool_compare_and_swap(list, head, list_head(head, next))) {
+      return offset;
+    }
+  }
+
+  int64 slab = __sync_fetch_and_add(&m_header->slabNext, (int64)SlabSize);
+  if (slab + SlabSize > m_size) {
+    return 0;
+  }
+  __sync_fetch_and_add(&m_header->slabs, 1);
+
+  // keep the first block, and hand the rest to the list in one go
+  int blockSize = GetBlockSize(sizeClass);
+  int count = SlabSize / blockSize;
+  for (int i = 0; i < count; i++) {
+    getRecord(slab + (int64)i * blockSize)->sizeClass = sizeClass;
+  }
+  if (count > 1) {
+    for (int i = 1; i < count - 1; i++) {
+      getRecord(slab + (int64)i * blockSize)->next =
+        slab + (int64)(i + 1) * blockSize;
+    }
+    push(sizeClass, slab + blockSize, slab + (int64)(count - 1) * blockSize);
+  }
+  return slab;
+}
+
+void SharedMemoryTable::free(int64 offset) {
+  push(getRecord(offset)->sizeClass, offset, offset);
+}
+
+void SharedMemoryTable::push(int sizeClass, int64 first, int64 last) {
+  volatile uint64 *list = &m_header->freeLists[sizeClass];
+  while (true) {
+    uint64 head = *list;
+    getRecord(last)->next = head & OffsetMask;
+    if (__sync_bool_compare_and_swap(list, head, list_head(head, first))) {
+      return;
+    }
+  }
+}
+
+int64 SharedMemoryTable::newRecord(uint32 hash, const char *key, int len,
+                                   const char *value, int valueLen, int type,
+                                   int64 expiry) {
+  if (len < 0 || valueLen < 0) return 0;
+  int64 bytes = sizeof(Record) + (int64)len + valueLen;
+  if (bytes > SlabSize) return 0;
+
+  int sizeClass = GetSizeClass(bytes);
+  int64 offset = alloc(sizeClass);
+  if (!offset) return 0;
+
+  Record *r = getRecord(offset);
+  r->next = 0;
+  r->expiry = expiry;
+  r->hash = hash;
+  r->keyLen = len;
+  r->valueLen = valueLen;
+  r->sizeClass = sizeClass;
+  r->type = type;
+  memcpy(r->data(), key, len);
+  memcpy(r->data() + len, value, valueLen);
+  return offset;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+}
@@ -0,0 +1,193 @@
+/*
+   +----------------------------------------------------------------------+
+   | HipHop for PHP                                                       |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2010 Facebook, Inc. (http://www.facebook.com)          |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 3.01 of the PHP license,      |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available through the world-wide-web at the following url:           |
+   | http://www.php.net/license/3_01.txt                                  |
+   | If you did not receive a copy of the PHP license and are unable to   |
+   | obtain it through the world-wide-web, please send a note to          |
+   | license@php.net so we can mail you a copy immediately.               |
+   +----------------------------------------------------------------------+
+*/
+
+#ifndef __HPHP_SHARED_MEMORY_TABLE_H__
+#define __HPHP_SHARED_MEMORY_TABLE_H__
+
+#include <util/base.h>
+
+namespace HPHP {
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * A hash table of byte strings in a memory mapped file. Every process that
+ * maps the same file shares it, and no interprocess mutex is involved:
+ *
+ *   Header
+ *   Bucket [bucketCount]   sequence word with writer pid, first record
+ *   slabs                  each one carved into blocks of one size class
+ *
+ * The records of a bucket form a chain of offsets. A writer owns a bucket by
+ * moving its sequence word from even to odd with a CAS, and changes a chain
+ * only by storing the offset of a fully written record, so the chain is
+ * whole after every store. Readers take no lock: they copy what they find
+ * and try again if the sequence word was odd or moved meanwhile, so a block
+ * reused under a reader is noticed instead of returned, and a reader only
+ * ever waits out a change to the bucket it reads. Writers of different
+ * buckets never wait for each other.
+ *
+ * Blocks come from lock-free free lists, one per size class, whose heads
+ * carry a counter against ABA; a class with an empty list takes a new slab
+ * off a bump pointer. Slabs never change class.
+ *
+ * A bucket also names the blocks its writer is linking in and out. When a
+ * process dies owning a bucket, the next reader or writer that finds the
+ * owner's pid gone takes the bucket over and frees whichever of those blocks
+ * is not in the chain, so the table stays consistent and at most a block or
+ * a slab is lost to the crash. A pid reused before that happens looks alive
+ * and keeps the bucket owned until it exits too.
+ */
+class SharedMemoryTable {
+public:
+  enum {
+    Magic = 0x48505354, // "HPST"
+    Version = 1,
+    SlabSize = 1 << 20,
+    MinBlockSize = 64,
+    NumSizeClasses = 29, // 64, 96, 128, 192, ... 1MB
+    MaxChain = 4096,     // beyond this a reader assumes it followed garbage
+  };
+
+  /**
+   * Maps "path", creating it with "size" bytes if it doesn't exist yet, if
+   * it was left half made by a process that has gone, or if it was made with
+   * another layout. Otherwise the table in it is shared as it is, whatever
+   * size it was made with. Returns NULL and logs why if it can't.
+   */
+  static SharedMemoryTable *Open(const std::string &path, int64 size);
+
+  ~SharedMemoryTable();
+
+  const std::string &getPath() const { return m_path;}
+
+  /**
+   * Biggest value a key of keyLen bytes can have.
+   */
+  static int MaxValueSize(int keyLen);
+
+  /**
+   * "type" is the caller's tag of a value, up to 32767, and is kept with
+   * it. An entry whose expiry is set and not after "now" is not found; the
+   * writers of its bucket erase it when they come across it.
+   */
+  bool get(const char *key, int len, std::string &value, int &type,
+           int64 now) const;
+
+  /**
+   * Returns false without storing if "overwrite" is not set and the key has
+   * a live entry, or if the table is out of memory for the value. Sets
+   * "replaced" if an entry was there before.
+   */
+  bool store(const char *key, int len, const char *value, int valueLen,
+             int type, int64 expiry, bool overwrite, int64 now,
+             bool *replaced = NULL);
+
+  /**
+   * With "expired" set, only erases an entry that has expired.
+   */
+  bool erase(const char *key, int len, bool expired, int64 now);
+
+  /**
+   * Read-modify-write of a live entry, with its bucket owned: update() gets
+   * the current value and returns true after changing it to have it stored.
+   * Returns false if the entry doesn't exist, or wasn't changed or stored.
+   */
+  class Updater {
+  public:
+    virtual ~Updater() {}
+    virtual bool update(std::string &value, int &type) = 0;
+  };
+  bool update(const char *key, int len, Updater &updater, int64 now);
+
+  void clear();
+
+  /**
+   * Copies every entry out, the expired ones too, each one as it was at some
+   * point during the call.
+   */
+  struct Entry {
+    std::string key;
+    std::string value;
+    int type;
+    int64 expiry;
+  };
+  void dump(std::vector<Entry> &entries) const;
+
+  /**
+   * Live counters, shared by all processes.
+   */
+  int64 getEntryCount() const;
+  int64 getFailedStores() const;  // out of memory
+  int64 getRecoveredBuckets() const;
+  int64 getSlabCount() const;
+  int64 getSize() const { return m_size;}
+
+  /**
+   * For tests: owns the bucket of a key and returns without giving it back,
+   * as a process dying in the middle of a write would.
+   */
+  void abandonBucket(const char *key, int len);
+
+private:
+  struct Header;
+  struct Bucket;
+  struct Record;
+
+  std::string m_path;
+  char *m_base;
+  int64 m_size;
+  Header *m_header;
+  Bucket *m_buckets;
+  int64 m_bucketMask;
+
+  SharedMemoryTable(const std::string &path, char *base, int64 size);
+  static SharedMemoryTable *Create(const std::string &path, int fd,
+                                   int64 size);
+  static SharedMemoryTable *Attach(const std::string &path, int fd,
+                                   bool &stale);
+
+  static int GetSizeClass(int bytes);
+  static int GetBlockSize(int sizeClass);
+
+  Bucket *getBucket(uint32 hash) const;
+  Record *getRecord(int64 offset) const { return (Record*)(m_base + offset);}
+  bool isValidBlock(int64 offset) const;
+  const Record *readRecord(int64 offset, Record &copy) const;
+  static bool Expired(const Record *r, int64 now);
+
+  void wait(Bucket *b, uint64 word, int tries) const;
+  void lock(Bucket *b);
+  void unlock(Bucket *b);
+  bool takeOver(Bucket *b, uint64 word);
+  void recover(Bucket *b);
+  bool inChain(Bucket *b, int64 offset) const;
+  volatile int64 *find(Bucket *b, uint32 hash, const char *key, int len,
+                       int64 now);
+  void insert(Bucket *b, int64 offset);
+  void replace(Bucket *b, volatile int64 *at, int64 offset);
+  void unlink(Bucket *b, volatile int64 *at);
+
+  int64 alloc(int sizeClass);
+  void free(int64 offset);
+  void push(int sizeClass, int64 first, int64 last);
+  int64 newRecord(uint32 hash, const char *key, int len, const char *value,
+                  int valueLen, int type, int64 expiry);
+};
+
+///////////////////////////////////////////////////////////////////////////////
+}
+
+#endif // __HPHP_SHARED_MEMORY_TABLE_H__
@@ -20,8 +20,13 @@
 namespace HPHP {
 ///////////////////////////////////////////////////////////////////////////////
 
-Synchronizable::Synchronizable() {
-  pthread_cond_init(&m_cond, NULL);
+Synchronizable::Synchronizable(clockid_t clock /* = CLOCK_REALTIME */)
+  : m_clock(clock) {
+  pthread_condattr_t attr;
+  pthread_condattr_init(&attr);
+  pthread_condattr_setclock(&attr, clock);
+  pthread_cond_init(&m_cond, &attr);
+  pthread_condattr_destroy(&attr);
 }
 
 Synchronizable::~Synchronizable() {
@@ -43,9 +48,13 @@ bool Synchronizable::wait(long long seconds) {
 
 bool Synchronizable::wait(long long seconds, long long nanosecs) {
   struct timespec ts;
-  clock_gettime(CLOCK_REALTIME, &ts);
+  clock_gettime(m_clock, &ts);
   ts.tv_sec += seconds;
   ts.tv_nsec += nanosecs;
+  if (ts.tv_nsec >= 1000000000) {
+    ts.tv_sec += ts.tv_nsec / 1000000000;
+    ts.tv_nsec %= 1000000000;
+  }
 
   int ret = pthread_cond_timedwait(&m_cond, &m_mutex.getRaw(), &ts);
   ASSERT(ret != EPERM); // did you lock the mutex?
@@ -19,6 +19,7 @@
 
 #include "mutex.h"
 #include <pthread.h>
+#include <time.h>
 
 namespace HPHP {
 ///////////////////////////////////////////////////////////////////////////////
@@ -29,7 +30,11 @@ namespace HPHP {
  */
 class Synchronizable {
  public:
-  Synchronizable();
+  /**
+   * Timed waits measure their timeout on this clock. CLOCK_MONOTONIC makes
+   * them immune to the time of day being set.
+   */
+  Synchronizable(clockid_t clock = CLOCK_REALTIME);
   virtual ~Synchronizable();
 
   void wait();
@@ -43,6 +48,7 @@ class Synchronizable {
  private:
   Mutex m_mutex;
   pthread_cond_t m_cond;
+  clockid_t m_clock;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
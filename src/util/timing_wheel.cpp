@@ -0,0 +1,146 @@
+/*
+   +----------------------------------------------------------------------+
+   | HipHop for PHP                                                       |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2010 Facebook, Inc. (http://www.facebook.com)          |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 3.01 of the PHP license,      |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available through the world-wide-web at the following url:           |
+   | http://www.php.net/license/3_01.txt                                  |
+   | If you did not receive a copy of the PHP license and are unable to   |
+   | obtain it through the world-wide-web, please send a note to          |
+   | license@php.net so we can mail you a copy immediately.               |
+   +----------------------------------------------------------------------+
+*/
+
+#include <util/timing_wheel.h>
+
+using namespace std;
+
+namespace HPHP {
+///////////////////////////////////////////////////////////////////////////////
+
+TimingWheel::TimingWheel(int timerCount, int64 now)
+  : m_now(now), m_count(0), m_when(timerCount, 0), m_slot(timerCount, -1),
+    m_prev(timerCount, -1), m_next(timerCount, -1),
+    m_heads(Slots + (Levels - 1) * HigherSlots, -1) {
+}
+
+int TimingWheel::SlotOf(int level, int64 when) {
+  if (level == 0) {
+    return when & (Slots - 1);
+  }
+  int shift = Bits + (level - 1) * HigherBits;
+  return Slots + (level - 1) * HigherSlots +
+    ((when >> shift) & (HigherSlots - 1));
+}
+
+void TimingWheel::link(int timer) {
+  int64 delta = m_when[timer] - m_now;
+  int slot;
+  if (delta < 0) {
+    slot = SlotOf(0, m_now); // fires with the next tick processed
+  } else if (delta < Slots) {
+    slot = SlotOf(0, m_when[timer]);
+  } else if (delta < 1LL << (Bits + HigherBits)) {
+    slot = SlotOf(1, m_when[timer]);
+  } else if (delta < 1LL << (Bits + 2 * HigherBits)) {
+    slot = SlotOf(2, m_when[timer]);
+  } else if (delta < 1LL << (Bits + 3 * HigherBits)) {
+    slot = SlotOf(3, m_when[timer]);
+  } else {
+    if (delta > 0xFFFFFFFFLL) {
+      m_when[timer] = m_now + 0xFFFFFFFFLL;
+    }
+    slot = SlotOf(4, m_when[timer]);
+  }
+
+  int head = m_heads[slot];
+  m_slot[timer] = slot;
+  m_prev[timer] = -1;
+  m_next[timer] = head;
+  if (head >= 0) m_prev[head] = timer;
+  m_heads[slot] = timer;
+}
+
+void TimingWheel::unlink(int timer) {
+  int prev = m_prev[timer];
+  int next = m_next[timer];
+  if (prev >= 0) {
+    m_next[prev] = next;
+  } else {
+    m_heads[m_slot[timer]] = next;
+  }
+  if (next >= 0) m_prev[next] = prev;
+  m_slot[timer] = -1;
+}
+
+void TimingWheel::schedule(int timer, int64 when) {
+  ASSERT(timer >= 0 && timer < (int)m_when.size());
+  if (m_slot[timer] >= 0) {
+    unlink(timer);
+  } else {
+    m_count++;
+  }
+  m_when[timer] = when;
+  link(timer);
+}
+
+void TimingWheel::cancel(int timer) {
+  ASSERT(timer >= 0 && timer < (int)m_when.size());
+  if (m_slot[timer] >= 0) {
+    unlink(timer);
+    m_count--;
+  }
+}
+
+int TimingWheel::cascade(int level) {
+  int slot = SlotOf(level, m_now);
+  int timer = m_heads[slot];
+  m_heads[slot] = -1;
+  while (timer >= 0) {
+    int next = m_next[timer];
+    link(timer);
+    timer = next;
+  }
+  return (slot - Slots) & (HigherSlots - 1);
+}
+
+void TimingWheel::advance(int64 now, vector<int> &expired) {
+  if (m_count == 0) {
+    if (m_now <= now) m_now = now + 1;
+    return;
+  }
+
+  while (m_now <= now) {
+    int index = SlotOf(0, m_now);
+    if (index == 0) {
+      // each wheel that turns over to its first slot turns the next one too
+      for (int level = 1; level < Levels && cascade(level) == 0; level++) {}
+    }
+    m_now++;
+
+    int timer = m_heads[index];
+    m_heads[index] = -1;
+    while (timer >= 0) {
+      int next = m_next[timer];
+      m_slot[timer] = -1;
+      m_count--;
+      expired.push_back(timer);
+      timer = next;
+    }
+  }
+}
+
+int64 TimingWheel::getNextTick() const {
+  for (int64 t = m_now; ; t++) {
+    int index = SlotOf(0, t);
+    if (index == 0 || m_heads[index] >= 0) {
+      return t;
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+}
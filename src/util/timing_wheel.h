@@ -0,0 +1,91 @@
+/*
+   +----------------------------------------------------------------------+
+   | HipHop for PHP                                                       |
+   +----------------------------------------------------------------------+
+   | Copyright (c) 2010 Facebook, Inc. (http://www.facebook.com)          |
+   +----------------------------------------------------------------------+
+   | This source file is subject to version 3.01 of the PHP license,      |
+   | that is bundled with this package in the file LICENSE, and is        |
+   | available through the world-wide-web at the following url:           |
+   | http://www.php.net/license/3_01.txt                                  |
+   | If you did not receive a copy of the PHP license and are unable to   |
+   | obtain it through the world-wide-web, please send a note to          |
+   | license@php.net so we can mail you a copy immediately.               |
+   +----------------------------------------------------------------------+
+*/
+
+#ifndef __HPHP_TIMING_WHEEL_H__
+#define __HPHP_TIMING_WHEEL_H__
+
+#include <util/base.h>
+
+namespace HPHP {
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Hierarchical timing wheel of a fixed number of timers, numbered from 0,
+ * each one either off or due at some tick. Ticks are whatever unit the
+ * caller counts time in, usually milliseconds.
+ *
+ * The first wheel has a slot for each of the next 256 ticks, and each of
+ * the four others has 64 slots as wide as a whole turn of the wheel below.
+ * A timer goes into the finest wheel its distance fits in, and moves down
+ * a wheel when the one below turns over to its slot, so scheduling and
+ * canceling take constant time and each timer moves at most four times.
+ * Timers further than 2^32 ticks away fire at 2^32 ticks.
+ */
+class TimingWheel {
+public:
+  TimingWheel(int timerCount, int64 now);
+
+  int getTimerCount() const { return m_when.size();}
+
+  /**
+   * Sets a timer to fire at "when", moving it if it was on already. A time
+   * that has passed fires at the next advance().
+   */
+  void schedule(int timer, int64 when);
+  void cancel(int timer);
+  bool scheduled(int timer) const { return m_slot[timer] >= 0;}
+  int64 getWhen(int timer) const { return m_when[timer];}
+
+  /**
+   * Moves time up to "now" and turns the timers that became due off,
+   * appending them to "expired" in the order they were due.
+   */
+  void advance(int64 now, std::vector<int> &expired);
+
+  /**
+   * The earliest tick advance() has to be called at not to fire anything
+   * late: the first due timer's within the next 256 ticks, or else when
+   * the first wheel turns over. Nothing is due before it.
+   */
+  int64 getNextTick() const;
+
+private:
+  enum {
+    Bits = 8,           // first wheel
+    Slots = 1 << Bits,
+    HigherBits = 6,     // the four others
+    HigherSlots = 1 << HigherBits,
+    Levels = 5,
+  };
+
+  int64 m_now;          // next tick to process
+  int m_count;          // timers on
+  std::vector<int64> m_when;
+  std::vector<int> m_slot; // -1 if off
+  std::vector<int> m_prev;
+  std::vector<int> m_next;
+  std::vector<int> m_heads; // Slots + (Levels - 1) * HigherSlots lists
+
+  static int SlotOf(int level, int64 when);
+  void link(int timer);
+  void unlink(int timer);
+  int cascade(int level);
+};
+
+///////////////////////////////////////////////////////////////////////////////
+}
+
+#endif // __HPHP_TIMING_WHEEL_H__